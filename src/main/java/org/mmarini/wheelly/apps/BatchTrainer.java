@@ -31,35 +31,42 @@ package org.mmarini.wheelly.apps;
 
 
 import com.fasterxml.jackson.databind.JsonNode;
-import org.datavec.api.records.reader.impl.csv.CSVRecordReader;
-import org.datavec.api.split.FileSplit;
-import org.datavec.api.writable.Writable;
 import org.deeplearning4j.core.storage.StatsStorage;
-import org.deeplearning4j.datasets.datavec.RecordReaderMultiDataSetIterator;
+import org.deeplearning4j.datasets.iterator.AsyncMultiDataSetIterator;
+import org.deeplearning4j.datasets.iterator.file.FileMultiDataSetIterator;
 import org.deeplearning4j.nn.graph.ComputationGraph;
+import org.deeplearning4j.optimize.listeners.ScoreIterationListener;
 import org.deeplearning4j.ui.api.UIServer;
 import org.deeplearning4j.ui.model.stats.StatsListener;
 import org.deeplearning4j.ui.model.storage.InMemoryStatsStorage;
 import org.deeplearning4j.util.ModelSerializer;
 import org.mmarini.yaml.Utils;
 import org.mmarini.yaml.schema.Locator;
+import org.nd4j.linalg.dataset.api.iterator.MultiDataSetIterator;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.io.File;
 import java.io.IOException;
+import java.nio.file.Files;
 import java.util.List;
+import java.util.Random;
 
 import static org.mmarini.wheelly.apps.Yaml.trainer;
 import static org.mmarini.yaml.schema.Locator.locate;
 import static org.nd4j.linalg.factory.Nd4j.zeros;
 
+/**
+ * Trains the network from the csv dataset files.
+ * <p>
+ * The input files are converted in parallel into a cache of binary minibatches
+ * (see {@link TrainingDatasets}) that are loaded by a prefetching iterator in shuffled order during the epochs.
+ * Without a cache folder in the configuration the minibatches are converted into a temporary folder.
+ * </p>
+ */
 public class BatchTrainer {
-    public static final int CRITIC_SIZE = 1;
-    public static final int HALT_ACTOR_SIZE = 2;
-    public static final int DIRECTION_ACTOR_SIZE = 24;
-    public static final int SPEED_ACTOR_SIZE = 21;
-    public static final int SENSOR_ACTOR_SIZE = 9;
+    public static final int DEFAULT_PREFETCH_SIZE = 8;
+    public static final int SCORE_INTERVAL = 100;
     private static final Logger logger = LoggerFactory.getLogger(BatchTrainer.class);
 
     public static void main(String[] args) throws Throwable {
@@ -82,49 +89,59 @@ public class BatchTrainer {
         logger.info("Reading configuration {} ...", confFile);
         JsonNode config = Utils.fromFile(confFile);
         trainer().apply(Locator.root()).accept(config);
-        File inFile = new File(locate("inputFile").getNode(config).asText());
-        logger.info("Reading data file {} ...", inFile);
-        CSVRecordReader reader = new CSVRecordReader(0, ',');
-        reader.initialize(new FileSplit(inFile));
-        List<Writable> record = reader.next();
+        String inputPath = locate("inputFile").getNode(config).asText();
+        List<File> inFiles = TrainingDatasets.listFiles(inputPath);
+        if (inFiles.isEmpty()) {
+            throw new IOException("No data file " + inputPath);
+        }
         int numEpochs = locate("numEpochs").getNode(config).asInt();
         int batchSize = locate("batchSize").getNode(config).asInt();
         int inputSize = locate("inputSize").getNode(config).asInt();
-        int haltActorOffset = inputSize + CRITIC_SIZE;
-        int directionActorOffset = haltActorOffset + HALT_ACTOR_SIZE;
-        int speedActorOffset = directionActorOffset + DIRECTION_ACTOR_SIZE;
-        int sensorActorOffset = speedActorOffset + SPEED_ACTOR_SIZE;
-        int size = sensorActorOffset + SENSOR_ACTOR_SIZE;
-        if (size != record.size()) {
-            logger.error("Wrong record size = {}, file record size = {}",
-                    size,
-                    record.size());
-            throw new Error("Wrong record size");
+        int numThreads = locate("numThreads").getNode(config).asInt(Runtime.getRuntime().availableProcessors());
+        int prefetchSize = locate("prefetchSize").getNode(config).asInt(DEFAULT_PREFETCH_SIZE);
+        boolean shuffle = locate("shuffle").getNode(config).asBoolean(true);
+        boolean ui = locate("ui").getNode(config).asBoolean(true);
+        String cachePath = locate("cacheDir").getNode(config).asText(null);
+        File cacheDir = cachePath != null
+                ? new File(cachePath)
+                : Files.createTempDirectory("wheelly-dataset").toFile();
+
+        if (TrainingDatasets.isCacheValid(cacheDir, inFiles, batchSize, inputSize)) {
+            logger.info("Using cached dataset {}", cacheDir);
+        } else {
+            logger.info("Converting {} data files into {} ...", inFiles.size(), cacheDir);
+            TrainingDatasets.convert(inFiles, cacheDir, batchSize, inputSize, numThreads);
         }
-        RecordReaderMultiDataSetIterator.Builder builder = new RecordReaderMultiDataSetIterator.Builder(batchSize)
-                .addReader("reader", reader)
-                .addInput("reader", 0, inputSize - 1)
-                .addOutput("reader", inputSize, inputSize + CRITIC_SIZE - 1)
-                .addOutput("reader", haltActorOffset, haltActorOffset + HALT_ACTOR_SIZE - 1)
-                .addOutput("reader", directionActorOffset, directionActorOffset + DIRECTION_ACTOR_SIZE - 1)
-                .addOutput("reader", speedActorOffset, speedActorOffset + SPEED_ACTOR_SIZE - 1)
-                .addOutput("reader", sensorActorOffset, sensorActorOffset + SENSOR_ACTOR_SIZE - 1);
-        RecordReaderMultiDataSetIterator dsi = builder.build();
+        MultiDataSetIterator dsi = new AsyncMultiDataSetIterator(
+                new FileMultiDataSetIterator(cacheDir, false, shuffle ? new Random() : null, batchSize,
+                        TrainingDatasets.CACHE_EXTENSION),
+                prefetchSize);
         File modelFile = new File(locate("modelFile").getNode(config).asText());
 
-        UIServer uiServer = UIServer.getInstance();
-        StatsStorage statsStorage = new InMemoryStatsStorage();         //Alternative: new FileStatsStorage(File), for saving and loading later
-
-        //Attach the StatsStorage instance to the UI: this allows the contents of the StatsStorage to be visualized
-        uiServer.attach(statsStorage);
-
-        // Then add the StatsListener to collect this information from the network, as it trains
+        UIServer uiServer = null;
         logger.info("Loading model {} ...", modelFile);
         ComputationGraph net = ModelSerializer.restoreComputationGraph(modelFile, true);
-        net.setListeners(new StatsListener(statsStorage));
+        if (ui) {
+            uiServer = UIServer.getInstance();
+            StatsStorage statsStorage = new InMemoryStatsStorage();         //Alternative: new FileStatsStorage(File), for saving and loading later
+
+            //Attach the StatsStorage instance to the UI: this allows the contents of the StatsStorage to be visualized
+            uiServer.attach(statsStorage);
+
+            // Then add the StatsListener to collect this information from the network, as it trains
+            net.setListeners(new StatsListener(statsStorage));
+        } else {
+            net.setListeners(new ScoreIterationListener(SCORE_INTERVAL));
+        }
         net.fit(dsi, numEpochs);
         logger.info("Saving model {} ...", modelFile);
         ModelSerializer.writeModel(net, modelFile, false);
-        uiServer.stop();
+        if (cachePath == null) {
+            TrainingDatasets.clearCache(cacheDir);
+            Files.delete(cacheDir.toPath());
+        }
+        if (uiServer != null) {
+            uiServer.stop();
+        }
     }
 }
@@ -0,0 +1,73 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import org.mmarini.wheelly.model.DumpFiles;
+import org.mmarini.wheelly.model.FileFunctions;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.File;
+import java.io.IOException;
+
+import static org.mmarini.wheelly.model.FileFunctions.readDumpFile;
+
+/**
+ * Converts the dump files between csv and binary formats.
+ * <p>
+ * A csv input file is converted to binary dump file and a binary input file is converted to csv file.
+ * </p>
+ * <pre>
+ *     ConvertDump input-file output-file
+ * </pre>
+ */
+public class ConvertDump {
+    private static final Logger logger = LoggerFactory.getLogger(ConvertDump.class);
+
+    public static void main(String[] args) throws IOException {
+        if (args.length < 2) {
+            throw new IllegalArgumentException("Usage: ConvertDump input-file output-file");
+        }
+        File input = new File(args[0]);
+        File output = new File(args[1]);
+        output.delete();
+        if (DumpFiles.isBinary(input)) {
+            logger.info("Converting binary dump {} to csv {} ...", input, output);
+            readDumpFile(input)
+                    .map(FileFunctions::toString)
+                    .blockingSubscribe(FileFunctions.writeFile(output));
+        } else {
+            logger.info("Converting csv dump {} to binary {} ...", input, output);
+            readDumpFile(input)
+                    .blockingSubscribe(DumpFiles.writeFile(output));
+        }
+        logger.info("Completed.");
+    }
+}
@@ -41,6 +41,7 @@ import org.deeplearning4j.nn.graph.ComputationGraph;
 import org.deeplearning4j.nn.weights.WeightInit;
 import org.deeplearning4j.util.ModelSerializer;
 import org.mmarini.Tuple2;
+import org.mmarini.wheelly.engines.deepl.InferenceNetwork;
 import org.mmarini.yaml.schema.Locator;
 import org.nd4j.linalg.activations.Activation;
 import org.nd4j.linalg.factory.Nd4j;
@@ -256,5 +257,12 @@ public class CreateNetwork {
         File outFile = new File(Locator.locate("file").getNode(root).asText());
         logger.info("Writing model {} ...", outFile);
         ModelSerializer.writeModel(net, outFile, false);
+        String inferenceFile = Locator.locate("inferenceFile").getNode(root).asText(null);
+        if (inferenceFile != null) {
+            InferenceNetwork.Precision precision = InferenceNetwork.Precision.fromName(
+                    Locator.locate("precision").getNode(root).asText(InferenceNetwork.DEFAULT_PRECISION));
+            logger.info("Writing inference network {} ({}) ...", inferenceFile, precision);
+            InferenceNetwork.fromGraph(net).write(new File(inferenceFile), precision);
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import org.deeplearning4j.nn.graph.ComputationGraph;
+import org.deeplearning4j.util.ModelSerializer;
+import org.mmarini.wheelly.engines.deepl.InferenceNetwork;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.Arrays;
+
+/**
+ * Exports the inference network of a trained agent model.
+ * <p>
+ * The model is restored without the updater state and the weights are written in the optional precision
+ * (float32, float16, int8, default float32) to be loaded by the {@link org.mmarini.wheelly.engines.deepl.RLInferenceEngine}.
+ * </p>
+ * <pre>
+ *     ExportNetwork model-file inference-file [precision]
+ * </pre>
+ */
+public class ExportNetwork {
+    private static final Logger logger = LoggerFactory.getLogger(ExportNetwork.class);
+
+    public static void main(String[] args) throws IOException {
+        if (args.length < 2) {
+            throw new IllegalArgumentException("Usage: ExportNetwork model-file inference-file [precision]");
+        }
+        File input = new File(args[0]);
+        File output = new File(args[1]);
+        InferenceNetwork.Precision precision = InferenceNetwork.Precision.fromName(
+                args.length > 2 ? args[2] : InferenceNetwork.DEFAULT_PRECISION);
+        logger.info("Loading {} ...", input);
+        ComputationGraph net = ModelSerializer.restoreComputationGraph(input, false);
+        logger.info("Writing inference network {} ({}) ...", output, precision);
+        InferenceNetwork network = InferenceNetwork.fromGraph(net).write(output, precision);
+        logger.info("Exported {} parameters, outputs {}", network.getNumParameters(), Arrays.toString(network.getNumOutputs()));
+        logger.info("Completed.");
+    }
+}
@@ -0,0 +1,281 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import com.fasterxml.jackson.databind.node.ObjectNode;
+import io.reactivex.rxjava3.core.Scheduler;
+import io.reactivex.rxjava3.disposables.Disposable;
+import io.reactivex.rxjava3.schedulers.Schedulers;
+import io.reactivex.rxjava3.subjects.CompletableSubject;
+import org.mmarini.wheelly.engines.Builders;
+import org.mmarini.wheelly.engines.deepl.InferenceBatcher;
+import org.mmarini.wheelly.engines.deepl.RLEngine;
+import org.mmarini.wheelly.model.*;
+import org.mmarini.yaml.Utils;
+import org.mmarini.yaml.schema.Locator;
+import org.nd4j.linalg.factory.Nd4j;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.stream.Collectors;
+import java.util.stream.IntStream;
+
+import static java.lang.Math.min;
+import static java.lang.String.format;
+import static org.mmarini.wheelly.swing.Yaml.config;
+import static org.mmarini.wheelly.swing.Yaml.engine;
+
+/**
+ * Runs a fleet of robot agents in a single process.
+ * <p>
+ * The robots are listed by the fleet section of the configuration file (<code>.wheelly.yml</code> by default),
+ * each robot item overrides the properties of the configuration root. The log, dump and latency files are
+ * written only if defined by the robot item.
+ * The sockets of all the robots are read and written by a single shared {@link SocketSelector} thread and
+ * the map, inference and command flows of each robot run on one of the scheduler partitions (single threads)
+ * assigned round robin.
+ * The robots referencing the same RL engine share its agent, that chooses their actions by batched forward passes
+ * of an {@link InferenceBatcher}.
+ * </p>
+ */
+public class Fleet {
+    public static final String DEFAULT_CONFIG_FILE = ".wheelly.yml";
+    private static final List<String> ROBOT_FILES = List.of("dumpFile", "robotLogFile", "latencyFile");
+    private static final Logger logger = LoggerFactory.getLogger(Fleet.class);
+
+    public static void main(String[] args) throws Throwable {
+        Fleet fleet = new Fleet(new File(args.length > 0 ? args[0] : DEFAULT_CONFIG_FILE));
+        Runtime.getRuntime().addShutdownHook(new Thread(fleet::close));
+        fleet.start();
+        fleet.closed.blockingAwait();
+        logger.info("Completed.");
+    }
+
+    /**
+     * Returns the configuration of a robot with the robot properties overriding the root properties
+     *
+     * @param root  the configuration root
+     * @param robot the robot item
+     */
+    static JsonNode robotConfig(JsonNode root, JsonNode robot) {
+        ObjectNode result = root.deepCopy();
+        result.remove("fleet");
+        result.remove(ROBOT_FILES);
+        result.setAll((ObjectNode) robot);
+        return result;
+    }
+
+    private final File confFile;
+    private final List<RobotAgent> agents;
+    private final List<ExecutorService> executors;
+    private final List<Disposable> disposables;
+    private final CompletableSubject closed;
+    private SocketSelector selector;
+
+    protected Fleet(File confFile) {
+        this.confFile = confFile;
+        this.agents = new ArrayList<>();
+        this.executors = new ArrayList<>();
+        this.disposables = new ArrayList<>();
+        this.closed = CompletableSubject.create();
+    }
+
+    /**
+     * Closes the robots of the fleet
+     */
+    private synchronized void close() {
+        if (closed.hasComplete()) {
+            return;
+        }
+        logger.info("Closing fleet ...");
+        disposables.forEach(Disposable::dispose);
+        agents.forEach(RobotAgent::close);
+        if (selector != null) {
+            selector.close();
+        }
+        executors.forEach(ExecutorService::shutdown);
+        closed.onComplete();
+    }
+
+    /**
+     * Returns the engines of the robots referencing the same engine node
+     * The RL engines share the agent and the inference batcher of the robots.
+     *
+     * @param configs       the robot configurations
+     * @param robots        the indices of robots
+     * @param numPartitions the number of scheduler partitions
+     * @param batchTimeout  the batch timeout (ms)
+     */
+    private List<InferenceEngine> createEngines(List<JsonNode> configs, List<Integer> robots, int numPartitions, long batchTimeout) {
+        JsonNode firstConfig = configs.get(robots.get(0));
+        InferenceEngine first = Builders.fromJson(firstConfig, engine(firstConfig, Locator.root()));
+        List<InferenceEngine> result = new ArrayList<>(robots.size());
+        if (first instanceof RLEngine && robots.size() > 1) {
+            RLEngine rlEngine = (RLEngine) first;
+            // The robots of the same partition are serialized, so the batch is completed by a robot per partition
+            int numMembers = (int) robots.stream()
+                    .mapToInt(i -> i % numPartitions)
+                    .distinct()
+                    .count();
+            InferenceBatcher batcher = InferenceBatcher.create(rlEngine.getAgent(),
+                    Nd4j.getRandomFactory().getNewRandomInstance(), numMembers, batchTimeout);
+            logger.info("Robots {} share the agent with batches of {} robots", robots, numMembers);
+            for (int i = 0; i < robots.size(); i++) {
+                result.add(RLEngine.create(rlEngine.getConfig(), Nd4j.getRandomFactory().getNewRandomInstance(),
+                        rlEngine.getAgent(), batcher));
+            }
+        } else {
+            result.add(first);
+            for (int i = 1; i < robots.size(); i++) {
+                JsonNode config = configs.get(robots.get(i));
+                result.add(Builders.fromJson(config, engine(config, Locator.root())));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the scheduler partitions
+     *
+     * @param n the number of partitions
+     */
+    private List<Scheduler> createPartitions(int n) {
+        List<Scheduler> result = new ArrayList<>(n);
+        for (int i = 0; i < n; i++) {
+            String name = "fleet-" + i;
+            ExecutorService executor = Executors.newSingleThreadExecutor(task -> new Thread(task, name));
+            executors.add(executor);
+            result.add(Schedulers.from(executor));
+        }
+        return result;
+    }
+
+    /**
+     * Opens the robot files and the robot log
+     *
+     * @param index  the robot index
+     * @param agent  the robot agent
+     * @param params the configuration parameters of robot
+     */
+    private void openFiles(int index, RobotAgent agent, ConfigParameters params) {
+        if (params.robotLogFile != null) {
+            File file = new File(params.robotLogFile);
+            file.delete();
+            RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+            disposables.add(agent.readLog()
+                    .doFinally(writer::close)
+                    .subscribe(v -> writer.writeLine(format("%d %s", v.time(TimeUnit.MILLISECONDS), v.value()))));
+        }
+        if (params.dumpFile != null) {
+            File file = new File(params.dumpFile);
+            file.delete();
+            RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+            if (DumpFiles.isBinaryName(file)) {
+                writer.write(DumpFiles.header());
+                disposables.add(agent.readDumpRecords()
+                        .doFinally(writer::close)
+                        .subscribe(data -> writer.write(DumpFiles.toBytes(data))));
+            } else {
+                disposables.add(agent.readDump()
+                        .doFinally(writer::close)
+                        .subscribe(writer::writeLine));
+            }
+        }
+        if (params.latencyFile != null) {
+            File file = new File(params.latencyFile);
+            file.delete();
+            RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+            writer.writeLine(LatencyMonitor.CSV_HEADER);
+            disposables.add(agent.readLatencies()
+                    .doFinally(writer::close)
+                    .subscribe(report -> {
+                        for (String line : report.toCSV()) {
+                            writer.writeLine(line);
+                        }
+                    }));
+        }
+        disposables.add(agent.readConnection()
+                .distinctUntilChanged()
+                .subscribe(connected -> logger.info("Robot {} {}", index, connected ? "connected" : "disconnected")));
+        disposables.add(agent.readErrors()
+                .subscribe(ex -> logger.error(format("Robot %d error", index), ex)));
+        disposables.add(agent.readInferenceMessages()
+                .subscribe(text -> logger.info("Robot {}: {}", index, text)));
+    }
+
+    private synchronized void start() throws IOException {
+        logger.info("Reading configuration {} ...", confFile);
+        JsonNode root = Utils.fromFile(confFile);
+        config().apply(Locator.root()).accept(root);
+        Locator fleet = Locator.locate("fleet");
+        if (fleet.getNode(root).isMissingNode()) {
+            throw new IllegalArgumentException(format("Missing %s node", fleet.pointer));
+        }
+        List<JsonNode> configs = fleet.path("robots").elements(root)
+                .map(robot -> robotConfig(root, robot.getNode(root)))
+                .collect(Collectors.toList());
+        int numPartitions = min(fleet.path("threads").getNode(root).asInt(configs.size()), configs.size());
+        long batchTimeout = fleet.path("batchTimeout").getNode(root).asLong(InferenceBatcher.DEFAULT_TIMEOUT);
+
+        // Creates the engines of the robots grouped by engine node
+        Map<String, List<Integer>> engineRobots = IntStream.range(0, configs.size())
+                .boxed()
+                .collect(Collectors.groupingBy(i -> engine(configs.get(i), Locator.root()).toString(),
+                        LinkedHashMap::new, Collectors.toList()));
+        InferenceEngine[] engines = new InferenceEngine[configs.size()];
+        engineRobots.values().forEach(robots -> {
+            List<InferenceEngine> robotEngines = createEngines(configs, robots, numPartitions, batchTimeout);
+            for (int i = 0; i < robots.size(); i++) {
+                engines[robots.get(i)] = robotEngines.get(i);
+            }
+        });
+
+        List<Scheduler> partitions = createPartitions(numPartitions);
+        selector = SocketSelector.create("fleet-selector");
+        for (int i = 0; i < configs.size(); i++) {
+            ConfigParameters params = ConfigParameters.fromJson(configs.get(i), Locator.root());
+            RobotAgent agent = RobotAgent.create(params, engines[i], selector, partitions.get(i % numPartitions));
+            agents.add(agent);
+            openFiles(i, agent, params);
+        }
+        logger.info("Starting {} robots on {} partitions ...", agents.size(), numPartitions);
+        agents.forEach(RobotAgent::start);
+    }
+}
@@ -0,0 +1,301 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.schedulers.Schedulers;
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.Tuple2;
+import org.mmarini.wheelly.engines.deepl.*;
+import org.mmarini.wheelly.model.*;
+import org.mmarini.yaml.Utils;
+import org.mmarini.yaml.schema.Locator;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.api.rng.Random;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.awt.geom.Line2D;
+import java.awt.geom.Point2D;
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.Optional;
+import java.util.concurrent.TimeUnit;
+import java.util.stream.Collectors;
+
+import static java.lang.Math.min;
+import static org.mmarini.wheelly.apps.Yaml.rollouts;
+import static org.mmarini.wheelly.engines.deepl.RLEngine.createKpi;
+import static org.mmarini.wheelly.engines.deepl.RLEngine.decodeAction;
+import static org.mmarini.wheelly.model.FileFunctions.readDumpFile;
+import static org.mmarini.wheelly.model.GridScannerMap.THRESHOLD_DISTANCE;
+
+/**
+ * Runs parallel rollouts of the RL engine in many environments sharing the agent network.
+ * <p>
+ * The environments are either the kinematic simulations of the robot ({@link RobotSimulator}) in the world
+ * polygons or the recorded dump files.
+ * Each simulated environment has its own robot simulator and scanner map, the environments are stepped in parallel on
+ * the computation scheduler, then the actions of all the environments are chosen by a single batched forward pass
+ * and the network is fit by a single minibatch of the feedbacks of all the environments.
+ * The dump environments are read in parallel and their feedbacks are learnt by minibatches of numEnvironments
+ * feedbacks.
+ * </p>
+ */
+public class Rollouts {
+    public static final long DEFAULT_STEP_INTERVAL = 300;
+    public static final long DEFAULT_STATUS_INTERVAL = 50;
+    public static final double DEFAULT_START_RANGE = 1;
+    public static final int LOG_INTERVAL = 100;
+    private static final Logger logger = LoggerFactory.getLogger(Rollouts.class);
+
+    public static void main(String[] args) throws Throwable {
+        logger.info("Create rollouts");
+        if (args.length < 1) {
+            throw new IllegalArgumentException("Missing config file");
+        }
+        new Rollouts(new File(args[0])).start();
+        logger.info("Completed.");
+    }
+
+    private final File confFile;
+    private RLEngine engine;
+    private long stepInterval;
+    private long statusInterval;
+    private long steps;
+    private double rewardSum;
+
+    protected Rollouts(File confFile) {
+        this.confFile = confFile;
+    }
+
+    /**
+     * Returns the simulated environments
+     *
+     * @param world      the world segments
+     * @param n          the number of environments
+     * @param startRange the range of start locations (m)
+     */
+    private List<Environment> createEnvironments(List<Line2D> world, int n, double startRange) {
+        Random random = engine.getRandom();
+        List<Environment> result = new ArrayList<>(n);
+        for (int i = 0; i < n; i++) {
+            Point2D location = new Point2D.Double(
+                    (random.nextDouble() * 2 - 1) * startRange,
+                    (random.nextDouble() * 2 - 1) * startRange);
+            int robotDeg = random.nextInt(360) - 180;
+            RobotSimulator simulator = RobotSimulator.create(world, location, robotDeg, 0);
+            result.add(new Environment(simulator, engine.getConfig()));
+        }
+        return result;
+    }
+
+    /**
+     * Returns the kpi records of the training data
+     *
+     * @param feedbacks the feedbacks
+     */
+    private List<String> learn(List<Feedback> feedbacks) {
+        if (feedbacks.isEmpty()) {
+            return List.of();
+        }
+        List<Map<String, Object>> maps = engine.getAgent().batchLearn(feedbacks, engine.getRandom());
+        List<String> result = new ArrayList<>(feedbacks.size());
+        for (int i = 0; i < feedbacks.size(); i++) {
+            double reward = feedbacks.get(i).getReward();
+            rewardSum += reward;
+            result.add(FileFunctions.toCSVRaw(createKpi(maps.get(i), reward)));
+        }
+        steps++;
+        if (steps % LOG_INTERVAL == 0) {
+            logger.info("Step {} average reward {}", steps, rewardSum / feedbacks.size() / LOG_INTERVAL);
+            rewardSum = 0;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the flow of kpi records of the dump environments
+     *
+     * @param files     the dump files
+     * @param batchSize the number of feedbacks per batch
+     */
+    private Flowable<String> runDumps(List<File> files, int batchSize) {
+        return Flowable.fromIterable(files)
+                .flatMap(file -> readDumpFile(file)
+                        .buffer(2, 1)
+                        .filter(t -> t.size() >= 2)
+                        .map(t -> engine.createFeedback(t.get(0)._1, t.get(0)._2, t.get(1)._1)))
+                .buffer(batchSize)
+                .concatMapIterable(this::learn);
+    }
+
+    /**
+     * Returns the flow of kpi records of the simulated environments
+     *
+     * @param environments the environments
+     * @param numSteps     the number of steps
+     */
+    private Flowable<String> runSimulations(List<Environment> environments, long numSteps) {
+        ActorCriticAgent agent = engine.getAgent();
+        SignalBuffer buffer = SignalBuffer.create(environments.size(), engine.getConfig().getNumInputs());
+        return Flowable.rangeLong(0, numSteps)
+                .concatMapIterable(step -> {
+                    // Steps the environments in parallel
+                    List<Environment> stepped = Flowable.fromIterable(environments)
+                            .concatMapEager(env -> Flowable.fromCallable(() -> env.step(stepInterval, statusInterval))
+                                    .subscribeOn(Schedulers.computation()))
+                            .toList()
+                            .blockingGet();
+                    for (int i = 0; i < stepped.size(); i++) {
+                        buffer.set(i, stepped.get(i).indices);
+                    }
+                    INDArray signals = buffer.toINDArray();
+                    List<Feedback> feedbacks = new ArrayList<>(stepped.size());
+                    for (int i = 0; i < stepped.size(); i++) {
+                        stepped.get(i).feedback(signals.getRow(i, true)).ifPresent(feedbacks::add);
+                    }
+                    List<String> kpis = learn(feedbacks);
+                    // Chooses the actions by a single batched inference
+                    INDArray[] actions = agent.chooseActions(signals, engine.getRandom());
+                    for (int i = 0; i < stepped.size(); i++) {
+                        stepped.get(i).act(signals.getRow(i, true), actions[i]);
+                    }
+                    return kpis;
+                });
+    }
+
+    private void start() throws IOException {
+        logger.info("Reading configuration {} ...", confFile);
+        JsonNode config = Utils.fromFile(confFile);
+        rollouts().apply(Locator.root()).accept(config);
+        engine = RLEngine.fromJson(config, Locator.locate("agent"));
+        int numEnvironments = Locator.locate("numEnvironments").getNode(config).asInt();
+        stepInterval = Locator.locate("stepInterval").getNode(config).asLong(DEFAULT_STEP_INTERVAL);
+        statusInterval = Locator.locate("statusInterval").getNode(config).asLong(DEFAULT_STATUS_INTERVAL);
+        JsonNode dumpNode = Locator.locate("dumpFiles").getNode(config);
+
+        Flowable<String> kpis;
+        if (!dumpNode.isMissingNode()) {
+            List<File> files = Locator.locate("dumpFiles").elements(config)
+                    .map(l -> new File(l.getNode(config).asText()))
+                    .collect(Collectors.toList());
+            logger.info("Running {} dump environments ...", files.size());
+            kpis = runDumps(files, numEnvironments);
+        } else {
+            long numSteps = Locator.locate("numSteps").getNode(config).asLong();
+            double startRange = Locator.locate("startRange").getNode(config).asDouble(DEFAULT_START_RANGE);
+            List<Line2D> world = RobotSimulator.worldFromJson(Locator.locate("world").getNode(config));
+            logger.info("Running {} simulated environments for {} steps ...", numEnvironments, numSteps);
+            kpis = runSimulations(createEnvironments(world, numEnvironments, startRange), numSteps);
+        }
+        JsonNode kpiNode = Locator.locate("kpiFile").getNode(config);
+        if (!kpiNode.isMissingNode()) {
+            File kpiFile = new File(kpiNode.asText());
+            kpiFile.delete();
+            logger.info("Writing kpi file {} ...", kpiFile);
+            kpis.blockingSubscribe(FileFunctions.writeFile(kpiFile));
+        } else {
+            kpis.blockingSubscribe();
+        }
+    }
+
+    /**
+     * The simulated environment.
+     * The environment is stepped by one thread at a time.
+     */
+    static class Environment {
+        private final RobotSimulator simulator;
+        private final RLEngineConf config;
+        private GridScannerMap map;
+        private Timed<MapStatus> status;
+        private Timed<MapStatus> prevStatus;
+        private INDArray prevSignals;
+        private INDArray prevAction;
+        private Tuple2<MotionCommand, Integer> command;
+        private int[] indices;
+
+        Environment(RobotSimulator simulator, RLEngineConf config) {
+            this.simulator = simulator;
+            this.config = config;
+            this.map = GridScannerMap.create(List.of(), THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0);
+            this.command = Tuple2.of(HaltCommand.HALT_COMMAND, 0);
+        }
+
+        /**
+         * Applies the action chosen for the signals
+         *
+         * @param signals the signals of current status
+         * @param action  the action
+         */
+        void act(INDArray signals, INDArray action) {
+            prevStatus = status;
+            prevSignals = signals;
+            prevAction = action;
+            command = decodeAction(status, action);
+        }
+
+        /**
+         * Returns the feedback of the last step if any
+         *
+         * @param signals the signals of current status
+         */
+        Optional<Feedback> feedback(INDArray signals) {
+            if (prevStatus == null) {
+                return Optional.empty();
+            }
+            double reward = config.reward(prevStatus, status);
+            double dt = (status.time(TimeUnit.MILLISECONDS) - prevStatus.time(TimeUnit.MILLISECONDS)) * 1e-3;
+            return Optional.of(Feedback.create(prevSignals, prevAction, reward, signals, dt));
+        }
+
+        /**
+         * Returns the environment after simulating the robot for an interval and encoding the status
+         *
+         * @param interval       the step interval (ms)
+         * @param statusInterval the status interval (ms)
+         */
+        Environment step(long interval, long statusInterval) {
+            simulator.move(command._1).scan(command._2);
+            Timed<WheellyStatus> sample = null;
+            for (long t = 0; t < interval; t += statusInterval) {
+                sample = simulator.step(min(statusInterval, interval - t));
+                map = map.process(sample);
+            }
+            status = new Timed<>(MapStatus.create(sample.value(), map), sample.time(), sample.unit());
+            indices = config.getEncoder().encodeIndices(status);
+            return this;
+        }
+    }
+}
@@ -31,6 +31,8 @@ package org.mmarini.wheelly.apps;
 
 
 import com.fasterxml.jackson.databind.JsonNode;
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.schedulers.Schedulers;
 import io.reactivex.rxjava3.schedulers.Timed;
 import org.deeplearning4j.core.storage.StatsStorage;
 import org.deeplearning4j.ui.api.UIServer;
@@ -51,7 +53,9 @@ import org.slf4j.LoggerFactory;
 
 import java.io.File;
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.List;
 import java.util.Map;
 
 import static org.mmarini.wheelly.apps.Yaml.analysis;
@@ -60,7 +64,15 @@ import static org.mmarini.wheelly.model.FileFunctions.*;
 import static org.nd4j.linalg.factory.Nd4j.hstack;
 import static org.nd4j.linalg.factory.Nd4j.zeros;
 
+/**
+ * Simulates the learning of the agent from the dump file generating the training dataset and the kpi
+ * <p>
+ * With batchSize greater than 1 the transitions are learnt in minibatches of batchSize transitions
+ * and the signal encoding and the csv conversion run in parallel on the computation scheduler.
+ * </p>
+ */
 public class Simulate {
+    public static final int DEFAULT_BATCH_SIZE = 1;
     private static final Logger logger = LoggerFactory.getLogger(Simulate.class);
 
     public static void main(String[] args) throws Throwable {
@@ -95,6 +107,55 @@ public class Simulate {
         return new INDArray[]{data, kpi};
     }
 
+    /**
+     * Returns the data and kpi for a batch of feedbacks
+     *
+     * @param feedbacks the feedbacks
+     */
+    private List<INDArray[]> generateBatch(List<Feedback> feedbacks) {
+        List<Map<String, Object>> maps = engine.getAgent().batchLearn(feedbacks, engine.getRandom());
+        List<INDArray[]> result = new ArrayList<>(feedbacks.size());
+        for (int i = 0; i < feedbacks.size(); i++) {
+            Feedback feedback = feedbacks.get(i);
+            Map<String, Object> map = maps.get(i);
+            INDArray labArray = hstack((INDArray[]) map.get("labels"));
+            INDArray data = hstack(feedback.getS0(), labArray);
+            INDArray kpi = createKpi(map, feedback.getReward());
+            result.add(new INDArray[]{data, kpi});
+        }
+        return result;
+    }
+
+    /**
+     * Returns the csv records of data
+     *
+     * @param data the data
+     */
+    private static String[] toCSVRecords(INDArray[] data) {
+        return Arrays.stream(data)
+                .map(FileFunctions::toCSVRaw)
+                .toArray(String[]::new);
+    }
+
+    /**
+     * Returns the csv records of the dump file learnt in batches
+     *
+     * @param inFilename the dump file
+     * @param batchSize  the batch size
+     */
+    private Flowable<String[]> simulateBatches(File inFilename, int batchSize) {
+        return readDumpFile(inFilename)
+                .buffer(2, 1)
+                .filter(t -> t.size() >= 2)
+                .concatMapEager(data -> Flowable.fromCallable(() ->
+                                engine.createFeedback(data.get(0)._1, data.get(0)._2, data.get(1)._1))
+                        .subscribeOn(Schedulers.computation()))
+                .buffer(batchSize)
+                .concatMapIterable(this::generateBatch)
+                .concatMapEager(data -> Flowable.fromCallable(() -> toCSVRecords(data))
+                        .subscribeOn(Schedulers.computation()));
+    }
+
     private void start() throws IOException, InterruptedException {
         logger.info("Reading configuaration {} ...", confFile);
         config = Utils.fromFile(confFile);
@@ -107,6 +168,8 @@ public class Simulate {
         logger.info("Writing kpi file {} ...", kpiFile);
         engine = RLEngine.fromJson(config, Locator.locate("agent"));
         int numEpochs = Locator.locate("numEpochs").getNode(config).asInt();
+        int batchSize = Locator.locate("batchSize").getNode(config).asInt(DEFAULT_BATCH_SIZE);
+        logger.info("Batch size {}", batchSize);
 
         UIServer uiServer = UIServer.getInstance();
         StatsStorage statsStorage = new InMemoryStatsStorage();         //Alternative: new FileStatsStorage(File), for saving and loading later
@@ -120,14 +183,14 @@ public class Simulate {
         for (int ephoc = 0; ephoc < numEpochs; ephoc++) {
             logger.info("Epoch {}.", ephoc + 1);
             outFile.delete();
-            readDumpFile(inFilename)
+            Flowable<String[]> records = batchSize > 1
+                    ? simulateBatches(inFilename, batchSize)
+                    : readDumpFile(inFilename)
                     .buffer(2, 1)
                     .filter(t -> t.size() >= 2)
                     .map(data -> this.generateData(data.get(0)._1, data.get(0)._2, data.get(1)._1))
-                    .map(data -> Arrays.stream(data)
-                            .map(FileFunctions::toCSVRaw)
-                            .toArray(String[]::new))
-                    .blockingSubscribe(writeFiles(files));
+                    .map(Simulate::toCSVRecords);
+            records.blockingSubscribe(writeFiles(files));
             logger.info("Written data file {}.", outFile);
         }
         logger.info("Written kpi file {}.", kpiFile);
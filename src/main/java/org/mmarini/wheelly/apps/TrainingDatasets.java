@@ -0,0 +1,263 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import org.datavec.api.records.reader.RecordReader;
+import org.datavec.api.records.reader.impl.csv.CSVRecordReader;
+import org.datavec.api.split.FileSplit;
+import org.datavec.api.writable.Writable;
+import org.deeplearning4j.datasets.datavec.RecordReaderMultiDataSetIterator;
+import org.nd4j.linalg.dataset.api.MultiDataSet;
+import org.nd4j.linalg.dataset.api.iterator.MultiDataSetIterator;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.*;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.stream.Collectors;
+import java.util.stream.Stream;
+
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The training dataset functions.
+ * <p>
+ * The csv dataset files are converted in parallel into a cache folder of binary minibatch files
+ * ({@link MultiDataSet#save(File)}) so the training epochs and the following runs skip the csv parsing.
+ * The cache folder holds an index file with the list of source files, their sizes and modification times,
+ * the batch size and the input size, the cache is valid only if the index matches the current sources.
+ * </p>
+ */
+public interface TrainingDatasets {
+    int CRITIC_SIZE = 1;
+    int HALT_ACTOR_SIZE = 2;
+    int DIRECTION_ACTOR_SIZE = 24;
+    int SPEED_ACTOR_SIZE = 21;
+    int SENSOR_ACTOR_SIZE = 9;
+    String CACHE_EXTENSION = "bin";
+    String INDEX_FILE = "index.txt";
+    Logger logger = LoggerFactory.getLogger(TrainingDatasets.class);
+
+    /**
+     * Converts the csv dataset files into the cache folder in parallel
+     *
+     * @param files      the csv files
+     * @param cacheDir   the cache folder
+     * @param batchSize  the batch size
+     * @param inputSize  the input size
+     * @param numThreads the number of conversion threads
+     * @throws IOException          in case of error
+     * @throws InterruptedException if interrupted
+     */
+    static void convert(List<File> files, File cacheDir, int batchSize, int inputSize, int numThreads) throws IOException, InterruptedException {
+        requireNonNull(files);
+        clearCache(cacheDir);
+        ExecutorService executor = Executors.newFixedThreadPool(numThreads);
+        try {
+            List<Future<Integer>> results = new ArrayList<>();
+            for (int i = 0; i < files.size(); i++) {
+                File file = files.get(i);
+                String prefix = String.format("%04d-", i);
+                results.add(executor.submit(() -> convert(file, cacheDir, prefix, batchSize, inputSize)));
+            }
+            int n = 0;
+            for (Future<Integer> result : results) {
+                try {
+                    n += result.get();
+                } catch (ExecutionException e) {
+                    Throwable cause = e.getCause();
+                    throw cause instanceof IOException ? (IOException) cause : new IOException(cause);
+                }
+            }
+            logger.info("Converted {} files into {} minibatches", files.size(), n);
+        } finally {
+            executor.shutdownNow();
+        }
+        Files.write(new File(cacheDir, INDEX_FILE).toPath(), index(files, batchSize, inputSize));
+    }
+
+    /**
+     * Converts a csv dataset file into the minibatch files and returns the number of minibatches
+     *
+     * @param file      the csv file
+     * @param cacheDir  the cache folder
+     * @param prefix    the prefix of minibatch file names
+     * @param batchSize the batch size
+     * @param inputSize the input size
+     * @throws IOException          in case of error
+     * @throws InterruptedException if interrupted
+     */
+    static int convert(File file, File cacheDir, String prefix, int batchSize, int inputSize) throws IOException, InterruptedException {
+        logger.info("Converting data file {} ...", file);
+        CSVRecordReader reader = new CSVRecordReader(0, ',');
+        reader.initialize(new FileSplit(file));
+        if (!reader.hasNext()) {
+            return 0;
+        }
+        List<Writable> record = reader.next();
+        int size = recordSize(inputSize);
+        if (size != record.size()) {
+            logger.error("Wrong record size = {}, file {} record size = {}",
+                    size,
+                    file,
+                    record.size());
+            throw new IOException("Wrong record size");
+        }
+        reader.reset();
+        MultiDataSetIterator iter = createIterator(reader, batchSize, inputSize);
+        int n = 0;
+        while (iter.hasNext()) {
+            MultiDataSet batch = iter.next();
+            batch.save(new File(cacheDir, String.format("%s%06d.%s", prefix, n++, CACHE_EXTENSION)));
+        }
+        reader.close();
+        return n;
+    }
+
+    /**
+     * Deletes the cached files
+     *
+     * @param cacheDir the cache folder
+     * @throws IOException in case of error
+     */
+    static void clearCache(File cacheDir) throws IOException {
+        Files.createDirectories(cacheDir.toPath());
+        File[] files = cacheDir.listFiles((dir, name) -> name.endsWith("." + CACHE_EXTENSION) || name.equals(INDEX_FILE));
+        if (files != null) {
+            for (File file : files) {
+                Files.delete(file.toPath());
+            }
+        }
+    }
+
+    /**
+     * Returns the multi dataset iterator of the csv records
+     *
+     * @param reader    the csv record reader
+     * @param batchSize the batch size
+     * @param inputSize the input size
+     */
+    static MultiDataSetIterator createIterator(RecordReader reader, int batchSize, int inputSize) {
+        int haltActorOffset = inputSize + CRITIC_SIZE;
+        int directionActorOffset = haltActorOffset + HALT_ACTOR_SIZE;
+        int speedActorOffset = directionActorOffset + DIRECTION_ACTOR_SIZE;
+        int sensorActorOffset = speedActorOffset + SPEED_ACTOR_SIZE;
+        return new RecordReaderMultiDataSetIterator.Builder(batchSize)
+                .addReader("reader", reader)
+                .addInput("reader", 0, inputSize - 1)
+                .addOutput("reader", inputSize, inputSize + CRITIC_SIZE - 1)
+                .addOutput("reader", haltActorOffset, haltActorOffset + HALT_ACTOR_SIZE - 1)
+                .addOutput("reader", directionActorOffset, directionActorOffset + DIRECTION_ACTOR_SIZE - 1)
+                .addOutput("reader", speedActorOffset, speedActorOffset + SPEED_ACTOR_SIZE - 1)
+                .addOutput("reader", sensorActorOffset, sensorActorOffset + SENSOR_ACTOR_SIZE - 1)
+                .build();
+    }
+
+    /**
+     * Returns the lines of cache index
+     *
+     * @param files     the source files
+     * @param batchSize the batch size
+     * @param inputSize the input size
+     */
+    static List<String> index(List<File> files, int batchSize, int inputSize) {
+        List<String> result = new ArrayList<>();
+        result.add("batchSize=" + batchSize);
+        result.add("inputSize=" + inputSize);
+        for (File file : files) {
+            result.add(file.getAbsolutePath() + "," + file.length() + "," + file.lastModified());
+        }
+        return result;
+    }
+
+    /**
+     * Returns true if the cache folder holds the minibatches of the source files
+     *
+     * @param cacheDir  the cache folder
+     * @param files     the source files
+     * @param batchSize the batch size
+     * @param inputSize the input size
+     * @throws IOException in case of error
+     */
+    static boolean isCacheValid(File cacheDir, List<File> files, int batchSize, int inputSize) throws IOException {
+        File indexFile = new File(cacheDir, INDEX_FILE);
+        return indexFile.isFile()
+                && Files.readAllLines(indexFile.toPath()).equals(index(files, batchSize, inputSize));
+    }
+
+    /**
+     * Returns the files defined by a path.
+     * The path may be a file, a folder (all the files in the folder) or a glob pattern of file name
+     * (e.g. <code>data/dataset-*.csv</code>), the files are sorted by name.
+     *
+     * @param path the path
+     * @throws IOException in case of error
+     */
+    static List<File> listFiles(String path) throws IOException {
+        File file = new File(path);
+        if (file.isFile()) {
+            return List.of(file);
+        }
+        File dir;
+        PathMatcher matcher;
+        if (file.isDirectory()) {
+            dir = file;
+            matcher = p -> true;
+        } else {
+            dir = file.getAbsoluteFile().getParentFile();
+            matcher = FileSystems.getDefault().getPathMatcher("glob:" + file.getName());
+        }
+        File[] files = dir != null ? dir.listFiles() : null;
+        if (files == null) {
+            throw new IOException("Missing " + path);
+        }
+        return Stream.of(files)
+                .filter(File::isFile)
+                .filter(f -> matcher.matches(Paths.get(f.getName())))
+                .sorted()
+                .collect(Collectors.toList());
+    }
+
+    /**
+     * Returns the size of dataset records
+     *
+     * @param inputSize the input size
+     */
+    static int recordSize(int inputSize) {
+        return inputSize + CRITIC_SIZE + HALT_ACTOR_SIZE + DIRECTION_ACTOR_SIZE + SPEED_ACTOR_SIZE + SENSOR_ACTOR_SIZE;
+    }
+}
@@ -46,7 +46,8 @@ public interface Yaml {
                         "outputFile", string(),
                         "kpiFile", string(),
                         "agent", engineConf(),
-                        "numEpochs", positiveInteger()
+                        "numEpochs", positiveInteger(),
+                        "batchSize", positiveInteger()
                 ), List.of(
                         "version",
                         "inputFile",
@@ -73,14 +74,43 @@ public interface Yaml {
         );
     }
 
+    static Validator point() {
+        return array(prefixItems(number(), number()), minItems(2), maxItems(2));
+    }
+
+    static Validator rollouts() {
+        return objectPropertiesRequired(Map.ofEntries(
+                        Map.entry("version", string(values("0.1"))),
+                        Map.entry("agent", engineConf()),
+                        Map.entry("numEnvironments", positiveInteger()),
+                        Map.entry("numSteps", positiveInteger()),
+                        Map.entry("stepInterval", positiveInteger()),
+                        Map.entry("statusInterval", positiveInteger()),
+                        Map.entry("startRange", nonNegativeNumber()),
+                        Map.entry("world", arrayItems(arrayItems(point()))),
+                        Map.entry("dumpFiles", arrayItems(string(minLength(1)))),
+                        Map.entry("kpiFile", string())
+                ), List.of(
+                        "version",
+                        "agent",
+                        "numEnvironments"
+                )
+        );
+    }
+
     static Validator trainer() {
-        return objectPropertiesRequired(Map.of(
-                "version", string(values("0.1")),
-                "inputFile", string(minLength(1)),
-                "modelFile", string(minLength(1)),
-                "numEpochs", positiveInteger(),
-                "batchSize", positiveInteger(),
-                "inputSize", positiveInteger()), List.of(
+        return objectPropertiesRequired(Map.ofEntries(
+                Map.entry("version", string(values("0.1"))),
+                Map.entry("inputFile", string(minLength(1))),
+                Map.entry("modelFile", string(minLength(1))),
+                Map.entry("cacheDir", string(minLength(1))),
+                Map.entry("numEpochs", positiveInteger()),
+                Map.entry("batchSize", positiveInteger()),
+                Map.entry("inputSize", positiveInteger()),
+                Map.entry("numThreads", positiveInteger()),
+                Map.entry("prefetchSize", positiveInteger()),
+                Map.entry("shuffle", booleanValue()),
+                Map.entry("ui", booleanValue())), List.of(
                 "version",
                 "inputFile",
                 "modelFile",
@@ -39,9 +39,14 @@ import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.awt.geom.Point2D;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
 import java.util.List;
 import java.util.Random;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
 
+import static java.lang.String.format;
 import static org.mmarini.wheelly.engines.statemachine.ContextOperator.*;
 import static org.mmarini.wheelly.engines.statemachine.EngineStatus.*;
 import static org.mmarini.wheelly.engines.statemachine.FindPathStatus.*;
@@ -54,6 +59,7 @@ import static org.mmarini.wheelly.engines.statemachine.Yaml.*;
 public interface Builders {
 
     Logger logger = LoggerFactory.getLogger(Builders.class);
+    Pattern BUILDER_PATTERN = Pattern.compile("^([a-zA-Z_]\\w*\\.)+([a-zA-Z_]\\w*)$");
 
     static InferenceEngine avoidObstacle(JsonNode config, Locator locator) {
         return StateMachineBuilder.create()
@@ -77,10 +83,14 @@ public interface Builders {
         List<Point2D> targets = points(config.path("targets"));
         double safeDistance = config.path("safeDistance").asDouble(FindPathStatus.DEFAULT_SAFE_DISTANCE);
         double thresholdDistance = config.path("thresholdDistance").asDouble(GotoStatus.DEFAULT_DISTANCE);
+        boolean incremental = config.path("incremental").asBoolean(false);
+        String smoothing = config.path("smoothing").asText(FindPathStatus.DEFAULT_SMOOTHING);
         return StateMachineBuilder.create()
                 .setParams("initial.timeout", 2000)
                 .setParams("nextTarget.list", targets)
                 .setParams("findPath.safeDistance", safeDistance)
+                .setParams("findPath.incremental", incremental)
+                .setParams("findPath.smoothing", smoothing)
                 .setParams("goto.distance", thresholdDistance)
                 .setParams("goto.timeout", 30000)
                 .addState(StopStatus.create("initial"))
@@ -155,6 +165,43 @@ public interface Builders {
                 .build("init");
     }
 
+    /**
+     * Returns the inference engine created by the static builder method of the engine node.
+     * The builder method is referenced by the builder property in the format <code>package.Class.method</code>
+     * and it is called with the root node and the locator of engine node.
+     *
+     * @param root    the configuration root
+     * @param locator the locator of engine node
+     */
+    static InferenceEngine fromJson(JsonNode root, Locator locator) {
+        JsonNode engineNode = locator.getNode(root);
+        if (engineNode.isMissingNode()) {
+            throw new IllegalArgumentException(format("Missing %s node", locator.pointer));
+        }
+        String builder = engineNode.path("builder").asText();
+        if (builder.isEmpty()) {
+            throw new IllegalArgumentException(format("Missing %s/builder node", locator.pointer));
+        }
+        Matcher m = BUILDER_PATTERN.matcher(builder);
+        if (!m.matches()) {
+            throw new IllegalArgumentException(format("builder %s does not match the format", builder));
+        }
+        String methodName = m.group(2);
+        String className = builder.substring(0, builder.length() - methodName.length() - 1);
+        try {
+            Class<?> clazz = Thread.currentThread().getContextClassLoader().loadClass(className);
+            Method creator = clazz.getDeclaredMethod(methodName, JsonNode.class, Locator.class);
+            int modifiers = creator.getModifiers();
+            if (!Modifier.isStatic(modifiers)) {
+                throw new IllegalArgumentException(format("builder %s is not static", builder));
+            }
+            Object result = creator.invoke(null, root, locator);
+            return (InferenceEngine) result;
+        } catch (Exception e) {
+            throw new RuntimeException(e);
+        }
+    }
+
     static InferenceEngine gotoTest(JsonNode config, Locator locator) {
         point().apply(locator.path("target")).accept(config);
         Point2D target = point(config.path("target")).orElseThrow();
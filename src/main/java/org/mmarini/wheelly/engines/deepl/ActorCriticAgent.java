@@ -37,10 +37,13 @@ import org.nd4j.linalg.api.rng.Random;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.io.File;
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
+import java.util.concurrent.atomic.AtomicReference;
 import java.util.stream.Stream;
 
 import static java.lang.String.format;
@@ -48,12 +51,27 @@ import static java.util.Objects.requireNonNull;
 import static org.mmarini.wheelly.engines.deepl.FunctionBuilder.decay;
 import static org.nd4j.linalg.factory.Nd4j.hstack;
 import static org.nd4j.linalg.factory.Nd4j.scalar;
+import static org.nd4j.linalg.factory.Nd4j.vstack;
+import static org.nd4j.linalg.indexing.NDArrayIndex.all;
+import static org.nd4j.linalg.indexing.NDArrayIndex.interval;
 import static org.nd4j.linalg.ops.transforms.Transforms.pow;
 
 /**
  * The actor-critic agent generates the action of robot basing on reinforcement learning
  * The interactions with the inference engine is based on INDArray values.
  * Any map with the robot environment (robot status, action status) is managed by the engine.
+ * <p>
+ * With replay memory the feedbacks are stored in a {@link ReplayBuffer} and the network is fit by minibatches of
+ * the last feedback and feedbacks sampled from the memory.
+ * With asynchronous training the actions are chosen by a read-only snapshot of the network,
+ * a new snapshot is published atomically every publishInterval fittings,
+ * so the training may run on a different thread then the inference without locks.
+ * </p>
+ * <p>
+ * The initial and final signals are evaluated by a single forward pass of the stacked batch and,
+ * with synchronous training, the outputs of the last final signals after the fitting are cached
+ * and reused to choose the next action.
+ * </p>
  */
 public class ActorCriticAgent {
     private static final Logger logger = LoggerFactory.getLogger(ActorCriticAgent.class);
@@ -64,15 +82,22 @@ public class ActorCriticAgent {
 
     private final ActorCriticAgentConf config;
     private final ComputationGraph agentModel;
+    private final AtomicReference<ComputationGraph> inferenceModel;
+    private final ReplayBuffer replay;
     private INDArray alpha;
     private INDArray avg;
     private long saveTime;
+    private long updates;
+    private INDArray cachedSignals;
+    private INDArray[] cachedOutputs;
 
     protected ActorCriticAgent(ActorCriticAgentConf config, ComputationGraph agentModel, INDArray alpha, INDArray avg) {
         this.config = config;
         this.agentModel = requireNonNull(agentModel);
         this.alpha = alpha;
         this.avg = avg;
+        this.inferenceModel = new AtomicReference<>(config.isAsyncTraining() ? agentModel.clone() : agentModel);
+        this.replay = config.getReplaySize() > 0 ? ReplayBuffer.create(config.getReplaySize()) : null;
         saveTime = System.currentTimeMillis() + config.getSaveInterval();
     }
 
@@ -83,27 +108,153 @@ public class ActorCriticAgent {
      * @param random  the random generator
      */
     public INDArray chooseAction(INDArray signals, Random random) {
-        INDArray[] netOutputs = agentModel.output(signals);
+        INDArray[] netOutputs = signals == cachedSignals
+                ? cachedOutputs
+                : inferenceModel.get().output(signals);
+        cachedSignals = null;
+        cachedOutputs = null;
         INDArray[] actions = config.getActors().stream()
                 .map(a -> a.chooseAction(netOutputs, random))
                 .toArray(INDArray[]::new);
         return hstack(actions);
     }
 
+    /**
+     * Returns the actions for a batch of signals (one action row per signals row)
+     * The signals are evaluated by a single forward pass.
+     *
+     * @param signals the normalized signals to network (one row per environment)
+     * @param random  the random generator
+     */
+    public INDArray[] chooseActions(INDArray signals, Random random) {
+        INDArray[] netOutputs = inferenceModel.get().output(signals);
+        int n = (int) signals.rows();
+        INDArray[] result = new INDArray[n];
+        for (int i = 0; i < n; i++) {
+            INDArray[] rowOutputs = rows(netOutputs, i);
+            result[i] = hstack(config.getActors().stream()
+                    .map(a -> a.chooseAction(rowOutputs, random))
+                    .toArray(INDArray[]::new));
+        }
+        return result;
+    }
+
+    /**
+     * Returns the list of dictionaries of training data for a batch of feedbacks
+     * Optimizes the policy fitting the network with a single minibatch.
+     * The network outputs before and after the fitting are computed by batched forward passes,
+     * the average reward and alpha parameters are updated sequentially for each feedback as in
+     * {@link #directLearn(Feedback, Random)}.
+     *
+     * @param feedbacks the feedbacks
+     * @param random    the random generator
+     */
+    public List<Map<String, Object>> batchLearn(List<Feedback> feedbacks, Random random) {
+        return batchLearn(feedbacks, 0);
+    }
+
+    /**
+     * Returns the list of dictionaries of training data for a batch of feedbacks
+     * Optimizes the policy fitting the network with a single minibatch.
+     *
+     * @param feedbacks  the feedbacks
+     * @param updateFrom the index of first feedback updating the average reward and alpha parameters
+     */
+    private List<Map<String, Object>> batchLearn(List<Feedback> feedbacks, int updateFrom) {
+        INDArray s0 = vstack(feedbacks.stream().map(Feedback::getS0).toArray(INDArray[]::new));
+        INDArray s1 = vstack(feedbacks.stream().map(Feedback::getS1).toArray(INDArray[]::new));
+
+        INDArray[][] outputs = evaluate(s0, s1);
+        List<Map<String, Object>> maps = computeLabels(feedbacks, outputs[0], outputs[1], feedbacks.size());
+        int numLabels = ((INDArray[]) maps.get(0).get("labels")).length;
+        INDArray[] labels = new INDArray[numLabels];
+        for (int i = 0; i < numLabels; i++) {
+            int idx = i;
+            labels[i] = vstack(maps.stream()
+                    .map(map -> ((INDArray[]) map.get("labels"))[idx])
+                    .toArray(INDArray[]::new));
+        }
+        agentModel.fit(new INDArray[]{s0}, labels);
+        updateInferenceModel();
+        checkForSave();
+
+        INDArray[][] outputs1 = evaluate(s0, s1);
+        List<Map<String, Object>> result = computeLabels(feedbacks, outputs1[0], outputs1[1], updateFrom);
+        int last = feedbacks.size() - 1;
+        cacheOutputs(feedbacks.get(last).getS1(), rows(outputs1[1], last));
+        for (int i = 0; i < result.size(); i++) {
+            Map<String, Object> map1 = result.get(i);
+            map1.put("J0", maps.get(i).get("J"));
+            map1.put("J1", map1.get("J"));
+        }
+        return result;
+    }
+
+    /**
+     * Caches the outputs of the trained network for the signals if the inference uses the trained network
+     *
+     * @param signals the signals
+     * @param outputs the network outputs
+     */
+    private void cacheOutputs(INDArray signals, INDArray[] outputs) {
+        if (!config.isAsyncTraining()) {
+            cachedSignals = signals;
+            cachedOutputs = outputs;
+        }
+    }
+
+    /**
+     * Saves the model if the save interval is elapsed
+     */
+    private void checkForSave() {
+        if (System.currentTimeMillis() >= saveTime) {
+            saveTime = System.currentTimeMillis() + config.getSaveInterval();
+            saveModel();
+        }
+    }
+
+    /**
+     * Returns the dictionaries of training data of a batch of feedbacks
+     *
+     * @param feedbacks  the feedbacks
+     * @param outputs0   the network outputs for the initial states
+     * @param outputs1   the network outputs for the final states
+     * @param updateFrom the index of first feedback updating the average reward and alpha after its labels
+     */
+    private List<Map<String, Object>> computeLabels(List<Feedback> feedbacks, INDArray[] outputs0, INDArray[] outputs1, int updateFrom) {
+        List<Map<String, Object>> result = new ArrayList<>(feedbacks.size());
+        for (int i = 0; i < feedbacks.size(); i++) {
+            Map<String, Object> map = computeLabels(feedbacks.get(i), rows(outputs0, i), rows(outputs1, i));
+            if (i >= updateFrom) {
+                avg = (INDArray) map.get("newAverage");
+                alpha = (INDArray) map.get("alpha*");
+            }
+            result.add(map);
+        }
+        return result;
+    }
+
     /**
      * Returns the dictionary of training data
      *
      * @param feedback the feedback
      */
     public Map<String, Object> computeLabels(Feedback feedback) {
+        INDArray[][] outputs = evaluate(feedback.getS0(), feedback.getS1());
+        return computeLabels(feedback, outputs[0], outputs[1]);
+    }
+
+    /**
+     * Returns the dictionary of training data
+     *
+     * @param feedback the feedback
+     * @param outputs0 the network outputs for the initial state
+     * @param outputs1 the network outputs for the final state
+     */
+    private Map<String, Object> computeLabels(Feedback feedback, INDArray[] outputs0, INDArray[] outputs1) {
         Map<String, Object> result = new HashMap<>();
-        INDArray s0 = feedback.getS0();
         INDArray actions = feedback.getAction();
         double reward = feedback.getReward();
-        INDArray s1 = feedback.getS1();
-
-        INDArray[] outputs0 = agentModel.output(s0);
-        INDArray[] outputs1 = agentModel.output(s1);
 
         INDArray v0 = getV(outputs0);
         INDArray v1 = getV(outputs1);
@@ -169,18 +320,18 @@ public class ActorCriticAgent {
      * @param random   the random generator
      */
     public Map<String, Object> directLearn(Feedback feedback, Random random) {
-        Map<String, Object> map = computeLabels(feedback);
+        INDArray[][] outputs = evaluate(feedback.getS0(), feedback.getS1());
+        Map<String, Object> map = computeLabels(feedback, outputs[0], outputs[1]);
         INDArray[] labels = (INDArray[]) map.get("labels");
 
         INDArray[] inputs = new INDArray[]{feedback.getS0()};
         agentModel.fit(inputs, labels);
+        updateInferenceModel();
+        checkForSave();
 
-        if (saveTime >= System.currentTimeMillis()) {
-            saveTime = System.currentTimeMillis() + config.getSaveInterval();
-            saveModel();
-        }
-
-        Map<String, Object> map1 = computeLabels(feedback);
+        INDArray[][] outputs1 = evaluate(feedback.getS0(), feedback.getS1());
+        Map<String, Object> map1 = computeLabels(feedback, outputs1[0], outputs1[1]);
+        cacheOutputs(feedback.getS1(), outputs1[1]);
 
         avg = (INDArray) map1.get("newAverage");
         alpha = (INDArray) map1.get("alpha*");
@@ -189,6 +340,25 @@ public class ActorCriticAgent {
         return map1;
     }
 
+    /**
+     * Returns the outputs of the trained network for the initial and final signals ({outputs0, outputs1})
+     * The signals are stacked and evaluated by a single forward pass.
+     *
+     * @param s0 the initial signals
+     * @param s1 the final signals
+     */
+    public INDArray[][] evaluate(INDArray s0, INDArray s1) {
+        long n = s0.rows();
+        INDArray[] outputs = agentModel.output(vstack(s0, s1));
+        INDArray[] outputs0 = new INDArray[outputs.length];
+        INDArray[] outputs1 = new INDArray[outputs.length];
+        for (int i = 0; i < outputs.length; i++) {
+            outputs0[i] = outputs[i].get(interval(0, n), all());
+            outputs1[i] = outputs[i].get(interval(n, 2 * n), all());
+        }
+        return new INDArray[][]{outputs0, outputs1};
+    }
+
     /**
      * Returns the fit agent and the score
      * Optimizes the policy based on the feedback and model/planning
@@ -200,6 +370,50 @@ public class ActorCriticAgent {
         return null;
     }
 
+    /**
+     * Returns the dictionary of training data
+     * Stores the feedback in the replay memory and optimizes the policy
+     * (see {@link #remember(Feedback)}, {@link #train(Feedback, Random)})
+     *
+     * @param feedback the feedback from the last step
+     * @param random   the random generator
+     */
+    public Map<String, Object> learn(Feedback feedback, Random random) {
+        remember(feedback);
+        return train(feedback, random);
+    }
+
+    /**
+     * Stores the feedback in the replay memory if any
+     *
+     * @param feedback the feedback
+     */
+    public ActorCriticAgent remember(Feedback feedback) {
+        if (replay != null) {
+            replay.add(feedback);
+        }
+        return this;
+    }
+
+    /**
+     * Returns the dictionary of training data
+     * Optimizes the policy by a minibatch of the feedback and the feedbacks sampled from replay memory
+     * or by the single feedback if no replay memory is configured.
+     * The average reward and alpha parameters are updated by the feedback only.
+     *
+     * @param feedback the feedback from the last step
+     * @param random   the random generator
+     */
+    public Map<String, Object> train(Feedback feedback, Random random) {
+        if (replay == null) {
+            return directLearn(feedback, random);
+        }
+        List<Feedback> batch = replay.sample(config.getBatchSize() - 1, random);
+        batch.add(feedback);
+        List<Map<String, Object>> maps = batchLearn(batch, batch.size() - 1);
+        return maps.get(maps.size() - 1);
+    }
+
     private <T> Stream<T> getActorValues(Map<String, Object> values, String key) {
         return config.getActors().stream()
                 .map(a -> (T) values.get(format("%s(%d)", key, a.getDimension())));
@@ -216,6 +430,13 @@ public class ActorCriticAgent {
         return agentModel;
     }
 
+    /**
+     * Returns true if the training runs on a different thread then the inference
+     */
+    public boolean isAsyncTraining() {
+        return config.isAsyncTraining();
+    }
+
     /**
      * Returns the estimation of state value (denormalized critic output)
      *
@@ -225,6 +446,51 @@ public class ActorCriticAgent {
         return config.denormalizeActionValue(outputs[0].getScalar(0));
     }
 
+    /**
+     * Returns a row of each network output
+     *
+     * @param outputs the network outputs
+     * @param row     the row
+     */
+    private static INDArray[] rows(INDArray[] outputs, int row) {
+        INDArray[] result = new INDArray[outputs.length];
+        for (int i = 0; i < outputs.length; i++) {
+            result[i] = outputs[i].getRow(row, true);
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of fittings
+     */
+    public long getUpdates() {
+        return updates;
+    }
+
+    /**
+     * Publishes a new snapshot of the trained network to the inference every publishInterval fittings
+     */
+    private void updateInferenceModel() {
+        updates++;
+        if (!config.isAsyncTraining()) {
+            cachedSignals = null;
+            cachedOutputs = null;
+        } else if (updates % config.getPublishInterval() == 0) {
+            inferenceModel.set(agentModel.clone());
+        }
+    }
+
+    /**
+     * Returns the inference network exported to a file from the network published to the inference
+     *
+     * @param file      the file
+     * @param precision the precision of weights
+     * @throws IOException in case of error
+     */
+    public InferenceNetwork exportInference(File file, InferenceNetwork.Precision precision) throws IOException {
+        return InferenceNetwork.fromGraph(inferenceModel.get()).write(file, precision);
+    }
+
     private void saveModel() {
         config.getSaveFile().ifPresent(file -> {
             try {
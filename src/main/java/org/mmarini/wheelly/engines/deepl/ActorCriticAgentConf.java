@@ -45,6 +45,8 @@ import static java.util.stream.IntStream.concat;
 
 public class ActorCriticAgentConf {
     public static final long DEFAULT_SAVE_INTERVAL = 10000;
+    public static final int DEFAULT_BATCH_SIZE = 32;
+    public static final int DEFAULT_PUBLISH_INTERVAL = 1;
 
     private static final Logger logger = LoggerFactory.getLogger(ActorCriticAgentConf.class);
 
@@ -62,10 +64,15 @@ public class ActorCriticAgentConf {
                 rewardRange.getDouble(0),
                 rewardRange.getDouble(1));
         long saveInterval1 = locator.path("saveInterval").getNode(root).asLong(DEFAULT_SAVE_INTERVAL);
+        int replaySize = locator.path("replaySize").getNode(root).asInt(0);
+        int batchSize = locator.path("batchSize").getNode(root).asInt(DEFAULT_BATCH_SIZE);
+        boolean asyncTraining = locator.path("asyncTraining").getNode(root).asBoolean(false);
+        int publishInterval = locator.path("publishInterval").getNode(root).asInt(DEFAULT_PUBLISH_INTERVAL);
         return new ActorCriticAgentConf(rewardDecay, valueDecay,
                 denormalizerReward, normalizerReward,
                 actors,
-                saveFile != null ? new File(saveFile) : null, saveInterval1);
+                saveFile != null ? new File(saveFile) : null, saveInterval1,
+                replaySize, batchSize, asyncTraining, publishInterval);
     }
 
     private final double rewardDecay;
@@ -75,10 +82,31 @@ public class ActorCriticAgentConf {
     private final long saveInterval;
     private final UnaryOperator<INDArray> denormalizerReward;
     private final UnaryOperator<INDArray> normalizerReward;
+    private final int replaySize;
+    private final int batchSize;
+    private final boolean asyncTraining;
+    private final int publishInterval;
 
+    /**
+     * Creates the agent configuration
+     *
+     * @param rewardDecay        the reward decay time (s)
+     * @param valueDecay         the value decay time (s)
+     * @param denormalizerReward the reward denormalizer
+     * @param normalizerReward   the reward normalizer
+     * @param actors             the actors
+     * @param saveFile           the model save file
+     * @param saveInterval       the save interval (ms)
+     * @param replaySize         the capacity of replay memory (0 if the agent learns from the last feedback only)
+     * @param batchSize          the number of feedbacks of each training minibatch (replay memory only)
+     * @param asyncTraining      true if the training runs on its own thread
+     * @param publishInterval    the number of fittings between network snapshots published to the inference
+     *                           (asynchronous training only)
+     */
     protected ActorCriticAgentConf(double rewardDecay, double valueDecay,
                                    UnaryOperator<INDArray> denormalizerReward, UnaryOperator<INDArray> normalizerReward,
-                                   List<Actor> actors, File saveFile, long saveInterval) {
+                                   List<Actor> actors, File saveFile, long saveInterval,
+                                   int replaySize, int batchSize, boolean asyncTraining, int publishInterval) {
         this.rewardDecay = rewardDecay;
         this.valueDecay = valueDecay;
         this.denormalizerReward = denormalizerReward;
@@ -86,6 +114,10 @@ public class ActorCriticAgentConf {
         this.actors = actors;
         this.saveFile = saveFile;
         this.saveInterval = saveInterval;
+        this.replaySize = replaySize;
+        this.batchSize = batchSize;
+        this.asyncTraining = asyncTraining;
+        this.publishInterval = publishInterval;
     }
 
     /**
@@ -101,6 +133,13 @@ public class ActorCriticAgentConf {
         return actors;
     }
 
+    /**
+     * Returns the number of feedbacks of each training minibatch
+     */
+    public int getBatchSize() {
+        return batchSize;
+    }
+
     public int[] getNumOutputs() {
         return concat(
                 IntStream.of(1), // Critic output
@@ -108,6 +147,20 @@ public class ActorCriticAgentConf {
         ).toArray();
     }
 
+    /**
+     * Returns the number of fittings between network snapshots published to the inference
+     */
+    public int getPublishInterval() {
+        return publishInterval;
+    }
+
+    /**
+     * Returns the capacity of replay memory (0 if the agent learns from the last feedback only)
+     */
+    public int getReplaySize() {
+        return replaySize;
+    }
+
     public double getRewardDecay() {
         return rewardDecay;
     }
@@ -124,6 +177,13 @@ public class ActorCriticAgentConf {
         return valueDecay;
     }
 
+    /**
+     * Returns true if the training runs on its own thread
+     */
+    public boolean isAsyncTraining() {
+        return asyncTraining;
+    }
+
     /**
      * Returns the normalized action value
      *
@@ -0,0 +1,163 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import io.reactivex.rxjava3.core.Scheduler;
+import org.nd4j.linalg.api.rng.Random;
+import org.nd4j.linalg.factory.Nd4j;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.Map;
+import java.util.Queue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.function.BiConsumer;
+
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The background learner of the actor-critic agent.
+ * <p>
+ * The feedbacks are offered by the inference thread to a lock-free bounded queue and consumed in order by
+ * the worker of the scheduler that trains the agent.
+ * The feedbacks offered when the queue is full are dropped, so the inference never waits for the training.
+ * The agent publishes the network snapshots to the inference and saves the model from the learner thread.
+ * </p>
+ */
+public class AsyncLearner {
+    public static final int DEFAULT_QUEUE_SIZE = 64;
+    private static final Logger logger = LoggerFactory.getLogger(AsyncLearner.class);
+
+    /**
+     * Returns the learner
+     *
+     * @param agent     the agent
+     * @param scheduler the scheduler of training
+     * @param queueSize the maximum number of pending feedbacks
+     * @param onTrained the consumer of the feedback and training data after each training
+     */
+    public static AsyncLearner create(ActorCriticAgent agent, Scheduler scheduler, int queueSize,
+                                      BiConsumer<Feedback, Map<String, Object>> onTrained) {
+        return new AsyncLearner(agent, scheduler.createWorker(), queueSize, onTrained);
+    }
+
+    private final ActorCriticAgent agent;
+    private final Scheduler.Worker worker;
+    private final int queueSize;
+    private final BiConsumer<Feedback, Map<String, Object>> onTrained;
+    private final Queue<Feedback> queue;
+    private final AtomicInteger pending;
+    private final AtomicInteger wip;
+    private final AtomicLong dropped;
+    private final Random random;
+
+    /**
+     * Creates the learner
+     *
+     * @param agent     the agent
+     * @param worker    the worker of training
+     * @param queueSize the maximum number of pending feedbacks
+     * @param onTrained the consumer of the feedback and training data after each training
+     */
+    protected AsyncLearner(ActorCriticAgent agent, Scheduler.Worker worker, int queueSize,
+                           BiConsumer<Feedback, Map<String, Object>> onTrained) {
+        this.agent = requireNonNull(agent);
+        this.worker = requireNonNull(worker);
+        this.queueSize = queueSize;
+        this.onTrained = requireNonNull(onTrained);
+        this.queue = new ConcurrentLinkedQueue<>();
+        this.pending = new AtomicInteger();
+        this.wip = new AtomicInteger();
+        this.dropped = new AtomicLong();
+        this.random = Nd4j.getRandomFactory().getNewRandomInstance();
+    }
+
+    /**
+     * Stops the learner
+     */
+    public void dispose() {
+        worker.dispose();
+        queue.clear();
+    }
+
+    /**
+     * Trains the agent with the pending feedbacks
+     */
+    private void drain() {
+        int missed = 1;
+        for (; ; ) {
+            for (Feedback feedback = queue.poll(); feedback != null; feedback = queue.poll()) {
+                pending.decrementAndGet();
+                if (worker.isDisposed()) {
+                    return;
+                }
+                try {
+                    Map<String, Object> map = agent.train(feedback, random);
+                    onTrained.accept(feedback, map);
+                } catch (Throwable ex) {
+                    logger.error(ex.getMessage(), ex);
+                }
+            }
+            missed = wip.addAndGet(-missed);
+            if (missed == 0) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Returns the number of dropped feedbacks
+     */
+    public long getDropped() {
+        return dropped.get();
+    }
+
+    /**
+     * Returns true if the feedback has been queued for training or false if the queue is full
+     *
+     * @param feedback the feedback
+     */
+    public boolean offer(Feedback feedback) {
+        requireNonNull(feedback);
+        if (pending.incrementAndGet() > queueSize) {
+            pending.decrementAndGet();
+            long n = dropped.incrementAndGet();
+            logger.debug("Learner queue full, {} feedbacks dropped", n);
+            return false;
+        }
+        queue.offer(feedback);
+        if (wip.getAndIncrement() == 0) {
+            worker.schedule(this::drain);
+        }
+        return true;
+    }
+}
@@ -34,8 +34,6 @@ import org.mmarini.wheelly.model.GridScannerMap;
 import org.mmarini.wheelly.model.MapStatus;
 import org.mmarini.wheelly.model.Obstacle;
 import org.mmarini.wheelly.model.WheellyStatus;
-import org.nd4j.linalg.api.ndarray.INDArray;
-import org.nd4j.linalg.factory.Nd4j;
 
 import java.awt.geom.AffineTransform;
 import java.awt.geom.Point2D;
@@ -123,7 +121,7 @@ public class FullFeaturesSignalEncoder implements SignalEncoder {
      */
     private static IntStream encodeMap(WheellyStatus wheelly, GridScannerMap map) {
         return encodePoints(
-                transform(map.getObstacles().stream().map(Obstacle::getLocation),
+                transform(map.getGrid().stream().map(Obstacle::getLocation),
                         wheelly.getRobotLocation(),
                         wheelly.getSensorRad()));
     }
@@ -169,8 +167,7 @@ public class FullFeaturesSignalEncoder implements SignalEncoder {
     }
 
     @Override
-    public INDArray encode(Timed<MapStatus> status) {
-        INDArray result = Nd4j.zeros(1, NUM_SIGNALS);
+    public int[] encodeIndices(Timed<MapStatus> status) {
         WheellyStatus wheelly = status.value().getWheelly();
         GridScannerMap map = status.value().getMap();
 
@@ -183,22 +180,23 @@ public class FullFeaturesSignalEncoder implements SignalEncoder {
         boolean imuFailure = wheelly.isImuFailure();
         int voltage = encodeVoltage(wheelly.getVoltage());
         int location = encodeLocation(wheelly.getRobotLocation());
-
-        result.putScalar(0, direction + DIRECTION_OFFSET, 1d);
-        result.putScalar(0, sensor + SENSOR_OFFSET, 1d);
-        result.putScalar(0, distance + DISTANCE_OFFSET, 1d);
-        result.putScalar(0, contacts + CONTACTS_OFFSET, 1d);
-        result.putScalar(0, block + BLOCK_OFFSET, 1d);
+        int[] obstacles = encodeMap(wheelly, map).toArray();
+
+        int[] result = new int[(imuFailure ? 8 : 7) + obstacles.length];
+        int n = 0;
+        result[n++] = direction + DIRECTION_OFFSET;
+        result[n++] = sensor + SENSOR_OFFSET;
+        result[n++] = distance + DISTANCE_OFFSET;
+        result[n++] = contacts + CONTACTS_OFFSET;
+        result[n++] = block + BLOCK_OFFSET;
         if (imuFailure) {
-            result.putScalar(0, IMU_FAILURE_OFFSET, 1d);
+            result[n++] = IMU_FAILURE_OFFSET;
+        }
+        result[n++] = voltage + VOLTAGE_OFFSET;
+        result[n++] = location + LOCATION_OFFSET;
+        for (int idx : obstacles) {
+            result[n++] = idx + MAP_OFFSET;
         }
-        result.putScalar(0, voltage + VOLTAGE_OFFSET, 1);
-        result.putScalar(0, location + LOCATION_OFFSET, 1);
-
-        encodeMap(wheelly, map).forEach(
-                idx -> result.putScalar(0, idx + MAP_OFFSET, 1)
-        );
-
         return result;
     }
 
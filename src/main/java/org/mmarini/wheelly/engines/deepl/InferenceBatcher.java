@@ -0,0 +1,228 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.api.rng.Random;
+
+import java.util.*;
+import java.util.function.BiConsumer;
+import java.util.function.Function;
+import java.util.function.Supplier;
+
+import static java.util.Objects.requireNonNull;
+import static java.util.concurrent.TimeUnit.MILLISECONDS;
+import static java.util.concurrent.TimeUnit.NANOSECONDS;
+import static org.nd4j.linalg.factory.Nd4j.vstack;
+
+/**
+ * The inference batcher chooses the actions of several robots sharing the same agent by batched forward passes.
+ * <p>
+ * Each member thread requesting an action joins the current batch and waits until all the members
+ * requested their actions or the batch timeout expires, then the batch signals are evaluated by a single
+ * forward pass and each member gets its own action row.
+ * The batches and the exclusive tasks (e.g. the training) are serialized, so the shared agent is accessed
+ * by one thread at a time.
+ * With asynchronous training the members share a single background learner and the training data of each
+ * feedback is notified to the member that offered the feedback.
+ * The members should run on different threads, the members of the same thread are serialized and complete
+ * their batches at the timeout.
+ * </p>
+ */
+public class InferenceBatcher {
+    public static final long DEFAULT_TIMEOUT = 10;
+
+    /**
+     * Returns the batcher of the agent actions
+     *
+     * @param agent      the shared agent
+     * @param random     the random generator
+     * @param numMembers the number of members
+     * @param timeout    the maximum wait time for the batch completion (ms)
+     */
+    public static InferenceBatcher create(ActorCriticAgent agent, Random random, int numMembers, long timeout) {
+        requireNonNull(agent);
+        requireNonNull(random);
+        return new InferenceBatcher(signals -> agent.chooseActions(signals, random), numMembers, timeout);
+    }
+
+    private final Function<INDArray, INDArray[]> batchFunction;
+    private final int numMembers;
+    private final long timeoutNanos;
+    private final Map<Feedback, BiConsumer<Feedback, Map<String, Object>>> owners;
+    private Batch current;
+    private AsyncLearner learner;
+    private long numBatches;
+    private long numActions;
+
+    /**
+     * Creates the batcher
+     *
+     * @param batchFunction the function returning the action rows of the batch signals
+     * @param numMembers    the number of members
+     * @param timeout       the maximum wait time for the batch completion (ms)
+     */
+    protected InferenceBatcher(Function<INDArray, INDArray[]> batchFunction, int numMembers, long timeout) {
+        this.batchFunction = requireNonNull(batchFunction);
+        if (numMembers < 1) {
+            throw new IllegalArgumentException("numMembers must be positive");
+        }
+        this.numMembers = numMembers;
+        this.timeoutNanos = MILLISECONDS.toNanos(timeout);
+        this.current = new Batch();
+        this.owners = Collections.synchronizedMap(new IdentityHashMap<>());
+    }
+
+    /**
+     * Returns the action for the signals of a member.
+     * The signals are evaluated with the signals of the other members in the same batch.
+     *
+     * @param signals the signals row
+     */
+    public synchronized INDArray chooseAction(INDArray signals) {
+        requireNonNull(signals);
+        Batch batch = current;
+        int slot = batch.signals.size();
+        batch.signals.add(signals);
+        if (batch.signals.size() < numMembers) {
+            long deadline = System.nanoTime() + timeoutNanos;
+            try {
+                for (long wait = timeoutNanos; batch.actions == null && wait > 0; wait = deadline - System.nanoTime()) {
+                    NANOSECONDS.timedWait(this, wait);
+                }
+            } catch (InterruptedException ex) {
+                Thread.currentThread().interrupt();
+            }
+        }
+        if (batch.actions == null) {
+            run(batch);
+        }
+        return batch.actions[slot];
+    }
+
+    /**
+     * Returns the result of the task run exclusively of the batches and the other tasks
+     *
+     * @param task the task
+     */
+    public synchronized <T> T exclusive(Supplier<T> task) {
+        return task.get();
+    }
+
+    /**
+     * Returns the average number of actions per batch
+     */
+    public synchronized double getAverageBatchSize() {
+        return numBatches > 0 ? (double) numActions / numBatches : 0;
+    }
+
+    /**
+     * Returns the background learner shared by the members creating it at the first call
+     *
+     * @param factory the factory of learner
+     */
+    public synchronized AsyncLearner getLearner(Supplier<AsyncLearner> factory) {
+        if (learner == null) {
+            learner = requireNonNull(factory.get());
+        }
+        return learner;
+    }
+
+    /**
+     * Returns the number of feedbacks offered to the learner and not yet trained
+     */
+    public int getNumPendingFeedbacks() {
+        return owners.size();
+    }
+
+    /**
+     * Notifies the training data of a feedback to the member that offered it.
+     * It should be the training consumer of the shared learner.
+     *
+     * @param feedback the trained feedback
+     * @param map      the training data
+     */
+    public void notifyTrained(Feedback feedback, Map<String, Object> map) {
+        BiConsumer<Feedback, Map<String, Object>> owner = owners.remove(feedback);
+        if (owner != null) {
+            owner.accept(feedback, map);
+        }
+    }
+
+    /**
+     * Returns true if the feedback of a member has been queued to the shared learner
+     *
+     * @param learner   the shared learner
+     * @param feedback  the feedback
+     * @param onTrained the consumer of the member notified after the feedback training
+     */
+    public boolean offer(AsyncLearner learner, Feedback feedback, BiConsumer<Feedback, Map<String, Object>> onTrained) {
+        requireNonNull(learner);
+        requireNonNull(feedback);
+        requireNonNull(onTrained);
+        // Registers the owner before queuing, the training may complete before the offer returns
+        owners.put(feedback, onTrained);
+        if (!learner.offer(feedback)) {
+            owners.remove(feedback);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Returns the number of members
+     */
+    public int getNumMembers() {
+        return numMembers;
+    }
+
+    /**
+     * Evaluates the batch and notifies the waiting members
+     *
+     * @param batch the batch
+     */
+    private void run(Batch batch) {
+        current = new Batch();
+        List<INDArray> signals = batch.signals;
+        INDArray inputs = signals.size() == 1 ? signals.get(0) : vstack(signals.toArray(INDArray[]::new));
+        batch.actions = batchFunction.apply(inputs);
+        numBatches++;
+        numActions += signals.size();
+        notifyAll();
+    }
+
+    /**
+     * The signals of members and the resulting actions
+     */
+    private static class Batch {
+        final List<INDArray> signals = new ArrayList<>();
+        INDArray[] actions;
+    }
+}
@@ -0,0 +1,599 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.deeplearning4j.nn.api.Layer;
+import org.deeplearning4j.nn.conf.layers.BaseLayer;
+import org.deeplearning4j.nn.graph.ComputationGraph;
+import org.deeplearning4j.nn.graph.vertex.GraphVertex;
+import org.deeplearning4j.nn.graph.vertex.VertexIndices;
+import org.deeplearning4j.nn.graph.vertex.impl.MergeVertex;
+import org.nd4j.linalg.activations.IActivation;
+import org.nd4j.linalg.activations.impl.*;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.factory.Nd4j;
+
+import java.io.*;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import static java.lang.Math.*;
+import static java.lang.String.format;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The inference only network evaluates the outputs of a dense layers graph with flat weights arrays.
+ * <p>
+ * The network is exported from the {@link ComputationGraph} of the agent without the updater state and
+ * the training configuration, and it is stored in a compact binary file with the weights in float32
+ * or quantised in float16 or int8 (symmetric scale per output node) precision.
+ * The quantised weights are converted to float when the file is read.
+ * The nodes are evaluated in topological order, the input node values are concatenated and the zero inputs are
+ * skipped, so the sparse signals of the encoders cost only the active weights.
+ * The network is immutable and thread safe.
+ * </p>
+ */
+public class InferenceNetwork {
+    public static final String DEFAULT_PRECISION = "float32";
+    private static final int MAGIC = 0x57494e46;
+    private static final int VERSION = 1;
+    private static final int NO_LAYER = -1;
+    private static final Activation[] ACTIVATIONS = Activation.values();
+
+    /**
+     * Returns the inference network of a computation graph.
+     * The graph may contain only input, dense or output layer and merge vertices.
+     *
+     * @param graph the computation graph
+     * @throws IllegalArgumentException if the graph contains unsupported vertices or activations
+     */
+    public static InferenceNetwork fromGraph(ComputationGraph graph) {
+        requireNonNull(graph);
+        if (graph.getNumInputArrays() != 1) {
+            throw new IllegalArgumentException(format("Network with %d inputs: expected 1", graph.getNumInputArrays()));
+        }
+        GraphVertex[] vertices = graph.getVertices();
+        Map<Integer, Integer> nodeByVertex = new HashMap<>();
+        List<Node> nodes = new ArrayList<>();
+        int numInputs = (int) graph.layerInputSize(0);
+        for (int vertexIndex : graph.topologicalSortOrder()) {
+            GraphVertex vertex = vertices[vertexIndex];
+            if (vertex.isInputVertex()) {
+                nodeByVertex.put(vertexIndex, nodes.size());
+                nodes.add(new Node(vertex.getVertexName(), new int[0], NO_LAYER, numInputs, numInputs, null, null));
+                continue;
+            }
+            VertexIndices[] inputVertices = vertex.getInputVertices();
+            int[] inputs = new int[inputVertices.length];
+            int nIn = 0;
+            for (int i = 0; i < inputs.length; i++) {
+                inputs[i] = nodeByVertex.get(inputVertices[i].getVertexIndex());
+                nIn += nodes.get(inputs[i]).numOutputs;
+            }
+            if (vertex instanceof MergeVertex) {
+                nodeByVertex.put(vertexIndex, nodes.size());
+                nodes.add(new Node(vertex.getVertexName(), inputs, NO_LAYER, nIn, nIn, null, null));
+            } else if (vertex.hasLayer() && vertex.getLayer().conf().getLayer() instanceof BaseLayer) {
+                Layer layer = vertex.getLayer();
+                INDArray w = layer.getParam("W");
+                INDArray b = layer.getParam("b");
+                if (w == null || b == null || w.rows() != nIn) {
+                    throw new IllegalArgumentException(format("Unsupported layer %s", vertex.getVertexName()));
+                }
+                int nOut = (int) w.columns();
+                float[][] wm = w.toFloatMatrix();
+                float[] weights = new float[nIn * nOut];
+                for (int i = 0; i < nIn; i++) {
+                    System.arraycopy(wm[i], 0, weights, i * nOut, nOut);
+                }
+                float[] bias = b.reshape(nOut).toFloatVector();
+                int activation = activationCode(((BaseLayer) layer.conf().getLayer()).getActivationFn());
+                nodeByVertex.put(vertexIndex, nodes.size());
+                nodes.add(new Node(vertex.getVertexName(), inputs, activation, nIn, nOut, weights, bias));
+            } else {
+                throw new IllegalArgumentException(format("Unsupported vertex %s", vertex.getVertexName()));
+            }
+        }
+        int[] outputs = graph.getConfiguration().getNetworkOutputs().stream()
+                .mapToInt(name -> nodeByVertex.get(graph.getVertex(name).getVertexIndex()))
+                .toArray();
+        return new InferenceNetwork(nodes, outputs);
+    }
+
+    /**
+     * Returns the activation code
+     *
+     * @param activation the activation function
+     */
+    private static int activationCode(IActivation activation) {
+        if (activation instanceof ActivationIdentity) {
+            return Activation.IDENTITY.ordinal();
+        } else if (activation instanceof ActivationReLU) {
+            return Activation.RELU.ordinal();
+        } else if (activation instanceof ActivationTanH) {
+            return Activation.TANH.ordinal();
+        } else if (activation instanceof ActivationHardTanH) {
+            return Activation.HARDTANH.ordinal();
+        } else if (activation instanceof ActivationSigmoid) {
+            return Activation.SIGMOID.ordinal();
+        } else if (activation instanceof ActivationHardSigmoid) {
+            return Activation.HARDSIGMOID.ordinal();
+        } else if (activation instanceof ActivationSoftPlus) {
+            return Activation.SOFTPLUS.ordinal();
+        }
+        throw new IllegalArgumentException(format("Unsupported activation %s", activation));
+    }
+
+    /**
+     * Returns the float value of a float16 (IEEE 754 half precision)
+     *
+     * @param half the float16 bits
+     */
+    static float halfToFloat(short half) {
+        int bits = half & 0xffff;
+        int sign = (bits & 0x8000) << 16;
+        int exponent = (bits >>> 10) & 0x1f;
+        int mantissa = bits & 0x3ff;
+        if (exponent == 0x1f) {
+            // Infinity or NaN
+            return Float.intBitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+        }
+        if (exponent == 0) {
+            // Zero or subnormal
+            float value = mantissa * 0x1p-24f;
+            return sign != 0 ? -value : value;
+        }
+        return Float.intBitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+
+    /**
+     * Returns the float16 (IEEE 754 half precision) nearest to a float value
+     *
+     * @param value the value
+     */
+    static short floatToHalf(float value) {
+        int bits = Float.floatToIntBits(value);
+        int sign = (bits >>> 16) & 0x8000;
+        int exponent = ((bits >>> 23) & 0xff) - 112;
+        int mantissa = bits & 0x7fffff;
+        if (exponent >= 0x1f) {
+            // Overflow, infinity or NaN
+            boolean nan = ((bits >>> 23) & 0xff) == 0xff && mantissa != 0;
+            return (short) (sign | 0x7c00 | (nan ? 0x200 : 0));
+        }
+        if (exponent <= 0) {
+            // Subnormal or zero
+            if (exponent < -10) {
+                return (short) sign;
+            }
+            mantissa |= 0x800000;
+            int shift = 14 - exponent;
+            int half = mantissa >> shift;
+            int rest = mantissa & ((1 << shift) - 1);
+            int halfway = 1 << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1) != 0)) {
+                half++;
+            }
+            return (short) (sign | half);
+        }
+        int half = (exponent << 10) | (mantissa >> 13);
+        int rest = mantissa & 0x1fff;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0)) {
+            // Rounds to nearest even, the carry may increment the exponent
+            half++;
+        }
+        return (short) (sign | half);
+    }
+
+    /**
+     * Returns the inference network read from a file
+     *
+     * @param file the file
+     * @throws IOException in case of error
+     */
+    public static InferenceNetwork read(File file) throws IOException {
+        try (DataInputStream in = new DataInputStream(new BufferedInputStream(new FileInputStream(file)))) {
+            if (in.readInt() != MAGIC) {
+                throw new IOException(format("File %s is not an inference network", file));
+            }
+            int version = in.readUnsignedByte();
+            if (version != VERSION) {
+                throw new IOException(format("Wrong inference network version %d: expected %d", version, VERSION));
+            }
+            Precision precision = Precision.values()[in.readUnsignedByte()];
+            int numNodes = in.readInt();
+            List<Node> nodes = new ArrayList<>(numNodes);
+            for (int k = 0; k < numNodes; k++) {
+                String name = in.readUTF();
+                int[] inputs = new int[in.readInt()];
+                for (int i = 0; i < inputs.length; i++) {
+                    inputs[i] = in.readInt();
+                }
+                int activation = in.readByte();
+                int nIn = in.readInt();
+                int nOut = in.readInt();
+                float[] bias = null;
+                float[] weights = null;
+                if (activation != NO_LAYER) {
+                    bias = new float[nOut];
+                    for (int j = 0; j < nOut; j++) {
+                        bias[j] = in.readFloat();
+                    }
+                    weights = readWeights(in, precision, nIn, nOut);
+                }
+                nodes.add(new Node(name, inputs, activation, nIn, nOut, weights, bias));
+            }
+            int[] outputs = new int[in.readInt()];
+            for (int i = 0; i < outputs.length; i++) {
+                outputs[i] = in.readInt();
+            }
+            return new InferenceNetwork(nodes, outputs);
+        }
+    }
+
+    /**
+     * Returns the weights read with a precision
+     *
+     * @param in        the input stream
+     * @param precision the precision
+     * @param nIn       the number of inputs
+     * @param nOut      the number of outputs
+     */
+    private static float[] readWeights(DataInputStream in, Precision precision, int nIn, int nOut) throws IOException {
+        float[] weights = new float[nIn * nOut];
+        switch (precision) {
+            case FLOAT16:
+                for (int i = 0; i < weights.length; i++) {
+                    weights[i] = halfToFloat(in.readShort());
+                }
+                break;
+            case INT8:
+                float[] scales = new float[nOut];
+                for (int j = 0; j < nOut; j++) {
+                    scales[j] = in.readFloat();
+                }
+                for (int i = 0; i < weights.length; i++) {
+                    weights[i] = in.readByte() * scales[i % nOut];
+                }
+                break;
+            default:
+                for (int i = 0; i < weights.length; i++) {
+                    weights[i] = in.readFloat();
+                }
+        }
+        return weights;
+    }
+
+    private final List<Node> nodes;
+    private final int[] outputs;
+
+    /**
+     * Creates the inference network
+     *
+     * @param nodes   the nodes in topological order (the first node is the network input)
+     * @param outputs the indices of output nodes
+     */
+    protected InferenceNetwork(List<Node> nodes, int[] outputs) {
+        this.nodes = List.copyOf(nodes);
+        this.outputs = requireNonNull(outputs);
+        if (this.nodes.isEmpty() || this.nodes.get(0).inputs.length != 0) {
+            throw new IllegalArgumentException("Missing input node");
+        }
+    }
+
+    /**
+     * Returns the values of the output nodes for an input vector
+     *
+     * @param input the input vector
+     */
+    public float[][] forward(float[] input) {
+        requireNonNull(input);
+        int numInputs = getNumInputs();
+        if (input.length != numInputs) {
+            throw new IllegalArgumentException(format("Wrong input size %d: expected %d", input.length, numInputs));
+        }
+        float[][] values = new float[nodes.size()][];
+        values[0] = input;
+        for (int k = 1; k < values.length; k++) {
+            values[k] = nodes.get(k).evaluate(values);
+        }
+        float[][] result = new float[outputs.length][];
+        for (int i = 0; i < outputs.length; i++) {
+            result[i] = values[outputs[i]];
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of inputs
+     */
+    public int getNumInputs() {
+        return nodes.get(0).numOutputs;
+    }
+
+    /**
+     * Returns the number of outputs of each output node
+     */
+    public int[] getNumOutputs() {
+        int[] result = new int[outputs.length];
+        for (int i = 0; i < outputs.length; i++) {
+            result[i] = nodes.get(outputs[i]).numOutputs;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of weights and biases
+     */
+    public long getNumParameters() {
+        return nodes.stream()
+                .filter(node -> node.bias != null)
+                .mapToLong(node -> (long) node.weights.length + node.bias.length)
+                .sum();
+    }
+
+    /**
+     * Returns the outputs of the network (one row per signals row) as the computation graph outputs
+     *
+     * @param signals the signals (one row per batch item)
+     */
+    public INDArray[] output(INDArray signals) {
+        float[][] inputs = signals.toFloatMatrix();
+        float[][][] rows = new float[outputs.length][inputs.length][];
+        for (int r = 0; r < inputs.length; r++) {
+            float[][] out = forward(inputs[r]);
+            for (int i = 0; i < outputs.length; i++) {
+                rows[i][r] = out[i];
+            }
+        }
+        INDArray[] result = new INDArray[outputs.length];
+        for (int i = 0; i < outputs.length; i++) {
+            result[i] = Nd4j.create(rows[i]);
+        }
+        return result;
+    }
+
+    /**
+     * Writes the network to a file
+     *
+     * @param file      the file
+     * @param precision the precision of weights
+     * @throws IOException in case of error
+     */
+    public InferenceNetwork write(File file, Precision precision) throws IOException {
+        requireNonNull(precision);
+        try (DataOutputStream out = new DataOutputStream(new BufferedOutputStream(new FileOutputStream(file)))) {
+            out.writeInt(MAGIC);
+            out.writeByte(VERSION);
+            out.writeByte(precision.ordinal());
+            out.writeInt(nodes.size());
+            for (Node node : nodes) {
+                out.writeUTF(node.name);
+                out.writeInt(node.inputs.length);
+                for (int input : node.inputs) {
+                    out.writeInt(input);
+                }
+                out.writeByte(node.activation);
+                out.writeInt(node.numInputs);
+                out.writeInt(node.numOutputs);
+                if (node.bias != null) {
+                    for (float b : node.bias) {
+                        out.writeFloat(b);
+                    }
+                    writeWeights(out, precision, node.weights, node.numOutputs);
+                }
+            }
+            out.writeInt(outputs.length);
+            for (int output : outputs) {
+                out.writeInt(output);
+            }
+        }
+        return this;
+    }
+
+    /**
+     * Writes the weights with a precision
+     *
+     * @param out       the output stream
+     * @param precision the precision
+     * @param weights   the weights
+     * @param nOut      the number of outputs
+     */
+    private void writeWeights(DataOutputStream out, Precision precision, float[] weights, int nOut) throws IOException {
+        switch (precision) {
+            case FLOAT16:
+                for (float w : weights) {
+                    out.writeShort(floatToHalf(w));
+                }
+                break;
+            case INT8:
+                float[] scales = new float[nOut];
+                for (int i = 0; i < weights.length; i++) {
+                    scales[i % nOut] = max(scales[i % nOut], abs(weights[i]));
+                }
+                for (int j = 0; j < nOut; j++) {
+                    scales[j] /= 127;
+                    out.writeFloat(scales[j]);
+                }
+                for (int i = 0; i < weights.length; i++) {
+                    float scale = scales[i % nOut];
+                    out.writeByte(scale > 0 ? round(weights[i] / scale) : 0);
+                }
+                break;
+            default:
+                for (float w : weights) {
+                    out.writeFloat(w);
+                }
+        }
+    }
+
+    /**
+     * The activation functions
+     */
+    enum Activation {
+        IDENTITY, RELU, TANH, HARDTANH, SIGMOID, HARDSIGMOID, SOFTPLUS;
+
+        /**
+         * Applies the function to the values
+         *
+         * @param values the values
+         */
+        void apply(float[] values) {
+            for (int i = 0; i < values.length; i++) {
+                float x = values[i];
+                switch (this) {
+                    case RELU:
+                        values[i] = max(x, 0);
+                        break;
+                    case TANH:
+                        values[i] = (float) tanh(x);
+                        break;
+                    case HARDTANH:
+                        values[i] = min(max(x, -1), 1);
+                        break;
+                    case SIGMOID:
+                        values[i] = (float) (1 / (1 + exp(-x)));
+                        break;
+                    case HARDSIGMOID:
+                        values[i] = min(max(0.2f * x + 0.5f, 0), 1);
+                        break;
+                    case SOFTPLUS:
+                        values[i] = (float) log1p(exp(x));
+                        break;
+                    default:
+                }
+            }
+        }
+    }
+
+    /**
+     * The precision of the stored weights
+     */
+    public enum Precision {
+        FLOAT32, FLOAT16, INT8;
+
+        /**
+         * Returns the precision by name (float32, float16, int8)
+         *
+         * @param name the name
+         */
+        public static Precision fromName(String name) {
+            switch (name) {
+                case "float32":
+                    return FLOAT32;
+                case "float16":
+                    return FLOAT16;
+                case "int8":
+                    return INT8;
+                default:
+                    throw new IllegalArgumentException(format("Wrong precision %s", name));
+            }
+        }
+    }
+
+    /**
+     * The network node, a dense layer or the concatenation of the input nodes
+     */
+    static class Node {
+        final String name;
+        final int[] inputs;
+        final int activation;
+        final int numInputs;
+        final int numOutputs;
+        final float[] weights;
+        final float[] bias;
+
+        /**
+         * Creates the node
+         *
+         * @param name       the name
+         * @param inputs     the input nodes
+         * @param activation the activation code or -1 if no layer
+         * @param numInputs  the number of inputs
+         * @param numOutputs the number of outputs
+         * @param weights    the weights (row major numInputs x numOutputs) or null if no layer
+         * @param bias       the biases or null if no layer
+         */
+        Node(String name, int[] inputs, int activation, int numInputs, int numOutputs, float[] weights, float[] bias) {
+            this.name = requireNonNull(name);
+            this.inputs = requireNonNull(inputs);
+            this.activation = activation;
+            this.numInputs = numInputs;
+            this.numOutputs = numOutputs;
+            this.weights = weights;
+            this.bias = bias;
+        }
+
+        /**
+         * Returns the concatenated values of the input nodes
+         *
+         * @param values the node values
+         */
+        private float[] concat(float[][] values) {
+            if (inputs.length == 1) {
+                return values[inputs[0]];
+            }
+            float[] result = new float[numInputs];
+            int offset = 0;
+            for (int input : inputs) {
+                float[] value = values[input];
+                System.arraycopy(value, 0, result, offset, value.length);
+                offset += value.length;
+            }
+            return result;
+        }
+
+        /**
+         * Returns the node values
+         *
+         * @param values the values of the previous nodes
+         */
+        float[] evaluate(float[][] values) {
+            float[] x = concat(values);
+            if (bias == null) {
+                return x;
+            }
+            float[] result = bias.clone();
+            for (int i = 0; i < numInputs; i++) {
+                float xi = x[i];
+                if (xi != 0) {
+                    int offset = i * numOutputs;
+                    for (int j = 0; j < numOutputs; j++) {
+                        result[j] += xi * weights[offset + j];
+                    }
+                }
+            }
+            ACTIVATIONS[activation].apply(result);
+            return result;
+        }
+    }
+}
@@ -30,6 +30,7 @@
 package org.mmarini.wheelly.engines.deepl;
 
 import com.fasterxml.jackson.databind.JsonNode;
+import io.reactivex.rxjava3.schedulers.Schedulers;
 import io.reactivex.rxjava3.schedulers.Timed;
 import org.deeplearning4j.nn.graph.ComputationGraph;
 import org.deeplearning4j.util.ModelSerializer;
@@ -72,6 +73,11 @@ import static org.nd4j.linalg.factory.Nd4j.scalar;
  * - Each actor uses a parametric normalizer and de-normalizer function to convert the neural outputs to the desired value.
  * - The normalized output value of the network is in (-1, 1) range.
  * The critic produces the common residual advantage that evaluates the state, action pair for each step used to fit the network.
+ * With asynchronous training the feedbacks are stored in the agent replay memory by the process and queued to the
+ * {@link AsyncLearner} that fits the network on a dedicated thread, the process runs only the inference.
+ * The engines of several robots sharing the same agent choose the actions by the batched forward passes of an
+ * {@link InferenceBatcher} that serializes the training too; with asynchronous training they share
+ * the background learner created by the first initialized engine and each engine gets the kpi of its own feedbacks.
  */
 public class RLEngine implements InferenceEngine {
     public static final int HALT_OFFSET = 0;
@@ -82,7 +88,19 @@ public class RLEngine implements InferenceEngine {
     private static final Logger logger = LoggerFactory.getLogger(RLEngine.class);
 
     public static InferenceEngine create(RLEngineConf config, Random random, ActorCriticAgent agent) {
-        return new RLEngine(config, random, agent);
+        return new RLEngine(config, random, agent, null);
+    }
+
+    /**
+     * Returns the engine sharing the agent with others engines through the inference batcher
+     *
+     * @param config  the agent configuration
+     * @param random  the random generator
+     * @param agent   the shared agent
+     * @param batcher the inference batcher of the agent
+     */
+    public static RLEngine create(RLEngineConf config, Random random, ActorCriticAgent agent, InferenceBatcher batcher) {
+        return new RLEngine(config, random, agent, requireNonNull(batcher));
     }
 
     public static INDArray createKpi(Map<String, Object> map, double reward) {
@@ -113,7 +131,7 @@ public class RLEngine implements InferenceEngine {
      * @param status  the status of robot
      * @param actions the actions of robot
      */
-    static Tuple2<MotionCommand, Integer> decodeAction(Timed<MapStatus> status, INDArray actions) {
+    public static Tuple2<MotionCommand, Integer> decodeAction(Timed<MapStatus> status, INDArray actions) {
         boolean halt = actions.getDouble(HALT_OFFSET) > 0;
         int direction = normalizeDegAngle(status.value().getWheelly().getRobotDeg() + actions.getInt(DIRECTION_OFFSET));
         double speed = min(max(actions.getDouble(SPEED_OFFSET), -1), 1);
@@ -163,7 +181,7 @@ public class RLEngine implements InferenceEngine {
         INDArray avg = scalar((float) locator.path("averageReward").getNode(root).asDouble(0));
         ActorCriticAgent agent = ActorCriticAgent.create(agentConf, agentModel, alphas, avg);
         Random random = Nd4j.getRandomFactory().getNewRandomInstance();
-        return new RLEngine(config, random, agent);
+        return new RLEngine(config, random, agent, null);
     }
 
     static ComputationGraph loadNetwork(File file, int noInputs, int[] noOutputs) throws IOException {
@@ -186,6 +204,8 @@ public class RLEngine implements InferenceEngine {
     private final RLEngineConf config;
     private final Random random;
     private final ActorCriticAgent agent;
+    private final InferenceBatcher batcher;
+    private AsyncLearner learner;
     private Timed<MapStatus> prevStatus;
     private INDArray prevSignals;
     private INDArray prevAction;
@@ -193,14 +213,16 @@ public class RLEngine implements InferenceEngine {
     /**
      * Creates the deep learning engine
      *
-     * @param config the agent configuration
-     * @param random the random generator
-     * @param agent  the reinforcement learning agent
+     * @param config  the agent configuration
+     * @param random  the random generator
+     * @param agent   the reinforcement learning agent
+     * @param batcher the inference batcher of the shared agent or null if not shared
      */
-    protected RLEngine(RLEngineConf config, Random random, ActorCriticAgent agent) {
+    protected RLEngine(RLEngineConf config, Random random, ActorCriticAgent agent, InferenceBatcher batcher) {
         this.random = requireNonNull(random);
         this.config = requireNonNull(config);
         this.agent = requireNonNull(agent);
+        this.batcher = batcher;
     }
 
     Feedback createFeedback(Timed<MapStatus> s1) {
@@ -233,6 +255,22 @@ public class RLEngine implements InferenceEngine {
 
     @Override
     public RLEngine init(InferenceMonitor monitor) {
+        if (batcher != null) {
+            // The engines of the batcher share the background learner notifying the kpi to the feedback owner
+            learner = agent.isAsyncTraining()
+                    ? batcher.getLearner(() -> AsyncLearner.create(agent, Schedulers.newThread(), AsyncLearner.DEFAULT_QUEUE_SIZE,
+                            batcher::notifyTrained))
+                    : null;
+            return this;
+        }
+        if (learner != null) {
+            learner.dispose();
+            learner = null;
+        }
+        if (agent.isAsyncTraining()) {
+            learner = AsyncLearner.create(agent, Schedulers.newThread(), AsyncLearner.DEFAULT_QUEUE_SIZE,
+                    (feedback, map) -> monitor.put(PERFORMANCE_KEY, createKpi(map, feedback.getReward())));
+        }
         return this;
     }
 
@@ -243,12 +281,27 @@ public class RLEngine implements InferenceEngine {
             inputs = config.encode(status);
         } else {
             Feedback feedback = createFeedback(status);
-            Map<String, Object> map = agent.directLearn(feedback, random);
-            INDArray kpi = createKpi(map, feedback.getReward());
-            monitor.put(PERFORMANCE_KEY, kpi);
+            if (learner != null) {
+                if (batcher != null) {
+                    batcher.exclusive(() -> agent.remember(feedback));
+                    batcher.offer(learner, feedback,
+                            (f, map) -> monitor.put(PERFORMANCE_KEY, createKpi(map, f.getReward())));
+                } else {
+                    agent.remember(feedback);
+                    learner.offer(feedback);
+                }
+            } else {
+                Map<String, Object> map = batcher != null
+                        ? batcher.exclusive(() -> agent.learn(feedback, random))
+                        : agent.learn(feedback, random);
+                INDArray kpi = createKpi(map, feedback.getReward());
+                monitor.put(PERFORMANCE_KEY, kpi);
+            }
             inputs = feedback.getS1();
         }
-        INDArray action = agent.chooseAction(inputs, random);
+        INDArray action = batcher != null
+                ? batcher.chooseAction(inputs)
+                : agent.chooseAction(inputs, random);
         prevStatus = status;
         prevAction = action;
         prevSignals = inputs;
@@ -62,6 +62,13 @@ public class RLEngineConf {
         return encoder.encode(status);
     }
 
+    /**
+     * Returns the signal encoder
+     */
+    public SignalEncoder getEncoder() {
+        return encoder;
+    }
+
     public int getNumInputs() {
         return encoder.getNumSignals();
     }
@@ -0,0 +1,138 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.Tuple2;
+import org.mmarini.wheelly.model.InferenceEngine;
+import org.mmarini.wheelly.model.InferenceMonitor;
+import org.mmarini.wheelly.model.MapStatus;
+import org.mmarini.wheelly.model.MotionCommand;
+import org.mmarini.yaml.schema.Locator;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.api.rng.Random;
+import org.nd4j.linalg.factory.Nd4j;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.List;
+
+import static java.lang.String.format;
+import static java.util.Objects.requireNonNull;
+import static org.nd4j.linalg.factory.Nd4j.hstack;
+
+/**
+ * The engine choose the action by the exported {@link InferenceNetwork} of the actor-critic agent without learning.
+ * The engine does not restore the computation graph and the updater state of the agent,
+ * so it starts fast and requires less memory than the {@link RLEngine} when the learning is not required.
+ */
+public class RLInferenceEngine implements InferenceEngine {
+    private static final Logger logger = LoggerFactory.getLogger(RLInferenceEngine.class);
+
+    /**
+     * Returns the engine
+     *
+     * @param encoder the signal encoder
+     * @param actors  the actors
+     * @param network the inference network
+     * @param random  the random generator
+     */
+    public static RLInferenceEngine create(SignalEncoder encoder, List<Actor> actors, InferenceNetwork network, Random random) {
+        int numInputs = encoder.getNumSignals();
+        if (network.getNumInputs() != numInputs) {
+            throw new IllegalArgumentException(format("Network with wrong (%d) input number: expected %d",
+                    network.getNumInputs(), numInputs));
+        }
+        // Critic output and actors outputs
+        int numOutputs = network.getNumOutputs().length;
+        if (numOutputs != actors.size() + 1) {
+            throw new IllegalArgumentException(format("Network with wrong (%d) output layers: expected %d",
+                    numOutputs, actors.size() + 1));
+        }
+        return new RLInferenceEngine(encoder, actors, network, random);
+    }
+
+    /**
+     * Returns the engine from configuration
+     *
+     * @param root    the configuration document
+     * @param locator the engine locator
+     * @throws IOException in case of error
+     */
+    public static RLInferenceEngine fromJson(JsonNode root, Locator locator) throws IOException {
+        Yaml.inferenceEngineConf().apply(locator).accept(root);
+        SignalEncoder encoder = Yaml.stateEncoder(root, locator.path("stateEncoder"));
+        List<Actor> actors = Actor.fromArray(root, locator.path("actors"));
+        File file = new File(locator.path("inferenceFile").getNode(root).asText());
+        logger.info("Loading {} ...", file);
+        InferenceNetwork network = InferenceNetwork.read(file);
+        logger.info("Network {} parameters, outputs {}", network.getNumParameters(), Arrays.toString(network.getNumOutputs()));
+        Random random = Nd4j.getRandomFactory().getNewRandomInstance();
+        return create(encoder, actors, network, random);
+    }
+
+    private final SignalEncoder encoder;
+    private final List<Actor> actors;
+    private final InferenceNetwork network;
+    private final Random random;
+
+    /**
+     * Creates the engine
+     *
+     * @param encoder the signal encoder
+     * @param actors  the actors
+     * @param network the inference network
+     * @param random  the random generator
+     */
+    protected RLInferenceEngine(SignalEncoder encoder, List<Actor> actors, InferenceNetwork network, Random random) {
+        this.encoder = requireNonNull(encoder);
+        this.actors = requireNonNull(actors);
+        this.network = requireNonNull(network);
+        this.random = requireNonNull(random);
+    }
+
+    @Override
+    public RLInferenceEngine init(InferenceMonitor monitor) {
+        return this;
+    }
+
+    @Override
+    public Tuple2<MotionCommand, Integer> process(Timed<MapStatus> status, InferenceMonitor monitor) {
+        INDArray[] outputs = network.output(encoder.encode(status));
+        INDArray action = hstack(actors.stream()
+                .map(a -> a.chooseAction(outputs, random))
+                .toArray(INDArray[]::new));
+        return RLEngine.decodeAction(status, action);
+    }
+}
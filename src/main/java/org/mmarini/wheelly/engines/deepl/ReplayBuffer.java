@@ -0,0 +1,160 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.api.rng.Random;
+import org.nd4j.linalg.factory.Nd4j;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import static java.lang.Math.min;
+
+/**
+ * The experience replay memory of the feedbacks.
+ * <p>
+ * The feedbacks are stored in a ring buffer of preallocated off-heap arrays (one row per feedback),
+ * the arrays are allocated by the first feedback with its signal and action sizes.
+ * When the buffer is full the oldest feedbacks are overwritten.
+ * The buffer is thread safe, the feedbacks may be stored by the inference thread and sampled by the training thread.
+ * </p>
+ */
+public class ReplayBuffer {
+    /**
+     * Returns the replay buffer
+     *
+     * @param capacity the number of feedbacks
+     */
+    public static ReplayBuffer create(int capacity) {
+        if (capacity <= 0) {
+            throw new IllegalArgumentException(String.format("Capacity must be positive (%d)", capacity));
+        }
+        return new ReplayBuffer(capacity);
+    }
+
+    private final int capacity;
+    private final double[] rewards;
+    private final double[] intervals;
+    private INDArray s0;
+    private INDArray s1;
+    private INDArray actions;
+    private int next;
+    private int size;
+
+    /**
+     * Creates the replay buffer
+     *
+     * @param capacity the number of feedbacks
+     */
+    protected ReplayBuffer(int capacity) {
+        this.capacity = capacity;
+        this.rewards = new double[capacity];
+        this.intervals = new double[capacity];
+    }
+
+    /**
+     * Stores a feedback overwriting the oldest one if the buffer is full
+     *
+     * @param feedback the feedback
+     */
+    public synchronized ReplayBuffer add(Feedback feedback) {
+        if (s0 == null) {
+            long numSignals = feedback.getS0().length();
+            s0 = Nd4j.zeros(capacity, numSignals);
+            s1 = Nd4j.zeros(capacity, numSignals);
+            actions = Nd4j.zeros(capacity, feedback.getAction().length());
+        }
+        s0.getRow(next).assign(feedback.getS0().reshape(s0.columns()));
+        s1.getRow(next).assign(feedback.getS1().reshape(s1.columns()));
+        actions.getRow(next).assign(feedback.getAction().reshape(actions.columns()));
+        rewards[next] = feedback.getReward();
+        intervals[next] = feedback.getInterval();
+        next = (next + 1) % capacity;
+        size = min(size + 1, capacity);
+        return this;
+    }
+
+    /**
+     * Returns the feedback at an index (0 is the oldest stored feedback)
+     *
+     * @param index the index
+     */
+    public synchronized Feedback get(int index) {
+        if (index < 0 || index >= size) {
+            throw new IndexOutOfBoundsException(String.format("Index %d out of range (0, %d)", index, size - 1));
+        }
+        return feedback((next - size + index + capacity) % capacity);
+    }
+
+    /**
+     * Returns the feedback at a row of the arrays (the arrays are copied)
+     *
+     * @param row the row
+     */
+    private Feedback feedback(int row) {
+        return Feedback.create(
+                s0.getRow(row, true).dup(),
+                actions.getRow(row, true).dup(),
+                rewards[row],
+                s1.getRow(row, true).dup(),
+                intervals[row]);
+    }
+
+    /**
+     * Returns the capacity of the buffer
+     */
+    public int getCapacity() {
+        return capacity;
+    }
+
+    /**
+     * Returns a random sample of the stored feedbacks drawn with replacement
+     *
+     * @param n      the number of feedbacks
+     * @param random the random generator
+     */
+    public synchronized List<Feedback> sample(int n, Random random) {
+        List<Feedback> result = new ArrayList<>(n);
+        if (size > 0) {
+            for (int i = 0; i < n; i++) {
+                result.add(feedback(random.nextInt(size)));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of stored feedbacks
+     */
+    public synchronized int size() {
+        return size;
+    }
+}
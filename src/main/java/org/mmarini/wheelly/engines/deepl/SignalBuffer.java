@@ -0,0 +1,136 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.factory.Nd4j;
+
+import static java.lang.String.format;
+
+/**
+ * The reusable buffer of binary signals.
+ * <p>
+ * The buffer holds the signals of a batch of rows as a dense float array on the java heap.
+ * The rows are set from the indices of the active signals clearing only the previously active signals,
+ * and the batch is copied to an {@link INDArray} in a single bulk operation.
+ * The buffer is not thread safe.
+ * </p>
+ */
+public class SignalBuffer {
+    /**
+     * Returns the signal buffer
+     *
+     * @param numRows    the number of rows
+     * @param numSignals the number of signals per row
+     */
+    public static SignalBuffer create(int numRows, int numSignals) {
+        return new SignalBuffer(numRows, numSignals);
+    }
+
+    private final int numRows;
+    private final int numSignals;
+    private final float[] data;
+    private final int[][] active;
+
+    /**
+     * Creates the signal buffer
+     *
+     * @param numRows    the number of rows
+     * @param numSignals the number of signals per row
+     */
+    protected SignalBuffer(int numRows, int numSignals) {
+        this.numRows = numRows;
+        this.numSignals = numSignals;
+        this.data = new float[numRows * numSignals];
+        this.active = new int[numRows][];
+    }
+
+    /**
+     * Returns the number of rows
+     */
+    public int getNumRows() {
+        return numRows;
+    }
+
+    /**
+     * Returns the number of signals per row
+     */
+    public int getNumSignals() {
+        return numSignals;
+    }
+
+    /**
+     * Sets the active signals of a row
+     *
+     * @param row     the row
+     * @param indices the indices of active signals
+     * @throws IllegalArgumentException if any index is out of range
+     */
+    public SignalBuffer set(int row, int[] indices) {
+        for (int idx : indices) {
+            if (idx < 0 || idx >= numSignals) {
+                throw new IllegalArgumentException(format("Signal index %d out of range 0 - %d", idx, numSignals - 1));
+            }
+        }
+        int offset = row * numSignals;
+        int[] previous = active[row];
+        if (previous != null) {
+            for (int idx : previous) {
+                data[offset + idx] = 0;
+            }
+        }
+        for (int idx : indices) {
+            data[offset + idx] = 1;
+        }
+        active[row] = indices;
+        return this;
+    }
+
+    /**
+     * Returns the signals of the first rows (numRows x numSignals)
+     *
+     * @param rows the number of rows
+     */
+    public INDArray toINDArray(int rows) {
+        if (rows == numRows) {
+            return Nd4j.create(data, new int[]{numRows, numSignals});
+        }
+        float[] result = new float[rows * numSignals];
+        System.arraycopy(data, 0, result, 0, result.length);
+        return Nd4j.create(result, new int[]{rows, numSignals});
+    }
+
+    /**
+     * Returns the signals (numRows x numSignals)
+     */
+    public INDArray toINDArray() {
+        return toINDArray(numRows);
+    }
+}
@@ -35,9 +35,40 @@ import org.nd4j.linalg.api.ndarray.INDArray;
 
 /**
  * Encodes the status of robot in neural network signals
+ * <p>
+ * The signals are binary, the encoders produce the indices of the active signals and the dense signals are
+ * built in bulk by {@link SignalBuffer}.
+ * </p>
  */
 public interface SignalEncoder {
-    INDArray encode(Timed<MapStatus> status);
+    /**
+     * Returns the dense signals (1 x numSignals)
+     *
+     * @param status the status
+     */
+    default INDArray encode(Timed<MapStatus> status) {
+        return SignalBuffer.create(1, getNumSignals())
+                .set(0, encodeIndices(status))
+                .toINDArray();
+    }
+
+    /**
+     * Encodes the status in a row of a reusable buffer
+     *
+     * @param status the status
+     * @param buffer the buffer
+     * @param row    the row
+     */
+    default SignalBuffer encode(Timed<MapStatus> status, SignalBuffer buffer, int row) {
+        return buffer.set(row, encodeIndices(status));
+    }
+
+    /**
+     * Returns the indices of the active signals (may contain duplicated indices)
+     *
+     * @param status the status
+     */
+    int[] encodeIndices(Timed<MapStatus> status);
 
     int getNumSignals();
 }
@@ -32,8 +32,6 @@ package org.mmarini.wheelly.engines.deepl;
 import io.reactivex.rxjava3.schedulers.Timed;
 import org.mmarini.wheelly.model.MapStatus;
 import org.mmarini.wheelly.model.WheellyStatus;
-import org.nd4j.linalg.api.ndarray.INDArray;
-import org.nd4j.linalg.factory.Nd4j;
 
 import static java.lang.Math.*;
 
@@ -119,8 +117,7 @@ public class SimpleFeaturesSignalEncoder implements SignalEncoder {
     }
 
     @Override
-    public INDArray encode(Timed<MapStatus> status) {
-        INDArray result = Nd4j.zeros(1, NUM_SIGNALS);
+    public int[] encodeIndices(Timed<MapStatus> status) {
         WheellyStatus wheelly = status.value().getWheelly();
 
         int direction = encodeDirection(wheelly.getRobotDeg());
@@ -132,16 +129,22 @@ public class SimpleFeaturesSignalEncoder implements SignalEncoder {
         boolean imuFailure = wheelly.isImuFailure();
         int speeds = encodeSpeeds(wheelly.getLeftSpeed(), wheelly.getRightSpeed());
 
-        result.putScalar(0, direction + DIRECTION_OFFSET, 1d);
-        result.putScalar(0, sensor + SENSOR_OFFSET, 1d);
-        result.putScalar(0, distance + DISTANCE_OFFSET, 1d);
-        result.putScalar(0, speeds + SPEED_OFFSET, 1d);
-        result.putScalar(0, contacts + CONTACTS_OFFSET, 1d);
-        result.putScalar(0, block + BLOCK_OFFSET, 1d);
-        if (imuFailure) {
-            result.putScalar(0, IMU_FAILURE_OFFSET, 1d);
-        }
-        return result;
+        return imuFailure
+                ? new int[]{
+                direction + DIRECTION_OFFSET,
+                sensor + SENSOR_OFFSET,
+                distance + DISTANCE_OFFSET,
+                speeds + SPEED_OFFSET,
+                contacts + CONTACTS_OFFSET,
+                block + BLOCK_OFFSET,
+                IMU_FAILURE_OFFSET}
+                : new int[]{
+                direction + DIRECTION_OFFSET,
+                sensor + SENSOR_OFFSET,
+                distance + DISTANCE_OFFSET,
+                speeds + SPEED_OFFSET,
+                contacts + CONTACTS_OFFSET,
+                block + BLOCK_OFFSET};
     }
 
     @Override
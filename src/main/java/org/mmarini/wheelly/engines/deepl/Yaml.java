@@ -71,14 +71,18 @@ public interface Yaml {
     }
 
     static Validator agentConf() {
-        return objectPropertiesRequired(Map.of(
-                        "rewardDecay", nonNegativeNumber(),
-                        "valueDecay", nonNegativeNumber(),
-                        "rewardRange", rangeDef(),
-                        "averageReward", number(),
-                        "actors", actors(),
-                        "saveFile", string(minLength(1)),
-                        "saveInterval", positiveInteger()
+        return objectPropertiesRequired(Map.ofEntries(
+                        Map.entry("rewardDecay", nonNegativeNumber()),
+                        Map.entry("valueDecay", nonNegativeNumber()),
+                        Map.entry("rewardRange", rangeDef()),
+                        Map.entry("averageReward", number()),
+                        Map.entry("actors", actors()),
+                        Map.entry("saveFile", string(minLength(1))),
+                        Map.entry("saveInterval", positiveInteger()),
+                        Map.entry("replaySize", nonNegativeInteger()),
+                        Map.entry("batchSize", positiveInteger()),
+                        Map.entry("asyncTraining", booleanValue()),
+                        Map.entry("publishInterval", positiveInteger())
                 ),
                 List.of("rewardDecay", "valueDecay", "rewardRange", "actors")
         );
@@ -109,6 +113,16 @@ public interface Yaml {
         );
     }
 
+    static Validator inferenceEngineConf() {
+        return objectPropertiesRequired(Map.of(
+                        "stateEncoder", stateEncoder(),
+                        "actors", actors(),
+                        "inferenceFile", string(minLength(1))
+                ),
+                List.of("stateEncoder", "actors", "inferenceFile")
+        );
+    }
+
     static Validator network() {
         return object(
                 objectPropertiesRequired(Map.ofEntries(
@@ -130,6 +144,8 @@ public interface Yaml {
                                 Map.entry("maxAbsGradient", positiveNumber()),
                                 Map.entry("maxAbsParameters", positiveNumber()),
                                 Map.entry("file", string()),
+                                Map.entry("inferenceFile", string(minLength(1))),
+                                Map.entry("precision", precision()),
                                 Map.entry("dropOut", positiveNumber())),
                         List.of("version",
                                 "numInputs",
@@ -146,6 +162,10 @@ public interface Yaml {
         );
     }
 
+    static Validator precision() {
+        return string(values("float32", "float16", "int8"));
+    }
+
     static Validator postShortcuts(int noHiddens) {
         return arrayItems(
                 arrayPrefixItems(List.of(
@@ -0,0 +1,474 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.statemachine;
+
+import org.mmarini.wheelly.model.ProhibitedArea;
+
+import java.awt.*;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import static java.lang.Math.*;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The incremental path planner (D* Lite) on the cell grid.
+ * <p>
+ * The planner searches backward from the goal and keeps the search tree between replanning,
+ * so that when the robot moves or the prohibited area changes only the nodes affected by the changed cells are
+ * repaired.
+ * The search area is fixed at creation: the cells whose distances from the initial start and the goal are not
+ * greater than the extended distance between them.
+ * The moving cost between adjacent cells is the square distance (as in {@link AStar}) and the estimation is the
+ * Manhattan distance that is consistent with such costs.
+ * </p>
+ */
+public class DStarLite {
+    private static final int[] NEIGHBOUR_DI = {-1, -1, -1, 0, 0, 1, 1, 1};
+    private static final int[] NEIGHBOUR_DJ = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+    /**
+     * Returns the planner
+     *
+     * @param start             the start cell
+     * @param goal              the goal cell
+     * @param area              the prohibited area
+     * @param extensionDistance the extension distance (cell units)
+     */
+    public static DStarLite create(Point start, Point goal, ProhibitedArea area, double extensionDistance) {
+        return new DStarLite(start, goal, area, extensionDistance);
+    }
+
+    private final Point origin;
+    private final Point goal;
+    private final double extensionDistance;
+    private final double maxDistanceSqr;
+    private final int minI;
+    private final int maxI;
+    private final int minJ;
+    private final int maxJ;
+    private final int height;
+    private final int goalId;
+    private final double[] g;
+    private final double[] rhs;
+    private final double[] key1;
+    private final double[] key2;
+    private final int[] heapPos;
+    private final int[] heap;
+    private int heapSize;
+    private ProhibitedArea area;
+    private Point start;
+    private double km;
+
+    /**
+     * Creates the planner
+     *
+     * @param start             the start cell
+     * @param goal              the goal cell
+     * @param area              the prohibited area
+     * @param extensionDistance the extension distance (cell units)
+     */
+    protected DStarLite(Point start, Point goal, ProhibitedArea area, double extensionDistance) {
+        this.origin = new Point(requireNonNull(start));
+        this.start = origin;
+        this.goal = new Point(requireNonNull(goal));
+        this.area = requireNonNull(area);
+        this.extensionDistance = extensionDistance;
+        this.maxDistanceSqr = start.distanceSq(goal) + extensionDistance * extensionDistance;
+        int r = (int) floor(sqrt(maxDistanceSqr));
+        this.minI = max(start.x, goal.x) - r;
+        this.maxI = min(start.x, goal.x) + r;
+        this.minJ = max(start.y, goal.y) - r;
+        this.maxJ = min(start.y, goal.y) + r;
+        this.height = maxJ - minJ + 1;
+        int n = (maxI - minI + 1) * height;
+        this.g = new double[n];
+        this.rhs = new double[n];
+        this.key1 = new double[n];
+        this.key2 = new double[n];
+        this.heapPos = new int[n];
+        this.heap = new int[n];
+        Arrays.fill(g, Double.POSITIVE_INFINITY);
+        Arrays.fill(rhs, Double.POSITIVE_INFINITY);
+        Arrays.fill(heapPos, -1);
+        this.goalId = id(goal.x, goal.y);
+        rhs[goalId] = 0;
+        insert(goalId);
+    }
+
+    /**
+     * Computes the key of a cell
+     *
+     * @param id the cell id
+     */
+    private void computeKey(int id) {
+        double k2 = min(g[id], rhs[id]);
+        key2[id] = k2;
+        key1[id] = k2 + estimate(start.x, start.y, id) + km;
+    }
+
+    /**
+     * Computes the shortest path from the current start
+     */
+    private void computeShortestPath() {
+        int startId = id(start.x, start.y);
+        for (; ; ) {
+            double startKey2 = min(g[startId], rhs[startId]);
+            double startKey1 = startKey2 + km;
+            boolean startInconsistent = rhs[startId] > g[startId];
+            if (heapSize == 0) {
+                return;
+            }
+            int u = heap[0];
+            if (!startInconsistent && !less(key1[u], key2[u], startKey1, startKey2)) {
+                return;
+            }
+            double oldKey1 = key1[u];
+            double oldKey2 = key2[u];
+            computeKey(u);
+            if (less(oldKey1, oldKey2, key1[u], key2[u])) {
+                // Key increased
+                siftDown(heapPos[u]);
+            } else if (g[u] > rhs[u]) {
+                // Over consistent
+                g[u] = rhs[u];
+                remove(u);
+                updatePredecessors(u);
+            } else {
+                // Under consistent
+                g[u] = Double.POSITIVE_INFINITY;
+                updateVertex(u);
+                updatePredecessors(u);
+            }
+        }
+    }
+
+    /**
+     * Returns the moving cost from a cell to an adjacent cell
+     *
+     * @param di the x offset
+     * @param dj the y offset
+     * @param i  the x index of the destination cell
+     * @param j  the y index of the destination cell
+     */
+    private double cost(int di, int dj, int i, int j) {
+        return isAvailable(i, j) ? di * di + dj * dj : Double.POSITIVE_INFINITY;
+    }
+
+    /**
+     * Returns the estimation of cost between a cell and a cell id
+     *
+     * @param i  the cell x index
+     * @param j  the cell y index
+     * @param id the cell id
+     */
+    private double estimate(int i, int j, int id) {
+        return abs(minI + id / height - i) + abs(minJ + id % height - j);
+    }
+
+    /**
+     * Returns the path from the start cell to the goal or empty list if no path exists
+     *
+     * @param start the start cell
+     * @param area  the prohibited area
+     */
+    public List<Point> findPath(Point start, ProhibitedArea area) {
+        requireNonNull(start);
+        requireNonNull(area);
+        if (!isReusable(start, goal, extensionDistance)) {
+            throw new IllegalArgumentException(String.format("Start %s out of search area", start));
+        }
+        if (area.isProhibited(goal.x, goal.y)) {
+            return List.of();
+        }
+        km += abs(this.start.x - start.x) + abs(this.start.y - start.y);
+        this.start = new Point(start);
+        if (area != this.area) {
+            List<Point> changed = area.changedCells(this.area);
+            this.area = area;
+            for (Point cell : changed) {
+                // The costs of the edges to the changed cell are changed
+                if (isInArea(cell.x, cell.y)) {
+                    updatePredecessors(id(cell.x, cell.y));
+                }
+            }
+        }
+        computeShortestPath();
+        return path();
+    }
+
+    /**
+     * Returns the id of a cell
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    private int id(int i, int j) {
+        return (i - minI) * height + j - minJ;
+    }
+
+    /**
+     * Inserts a cell in the queue
+     *
+     * @param id the cell id
+     */
+    private void insert(int id) {
+        computeKey(id);
+        int idx = heapSize++;
+        heap[idx] = id;
+        heapPos[id] = idx;
+        siftUp(idx);
+    }
+
+    /**
+     * Returns true if the cell is in the search area and is not prohibited
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    private boolean isAvailable(int i, int j) {
+        return isInArea(i, j) && !area.isProhibited(i, j);
+    }
+
+    /**
+     * Returns true if the cell is in the search area
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    private boolean isInArea(int i, int j) {
+        if (i < minI || i > maxI || j < minJ || j > maxJ) {
+            return false;
+        }
+        long dsi = i - origin.x;
+        long dsj = j - origin.y;
+        long dgi = i - goal.x;
+        long dgj = j - goal.y;
+        return dsi * dsi + dsj * dsj <= maxDistanceSqr
+                && dgi * dgi + dgj * dgj <= maxDistanceSqr;
+    }
+
+    /**
+     * Returns true if the planner can be used to replan for a start and a goal
+     *
+     * @param start             the start cell
+     * @param goal              the goal cell
+     * @param extensionDistance the extension distance (cell units)
+     */
+    public boolean isReusable(Point start, Point goal, double extensionDistance) {
+        return this.goal.equals(goal)
+                && this.extensionDistance == extensionDistance
+                && isInArea(start.x, start.y);
+    }
+
+    /**
+     * Returns true if the key (a1, a2) is lower than key (b1, b2)
+     */
+    private boolean less(double a1, double a2, double b1, double b2) {
+        return a1 < b1 || (a1 == b1 && a2 < b2);
+    }
+
+    /**
+     * Returns true if the key of heap entry a is lower than the key of heap entry b
+     *
+     * @param a the heap index a
+     * @param b the heap index b
+     */
+    private boolean lessAt(int a, int b) {
+        int u = heap[a];
+        int v = heap[b];
+        return less(key1[u], key2[u], key1[v], key2[v]);
+    }
+
+    /**
+     * Returns the path following the lowest cost from the start
+     */
+    private List<Point> path() {
+        int current = id(start.x, start.y);
+        if (g[current] == Double.POSITIVE_INFINITY) {
+            return List.of();
+        }
+        List<Point> result = new ArrayList<>();
+        result.add(new Point(start));
+        int ci = start.x;
+        int cj = start.y;
+        int maxSteps = g.length;
+        while (current != goalId) {
+            if (result.size() > maxSteps) {
+                return List.of();
+            }
+            double best = Double.POSITIVE_INFINITY;
+            int bestK = -1;
+            for (int k = 0; k < NEIGHBOUR_DI.length; k++) {
+                int ni = ci + NEIGHBOUR_DI[k];
+                int nj = cj + NEIGHBOUR_DJ[k];
+                double c = cost(NEIGHBOUR_DI[k], NEIGHBOUR_DJ[k], ni, nj);
+                if (c < Double.POSITIVE_INFINITY) {
+                    double value = c + g[id(ni, nj)];
+                    if (value < best) {
+                        best = value;
+                        bestK = k;
+                    }
+                }
+            }
+            if (bestK < 0) {
+                return List.of();
+            }
+            ci += NEIGHBOUR_DI[bestK];
+            cj += NEIGHBOUR_DJ[bestK];
+            current = id(ci, cj);
+            result.add(new Point(ci, cj));
+        }
+        return result;
+    }
+
+    /**
+     * Removes a cell from the queue
+     *
+     * @param id the cell id
+     */
+    private void remove(int id) {
+        int idx = heapPos[id];
+        heapPos[id] = -1;
+        heapSize--;
+        if (idx < heapSize) {
+            int last = heap[heapSize];
+            heap[idx] = last;
+            heapPos[last] = idx;
+            siftUp(idx);
+            siftDown(heapPos[last]);
+        }
+    }
+
+    /**
+     * Moves down a heap entry
+     *
+     * @param idx the heap index
+     */
+    private void siftDown(int idx) {
+        for (; ; ) {
+            int child = 2 * idx + 1;
+            if (child >= heapSize) {
+                return;
+            }
+            if (child + 1 < heapSize && lessAt(child + 1, child)) {
+                child++;
+            }
+            if (!lessAt(child, idx)) {
+                return;
+            }
+            swap(idx, child);
+            idx = child;
+        }
+    }
+
+    /**
+     * Moves up a heap entry
+     *
+     * @param idx the heap index
+     */
+    private void siftUp(int idx) {
+        while (idx > 0) {
+            int parent = (idx - 1) / 2;
+            if (!lessAt(idx, parent)) {
+                return;
+            }
+            swap(idx, parent);
+            idx = parent;
+        }
+    }
+
+    /**
+     * Swaps two heap entries
+     *
+     * @param a the heap index a
+     * @param b the heap index b
+     */
+    private void swap(int a, int b) {
+        int u = heap[a];
+        int v = heap[b];
+        heap[a] = v;
+        heap[b] = u;
+        heapPos[v] = a;
+        heapPos[u] = b;
+    }
+
+    /**
+     * Updates the predecessors of a cell (the adjacent cells in the search area)
+     *
+     * @param id the cell id
+     */
+    private void updatePredecessors(int id) {
+        int ci = minI + id / height;
+        int cj = minJ + id % height;
+        for (int k = 0; k < NEIGHBOUR_DI.length; k++) {
+            int ni = ci + NEIGHBOUR_DI[k];
+            int nj = cj + NEIGHBOUR_DJ[k];
+            if (isInArea(ni, nj)) {
+                updateVertex(id(ni, nj));
+            }
+        }
+    }
+
+    /**
+     * Updates the lookahead cost of a cell and its position in the queue
+     *
+     * @param id the cell id
+     */
+    private void updateVertex(int id) {
+        if (id != goalId) {
+            int ci = minI + id / height;
+            int cj = minJ + id % height;
+            double value = Double.POSITIVE_INFINITY;
+            for (int k = 0; k < NEIGHBOUR_DI.length; k++) {
+                int ni = ci + NEIGHBOUR_DI[k];
+                int nj = cj + NEIGHBOUR_DJ[k];
+                double c = cost(NEIGHBOUR_DI[k], NEIGHBOUR_DJ[k], ni, nj);
+                if (c < Double.POSITIVE_INFINITY) {
+                    value = min(value, c + g[id(ni, nj)]);
+                }
+            }
+            rhs[id] = value;
+        }
+        boolean inQueue = heapPos[id] >= 0;
+        if (g[id] != rhs[id]) {
+            if (inQueue) {
+                computeKey(id);
+                siftUp(heapPos[id]);
+                siftDown(heapPos[id]);
+            } else {
+                insert(id);
+            }
+        } else if (inQueue) {
+            remove(id);
+        }
+    }
+}
@@ -38,10 +38,10 @@ import java.awt.*;
 import java.awt.geom.Point2D;
 import java.util.ArrayList;
 import java.util.List;
-import java.util.Set;
 import java.util.stream.Collectors;
 
 import static java.lang.Math.ceil;
+import static java.lang.String.format;
 import static org.mmarini.wheelly.engines.statemachine.StateTransition.COMPLETED_TRANSITION;
 import static org.mmarini.wheelly.model.RobotController.STOP_DISTANCE;
 
@@ -55,10 +55,17 @@ public class FindPathStatus extends AbstractEngineStatus {
     public static final String SAFE_DISTANCE_KEY = "safeDistance";
     public static final String LIKELIHOOD_THRESHOLD_KEY = "likelihoodThreshold";
     public static final String EXTENSION_DISTANCE_KEY = "extensionDistance";
+    public static final String INCREMENTAL_KEY = "incremental";
+    public static final String SMOOTHING_KEY = "smoothing";
+
+    public static final String BISECTION_SMOOTHING = "bisection";
+    public static final String TRAVERSAL_SMOOTHING = "traversal";
+    public static final String STRING_PULLING_SMOOTHING = "stringPulling";
 
     public static final double DEFAULT_SAFE_DISTANCE = 1.5 * STOP_DISTANCE;
     public static final double DEFAULT_LIKELIHOOD_THRESHOLD = 0;
     public static final double DEFAULT_EXTENSION_DISTANCE = 3;
+    public static final String DEFAULT_SMOOTHING = BISECTION_SMOOTHING;
 
     private static final Logger logger = LoggerFactory.getLogger(FindPathStatus.class);
 
@@ -66,13 +73,18 @@ public class FindPathStatus extends AbstractEngineStatus {
         return new FindPathStatus(name);
     }
 
+    private final GridAStar aStar;
     private Point2D target;
     private double extensionDistance;
     private double safeDistance;
     private double likelihoodThreshold;
+    private boolean incremental;
+    private String smoothing;
+    private DStarLite planner;
 
     protected FindPathStatus(String name) {
         super(name);
+        this.aStar = new GridAStar();
     }
 
     @Override
@@ -81,6 +93,8 @@ public class FindPathStatus extends AbstractEngineStatus {
         this.extensionDistance = getDouble(context, EXTENSION_DISTANCE_KEY, DEFAULT_EXTENSION_DISTANCE);
         this.safeDistance = getDouble(context, SAFE_DISTANCE_KEY, DEFAULT_SAFE_DISTANCE);
         this.likelihoodThreshold = getDouble(context, LIKELIHOOD_THRESHOLD_KEY, DEFAULT_LIKELIHOOD_THRESHOLD);
+        this.incremental = this.<Boolean>get(context, INCREMENTAL_KEY).orElse(false);
+        this.smoothing = this.<String>get(context, SMOOTHING_KEY).orElse(DEFAULT_SMOOTHING);
         this.target = context.getTarget().orElse(null);
         context.remove(PATH_KEY);
         if (target != null) {
@@ -101,8 +115,17 @@ public class FindPathStatus extends AbstractEngineStatus {
         }
         Point start = map.cell(wheelly.getRobotLocation());
         Point goal = map.cell(target);
-        Set<Point> prohibited = map.setSafeDistance(safeDistance).setLikelihoodThreshold(likelihoodThreshold).getProhibited();
-        List<Point> gridPath = AStar.findPath(start, goal, prohibited, ceil(extensionDistance / map.gridSize));
+        ProhibitedArea area = map.setSafeDistance(safeDistance).setLikelihoodThreshold(likelihoodThreshold).getProhibitedArea();
+        double cellExtension = ceil(extensionDistance / map.gridSize);
+        List<Point> gridPath;
+        if (incremental) {
+            if (planner == null || !planner.isReusable(start, goal, cellExtension)) {
+                planner = DStarLite.create(start, goal, area, cellExtension);
+            }
+            gridPath = planner.findPath(start, area);
+        } else {
+            gridPath = aStar.findPath(start, goal, area::isProhibited, cellExtension);
+        }
         if (gridPath.isEmpty()) {
             logger.warn("Path not found");
             return NO_PATH_TRANSITION;
@@ -117,10 +140,31 @@ public class FindPathStatus extends AbstractEngineStatus {
                 .map(map::toPoint)
                 .collect(Collectors.toList());
         path.set(path.size() - 1, target);
-        path = new ArrayList<>(ProhibitedCellFinder.optimizePath(path, map.gridSize, prohibited::contains));
+        path = new ArrayList<>(smooth(path, map.gridSize, area));
         context.put(PATH_KEY, path);
         logger.debug("Path: {}", path);
         monitor.put(PATH_KEY, path);
         return COMPLETED_TRANSITION;
     }
+
+    /**
+     * Returns the path smoothed by the configured algorithm
+     *
+     * @param path     the path
+     * @param gridSize the grid size
+     * @param area     the prohibited area
+     * @throws IllegalArgumentException if the smoothing algorithm is unknown
+     */
+    private List<Point2D> smooth(List<Point2D> path, double gridSize, ProhibitedArea area) {
+        switch (smoothing) {
+            case STRING_PULLING_SMOOTHING:
+                return ProhibitedCellFinder.pullString(path, gridSize, area::isProhibited);
+            case TRAVERSAL_SMOOTHING:
+                return ProhibitedCellFinder.optimizeClearPath(path, gridSize, area::isProhibited);
+            case BISECTION_SMOOTHING:
+                return ProhibitedCellFinder.optimizePath(path, gridSize, area::isProhibited);
+            default:
+                throw new IllegalArgumentException(format("Unknown smoothing %s", smoothing));
+        }
+    }
 }
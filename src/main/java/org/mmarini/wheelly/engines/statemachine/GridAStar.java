@@ -0,0 +1,253 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.statemachine;
+
+import org.mmarini.wheelly.model.CellPredicate;
+
+import java.awt.*;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+
+import static java.lang.Math.*;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The A* algorithm specialised for the cell grid.
+ * <p>
+ * The cells of the search area are identified by packed int ids and the scores are held in flat arrays of
+ * a reusable workspace, the open set is a binary heap with lazy removal of the stale entries.
+ * The costs and the estimations are the same of {@link AStar#findPath(Point, Point, java.util.Set, double)}
+ * (the square distance between cells).
+ * The workspace is not thread safe, each search thread should use its own instance.
+ * </p>
+ */
+public class GridAStar {
+    private static final int MIN_CAPACITY = 256;
+    private static final int[] NEIGHBOUR_DI = {-1, -1, -1, 0, 0, 1, 1, 1};
+    private static final int[] NEIGHBOUR_DJ = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+    private int[] stamps;
+    private double[] gScore;
+    private double[] fScore;
+    private int[] cameFrom;
+    private double[] heapKeys;
+    private int[] heapIds;
+    private int heapSize;
+    private int stamp;
+
+    /**
+     * Creates the workspace
+     */
+    public GridAStar() {
+        this.stamps = new int[MIN_CAPACITY];
+        this.gScore = new double[MIN_CAPACITY];
+        this.fScore = new double[MIN_CAPACITY];
+        this.cameFrom = new int[MIN_CAPACITY];
+        this.heapKeys = new double[MIN_CAPACITY];
+        this.heapIds = new int[MIN_CAPACITY];
+    }
+
+    /**
+     * Ensures the capacity of the cell arrays and invalidates the previous scores
+     *
+     * @param n the number of cells
+     */
+    private void clear(int n) {
+        if (stamps.length < n) {
+            int capacity = max(n, stamps.length * 2);
+            stamps = new int[capacity];
+            gScore = new double[capacity];
+            fScore = new double[capacity];
+            cameFrom = new int[capacity];
+            stamp = 0;
+        }
+        if (stamp == Integer.MAX_VALUE) {
+            Arrays.fill(stamps, 0);
+            stamp = 0;
+        }
+        stamp++;
+        heapSize = 0;
+    }
+
+    /**
+     * Returns the path from the start cell to the goal cell or empty list if no path exists.
+     * The path is searched within the cells whose distances from start and goal are not greater than
+     * the extended distance between start and goal.
+     *
+     * @param start             the start cell
+     * @param goal              the goal cell
+     * @param prohibited        the prohibited cells
+     * @param extensionDistance the extension distance (cell units)
+     */
+    public List<Point> findPath(Point start, Point goal, CellPredicate prohibited, double extensionDistance) {
+        requireNonNull(start);
+        requireNonNull(goal);
+        requireNonNull(prohibited);
+        if (prohibited.test(goal.x, goal.y)) {
+            return List.of();
+        }
+        double maxDistanceSqr = start.distanceSq(goal) + extensionDistance * extensionDistance;
+        int r = (int) floor(sqrt(maxDistanceSqr));
+        int minI = max(start.x, goal.x) - r;
+        int maxI = min(start.x, goal.x) + r;
+        int minJ = max(start.y, goal.y) - r;
+        int maxJ = min(start.y, goal.y) + r;
+        int height = maxJ - minJ + 1;
+        int n = (maxI - minI + 1) * height;
+        clear(n);
+
+        int startId = (start.x - minI) * height + start.y - minJ;
+        int goalId = (goal.x - minI) * height + goal.y - minJ;
+        stamps[startId] = stamp;
+        gScore[startId] = 0;
+        fScore[startId] = start.distanceSq(goal);
+        cameFrom[startId] = -1;
+        push(startId, fScore[startId]);
+
+        while (heapSize > 0) {
+            double f = heapKeys[0];
+            int current = pop();
+            if (f > fScore[current]) {
+                // Stale entry
+                continue;
+            }
+            if (current == goalId) {
+                return reconstructPath(current, minI, minJ, height);
+            }
+            int ci = minI + current / height;
+            int cj = minJ + current % height;
+            double g = gScore[current];
+            for (int k = 0; k < NEIGHBOUR_DI.length; k++) {
+                int di = NEIGHBOUR_DI[k];
+                int dj = NEIGHBOUR_DJ[k];
+                int ni = ci + di;
+                int nj = cj + dj;
+                if (ni < minI || ni > maxI || nj < minJ || nj > maxJ) {
+                    continue;
+                }
+                long dsi = ni - start.x;
+                long dsj = nj - start.y;
+                long dgi = ni - goal.x;
+                long dgj = nj - goal.y;
+                if (dsi * dsi + dsj * dsj > maxDistanceSqr
+                        || dgi * dgi + dgj * dgj > maxDistanceSqr
+                        || prohibited.test(ni, nj)) {
+                    continue;
+                }
+                int neighbour = current + di * height + dj;
+                double tentativeGScore = g + di * di + dj * dj;
+                if (stamps[neighbour] != stamp || tentativeGScore < gScore[neighbour]) {
+                    stamps[neighbour] = stamp;
+                    gScore[neighbour] = tentativeGScore;
+                    fScore[neighbour] = tentativeGScore + dgi * dgi + dgj * dgj;
+                    cameFrom[neighbour] = current;
+                    push(neighbour, fScore[neighbour]);
+                }
+            }
+        }
+        // No path found
+        return List.of();
+    }
+
+    /**
+     * Returns the cell id with the minimum key removing it from the heap
+     */
+    private int pop() {
+        int result = heapIds[0];
+        heapSize--;
+        if (heapSize > 0) {
+            double key = heapKeys[heapSize];
+            int id = heapIds[heapSize];
+            int i = 0;
+            for (; ; ) {
+                int child = 2 * i + 1;
+                if (child >= heapSize) {
+                    break;
+                }
+                if (child + 1 < heapSize && heapKeys[child + 1] < heapKeys[child]) {
+                    child++;
+                }
+                if (heapKeys[child] >= key) {
+                    break;
+                }
+                heapKeys[i] = heapKeys[child];
+                heapIds[i] = heapIds[child];
+                i = child;
+            }
+            heapKeys[i] = key;
+            heapIds[i] = id;
+        }
+        return result;
+    }
+
+    /**
+     * Pushes a cell id into the heap
+     *
+     * @param id  the cell id
+     * @param key the key
+     */
+    private void push(int id, double key) {
+        if (heapSize >= heapKeys.length) {
+            heapKeys = Arrays.copyOf(heapKeys, heapKeys.length * 2);
+            heapIds = Arrays.copyOf(heapIds, heapIds.length * 2);
+        }
+        int i = heapSize++;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (heapKeys[parent] <= key) {
+                break;
+            }
+            heapKeys[i] = heapKeys[parent];
+            heapIds[i] = heapIds[parent];
+            i = parent;
+        }
+        heapKeys[i] = key;
+        heapIds[i] = id;
+    }
+
+    /**
+     * Returns the path to a cell
+     *
+     * @param current the cell id
+     * @param minI    the minimum x index of search area
+     * @param minJ    the minimum y index of search area
+     * @param height  the height of search area
+     */
+    private List<Point> reconstructPath(int current, int minI, int minJ, int height) {
+        List<Point> result = new ArrayList<>();
+        for (int id = current; id >= 0; id = cameFrom[id]) {
+            result.add(new Point(minI + id / height, minJ + id % height));
+        }
+        Collections.reverse(result);
+        return result;
+    }
+}
@@ -30,17 +30,16 @@
 package org.mmarini.wheelly.engines.statemachine;
 
 import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.wheelly.model.CellPredicate;
 import org.mmarini.wheelly.model.GridScannerMap;
 import org.mmarini.wheelly.model.InferenceMonitor;
 import org.mmarini.wheelly.model.MapStatus;
-import org.mmarini.wheelly.model.ProhibitedCellFinder;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.awt.*;
 import java.awt.geom.Point2D;
 import java.util.Random;
-import java.util.Set;
 
 import static org.mmarini.wheelly.engines.statemachine.StateTransition.COMPLETED_TRANSITION;
 import static org.mmarini.wheelly.model.RobotController.STOP_DISTANCE;
@@ -88,7 +87,7 @@ public class RandomTargetStatus extends AbstractEngineStatus {
     @Override
     public StateTransition process(Timed<MapStatus> data, StateMachineContext context, InferenceMonitor monitor) {
         GridScannerMap map = data.value().getMap();
-        Set<Point> prohibited = ProhibitedCellFinder.create(map, safeDistance, likelihoodThreshold).find();
+        CellPredicate prohibited = map.setSafeDistance(safeDistance).setLikelihoodThreshold(likelihoodThreshold).getProhibitedCells();
         Point2D robotLocation = data.value().getWheelly().getRobotLocation();
 
         for (int i = 0; i < NUM_TRY; i++) {
@@ -96,7 +95,7 @@ public class RandomTargetStatus extends AbstractEngineStatus {
                     center.getX() + (random.nextDouble() - 0.5) * maxDistance * 2,
                     center.getY() + (random.nextDouble() - 0.5) * maxDistance * 2);
             Point cell = map.cell(target);
-            if (target.distance(robotLocation) > safeDistance && !prohibited.contains(cell)) {
+            if (target.distance(robotLocation) > safeDistance && !prohibited.test(cell.x, cell.y)) {
                 logger.debug("Target {}", target);
                 context.setTarget(target);
                 return COMPLETED_TRANSITION;
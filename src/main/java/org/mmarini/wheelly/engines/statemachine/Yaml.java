@@ -24,7 +24,12 @@ public interface Yaml {
         return Validator.objectPropertiesRequired(Map.of(
                         "targets", points(),
                         "safeDistance", Validator.positiveNumber(),
-                        "targetdDistance", Validator.positiveNumber()
+                        "targetdDistance", Validator.positiveNumber(),
+                        "incremental", Validator.booleanValue(),
+                        "smoothing", Validator.string(Validator.values(
+                                FindPathStatus.BISECTION_SMOOTHING,
+                                FindPathStatus.TRAVERSAL_SMOOTHING,
+                                FindPathStatus.STRING_PULLING_SMOOTHING))
                 ), List.of("targets")
         );
     }
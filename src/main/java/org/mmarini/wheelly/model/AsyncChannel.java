@@ -58,10 +58,20 @@ public interface AsyncChannel {
      */
     Completable println(Flowable<String> dataFlow);
 
+    /**
+     * Returns the received clock per second records
+     */
+    Flowable<Timed<Integer>> readCps();
+
     /**
      * Returns thee received data text lines
      */
     Flowable<Timed<String>> readLines();
 
     Flowable<Timed<String>> readLog();
+
+    /**
+     * Returns the received status records
+     */
+    Flowable<Timed<WheellyStatus>> readStatus();
 }
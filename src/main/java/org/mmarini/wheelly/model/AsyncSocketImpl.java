@@ -46,24 +46,38 @@ import java.nio.ByteBuffer;
 import java.nio.channels.SocketChannel;
 import java.nio.charset.StandardCharsets;
 import java.time.Instant;
-import java.util.Arrays;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.TimeoutException;
-import java.util.stream.Stream;
 
 import static java.lang.String.format;
 import static java.net.StandardSocketOptions.SO_KEEPALIVE;
 import static java.util.Objects.requireNonNull;
+import static org.mmarini.wheelly.model.TelemetryFrames.*;
 
 /**
  * The AsyncSocketImpl handle the asynchronous communication via socket
  * The read text lines is published on string flow via readLines method.
+ * The status and cps records are parsed directly from the read buffer and published via readStatus and readCps
+ * methods, the text lines are decoded only if the readLines or readLog flows are subscribed.
+ * Each line is routed once by prefix through the {@link RecordDispatcher}, further record types can be handled by
+ * addHandler method.
+ * The published flows buffer up to {@link #FLOW_BUFFER_SIZE} records for each slow subscriber dropping the oldest ones.
+ * The binary telemetry mode can be requested by requestBinaryMode method, the data received after the robot
+ * acknowledge are decoded as {@link TelemetryFrames}.
+ * When a synchronized {@link ClockSync} is set, the status and cps records are timestamped with the local time of
+ * their remote sample time, otherwise with the receive time.
+ * When a {@link SocketSelector} is given, the channel is read and written in non blocking mode by the shared
+ * selector thread instead of a dedicated blocking reader.
  * The writing text lines is sent println method.
  * A closed completion flow can be used to get the notification of socket closure or any errors related the socket
  */
 public class AsyncSocketImpl implements AsyncSocket {
+    public static final int FLOW_BUFFER_SIZE = 1024;
+    public static final String STATUS_RECORD = "st ";
+    public static final String CPS_RECORD = "cs ";
     private static final String LF = "\n";
-    private static final String CRLF_PATTERN = "\\r?\\n";
+    private static final byte LF_BYTE = '\n';
+    private static final byte CR_BYTE = '\r';
     private static final int READ_BUFFER_SIZE = 1024;
     private static final Logger logger = LoggerFactory.getLogger(AsyncSocketImpl.class);
 
@@ -74,23 +88,18 @@ public class AsyncSocketImpl implements AsyncSocket {
      * @param readTimeout    the read timeout in millis
      */
     public static AsyncSocketImpl create(String host, int port, long connectTimeout, long readTimeout) {
-        return new AsyncSocketImpl(host, port, connectTimeout, readTimeout);
+        return new AsyncSocketImpl(host, port, connectTimeout, readTimeout, null);
     }
 
     /**
-     * @param bfr the buffer
+     * @param host           the host
+     * @param port           the port
+     * @param connectTimeout the connection timeout in millis
+     * @param readTimeout    the read timeout in millis
+     * @param selector       the shared selector or null for blocking reading
      */
-    private static Stream<Timed<String>> splitLines(ByteBuffer bfr) {
-        long timestamp = Instant.now().toEpochMilli();
-        String data = new String(bfr.array(), bfr.position(), bfr.remaining(), StandardCharsets.UTF_8);
-        String[] fragments = data.split(CRLF_PATTERN, -1);
-        String tail = fragments[fragments.length - 1];
-        Stream<Timed<String>> result = Arrays.stream(fragments).limit(fragments.length - 1)
-                .map(line -> new Timed<>(line, timestamp, TimeUnit.MILLISECONDS));
-        // enqueues to the buffer the tail (begin of next lines)
-        bfr.clear();
-        bfr.put(tail.getBytes(StandardCharsets.UTF_8));
-        return result;
+    public static AsyncSocketImpl create(String host, int port, long connectTimeout, long readTimeout, SocketSelector selector) {
+        return new AsyncSocketImpl(host, port, connectTimeout, readTimeout, selector);
     }
 
     private final SingleSubject<SocketChannel> channel;
@@ -106,6 +115,16 @@ public class AsyncSocketImpl implements AsyncSocket {
     private final BehaviorProcessor<Boolean> connected;
     private final long readTimeout;
     private final PublishProcessor<Timed<String>> logFlow;
+    private final PublishProcessor<Timed<WheellyStatus>> statusFlow;
+    private final PublishProcessor<Timed<Integer>> cpsFlow;
+    private final PublishProcessor<Throwable> parseErrors;
+    private final RecordDispatcher dispatcher;
+    private final SocketSelector selector;
+    private volatile SocketSelector.Registration registration;
+    private volatile boolean binaryModeRequested;
+    private volatile ClockSync clock;
+    private volatile boolean binaryMode;
+    private int lastSequence;
 
     /**
      * Creates an asynchronous socket
@@ -114,9 +133,11 @@ public class AsyncSocketImpl implements AsyncSocket {
      * @param port           the port
      * @param connectTimeout the connection timeout in millis
      * @param readTimeout    the read timeout in millis
+     * @param selector       the shared selector or null for blocking reading
      */
-    protected AsyncSocketImpl(String host, int port, long connectTimeout, long readTimeout) {
+    protected AsyncSocketImpl(String host, int port, long connectTimeout, long readTimeout, SocketSelector selector) {
         this.host = requireNonNull(host);
+        this.selector = selector;
         this.port = port;
         this.connectTimeout = connectTimeout;
         this.readTimeout = readTimeout;
@@ -127,6 +148,21 @@ public class AsyncSocketImpl implements AsyncSocket {
         this.readFlow = PublishProcessor.create();
         this.writeFlow = PublishProcessor.create();
         this.logFlow = PublishProcessor.create();
+        this.statusFlow = PublishProcessor.create();
+        this.cpsFlow = PublishProcessor.create();
+        this.parseErrors = PublishProcessor.create();
+        this.lastSequence = -1;
+        this.dispatcher = RecordDispatcher.create()
+                .register(STATUS_RECORD, (record, timestamp) -> {
+                    if (statusFlow.hasSubscribers()) {
+                        statusFlow.onNext(new Timed<>(record.parseStatus(), localTime(record, timestamp), TimeUnit.MILLISECONDS));
+                    }
+                })
+                .register(CPS_RECORD, (record, timestamp) -> {
+                    if (cpsFlow.hasSubscribers()) {
+                        cpsFlow.onNext(new Timed<>(record.parseCps(), localTime(record, timestamp), TimeUnit.MILLISECONDS));
+                    }
+                });
         this.ioScheduler = Schedulers.io();
         this.connected = BehaviorProcessor.createDefault(false);
         this.connectRequest.observeOn(ioScheduler)
@@ -141,6 +177,30 @@ public class AsyncSocketImpl implements AsyncSocket {
                         });
     }
 
+    /**
+     * Adds the handler of the records with a prefix
+     *
+     * @param prefix  the record prefix
+     * @param handler the handler
+     * @throws IllegalArgumentException if the prefix is already handled
+     */
+    public AsyncSocketImpl addHandler(String prefix, RecordDispatcher.Handler handler) {
+        dispatcher.register(prefix, handler);
+        return this;
+    }
+
+    /**
+     * Returns the flow with bounded buffer for slow subscribers
+     *
+     * @param flow the flow
+     * @param name the flow name
+     */
+    private <T> Flowable<T> buffered(Flowable<T> flow, String name) {
+        return flow.onBackpressureBuffer(FLOW_BUFFER_SIZE,
+                () -> logger.warn("Slow {} subscriber, dropped oldest records", name),
+                BackpressureOverflowStrategy.DROP_OLDEST);
+    }
+
     public AsyncSocketImpl close() {
         channel.observeOn(ioScheduler)
                 .subscribe(channel -> {
@@ -173,6 +233,59 @@ public class AsyncSocketImpl implements AsyncSocket {
         return channel.ignoreElement();
     }
 
+    /**
+     * Decodes the binary frames in the buffer and moves the tail (begin of next frame) to the buffer start
+     *
+     * @param bfr       the buffer
+     * @param timestamp the receive timestamp
+     */
+    private void decodeFrames(ByteBuffer bfr, long timestamp) {
+        bfr.flip();
+        boolean synchronised = true;
+        while (bfr.hasRemaining()) {
+            int offset = bfr.position();
+            byte tag = bfr.get(offset);
+            int size = frameSize(tag);
+            if (size < 0) {
+                // Skips the byte to synchronise to the next frame
+                if (synchronised) {
+                    parseErrors.onNext(new IllegalArgumentException(format("Wrong frame type %d", tag)));
+                    synchronised = false;
+                }
+                bfr.get();
+                continue;
+            }
+            if (bfr.remaining() < size) {
+                break;
+            }
+            synchronised = true;
+            int sequence = sequence(bfr, offset);
+            if (lastSequence >= 0) {
+                int lost = lostFrames(lastSequence, sequence);
+                if (lost > 0) {
+                    logger.warn("Lost {} frames before frame {}", lost, sequence);
+                    parseErrors.onNext(new IllegalStateException(format("Lost %d frames before frame %d", lost, sequence)));
+                }
+            }
+            lastSequence = sequence;
+            if (tag == STATUS_FRAME) {
+                WheellyStatus status = status(bfr, offset);
+                statusFlow.onNext(new Timed<>(status, localTime(bfr, offset, timestamp), TimeUnit.MILLISECONDS));
+                if (logFlow.hasSubscribers()) {
+                    logFlow.onNext(new Timed<>(format("< #%d %s", sequence, status), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
+                }
+            } else {
+                int cps = cps(bfr, offset);
+                cpsFlow.onNext(new Timed<>(cps, localTime(bfr, offset, timestamp), TimeUnit.MILLISECONDS));
+                if (logFlow.hasSubscribers()) {
+                    logFlow.onNext(new Timed<>(format("< #%d cps %d", sequence, cps), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
+                }
+            }
+            bfr.position(offset + size);
+        }
+        bfr.compact();
+    }
+
     private void createChannel() {
         try {
             logger.info("Creating channel ...");
@@ -190,6 +303,29 @@ public class AsyncSocketImpl implements AsyncSocket {
         }
     }
 
+    /**
+     * Returns the local timestamp of a binary frame
+     *
+     * @param bfr       the buffer
+     * @param offset    the frame offset
+     * @param timestamp the receive timestamp (ms)
+     */
+    private long localTime(ByteBuffer bfr, int offset, long timestamp) {
+        ClockSync clock = this.clock;
+        return clock != null && clock.isSynchronized() ? clock.toLocal(sampleTime(bfr, offset)) : timestamp;
+    }
+
+    /**
+     * Returns the local timestamp of a text record
+     *
+     * @param record    the record
+     * @param timestamp the receive timestamp (ms)
+     */
+    private long localTime(StatusParser record, long timestamp) {
+        ClockSync clock = this.clock;
+        return clock != null && clock.isSynchronized() ? clock.toLocal(record.parseSampleTime()) : timestamp;
+    }
+
     /**
      * @param lines the lines flow
      */
@@ -212,22 +348,89 @@ public class AsyncSocketImpl implements AsyncSocket {
         return this;
     }
 
+    /**
+     * Processes a received line
+     *
+     * @param parser    the parser of line
+     * @param timestamp the receive timestamp
+     */
+    private void processLine(StatusParser parser, long timestamp) {
+        try {
+            if (binaryModeRequested && parser.equalsTo(BINARY_MODE_ACK)) {
+                logger.info("Binary telemetry mode");
+                binaryMode = true;
+            } else {
+                dispatcher.dispatch(parser, timestamp);
+            }
+        } catch (IllegalArgumentException ex) {
+            parseErrors.onNext(ex);
+        }
+        if (logFlow.hasSubscribers() || readFlow.hasSubscribers()) {
+            String line = parser.line();
+            logFlow.onNext(new Timed<>(format("< %s", line), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
+            readFlow.onNext(new Timed<>(line, timestamp, TimeUnit.MILLISECONDS));
+        }
+    }
+
+    /**
+     * Processes the received data in the buffer
+     *
+     * @param bfr       the buffer
+     * @param parser    the parser
+     * @param timestamp the receive timestamp
+     */
+    private void processData(ByteBuffer bfr, StatusParser parser, long timestamp) {
+        if (!binaryMode) {
+            splitLines(bfr, parser, timestamp);
+        }
+        if (binaryMode) {
+            // The tail after the acknowledge line contains frames
+            decodeFrames(bfr, timestamp);
+        }
+    }
+
     private void readBody(SocketChannel ch) {
-        readLines(ch).subscribeOn(ioScheduler)
+        if (selector != null) {
+            registerBody(ch);
+            return;
+        }
+        readData(ch).subscribeOn(ioScheduler)
                 .timeout(this.readTimeout, TimeUnit.MILLISECONDS)
                 .subscribe(
-                        readFlow::onNext,
-                        ex -> {
-                            if (ex instanceof TimeoutException) {
-                                ch.close();
-                            }
-                            errors.onSuccess(ex);
-                            readFlow.onError(ex);
-                            connected.onNext(false);
-                            connected.onComplete();
-                            closed.onComplete();
+                        timestamp -> {
                         },
-                        readFlow::onComplete);
+                        ex -> readFailed(ch, ex),
+                        this::readCompleted);
+    }
+
+    /**
+     * Completes the read flows at the end of stream
+     */
+    private void readCompleted() {
+        readFlow.onComplete();
+        statusFlow.onComplete();
+        cpsFlow.onComplete();
+        parseErrors.onComplete();
+    }
+
+    /**
+     * Signals the reading error
+     *
+     * @param ch the channel
+     * @param ex the error
+     */
+    private void readFailed(SocketChannel ch, Throwable ex) throws IOException {
+        if (ex instanceof TimeoutException) {
+            ch.close();
+        }
+        errors.onSuccess(ex);
+        readFlow.onError(ex);
+        statusFlow.onError(ex);
+        cpsFlow.onError(ex);
+        parseErrors.onComplete();
+        connected.onNext(false);
+        connected.onComplete();
+        closed.onComplete();
     }
 
     @Override
@@ -235,29 +438,31 @@ public class AsyncSocketImpl implements AsyncSocket {
         return connected;
     }
 
-    public Maybe<Throwable> readErrors() {
-        return errors;
+    @Override
+    public Flowable<Timed<Integer>> readCps() {
+        return buffered(cpsFlow, "cps");
     }
 
     /**
+     * Returns the flow of read timestamps.
+     * The received lines are dispatched while reading, only the latest timestamp is kept for slow subscribers.
+     *
      * @param channel the channel
      */
-    private Flowable<Timed<String>> readLines(SocketChannel channel) {
+    private Flowable<Long> readData(SocketChannel channel) {
         return Flowable.create(emitter -> {
             try {
-                ByteBuffer bfr = ByteBuffer.allocate(READ_BUFFER_SIZE);
+                ByteBuffer bfr = ByteBuffer.allocate(READ_BUFFER_SIZE).order(BYTE_ORDER);
+                StatusParser parser = StatusParser.create();
                 while (channel.isConnected()) {
                     int n = channel.read(bfr);
                     if (n < 0) {
                         // End of file
                         break;
                     } else if (n > 0) {
-                        bfr.flip();
-                        Stream<Timed<String>> lines = splitLines(bfr);
-                        lines.forEach(line -> {
-                            logFlow.onNext(new Timed<>(format("< %s", line.value()), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
-                            emitter.onNext(line);
-                        });
+                        long timestamp = Instant.now().toEpochMilli();
+                        processData(bfr, parser, timestamp);
+                        emitter.onNext(timestamp);
                     }
                 }
                 emitter.onComplete();
@@ -266,11 +471,15 @@ public class AsyncSocketImpl implements AsyncSocket {
                     emitter.onError(ex);
                 }
             }
-        }, BackpressureStrategy.ERROR);
+        }, BackpressureStrategy.LATEST);
+    }
+
+    public Maybe<Throwable> readErrors() {
+        return errors;
     }
 
     public Flowable<Timed<String>> readLines() {
-        return readFlow;
+        return buffered(readFlow, "lines");
     }
 
     @Override
@@ -278,10 +487,119 @@ public class AsyncSocketImpl implements AsyncSocket {
         return logFlow;
     }
 
+    /**
+     * Returns the errors parsing the received records
+     */
+    public Flowable<Throwable> readParseErrors() {
+        return parseErrors;
+    }
+
+    @Override
+    public Flowable<Timed<WheellyStatus>> readStatus() {
+        return buffered(statusFlow, "status");
+    }
+
+    /**
+     * Registers the channel to the shared selector that processes the received data on the selector thread
+     *
+     * @param ch the channel
+     */
+    private void registerBody(SocketChannel ch) {
+        StatusParser parser = StatusParser.create();
+        try {
+            this.registration = selector.register(ch, ByteBuffer.allocate(READ_BUFFER_SIZE).order(BYTE_ORDER),
+                    readTimeout, new SocketSelector.Handler() {
+                        @Override
+                        public void onEnd() {
+                            readCompleted();
+                        }
+
+                        @Override
+                        public void onError(Throwable ex) {
+                            try {
+                                readFailed(ch, ex);
+                            } catch (IOException e) {
+                                logger.error("Error closing channel", e);
+                            }
+                        }
+
+                        @Override
+                        public void onRead(ByteBuffer buffer, long timestamp) {
+                            processData(buffer, parser, timestamp);
+                        }
+                    });
+        } catch (Throwable ex) {
+            try {
+                readFailed(ch, ex);
+            } catch (IOException e) {
+                logger.error("Error closing channel", e);
+            }
+        }
+    }
+
+    /**
+     * Returns true if the robot acknowledged the binary telemetry mode
+     */
+    public boolean isBinaryMode() {
+        return binaryMode;
+    }
+
+    /**
+     * Requests the binary telemetry mode to the robot
+     */
+    public AsyncSocketImpl requestBinaryMode() {
+        binaryModeRequested = true;
+        return println(BINARY_MODE_REQUEST);
+    }
+
+    /**
+     * Processes the lines in the buffer and moves the tail (begin of next line) to the buffer start.
+     * The processing stops when the binary mode is entered.
+     *
+     * @param bfr       the buffer
+     * @param parser    the parser
+     * @param timestamp the receive timestamp
+     */
+    private void splitLines(ByteBuffer bfr, StatusParser parser, long timestamp) {
+        byte[] data = bfr.array();
+        int end = bfr.position();
+        int start = 0;
+        for (int i = 0; i < end && !binaryMode; i++) {
+            if (data[i] == LF_BYTE) {
+                int lineEnd = i > start && data[i - 1] == CR_BYTE ? i - 1 : i;
+                processLine(parser.reset(data, start, lineEnd), timestamp);
+                start = i + 1;
+            }
+        }
+        if (!binaryMode && start == 0 && end == data.length) {
+            // The line does not fit the buffer
+            processLine(parser.reset(data, 0, end), timestamp);
+            start = end;
+        }
+        bfr.flip();
+        bfr.position(start);
+        bfr.compact();
+    }
+
+    /**
+     * Sets the clock sync estimator to timestamp the records
+     *
+     * @param clock the clock sync estimator or null to timestamp by receive time
+     */
+    public AsyncSocketImpl setClock(ClockSync clock) {
+        this.clock = clock;
+        return this;
+    }
+
     private void writeBody(SocketChannel ch) {
         writeFlow.observeOn(ioScheduler)
                 .subscribe(line -> {
-                            if (ch.isConnected()) {
+                            SocketSelector.Registration registration = this.registration;
+                            if (registration != null) {
+                                // The selector thread writes the queued line
+                                registration.write(ByteBuffer.wrap((line + LF).getBytes(StandardCharsets.UTF_8)));
+                                logFlow.onNext(new Timed<>(format("> %s", line), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
+                            } else if (ch.isConnected()) {
                                 ByteBuffer buffer = ByteBuffer.wrap((line + LF).getBytes(StandardCharsets.UTF_8));
                                 try {
                                     while (buffer.remaining() > 0) {
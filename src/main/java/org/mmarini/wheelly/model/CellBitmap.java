@@ -0,0 +1,307 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.*;
+import java.util.AbstractSet;
+import java.util.Collection;
+import java.util.Iterator;
+import java.util.Set;
+import java.util.stream.IntStream;
+import java.util.stream.Stream;
+
+import static java.lang.Math.abs;
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+
+/**
+ * The packed bitmap of a rectangular region of cells.
+ * <p>
+ * Each row of cells (constant y index) is packed in long words starting from the origin of the region,
+ * so that negative cell indices are held by offsetting the origin.
+ * The bit b of the word w of the row r is the cell (originI + w * 64 + b, originJ + r).
+ * The dilations and the contour are computed by shifting and combining whole words (64 cells per operation)
+ * and the bitmap is adapted to the cell predicates and to the sets of points by {@link #test(int, int)} and
+ * {@link #asSet()}.
+ * The bitmap is immutable.
+ * </p>
+ */
+public class CellBitmap implements CellPredicate {
+    private static final int WORD_BITS = 6;
+    private static final int WORD_SIZE = 1 << WORD_BITS;
+    private static final int WORD_MASK = WORD_SIZE - 1;
+    private static final int[] NEIGHBOURS = {-1, -1, -1, 0, -1, 1, 0, -1, 0, 0, 0, 1, 1, -1, 1, 0, 1, 1};
+    private static final CellBitmap EMPTY = new CellBitmap(0, 0, 0, 0, new long[0]);
+
+    /**
+     * Returns the empty bitmap
+     */
+    public static CellBitmap empty() {
+        return EMPTY;
+    }
+
+    /**
+     * Returns the bitmap of cells
+     *
+     * @param cells the cells
+     */
+    public static CellBitmap of(Collection<Point> cells) {
+        if (cells.isEmpty()) {
+            return EMPTY;
+        }
+        int minI = Integer.MAX_VALUE;
+        int minJ = Integer.MAX_VALUE;
+        int maxI = Integer.MIN_VALUE;
+        int maxJ = Integer.MIN_VALUE;
+        for (Point cell : cells) {
+            minI = min(minI, cell.x);
+            minJ = min(minJ, cell.y);
+            maxI = max(maxI, cell.x);
+            maxJ = max(maxJ, cell.y);
+        }
+        int width = maxI - minI + 1;
+        int height = maxJ - minJ + 1;
+        int words = wordCount(width);
+        long[] bits = new long[words * height];
+        for (Point cell : cells) {
+            int b = cell.x - minI;
+            bits[(cell.y - minJ) * words + (b >> WORD_BITS)] |= 1L << (b & WORD_MASK);
+        }
+        return new CellBitmap(minI, minJ, width, height, bits);
+    }
+
+    /**
+     * Ors the bits of a source row shifted toward the higher indices into a destination row
+     *
+     * @param src       the source bits
+     * @param srcOffset the offset of the source row
+     * @param srcWords  the number of words of the source row
+     * @param dst       the destination bits
+     * @param dstOffset the offset of the destination row
+     * @param dstWords  the number of words of the destination row
+     * @param shift     the number of bits to shift (non negative)
+     */
+    private static void orShifted(long[] src, int srcOffset, int srcWords,
+                                  long[] dst, int dstOffset, int dstWords, int shift) {
+        int q = shift >> WORD_BITS;
+        int s = shift & WORD_MASK;
+        for (int w = 0; w < srcWords; w++) {
+            long word = src[srcOffset + w];
+            if (word != 0) {
+                int d = w + q;
+                dst[dstOffset + d] |= word << s;
+                if (s != 0 && d + 1 < dstWords) {
+                    dst[dstOffset + d + 1] |= word >>> (WORD_SIZE - s);
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the number of words to hold a row of cells
+     *
+     * @param width the number of cells
+     */
+    private static int wordCount(int width) {
+        return (width + WORD_MASK) >> WORD_BITS;
+    }
+
+    private final int originI;
+    private final int originJ;
+    private final int width;
+    private final int height;
+    private final int words;
+    private final long[] bits;
+    private final int cardinality;
+    private final Set<Point> cells;
+
+    /**
+     * Creates the bitmap
+     *
+     * @param originI the x index of the first cell
+     * @param originJ the y index of the first cell
+     * @param width   the number of cells per row
+     * @param height  the number of rows
+     * @param bits    the packed bits
+     */
+    protected CellBitmap(int originI, int originJ, int width, int height, long[] bits) {
+        this.originI = originI;
+        this.originJ = originJ;
+        this.width = width;
+        this.height = height;
+        this.words = wordCount(width);
+        this.bits = bits;
+        int n = 0;
+        for (long word : bits) {
+            n += Long.bitCount(word);
+        }
+        this.cardinality = n;
+        this.cells = new CellSet();
+    }
+
+    /**
+     * Returns the set of points view of the bitmap
+     */
+    public Set<Point> asSet() {
+        return cells;
+    }
+
+    /**
+     * Returns the contour cells (the cells not in the bitmap adjacent to the cells in the bitmap)
+     */
+    public CellBitmap contour() {
+        CellBitmap dilated = dilate(NEIGHBOURS);
+        if (dilated == this) {
+            return this;
+        }
+        // Clears the cells of this bitmap, placed at one cell margin in the dilated bitmap
+        long[] result = dilated.bits;
+        for (int r = 0; r < height; r++) {
+            long[] row = new long[dilated.words];
+            orShifted(bits, r * words, words, row, 0, dilated.words, 1);
+            int offset = (r + 1) * dilated.words;
+            for (int w = 0; w < dilated.words; w++) {
+                result[offset + w] &= ~row[w];
+            }
+        }
+        return new CellBitmap(dilated.originI, dilated.originJ, dilated.width, dilated.height, result);
+    }
+
+    /**
+     * Returns the bitmap dilated by a structuring element.
+     * Each cell of the result is set if any cell of this bitmap at the offset of the structuring elements is set.
+     * The rows are dilated by shifting the words of each source row for each offset of the same row.
+     *
+     * @param offsets the offsets of the structuring element (di0, dj0, di1, dj1, ...)
+     */
+    public CellBitmap dilate(int[] offsets) {
+        if (cardinality == 0 || offsets.length == 0) {
+            return this;
+        }
+        int ki = 0;
+        int kj = 0;
+        for (int n = 0; n < offsets.length; n += 2) {
+            ki = max(ki, abs(offsets[n]));
+            kj = max(kj, abs(offsets[n + 1]));
+        }
+        int newWidth = width + 2 * ki;
+        int newHeight = height + 2 * kj;
+        int newWords = wordCount(newWidth);
+        long[] result = new long[newWords * newHeight];
+        for (int r = 0; r < height; r++) {
+            int srcOffset = r * words;
+            if (!isEmptyRow(srcOffset)) {
+                for (int n = 0; n < offsets.length; n += 2) {
+                    int dstOffset = (r + kj + offsets[n + 1]) * newWords;
+                    orShifted(bits, srcOffset, words, result, dstOffset, newWords, ki + offsets[n]);
+                }
+            }
+        }
+        return new CellBitmap(originI - ki, originJ - kj, newWidth, newHeight, result);
+    }
+
+    /**
+     * Returns the number of cells in the bitmap
+     */
+    public int getCardinality() {
+        return cardinality;
+    }
+
+    /**
+     * Returns true if a row has no cells
+     *
+     * @param offset the offset of the row
+     */
+    private boolean isEmptyRow(int offset) {
+        for (int w = 0; w < words; w++) {
+            if (bits[offset + w] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the cells of the bitmap
+     */
+    public Stream<Point> stream() {
+        return IntStream.range(0, bits.length)
+                .filter(idx -> bits[idx] != 0)
+                .boxed()
+                .flatMap(idx -> {
+                    Stream.Builder<Point> builder = Stream.builder();
+                    int i0 = originI + (idx % words) * WORD_SIZE;
+                    int j = originJ + idx / words;
+                    for (long word = bits[idx]; word != 0; word &= word - 1) {
+                        builder.add(new Point(i0 + Long.numberOfTrailingZeros(word), j));
+                    }
+                    return builder.build();
+                });
+    }
+
+    @Override
+    public boolean test(int i, int j) {
+        int b = i - originI;
+        int r = j - originJ;
+        if (b < 0 || b >= width || r < 0 || r >= height) {
+            return false;
+        }
+        return (bits[r * words + (b >> WORD_BITS)] & (1L << (b & WORD_MASK))) != 0;
+    }
+
+    /**
+     * The set of points view of the bitmap
+     */
+    private class CellSet extends AbstractSet<Point> {
+        @Override
+        public boolean contains(Object o) {
+            if (!(o instanceof Point)) {
+                return false;
+            }
+            Point cell = (Point) o;
+            return test(cell.x, cell.y);
+        }
+
+        @Override
+        public Iterator<Point> iterator() {
+            return stream().iterator();
+        }
+
+        @Override
+        public int size() {
+            return cardinality;
+        }
+
+        @Override
+        public Stream<Point> stream() {
+            return CellBitmap.this.stream();
+        }
+    }
+}
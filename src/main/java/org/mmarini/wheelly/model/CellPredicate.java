@@ -0,0 +1,73 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.*;
+import java.util.Set;
+import java.util.function.Predicate;
+
+/**
+ * Tests a grid cell by its indices without allocating points
+ */
+@FunctionalInterface
+public interface CellPredicate {
+    /**
+     * Returns the cell predicate of a set of cells
+     *
+     * @param cells the cells
+     */
+    static CellPredicate of(Set<Point> cells) {
+        return of(cells::contains);
+    }
+
+    /**
+     * Returns the cell predicate of a point predicate
+     *
+     * @param predicate the point predicate
+     */
+    static CellPredicate of(Predicate<Point> predicate) {
+        return (i, j) -> predicate.test(new Point(i, j));
+    }
+
+    /**
+     * Returns the point predicate of this cell predicate
+     */
+    default Predicate<Point> asPredicate() {
+        return cell -> test(cell.x, cell.y);
+    }
+
+    /**
+     * Returns true if the cell satisfies the predicate
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    boolean test(int i, int j);
+}
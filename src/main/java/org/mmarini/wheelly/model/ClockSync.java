@@ -0,0 +1,204 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.util.Arrays;
+
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+import static java.lang.Math.round;
+
+/**
+ * Estimates the offset and the drift of the remote clock from the clock sync events.
+ * <p>
+ * The last events are kept in a window and the offset is the offset of the event with the minimum round trip time
+ * (the least affected by the queueing delays).
+ * The drift is the slope of the offset from the minimum round trip event of the first window (the anchor),
+ * it is estimated only when the anchor is older than {@link #MIN_DRIFT_INTERVAL} so that the offset errors
+ * due to the millisecond resolution are negligible.
+ * The remote timestamps are converted to local timestamps by the offset at the time of the minimum round trip
+ * event corrected by the drift.
+ * The estimator is thread safe.
+ * </p>
+ */
+public class ClockSync {
+    public static final int DEFAULT_WINDOW_SIZE = 8;
+    /**
+     * The minimum interval to estimate the drift (ms)
+     */
+    public static final long MIN_DRIFT_INTERVAL = 60000;
+    /**
+     * The maximum absolute drift (1000 ppm)
+     */
+    public static final double MAX_DRIFT = 1e-3;
+
+    /**
+     * Returns the clock sync estimator with default window size
+     */
+    public static ClockSync create() {
+        return new ClockSync(DEFAULT_WINDOW_SIZE);
+    }
+
+    /**
+     * Returns the clock sync estimator
+     *
+     * @param windowSize the number of events to filter
+     */
+    public static ClockSync create(int windowSize) {
+        if (windowSize <= 0) {
+            throw new IllegalArgumentException("Window size must be positive");
+        }
+        return new ClockSync(windowSize);
+    }
+
+    /**
+     * Returns the local time of the middle of the exchange (ms)
+     *
+     * @param event the event
+     */
+    private static double middleTime(ClockSyncEvent event) {
+        return (event.originateTimestamp + event.destinationTimestamp) / 2.0;
+    }
+
+    /**
+     * Returns the offset of the remote clock at the middle of the exchange (ms)
+     *
+     * @param event the event
+     */
+    private static double offset(ClockSyncEvent event) {
+        return middleTime(event) - (event.receiveTimestamp + event.transmitTimestamp) / 2.0;
+    }
+
+    private final ClockSyncEvent[] window;
+    private long count;
+    private double anchorTime;
+    private double anchorOffset;
+    private double referenceTime;
+    private double offset;
+    private double drift;
+    private long roundTripTime;
+
+    /**
+     * Creates the clock sync estimator
+     *
+     * @param windowSize the number of events to filter
+     */
+    protected ClockSync(int windowSize) {
+        this.window = new ClockSyncEvent[windowSize];
+    }
+
+    /**
+     * Adds a clock sync event to the estimation.
+     * The events with negative round trip time are ignored.
+     *
+     * @param event the event
+     */
+    public synchronized ClockSync add(ClockSyncEvent event) {
+        if (event.getRoundTripTime() < 0) {
+            return this;
+        }
+        window[(int) (count % window.length)] = event;
+        count++;
+        // Minimum round trip event
+        ClockSyncEvent best = null;
+        for (ClockSyncEvent e : window) {
+            if (e != null && (best == null || e.getRoundTripTime() < best.getRoundTripTime())) {
+                best = e;
+            }
+        }
+        referenceTime = middleTime(best);
+        offset = offset(best);
+        roundTripTime = best.getRoundTripTime();
+        if (count <= window.length) {
+            anchorTime = referenceTime;
+            anchorOffset = offset;
+        }
+        double interval = referenceTime - anchorTime;
+        drift = interval >= MIN_DRIFT_INTERVAL
+                ? max(-MAX_DRIFT, min(MAX_DRIFT, (offset - anchorOffset) / interval))
+                : 0;
+        return this;
+    }
+
+    /**
+     * Returns the drift of the remote clock (ms of offset per local ms)
+     */
+    public synchronized double getDrift() {
+        return drift;
+    }
+
+    /**
+     * Returns the offset of the remote clock at a local time (ms)
+     *
+     * @param localTime the local time (ms)
+     */
+    public synchronized double getOffset(long localTime) {
+        return offset + drift * (localTime - referenceTime);
+    }
+
+    /**
+     * Returns the filtered round trip time (ms)
+     */
+    public synchronized long getRoundTripTime() {
+        return roundTripTime;
+    }
+
+    /**
+     * Returns true if any event has been processed
+     */
+    public synchronized boolean isSynchronized() {
+        return count > 0;
+    }
+
+    /**
+     * Clears the estimation (i.e. when the remote clock is restarted)
+     */
+    public synchronized ClockSync reset() {
+        Arrays.fill(window, null);
+        count = 0;
+        anchorTime = 0;
+        anchorOffset = 0;
+        referenceTime = 0;
+        offset = 0;
+        drift = 0;
+        roundTripTime = 0;
+        return this;
+    }
+
+    /**
+     * Returns the local timestamp of a remote timestamp (ms)
+     *
+     * @param remoteTime the remote timestamp (ms)
+     */
+    public synchronized long toLocal(long remoteTime) {
+        double localTime = remoteTime + offset;
+        return round(localTime + drift * (localTime - referenceTime));
+    }
+}
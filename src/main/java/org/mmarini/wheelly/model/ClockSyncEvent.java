@@ -56,7 +56,7 @@ public class ClockSyncEvent {
     public static ClockSyncEvent from(String data, long destinationTimestamp) {
         String[] fields = data.split(" ");
         if (fields.length != 4) {
-            throw new IllegalArgumentException(format("Wrong clock message \"%d\"", data));
+            throw new IllegalArgumentException(format("Wrong clock message \"%s\"", data));
         }
         long originateTimestamp = Long.parseLong(fields[1]);
         long receiveTimestamp = Long.parseLong(fields[2]);
@@ -119,6 +119,13 @@ public class ClockSyncEvent {
         return originateTimestamp + getLatency() - receiveTimestamp;
     }
 
+    /**
+     * Returns the round trip time excluding the remote processing time (ms)
+     */
+    public long getRoundTripTime() {
+        return destinationTimestamp - originateTimestamp - transmitTimestamp + receiveTimestamp;
+    }
+
     /**
      * Returns the transmit timestamp in remote clock ticks (ms)
      */
@@ -0,0 +1,167 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.core.Maybe;
+import io.reactivex.rxjava3.core.Scheduler;
+import org.mmarini.Tuple2;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Optional;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLongArray;
+import java.util.concurrent.atomic.AtomicReference;
+
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+import static java.util.Objects.requireNonNull;
+import static org.mmarini.wheelly.model.HaltCommand.HALT_COMMAND;
+
+/**
+ * Schedules the motor and scanner commands sent to the robot.
+ * <p>
+ * The commands are sent as soon as they change, the motor and the scanner commands changed together are
+ * coalesced in a single write.
+ * While the robot is moving or the scanner is not in front position each active command is resent as keep-alive
+ * at the keep-alive interval from its own last write, so that the robot watchdogs do not halt the robot or
+ * reset the scanner even if the other command changes faster than the keep-alive interval.
+ * No command is sent while the robot is halted with the scanner in front position.
+ * </p>
+ */
+public interface CommandScheduler {
+    int FRONT_DIRECTION = 0;
+
+    /**
+     * Returns the commands to send to the robot
+     *
+     * @param commands          the flow of motion and scanner direction commands
+     * @param keepAliveInterval the keep-alive interval (ms)
+     * @param scheduler         the scheduler of keep-alive timers
+     */
+    static Flowable<WheellyCommand> schedule(Flowable<Tuple2<MotionCommand, Integer>> commands,
+                                             long keepAliveInterval, Scheduler scheduler) {
+        requireNonNull(commands);
+        requireNonNull(scheduler);
+        return Flowable.defer(() -> {
+            AtomicReference<Tuple2<MotionCommand, Integer>> last = new AtomicReference<>();
+            // The last write instants of motor and scanner commands
+            AtomicLongArray writeTimes = new AtomicLongArray(2);
+            return commands.distinctUntilChanged()
+                    .switchMap(cmd -> {
+                        Tuple2<MotionCommand, Integer> prev = last.getAndSet(cmd);
+                        long now = scheduler.now(TimeUnit.MILLISECONDS);
+                        if (prev == null || !cmd._1.equals(prev._1)) {
+                            writeTimes.set(0, now);
+                        }
+                        if (prev == null || !cmd._2.equals(prev._2)) {
+                            writeTimes.set(1, now);
+                        }
+                        Flowable<WheellyCommand> changes = toCommand(changedCommands(prev, cmd))
+                                .map(Flowable::just)
+                                .orElse(Flowable.empty());
+                        return changes.concatWith(keepAlive(cmd, writeTimes, keepAliveInterval, scheduler));
+                    });
+        });
+    }
+
+    /**
+     * Returns the keep-alive commands of the active commands.
+     * Each active command is resent at the keep-alive interval from its last write,
+     * the commands expiring together are coalesced in a single write.
+     *
+     * @param cmd               the current commands
+     * @param writeTimes        the last write instants of motor and scanner commands (ms)
+     * @param keepAliveInterval the keep-alive interval (ms)
+     * @param scheduler         the scheduler of keep-alive timers
+     */
+    private static Flowable<WheellyCommand> keepAlive(Tuple2<MotionCommand, Integer> cmd, AtomicLongArray writeTimes,
+                                                      long keepAliveInterval, Scheduler scheduler) {
+        boolean motorActive = cmd._1 != HALT_COMMAND;
+        boolean scanActive = cmd._2 != FRONT_DIRECTION;
+        if (!motorActive && !scanActive) {
+            return Flowable.empty();
+        }
+        return Flowable.defer(() -> {
+                    long deadline = min(motorActive ? writeTimes.get(0) : Long.MAX_VALUE,
+                            scanActive ? writeTimes.get(1) : Long.MAX_VALUE) + keepAliveInterval;
+                    long delay = max(deadline - scheduler.now(TimeUnit.MILLISECONDS), 0);
+                    return Flowable.timer(delay, TimeUnit.MILLISECONDS, scheduler)
+                            .flatMapMaybe(i -> {
+                                long now = scheduler.now(TimeUnit.MILLISECONDS);
+                                List<WheellyCommand> expired = new ArrayList<>(2);
+                                if (motorActive && now - writeTimes.get(0) >= keepAliveInterval) {
+                                    expired.add(cmd._1);
+                                    writeTimes.set(0, now);
+                                }
+                                if (scanActive && now - writeTimes.get(1) >= keepAliveInterval) {
+                                    expired.add(ScanCommand.create(cmd._2));
+                                    writeTimes.set(1, now);
+                                }
+                                return toCommand(expired).map(Maybe::just).orElse(Maybe.empty());
+                            });
+                })
+                .repeat();
+    }
+
+    /**
+     * Returns the changed commands
+     *
+     * @param last the last commands or null if none
+     * @param cmd  the current commands
+     */
+    static List<WheellyCommand> changedCommands(Tuple2<MotionCommand, Integer> last, Tuple2<MotionCommand, Integer> cmd) {
+        List<WheellyCommand> result = new ArrayList<>(2);
+        if (last == null || !cmd._1.equals(last._1)) {
+            result.add(cmd._1);
+        }
+        if (last == null ? cmd._2 != FRONT_DIRECTION : !cmd._2.equals(last._2)) {
+            result.add(ScanCommand.create(cmd._2));
+        }
+        return result;
+    }
+
+    /**
+     * Returns the single command or the composite command of the commands or empty if no command
+     *
+     * @param commands the commands
+     */
+    static Optional<WheellyCommand> toCommand(List<WheellyCommand> commands) {
+        switch (commands.size()) {
+            case 0:
+                return Optional.empty();
+            case 1:
+                return Optional.of(commands.get(0));
+            default:
+                return Optional.of(CompositeCommand.create(commands));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.util.List;
+import java.util.StringJoiner;
+
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The sequence of commands sent to the robot in a single write
+ */
+public class CompositeCommand implements WheellyCommand {
+    /**
+     * Returns the composite command
+     *
+     * @param commands the commands
+     */
+    public static CompositeCommand create(List<? extends WheellyCommand> commands) {
+        return new CompositeCommand(commands);
+    }
+
+    /**
+     * Returns the composite command
+     *
+     * @param commands the commands
+     */
+    public static CompositeCommand create(WheellyCommand... commands) {
+        return new CompositeCommand(List.of(commands));
+    }
+
+    public final List<WheellyCommand> commands;
+
+    /**
+     * Creates the composite command
+     *
+     * @param commands the commands
+     */
+    protected CompositeCommand(List<? extends WheellyCommand> commands) {
+        this.commands = List.copyOf(requireNonNull(commands));
+    }
+
+    /**
+     * Returns the command lines separated by new line
+     */
+    @Override
+    public String getString() {
+        StringJoiner joiner = new StringJoiner("\n");
+        for (WheellyCommand command : commands) {
+            joiner.add(command.getString());
+        }
+        return joiner.toString();
+    }
+
+    @Override
+    public String toString() {
+        return new StringJoiner(", ", CompositeCommand.class.getSimpleName() + "[", "]")
+                .add("commands=" + commands)
+                .toString();
+    }
+}
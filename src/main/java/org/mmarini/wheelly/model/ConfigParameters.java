@@ -32,6 +32,10 @@ package org.mmarini.wheelly.model;
 import com.fasterxml.jackson.databind.JsonNode;
 import org.mmarini.yaml.schema.Locator;
 
+import java.awt.geom.Line2D;
+import java.awt.geom.Point2D;
+import java.util.List;
+
 import static java.util.Objects.requireNonNull;
 import static org.mmarini.wheelly.swing.Yaml.config;
 
@@ -53,19 +57,72 @@ public class ConfigParameters {
      * @param dumpFile                the file dump of inference engine
      * @param robotLogFile            the file log
      * @param netMonitor
+     * @param binaryTelemetry         true if binary telemetry mode is requested
+     */
+    public static ConfigParameters create(String host, int port,
+                                          long connectionTimeout, long retryConnectionInterval, long readTimeout,
+                                          long responseTime, long motorCommandInterval, long scanCommandInterval, String dumpFile, String robotLogFile, boolean netMonitor,
+                                          boolean binaryTelemetry) {
+        return new ConfigParameters(host, port,
+                connectionTimeout, retryConnectionInterval, readTimeout,
+                responseTime, motorCommandInterval, scanCommandInterval, dumpFile, robotLogFile, netMonitor,
+                binaryTelemetry, false, List.of(), new Point2D.Double(), 0,
+                SimulatedController.DEFAULT_STATUS_INTERVAL, SimulatedController.DEFAULT_SPEED_UP, null,
+                GridScannerMap.UNLIMITED, GridScannerMap.UNLIMITED, 0);
+    }
+
+    /**
+     * Creates configuration parameters
+     *
+     * @param host                    the host name
+     * @param port                    the port
+     * @param connectionTimeout       the connection timeout (ms)
+     * @param retryConnectionInterval the retry connection interval (ms)
+     * @param readTimeout             the read timeout (ms)
+     * @param responseTime            the minimum interval between inference process (ms)
+     * @param motorCommandInterval    the interval of motor command (ms)
+     * @param scanCommandInterval     the interval of scanner command (ms)
+     * @param dumpFile                the file dump of inference engine
+     * @param robotLogFile            the file log
+     * @param netMonitor              true if monitor active
+     * @param binaryTelemetry         true if binary telemetry mode is requested
+     * @param simulated               true if the robot is simulated
+     * @param world                   the segments of simulated world
+     * @param startLocation           the start location of simulated robot
+     * @param startDirection          the start direction of simulated robot (DEG)
+     * @param statusInterval          the interval of simulated status (ms)
+     * @param speedUp                 the speed up factor of simulated time relative to real time
+     * @param latencyFile             the file of control loop latencies
+     * @param mapMaxTiles             the maximum number of map tiles
+     * @param mapMaxObstacles         the maximum number of map obstacles
+     * @param clockSyncInterval       the interval of clock sync requests (ms) or 0 if no clock sync
      */
     public static ConfigParameters create(String host, int port,
                                           long connectionTimeout, long retryConnectionInterval, long readTimeout,
-                                          long responseTime, long motorCommandInterval, long scanCommandInterval, String dumpFile, String robotLogFile, boolean netMonitor) {
+                                          long responseTime, long motorCommandInterval, long scanCommandInterval, String dumpFile, String robotLogFile, boolean netMonitor,
+                                          boolean binaryTelemetry, boolean simulated, List<Line2D> world,
+                                          Point2D startLocation, int startDirection, long statusInterval, double speedUp,
+                                          String latencyFile, int mapMaxTiles, int mapMaxObstacles,
+                                          long clockSyncInterval) {
         return new ConfigParameters(host, port,
                 connectionTimeout, retryConnectionInterval, readTimeout,
-                responseTime, motorCommandInterval, scanCommandInterval, dumpFile, robotLogFile, netMonitor);
+                responseTime, motorCommandInterval, scanCommandInterval, dumpFile, robotLogFile, netMonitor,
+                binaryTelemetry, simulated, world, startLocation, startDirection, statusInterval, speedUp,
+                latencyFile, mapMaxTiles, mapMaxObstacles, clockSyncInterval);
     }
 
     public static ConfigParameters fromJson(JsonNode root, Locator locator) {
         requireNonNull(root);
         requireNonNull(locator);
         config().apply(locator).accept(root);
+        Locator simulation = locator.path("simulation");
+        boolean simulated = !simulation.getNode(root).isMissingNode();
+        JsonNode startNode = simulation.path("startLocation").getNode(root);
+        Point2D startLocation = startNode.isMissingNode()
+                ? new Point2D.Double()
+                : new Point2D.Double(startNode.get(0).asDouble(), startNode.get(1).asDouble());
+        JsonNode worldNode = simulation.path("world").getNode(root);
+        List<Line2D> world = worldNode.isMissingNode() ? List.of() : RobotSimulator.worldFromJson(worldNode);
         return ConfigParameters.create(
                 locator.path("host").getNode(root).asText(),
                 locator.path("port").getNode(root).asInt(),
@@ -77,12 +134,26 @@ public class ConfigParameters {
                 locator.path("scanCommandInterval").getNode(root).asLong(),
                 locator.path("dumpFile").getNode(root).asText(null),
                 locator.path("robotLogFile").getNode(root).asText(null),
-                locator.path("netMonitor").getNode(root).asBoolean(false));
+                locator.path("netMonitor").getNode(root).asBoolean(false),
+                locator.path("binaryTelemetry").getNode(root).asBoolean(false),
+                simulated, world, startLocation,
+                simulation.path("startDirection").getNode(root).asInt(0),
+                simulation.path("statusInterval").getNode(root).asLong(SimulatedController.DEFAULT_STATUS_INTERVAL),
+                simulation.path("speedUp").getNode(root).asDouble(SimulatedController.DEFAULT_SPEED_UP),
+                locator.path("latencyFile").getNode(root).asText(null),
+                locator.path("map").path("maxTiles").getNode(root).asInt(GridScannerMap.UNLIMITED),
+                locator.path("map").path("maxObstacles").getNode(root).asInt(GridScannerMap.UNLIMITED),
+                locator.path("clockSyncInterval").getNode(root).asLong(0));
     }
 
+    public final boolean binaryTelemetry;
+    public final long clockSyncInterval;
     public final long connectionTimeout;
     public final String dumpFile;
     public final String host;
+    public final String latencyFile;
+    public final int mapMaxObstacles;
+    public final int mapMaxTiles;
     public final long motorCommandInterval;
     public final boolean netMonitor;
     public final int port;
@@ -91,6 +162,12 @@ public class ConfigParameters {
     public final long retryConnectionInterval;
     public final String robotLogFile;
     public final long scanCommandInterval;
+    public final boolean simulated;
+    public final double speedUp;
+    public final int startDirection;
+    public final Point2D startLocation;
+    public final long statusInterval;
+    public final List<Line2D> world;
 
     /**
      * Creates configuration parameters
@@ -106,11 +183,26 @@ public class ConfigParameters {
      * @param dumpFile                the dump file with action , command
      * @param robotLogFile
      * @param netMonitor              true if monitor active
+     * @param binaryTelemetry         true if binary telemetry mode is requested
+     * @param simulated               true if the robot is simulated
+     * @param world                   the segments of simulated world
+     * @param startLocation           the start location of simulated robot
+     * @param startDirection          the start direction of simulated robot (DEG)
+     * @param statusInterval          the interval of simulated status (ms)
+     * @param speedUp                 the speed up factor of simulated time relative to real time
+     * @param latencyFile             the file of control loop latencies
+     * @param mapMaxTiles             the maximum number of map tiles
+     * @param mapMaxObstacles         the maximum number of map obstacles
+     * @param clockSyncInterval       the interval of clock sync requests (ms) or 0 if no clock sync
      */
     protected ConfigParameters(String host, int port,
                                long connectionTimeout, long retryConnectionInterval, long readTimeout,
                                long responseTime, long motorCommandInterval, long scanCommandInterval,
-                               String dumpFile, String robotLogFile, boolean netMonitor) {
+                               String dumpFile, String robotLogFile, boolean netMonitor,
+                               boolean binaryTelemetry, boolean simulated, List<Line2D> world,
+                               Point2D startLocation, int startDirection, long statusInterval, double speedUp,
+                               String latencyFile, int mapMaxTiles, int mapMaxObstacles,
+                               long clockSyncInterval) {
         this.connectionTimeout = connectionTimeout;
         this.host = requireNonNull(host);
         this.port = port;
@@ -122,5 +214,16 @@ public class ConfigParameters {
         this.responseTime = responseTime;
         this.robotLogFile = robotLogFile;
         this.netMonitor = netMonitor;
+        this.binaryTelemetry = binaryTelemetry;
+        this.simulated = simulated;
+        this.world = requireNonNull(world);
+        this.startLocation = requireNonNull(startLocation);
+        this.startDirection = startDirection;
+        this.statusInterval = statusInterval;
+        this.speedUp = speedUp;
+        this.latencyFile = latencyFile;
+        this.mapMaxTiles = mapMaxTiles;
+        this.mapMaxObstacles = mapMaxObstacles;
+        this.clockSyncInterval = clockSyncInterval;
     }
 }
@@ -0,0 +1,147 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.Tuple2;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.IOException;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.StandardOpenOption;
+
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+import static org.mmarini.wheelly.model.DumpFiles.*;
+
+/**
+ * Reads the records of a binary dump file through memory mapped windows of the file.
+ * <p>
+ * The windows are remapped at the start of the first record not entirely contained in the current window,
+ * so the records are decoded directly from the mapped buffer.
+ * </p>
+ */
+public class DumpFileReader implements Closeable {
+    public static final long MAP_WINDOW_SIZE = 64L * 1024 * 1024;
+
+    /**
+     * Returns the reader of a binary dump file
+     *
+     * @param file the file
+     * @throws IOException in case of error or invalid header
+     */
+    public static DumpFileReader open(File file) throws IOException {
+        FileChannel channel = FileChannel.open(file.toPath(), StandardOpenOption.READ);
+        try {
+            DumpFileReader reader = new DumpFileReader(channel, channel.size());
+            reader.map(0, HEADER_SIZE);
+            if (reader.buffer.remaining() < HEADER_SIZE || !isMagic(reader.buffer, 0)) {
+                throw new IOException(String.format("%s is not a binary dump file", file));
+            }
+            int version = reader.buffer.getInt(MAGIC.length);
+            if (version != VERSION) {
+                throw new IOException(String.format("Unsupported dump file version %d", version));
+            }
+            reader.buffer.position(HEADER_SIZE);
+            return reader;
+        } catch (IOException | RuntimeException e) {
+            channel.close();
+            throw e;
+        }
+    }
+
+    private final FileChannel channel;
+    private final long size;
+    private MappedByteBuffer buffer;
+    private long base;
+
+    /**
+     * Creates the reader
+     *
+     * @param channel the file channel
+     * @param size    the file size
+     */
+    protected DumpFileReader(FileChannel channel, long size) {
+        this.channel = channel;
+        this.size = size;
+    }
+
+    @Override
+    public void close() throws IOException {
+        channel.close();
+    }
+
+    /**
+     * Maps the window of the file starting at the given position
+     *
+     * @param position the file position
+     * @param minSize  the minimum size of window
+     */
+    private void map(long position, long minSize) throws IOException {
+        long length = min(max(MAP_WINDOW_SIZE, minSize), size - position);
+        buffer = channel.map(FileChannel.MapMode.READ_ONLY, position, length);
+        buffer.order(BYTE_ORDER);
+        base = position;
+    }
+
+    /**
+     * Returns the next record or null at the end of file
+     *
+     * @throws IOException in case of error or truncated file
+     */
+    public Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> next() throws IOException {
+        if (buffer.remaining() < Integer.BYTES) {
+            map(base + buffer.position(), Integer.BYTES);
+            if (!buffer.hasRemaining()) {
+                return null;
+            }
+            if (buffer.remaining() < Integer.BYTES) {
+                throw new IOException("Truncated dump file");
+            }
+        }
+        int length = buffer.getInt(buffer.position());
+        if (length < 0) {
+            throw new IOException(String.format("Wrong record length %d", length));
+        }
+        if (buffer.remaining() < Integer.BYTES + length) {
+            map(base + buffer.position(), Integer.BYTES + length);
+            if (buffer.remaining() < Integer.BYTES + length) {
+                throw new IOException("Truncated dump file");
+            }
+        }
+        try {
+            return read(buffer);
+        } catch (IllegalArgumentException e) {
+            throw new IOException(e.getMessage(), e);
+        }
+    }
+}
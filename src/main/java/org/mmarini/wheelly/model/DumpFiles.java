@@ -0,0 +1,356 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.core.FlowableSubscriber;
+import io.reactivex.rxjava3.schedulers.Schedulers;
+import io.reactivex.rxjava3.schedulers.Timed;
+import io.reactivex.rxjava3.subscribers.DefaultSubscriber;
+import org.mmarini.Tuple2;
+
+import java.awt.geom.Point2D;
+import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static org.mmarini.wheelly.model.FileFunctions.WRITE_MONITOR_INTERVAL;
+import static org.mmarini.wheelly.model.FileFunctions.logger;
+
+/**
+ * The binary dump files.
+ * <p>
+ * The file starts with the {@link #MAGIC} bytes and the format version followed by the length prefixed records,
+ * the multi byte fields are little endian.
+ * Each record holds the same data of the csv dump line (see {@link FileFunctions#toString(Tuple2)}).
+ * <pre>
+ *     offset type  field
+ *     0      i32   record length (bytes following the length)
+ *     4      i64   timestamp (ms)
+ *     12     f64   x location
+ *     20     f64   y location
+ *     28     i32   yaw (DEG)
+ *     32     i32   sensor direction (DEG)
+ *     36     f64   distance
+ *     44     f64   left speed
+ *     52     f64   right speed
+ *     60     i32   contact signals
+ *     64     u8    flags (bit 0 cannot move forward, bit 1 cannot move backward, bit 2 imu failure, bit 3 halt,
+ *                  bit 4 halt command)
+ *     65     i32   move direction (DEG)
+ *     69     f64   move speed
+ *     77     i32   next sensor direction (DEG)
+ *     81     i32   move command direction (DEG)
+ *     85     f64   move command speed
+ *     93     i32   sensor command direction (DEG)
+ *     97     i32   number of obstacles
+ *     101    ...   obstacles (f64 x, f64 y, i64 timestamp, f64 likelihood)
+ * </pre>
+ * </p>
+ */
+public interface DumpFiles {
+    byte[] MAGIC = {'W', 'D', 'M', 'P'};
+    int VERSION = 1;
+    int HEADER_SIZE = 8;
+    int FIXED_RECORD_SIZE = 101;
+    int OBSTACLE_SIZE = 32;
+    String EXTENSION = ".wdmp";
+    ByteOrder BYTE_ORDER = ByteOrder.LITTLE_ENDIAN;
+
+    int CANNOT_MOVE_FORWARD_FLAG = 1;
+    int CANNOT_MOVE_BACKWARD_FLAG = 2;
+    int IMU_FAILURE_FLAG = 4;
+    int HALT_FLAG = 8;
+    int HALT_COMMAND_FLAG = 16;
+
+    /**
+     * Appends the records to a binary dump file writing the header if the file is empty
+     *
+     * @param file    the file
+     * @param records the records
+     */
+    static void append(File file, List<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> records) throws IOException {
+        boolean empty = file.length() == 0;
+        try (OutputStream out = new BufferedOutputStream(new FileOutputStream(file, true))) {
+            if (empty) {
+                out.write(header());
+            }
+            for (Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record : records) {
+                out.write(toBytes(record));
+            }
+        }
+    }
+
+    /**
+     * Returns the file header
+     */
+    static byte[] header() {
+        return ByteBuffer.allocate(HEADER_SIZE).order(BYTE_ORDER)
+                .put(MAGIC)
+                .putInt(VERSION)
+                .array();
+    }
+
+    /**
+     * Returns true if the file is a binary dump file (starts with the magic bytes)
+     *
+     * @param file the file
+     */
+    static boolean isBinary(File file) throws IOException {
+        try (InputStream in = new FileInputStream(file)) {
+            byte[] magic = in.readNBytes(MAGIC.length);
+            return isMagic(ByteBuffer.wrap(magic), 0);
+        }
+    }
+
+    /**
+     * Returns true if the file name has the binary dump extension
+     *
+     * @param file the file
+     */
+    static boolean isBinaryName(File file) {
+        return file.getName().endsWith(EXTENSION);
+    }
+
+    /**
+     * Returns true if the buffer contains the magic bytes at the offset
+     *
+     * @param bfr    the buffer
+     * @param offset the offset
+     */
+    static boolean isMagic(ByteBuffer bfr, int offset) {
+        if (bfr.limit() - offset < MAGIC.length) {
+            return false;
+        }
+        for (int i = 0; i < MAGIC.length; i++) {
+            if (bfr.get(offset + i) != MAGIC[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the record at the buffer position advancing the position to the next record
+     *
+     * @param bfr the buffer (little endian)
+     */
+    static Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> read(ByteBuffer bfr) {
+        int length = bfr.getInt();
+        if (length < FIXED_RECORD_SIZE - Integer.BYTES || length > bfr.remaining()) {
+            throw new IllegalArgumentException(String.format("Wrong record length %d", length));
+        }
+        long timestamp = bfr.getLong();
+        double robotX = bfr.getDouble();
+        double robotY = bfr.getDouble();
+        int robotDeg = bfr.getInt();
+        int sensorDeg = bfr.getInt();
+        double distance = bfr.getDouble();
+        double left = bfr.getDouble();
+        double right = bfr.getDouble();
+        int contacts = bfr.getInt();
+        int flags = bfr.get();
+        int moveDeg = bfr.getInt();
+        double moveSpeed = bfr.getDouble();
+        int nextSensorDeg = bfr.getInt();
+        int moveCmdDeg = bfr.getInt();
+        double moveCmdSpeed = bfr.getDouble();
+        int sensorCmdDeg = bfr.getInt();
+        int noObstacles = bfr.getInt();
+        if (length != FIXED_RECORD_SIZE - Integer.BYTES + noObstacles * OBSTACLE_SIZE) {
+            throw new IllegalArgumentException(String.format("Wrong record length %d for %d obstacles", length, noObstacles));
+        }
+        List<Obstacle> obstacles = new ArrayList<>(noObstacles);
+        for (int i = 0; i < noObstacles; i++) {
+            double obsX = bfr.getDouble();
+            double obsY = bfr.getDouble();
+            long obsTimestamp = bfr.getLong();
+            double likelihood = bfr.getDouble();
+            obstacles.add(Obstacle.create(obsX, obsY, obsTimestamp, likelihood));
+        }
+
+        WheellyStatus wheelly = WheellyStatus.create(new Point2D.Double(robotX, robotY),
+                robotDeg,
+                sensorDeg,
+                distance,
+                left, right,
+                contacts, 0,
+                (flags & CANNOT_MOVE_FORWARD_FLAG) == 0,
+                (flags & CANNOT_MOVE_BACKWARD_FLAG) == 0,
+                (flags & IMU_FAILURE_FLAG) != 0,
+                (flags & HALT_FLAG) != 0,
+                moveDeg, moveSpeed,
+                nextSensorDeg);
+        GridScannerMap map = GridScannerMap.create(obstacles, GridScannerMap.THRESHOLD_DISTANCE, GridScannerMap.THRESHOLD_DISTANCE, 0);
+        Timed<MapStatus> timed = new Timed<>(MapStatus.create(wheelly, map), timestamp, TimeUnit.MILLISECONDS);
+        MotionCommand motionCmd = (flags & HALT_COMMAND_FLAG) != 0
+                ? HaltCommand.HALT_COMMAND
+                : MoveCommand.create(moveCmdDeg, moveCmdSpeed);
+        return Tuple2.of(timed, Tuple2.of(motionCmd, sensorCmdDeg));
+    }
+
+    /**
+     * Returns the flow of records of a binary dump file.
+     * The file is memory mapped by windows of {@link DumpFileReader#MAP_WINDOW_SIZE} bytes.
+     *
+     * @param file the file
+     */
+    static Flowable<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> readFile(File file) {
+        return Flowable.<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>, DumpFileReader>generate(
+                        () -> DumpFileReader.open(file),
+                        (reader, emitter) -> {
+                            Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record = reader.next();
+                            if (record != null) {
+                                emitter.onNext(record);
+                            } else {
+                                emitter.onComplete();
+                            }
+                        },
+                        DumpFileReader::close)
+                .subscribeOn(Schedulers.io());
+    }
+
+    /**
+     * Returns the size of the record
+     *
+     * @param record the record
+     */
+    static int recordSize(Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record) {
+        return FIXED_RECORD_SIZE + record._1.value().getMap().getObstacles().size() * OBSTACLE_SIZE;
+    }
+
+    /**
+     * Returns the bytes of the record
+     *
+     * @param record the record
+     */
+    static byte[] toBytes(Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record) {
+        ByteBuffer bfr = ByteBuffer.allocate(recordSize(record)).order(BYTE_ORDER);
+        write(bfr, record);
+        return bfr.array();
+    }
+
+    /**
+     * Writes the record at the buffer position advancing the position
+     *
+     * @param bfr    the buffer (little endian)
+     * @param record the record
+     */
+    static ByteBuffer write(ByteBuffer bfr, Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record) {
+        Timed<MapStatus> status = record._1;
+        WheellyStatus wheelly = status.value().getWheelly();
+        List<Obstacle> obstacles = status.value().getMap().getObstacles();
+        MotionCommand moveCmd = record._2._1;
+        boolean haltCmd = moveCmd instanceof HaltCommand;
+        int flags = (wheelly.getCannotMoveForward() ? CANNOT_MOVE_FORWARD_FLAG : 0)
+                | (wheelly.getCannotMoveBackward() ? CANNOT_MOVE_BACKWARD_FLAG : 0)
+                | (wheelly.isImuFailure() ? IMU_FAILURE_FLAG : 0)
+                | (wheelly.isHalt() ? HALT_FLAG : 0)
+                | (haltCmd ? HALT_COMMAND_FLAG : 0);
+
+        bfr.putInt(FIXED_RECORD_SIZE - Integer.BYTES + obstacles.size() * OBSTACLE_SIZE)
+                .putLong(status.time(TimeUnit.MILLISECONDS))
+                .putDouble(wheelly.getRobotLocation().getX())
+                .putDouble(wheelly.getRobotLocation().getY())
+                .putInt(wheelly.getRobotDeg())
+                .putInt(wheelly.getSensorRelativeDeg())
+                .putDouble(wheelly.getSampleDistance())
+                .putDouble(wheelly.getLeftSpeed())
+                .putDouble(wheelly.getRightSpeed())
+                .putInt(wheelly.getContactSensors())
+                .put((byte) flags)
+                .putInt(wheelly.getMoveDeg())
+                .putDouble(wheelly.getMoveSpeed())
+                .putInt(wheelly.getNextSensorDeg())
+                .putInt(haltCmd ? 0 : ((MoveCommand) moveCmd).direction)
+                .putDouble(haltCmd ? 0 : ((MoveCommand) moveCmd).speed)
+                .putInt(record._2._2)
+                .putInt(obstacles.size());
+        for (Obstacle obstacle : obstacles) {
+            bfr.putDouble(obstacle.getLocation().getX())
+                    .putDouble(obstacle.getLocation().getY())
+                    .putLong(obstacle.getTimestamp())
+                    .putDouble(obstacle.getLikelihood());
+        }
+        return bfr;
+    }
+
+    /**
+     * Returns the subscriber writing the records to a new binary dump file
+     *
+     * @param file the file
+     */
+    static FlowableSubscriber<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> writeFile(File file) throws IOException {
+        OutputStream out = new BufferedOutputStream(new FileOutputStream(file));
+        out.write(header());
+        return new DefaultSubscriber<>() {
+            long last = System.currentTimeMillis() + WRITE_MONITOR_INTERVAL;
+            long count;
+
+            private void close() {
+                try {
+                    out.close();
+                } catch (IOException e) {
+                    logger.error(e.getMessage(), e);
+                }
+            }
+
+            @Override
+            public void onComplete() {
+                logger.info("Written {} records", count);
+                close();
+            }
+
+            @Override
+            public void onError(Throwable throwable) {
+                logger.error(throwable.getMessage(), throwable);
+                close();
+            }
+
+            @Override
+            public void onNext(Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record) {
+                count++;
+                if (System.currentTimeMillis() >= last) {
+                    last += WRITE_MONITOR_INTERVAL;
+                    logger.info("Written {} records", count);
+                }
+                try {
+                    out.write(toBytes(record));
+                } catch (IOException e) {
+                    cancel();
+                    onError(e);
+                }
+            }
+        };
+    }
+}
@@ -42,11 +42,14 @@ import org.slf4j.LoggerFactory;
 
 import java.awt.geom.Point2D;
 import java.io.*;
+import java.nio.charset.StandardCharsets;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
 import java.util.StringJoiner;
 import java.util.concurrent.TimeUnit;
+import java.util.function.Function;
+import java.util.zip.GZIPInputStream;
 
 import static java.lang.Double.parseDouble;
 import static java.lang.Integer.parseInt;
@@ -113,15 +116,31 @@ public interface FileFunctions {
         return Tuple2.of(timed, cmd);
     }
 
+    /**
+     * Returns the records of a dump file.
+     * The binary dump files (see {@link DumpFiles}) are memory mapped, the others are parsed as csv files.
+     *
+     * @param file the file
+     */
     static Flowable<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> readDumpFile(File file) {
-        return readFile(file).map(FileFunctions::fromDumpLine);
+        return Flowable.defer(() -> DumpFiles.isBinary(file)
+                ? DumpFiles.readFile(file)
+                : readFile(file).map(FileFunctions::fromDumpLine));
     }
 
+    /**
+     * Returns the lines of a text file, the files with compressed extension (see {@link RecordWriter}) are
+     * decompressed
+     *
+     * @param file the file
+     */
     static Flowable<String> readFile(File file) {
         try {
-            BufferedReader reader = new BufferedReader(new FileReader(file));
+            BufferedReader reader = RecordWriter.isCompressedName(file)
+                    ? new BufferedReader(new InputStreamReader(new GZIPInputStream(new FileInputStream(file)), StandardCharsets.UTF_8))
+                    : new BufferedReader(new FileReader(file));
             return readFile(reader);
-        } catch (FileNotFoundException e) {
+        } catch (IOException e) {
             return Flowable.error(e);
         }
     }
@@ -201,9 +220,15 @@ public interface FileFunctions {
         return joiner.toString();
     }
 
+    /**
+     * Returns the subscriber appending the lines to a file through a blocking record writer
+     *
+     * @param file the file
+     * @throws IOException in case of error
+     */
     static FlowableSubscriber<String> writeFile(File file) throws IOException {
-        PrintWriter writer = new PrintWriter(new FileWriter(file, true));
-        return writeFile(writer);
+        RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.BLOCK);
+        return writeFiles(new RecordWriter[]{writer}, line -> new String[]{line});
     }
 
     static FlowableSubscriber<String> writeFile(PrintWriter writer) {
@@ -235,17 +260,65 @@ public interface FileFunctions {
         };
     }
 
+    /**
+     * Returns the subscriber appending the lines to the files through blocking record writers
+     *
+     * @param files the files
+     */
     static FlowableSubscriber<String[]> writeFiles(File[] files) {
-        PrintWriter[] printers = Arrays.stream(files)
+        RecordWriter[] writers = Arrays.stream(files)
                 .map(file -> {
                     try {
-                        return new PrintWriter(new FileWriter(file, true));
+                        return RecordWriter.create(file, RecordWriter.OverflowPolicy.BLOCK);
                     } catch (IOException e) {
                         throw new RuntimeException(e);
                     }
                 })
-                .toArray(PrintWriter[]::new);
-        return writeFiles(printers);
+                .toArray(RecordWriter[]::new);
+        return writeFiles(writers, lines -> lines);
+    }
+
+    /**
+     * Returns the subscriber appending the lines of each record to the record writers
+     *
+     * @param writers the record writers
+     * @param toLines the function returning the lines of a record
+     * @param <T>     the type of record
+     */
+    private static <T> FlowableSubscriber<T> writeFiles(RecordWriter[] writers, Function<T, String[]> toLines) {
+        return new DefaultSubscriber<>() {
+            long last = System.currentTimeMillis() + WRITE_MONITOR_INTERVAL;
+            long count;
+
+            @Override
+            public void onComplete() {
+                logger.info("Written {} records", count);
+                for (RecordWriter writer : writers) {
+                    writer.close();
+                }
+            }
+
+            @Override
+            public void onError(Throwable throwable) {
+                Utils.logger.error(throwable.getMessage(), throwable);
+                for (RecordWriter writer : writers) {
+                    writer.close();
+                }
+            }
+
+            @Override
+            public void onNext(T record) {
+                count++;
+                if (System.currentTimeMillis() >= last) {
+                    last += WRITE_MONITOR_INTERVAL;
+                    logger.info("Written {} records", count);
+                }
+                String[] lines = toLines.apply(record);
+                for (int i = 0; i < min(writers.length, lines.length); i++) {
+                    writers[i].writeLine(lines[i]);
+                }
+            }
+        };
     }
 
     static FlowableSubscriber<String[]> writeFiles(PrintWriter[] writers) {
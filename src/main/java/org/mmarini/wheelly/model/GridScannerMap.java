@@ -47,6 +47,16 @@ import static java.util.Objects.requireNonNull;
 import static java.util.stream.Stream.concat;
 import static org.mmarini.wheelly.model.FuzzyFunctions.*;
 
+/**
+ * The scanner map of obstacles arranged in a grid.
+ * <p>
+ * The map versions are persistent: each version produced by {@link #process(Timed)} shares the unchanged tiles
+ * of the obstacle grid and the cache of prohibited areas with its parent and holds the grid of the parent
+ * to compute the change set ({@link #getChangedCells()}).
+ * The versions with the same grid share the derived obstacle list and a sample that changes nothing returns
+ * the same version.
+ * </p>
+ */
 public class GridScannerMap implements ScannerMap {
     public static final double MAX_DISTANCE = 3;
     public static final double THRESHOLD_DISTANCE = 0.2;
@@ -56,6 +66,8 @@ public class GridScannerMap implements ScannerMap {
     public static final double THRESHOLD_LIKELIHOOD = 10e-3;
     public static final long HOLD_DURATION = 60000;
     public static final double LIKELIHOOD_TAU = HOLD_DURATION / 2000.;
+    public static final int UNLIMITED = Integer.MAX_VALUE;
+    private static final ThreadLocal<ObstacleBatch> BATCHES = ThreadLocal.withInitial(ObstacleBatch::new);
 
     public static Point cell(Point2D location, double gridSize) {
         double x = location.getX();
@@ -66,10 +78,44 @@ public class GridScannerMap implements ScannerMap {
     }
 
     /**
-     * Returns an empty map
+     * Returns a map with the given obstacles
+     * Only the first obstacle of each cell is retained in the map.
+     *
+     * @param obstacles           the list of obstacles
+     * @param gridSize            the grid size m
+     * @param safeDistance        the safe distance m
+     * @param likelihoodThreshold the likelihood threshold
      */
     public static GridScannerMap create(List<Obstacle> obstacles, double gridSize, double safeDistance, double likelihoodThreshold) {
-        return new GridScannerMap(obstacles, gridSize, safeDistance, likelihoodThreshold);
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        for (Obstacle obstacle : obstacles) {
+            Point cell = cell(obstacle.location, gridSize);
+            builder.putIfAbsent(cell.x, cell.y, obstacle);
+        }
+        return new GridScannerMap(builder.build(), null, gridSize, safeDistance, likelihoodThreshold, UNLIMITED, UNLIMITED,
+                new ProhibitedAreaCache(), null);
+    }
+
+    /**
+     * Returns the maximum distance of obstacles eligible for update by a sample
+     *
+     * @param sampleDistance the sample distance
+     */
+    private static double eligibleDistance(double sampleDistance) {
+        return sampleDistance > 0
+                ? sampleDistance + THRESHOLD_DISTANCE + FUZZY_THRESHOLD_DISTANCE
+                : MAX_DISTANCE;
+    }
+
+    /**
+     * Returns true if the obstacle is eligible for update by a sample
+     *
+     * @param properties     the obstacle sample properties
+     * @param sampleDistance the sample distance
+     */
+    private static boolean isEligible(ObstacleSampleProperties properties, double sampleDistance) {
+        return abs(properties.obstacleSensorRad) <= NO_SENSITIVITY_ANGLE
+                && properties.robotObstacleDistance < eligibleDistance(sampleDistance);
     }
 
     public static Point2D snapToGrid(Point2D location, double gridSize) {
@@ -78,29 +124,50 @@ public class GridScannerMap implements ScannerMap {
     }
 
     public final double gridSize;
-    public final List<Obstacle> obstacles;
+    private final ObstacleGrid grid;
+    private final ObstacleGrid parentGrid;
     private final double safeDistance;
     private final double likelihoodThreshold;
-    private final LazyValue<Set<Point>> prohibited;
-    private final LazyValue<Set<Point>> contours;
+    private final int maxTiles;
+    private final int maxObstacles;
+    private final ProhibitedAreaCache areaCache;
+    private final LazyValue<List<Obstacle>> obstacles;
+    private final LazyValue<ProhibitedArea> prohibitedArea;
+    private final LazyValue<List<Point>> changedCells;
 
     /**
      * Creates a scanner map
      *
-     * @param obstacles           the list of obstacles
+     * @param grid                the grid of obstacles
+     * @param parentGrid          the grid of obstacles of the parent version or null if none
+     * @param gridSize            the grid size m
      * @param safeDistance        the safe distance m
      * @param likelihoodThreshold the likelihood threshold
+     * @param maxTiles            the maximum number of tiles
+     * @param maxObstacles        the maximum number of obstacles
+     * @param areaCache           the cache of prohibited areas shared by the map versions
+     * @param obstacles           the obstacle list of the grid shared by the versions or null if not shared
      */
-    protected GridScannerMap(List<Obstacle> obstacles, double gridSize, double safeDistance, double likelihoodThreshold) {
-        this.obstacles = requireNonNull(obstacles);
+    protected GridScannerMap(ObstacleGrid grid, ObstacleGrid parentGrid, double gridSize, double safeDistance, double likelihoodThreshold,
+                             int maxTiles, int maxObstacles, ProhibitedAreaCache areaCache, LazyValue<List<Obstacle>> obstacles) {
+        this.grid = requireNonNull(grid);
+        this.parentGrid = parentGrid;
         this.gridSize = gridSize;
         this.safeDistance = safeDistance;
         this.likelihoodThreshold = likelihoodThreshold;
-        this.prohibited = new LazyValue<>(() ->
-                ProhibitedCellFinder.create(this, this.safeDistance, this.likelihoodThreshold).find()
+        this.maxTiles = maxTiles;
+        this.maxObstacles = maxObstacles;
+        this.areaCache = requireNonNull(areaCache);
+        this.obstacles = obstacles != null
+                ? obstacles
+                : new LazyValue<>(() -> grid.stream().collect(Collectors.toUnmodifiableList()));
+        this.prohibitedArea = new LazyValue<>(() ->
+                areaCache.get(grid, gridSize, this.safeDistance, this.likelihoodThreshold)
         );
-        this.contours = new LazyValue<>(() ->
-                ProhibitedCellFinder.findContour(getProhibited())
+        this.changedCells = new LazyValue<>(() ->
+                parentGrid != null
+                        ? grid.changedCells(parentGrid)
+                        : getCells().collect(Collectors.toList())
         );
     }
 
@@ -113,6 +180,31 @@ public class GridScannerMap implements ScannerMap {
     }
 
     /**
+     * Returns the batch of the obstacles within the sensor cone of the sample eligible for update.
+     * Only the cells in the range of the sensor are scanned.
+     *
+     * @param sample the sample
+     * @param batch  the batch workspace
+     */
+    ObstacleBatch coneObstacles(Timed<? extends ProxySample> sample, ObstacleBatch batch) {
+        ProxySample value = sample.value();
+        double distance = eligibleDistance(value.getSampleDistance());
+        Point2D robotLocation = value.getRobotLocation();
+        double robotX = robotLocation.getX();
+        double robotY = robotLocation.getY();
+        int minI = (int) floor((robotX - distance) / gridSize);
+        int minJ = (int) floor((robotY - distance) / gridSize);
+        int maxI = (int) ceil((robotX + distance) / gridSize);
+        int maxJ = (int) ceil((robotY + distance) / gridSize);
+        batch.clear();
+        grid.forEach(minI, minJ, maxI, maxJ, batch::add);
+        return batch.computeProperties(robotX, robotY, value.getSensorRad())
+                .retainEligibles(distance);
+    }
+
+    /**
+     * Returns all the obstacles of the map updated by the sample
+     *
      * @param sample the sample
      */
     Stream<Obstacle> createObstacles(Timed<? extends ProxySample> sample) {
@@ -121,81 +213,129 @@ public class GridScannerMap implements ScannerMap {
         double sampleDistance = sample.value().getSampleDistance();
         // Split the eligible obstacles
         Map<Boolean, List<ObstacleSampleProperties>> split = obsProps.collect(Collectors.groupingBy(op ->
-                abs(op.obstacleSensorRad) <= NO_SENSITIVITY_ANGLE
-                        && (sampleDistance > 0
-                        ? op.robotObstacleDistance < sampleDistance + THRESHOLD_DISTANCE + FUZZY_THRESHOLD_DISTANCE
-                        : op.robotObstacleDistance < MAX_DISTANCE)
-        ));
+                isEligible(op, sampleDistance)));
         List<ObstacleSampleProperties> eligibles = Utils.getValue(split, true).orElseGet(List::of);
         List<ObstacleSampleProperties> notEligibles = Utils.getValue(split, false).orElseGet(List::of);
 
-        Optional<Point2D> arrangedLocation = sample.value().getSampleLocation().map(this::arrangeLocation);
-        boolean hasTarget = arrangedLocation.stream().anyMatch(location ->
-                eligibles.stream()
-                        .map(ObstacleSampleProperties::getObstacle)
-
-                        .map(Obstacle::getLocation)
-                        .anyMatch(location::equals));
-
-        long sampleTimestamp = sample.time(TimeUnit.MILLISECONDS);
-
-        List<Obstacle> newObstacles = sample.value().getSampleLocation().map(sampleLocation -> {
-            // sample present: reinforce the obstacles near the sample location and weakening the obstacles before the sample location
-            List<Obstacle> obs = eligibles.stream()
-                    .map(reinforcedObstacle(sampleTimestamp, sampleDistance))
-                    .collect(Collectors.toList());
-            if (!hasTarget) {
-                // Add a new obstacle if target is not present
-                Point2D location = arrangeLocation(sampleLocation);
-                obs.add(Obstacle.create(location, sampleTimestamp, 1));
-            }
-            return obs;
-        }).orElseGet(() -> {
-            // Empty sample: weakening the obstacle in sensor trajectory
-            return eligibles.stream()
-                    .map(weakSample(sampleTimestamp))
-                    .collect(Collectors.toList());
-        });
-
         // Filter out the older obstacle and poor likelihood
         return concat(
                 notEligibles.stream().map(ObstacleSampleProperties::getObstacle),
-                newObstacles.stream());
+                concat(updateEligibles(sample, eligibles).stream(),
+                        newEchoObstacle(sample, eligibles).stream()));
+    }
+
+    /**
+     * Returns the cells whose obstacles changed from the parent version (all the cells if no parent)
+     */
+    public List<Point> getChangedCells() {
+        return changedCells.get();
     }
 
     public Stream<Point> getCells() {
-        return obstacles.stream()
+        return grid.stream()
                 .map(Obstacle::getLocation)
                 .map(this::cell);
     }
 
     public Set<Point> getContours() {
-        return contours.get();
+        return prohibitedArea.get().getContours();
+    }
+
+    /**
+     * Returns the grid of obstacles
+     */
+    public ObstacleGrid getGrid() {
+        return grid;
     }
 
     @Override
     public List<Obstacle> getObstacles() {
-        return obstacles;
+        return obstacles.get();
+    }
+
+    /**
+     * Returns the obstacles within a distance from a location.
+     * Only the tiles intersecting the range are scanned.
+     *
+     * @param center the center location
+     * @param radius the distance (m)
+     */
+    public List<Obstacle> getObstacles(Point2D center, double radius) {
+        List<Obstacle> result = new ArrayList<>();
+        Point cell = cell(center);
+        grid.forEachWithin(cell.x, cell.y, (int) ceil(radius / gridSize) + 1, obstacle -> {
+            if (obstacle.location.distance(center) <= radius) {
+                result.add(obstacle);
+            }
+        });
+        return result;
     }
 
     public Set<Point> getProhibited() {
-        return prohibited.get();
+        return prohibitedArea.get().getProhibited();
+    }
+
+    /**
+     * Returns the predicate of the prohibited cells.
+     * The cells are tested on the tiles of the prohibited area without allocating points.
+     */
+    public CellPredicate getProhibitedCells() {
+        return prohibitedArea.get()::isProhibited;
+    }
+
+    /**
+     * Returns the prohibited area for the safe distance and likelihood threshold of the map
+     */
+    public ProhibitedArea getProhibitedArea() {
+        return prohibitedArea.get();
     }
 
     public boolean isObstacleAt(Point2D target) {
         Point cell = cell(target);
-        return obstacles.stream()
-                .map(Obstacle::getLocation)
-                .map(this::cell)
-                .anyMatch(cell::equals);
+        return grid.get(cell.x, cell.y) != null;
     }
 
     public boolean isProhibited(Point2D robotLocation) {
-        return getProhibited().contains(cell(robotLocation));
+        Point cell = cell(robotLocation);
+        return prohibitedArea.get().isProhibited(cell.x, cell.y);
     }
 
-    protected GridScannerMap newInstance(List<Obstacle> obstacles) {
-        return new GridScannerMap(obstacles, gridSize, safeDistance, likelihoodThreshold);
+    /**
+     * Returns the new obstacle at the echo location if the echo location is not already an eligible obstacle
+     *
+     * @param sample    the sample
+     * @param eligibles the eligible obstacles
+     */
+    private Optional<Obstacle> newEchoObstacle(Timed<? extends ProxySample> sample, List<ObstacleSampleProperties> eligibles) {
+        return sample.value().getSampleLocation()
+                .map(this::arrangeLocation)
+                .filter(location ->
+                        eligibles.stream()
+                                .map(ObstacleSampleProperties::getObstacle)
+                                .map(Obstacle::getLocation)
+                                .noneMatch(location::equals))
+                .map(location -> Obstacle.create(location, sample.time(TimeUnit.MILLISECONDS), 1));
+    }
+
+    /**
+     * Returns the child version with a new grid
+     *
+     * @param grid the grid
+     */
+    protected GridScannerMap newInstance(ObstacleGrid grid) {
+        return new GridScannerMap(grid, this.grid, gridSize, safeDistance, likelihoodThreshold, maxTiles, maxObstacles, areaCache, null);
+    }
+
+    /**
+     * Returns the version with the same grid and different parameters sharing the derived values
+     *
+     * @param safeDistance        the safe distance m
+     * @param likelihoodThreshold the likelihood threshold
+     * @param maxTiles            the maximum number of tiles
+     * @param maxObstacles        the maximum number of obstacles
+     */
+    private GridScannerMap newInstance(double safeDistance, double likelihoodThreshold, int maxTiles, int maxObstacles) {
+        return new GridScannerMap(grid, parentGrid, gridSize, safeDistance, likelihoodThreshold, maxTiles, maxObstacles, areaCache, obstacles);
     }
 
     /**
@@ -205,27 +345,62 @@ public class GridScannerMap implements ScannerMap {
      */
     Stream<ObstacleSampleProperties> obstacleSampleProperties(Timed<? extends ProxySample> sample) {
         ProxySample value = sample.value();
-        return obstacles.stream()
+        return grid.stream()
                 .map(o -> ObstacleSampleProperties.from(o, value));
     }
 
+    /**
+     * Returns the map updated by a sample.
+     * Only the cells within the sensor cone are updated by the batch kernel of {@link ObstacleBatch},
+     * the older obstacles and the obstacles with poor likelihood are removed.
+     * The map is returned if the sample changes no obstacle.
+     *
+     * @param sample the sample
+     */
     @Override
     public GridScannerMap process(Timed<? extends WheellyStatus> sample) {
         requireNonNull(sample);
+        long sampleTimestamp = sample.time(TimeUnit.MILLISECONDS);
+        long holdTimestamp = sampleTimestamp - HOLD_DURATION;
+        ObstacleGrid.Builder builder = grid.builder();
+
+        ObstacleBatch eligibles = coneObstacles(sample, BATCHES.get());
+        Optional<Point2D> sampleLocation = sample.value().getSampleLocation();
+        if (sampleLocation.isPresent()) {
+            eligibles.reinforce(sampleTimestamp, sample.value().getSampleDistance());
+        } else {
+            eligibles.weaken(sampleTimestamp);
+        }
+        for (int i = 0; i < eligibles.size(); i++) {
+            Point2D location = eligibles.getObstacle(i).location;
+            double likelihood = eligibles.getUpdatedLikelihood(i);
+            Point cell = cell(location);
+            if (likelihood >= THRESHOLD_LIKELIHOOD) {
+                builder.put(cell.x, cell.y, Obstacle.create(location, sampleTimestamp, likelihood));
+            } else {
+                builder.remove(cell.x, cell.y);
+            }
+        }
+        sampleLocation.map(this::arrangeLocation)
+                .filter(location -> !eligibles.contains(location.getX(), location.getY()))
+                .ifPresent(location -> {
+                    Point cell = cell(location);
+                    builder.putIfAbsent(cell.x, cell.y, Obstacle.create(location, sampleTimestamp, 1));
+                });
+        eligibles.clear();
+        for (Point2D contact : sample.value().getContactObstacles()) {
+            Point cell = cell(contact);
+            // The contacts refresh their cells, so they are never removed as expired
+            builder.put(cell.x, cell.y, Obstacle.create(toPoint(cell), sampleTimestamp, 1));
+        }
         // Filter out the older obstacle and poor likelihood
-        long holdTimestamp = sample.time(TimeUnit.MILLISECONDS) - HOLD_DURATION;
-        Stream<Obstacle> scannerObstacles =
-                createObstacles(sample)
-                        .filter(o -> o.timestamp >= holdTimestamp)
-                        .filter(o -> o.getLikelihood() >= THRESHOLD_LIKELIHOOD);
-        Stream<Obstacle> contacts = sample.value().getContactObstacles().stream()
-                .map(this::cell)
-                .map(this::toPoint)
-                .map(pt -> Obstacle.create(pt, sample.time(TimeUnit.MILLISECONDS), 1));
-        return newInstance(
-                new ArrayList<>(
-                        concat(scannerObstacles, contacts).
-                                collect(Collectors.toSet())));
+        builder.removeExpired(holdTimestamp, THRESHOLD_LIKELIHOOD);
+        if (maxTiles != UNLIMITED || maxObstacles != UNLIMITED) {
+            Point robotCell = cell(sample.value().getRobotLocation());
+            builder.evict(maxTiles, maxObstacles, robotCell.x, robotCell.y);
+        }
+        ObstacleGrid newGrid = builder.build();
+        return newGrid != grid ? newInstance(newGrid) : this;
     }
 
     /**
@@ -258,18 +433,50 @@ public class GridScannerMap implements ScannerMap {
         };
     }
 
+    /**
+     * Returns the map with the memory limits.
+     * The least recently updated tiles farthest from the robot are evicted when the limits are exceeded
+     *
+     * @param maxTiles     the maximum number of tiles or {@link #UNLIMITED}
+     * @param maxObstacles the maximum number of obstacles or {@link #UNLIMITED}
+     */
+    public GridScannerMap setLimits(int maxTiles, int maxObstacles) {
+        return this.maxTiles != maxTiles || this.maxObstacles != maxObstacles
+                ? newInstance(safeDistance, likelihoodThreshold, maxTiles, maxObstacles)
+                : this;
+    }
+
     public GridScannerMap setLikelihoodThreshold(double likelihoodThreshold) {
-        return this.likelihoodThreshold != likelihoodThreshold ? new GridScannerMap(obstacles, gridSize, safeDistance, likelihoodThreshold) : this;
+        return this.likelihoodThreshold != likelihoodThreshold ? newInstance(safeDistance, likelihoodThreshold, maxTiles, maxObstacles) : this;
     }
 
     public GridScannerMap setSafeDistance(double safeDistance) {
-        return this.safeDistance != safeDistance ? new GridScannerMap(obstacles, gridSize, safeDistance, likelihoodThreshold) : this;
+        return this.safeDistance != safeDistance ? newInstance(safeDistance, likelihoodThreshold, maxTiles, maxObstacles) : this;
     }
 
     public Point2D toPoint(Point cell) {
         return new Point2D.Double(cell.x * gridSize, cell.y * gridSize);
     }
 
+    /**
+     * Returns the eligible obstacles updated by the sample:
+     * the obstacles near the sample location are reinforced and the obstacles before the sample location are weakened,
+     * the obstacles in the sensor trajectory are weakened if the sample is empty
+     *
+     * @param sample    the sample
+     * @param eligibles the eligible obstacles
+     */
+    private List<Obstacle> updateEligibles(Timed<? extends ProxySample> sample, List<ObstacleSampleProperties> eligibles) {
+        long sampleTimestamp = sample.time(TimeUnit.MILLISECONDS);
+        double sampleDistance = sample.value().getSampleDistance();
+        Function<ObstacleSampleProperties, Obstacle> update = sample.value().getSampleLocation().isPresent()
+                ? reinforcedObstacle(sampleTimestamp, sampleDistance)
+                : weakSample(sampleTimestamp);
+        return eligibles.stream()
+                .map(update)
+                .collect(Collectors.toList());
+    }
+
     /**
      * Returns the creator of a weak sample
      *
@@ -0,0 +1,230 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.HdrHistogram.Histogram;
+import org.HdrHistogram.Recorder;
+
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.Map;
+import java.util.StringJoiner;
+
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The latency recorder of the control loop stages.
+ * <p>
+ * The latencies are recorded in micro seconds by wait free HDR histogram recorders, one per stage,
+ * and are collected as interval histograms by {@link #report(long)}.
+ * </p>
+ */
+public class LatencyMonitor {
+    public static final long MAX_LATENCY_US = 60_000_000L;
+    public static final int SIGNIFICANT_DIGITS = 2;
+    public static final String CSV_HEADER = "timestamp,stage,count,p50,p90,p99,p999,max";
+
+    /**
+     * Returns the latency monitor
+     */
+    public static LatencyMonitor create() {
+        return new LatencyMonitor();
+    }
+
+    private final Map<Stage, Recorder> recorders;
+    private final Map<Stage, Histogram> intervals;
+
+    /**
+     * Creates the latency monitor
+     */
+    protected LatencyMonitor() {
+        this.recorders = new EnumMap<>(Stage.class);
+        this.intervals = new EnumMap<>(Stage.class);
+        for (Stage stage : Stage.values()) {
+            recorders.put(stage, new Recorder(MAX_LATENCY_US, SIGNIFICANT_DIGITS));
+        }
+    }
+
+    /**
+     * Records the latency of a stage (ms)
+     *
+     * @param stage  the stage
+     * @param millis the latency (ms)
+     */
+    public LatencyMonitor recordMillis(Stage stage, long millis) {
+        return recordMicros(stage, millis * 1000);
+    }
+
+    /**
+     * Records the latency of a stage (us)
+     * The negative latencies (clock adjustments) are ignored and the latencies over the maximum are clamped
+     *
+     * @param stage  the stage
+     * @param micros the latency (us)
+     */
+    public LatencyMonitor recordMicros(Stage stage, long micros) {
+        if (micros >= 0) {
+            recorders.get(stage).recordValue(Math.min(micros, MAX_LATENCY_US));
+        }
+        return this;
+    }
+
+    /**
+     * Records the latency of a stage (ns)
+     *
+     * @param stage the stage
+     * @param nanos the latency (ns)
+     */
+    public LatencyMonitor recordNanos(Stage stage, long nanos) {
+        return recordMicros(stage, nanos / 1000);
+    }
+
+    /**
+     * Returns the report of latencies recorded since the previous report.
+     * The report histograms are owned by the report, the method should be called by a single thread
+     *
+     * @param timestamp the report timestamp (ms)
+     */
+    public synchronized Report report(long timestamp) {
+        Map<Stage, Histogram> histograms = new EnumMap<>(Stage.class);
+        for (Stage stage : Stage.values()) {
+            Histogram interval = recorders.get(stage).getIntervalHistogram(intervals.get(stage));
+            intervals.put(stage, interval);
+            histograms.put(stage, interval.copy());
+        }
+        return new Report(timestamp, histograms);
+    }
+
+    /**
+     * The stages of control loop
+     */
+    public enum Stage {
+        /**
+         * Map update by status
+         */
+        MAP("map"),
+        /**
+         * Wait of the map status from its emission to the inference start, includes the throttling wait.
+         * It is measured by the local monotonic clock, independently of the robot or simulated status time
+         */
+        QUEUE("queue"),
+        /**
+         * Inference engine process
+         */
+        ENGINE("engine"),
+        /**
+         * Interval from the inference to the emission of the changed commands
+         */
+        SAMPLE("sample"),
+        /**
+         * Interval from the emission of command to the socket write (ms resolution)
+         */
+        WRITE("write"),
+        /**
+         * Round trip time of the clock sync exchanges with the robot (ms resolution)
+         */
+        RTT("rtt");
+
+        private final String id;
+
+        Stage(String id) {
+            this.id = id;
+        }
+
+        public String getId() {
+            return id;
+        }
+    }
+
+    /**
+     * The latencies recorded in a time interval
+     */
+    public static class Report {
+        private final long timestamp;
+        private final Map<Stage, Histogram> histograms;
+
+        /**
+         * Creates the report
+         *
+         * @param timestamp  the timestamp (ms)
+         * @param histograms the histograms by stage (us)
+         */
+        protected Report(long timestamp, Map<Stage, Histogram> histograms) {
+            this.timestamp = timestamp;
+            this.histograms = Collections.unmodifiableMap(requireNonNull(histograms));
+        }
+
+        /**
+         * Returns the histogram of a stage (us)
+         *
+         * @param stage the stage
+         */
+        public Histogram getHistogram(Stage stage) {
+            return histograms.get(stage);
+        }
+
+        /**
+         * Returns the latency percentile of a stage (ms)
+         *
+         * @param stage      the stage
+         * @param percentile the percentile (0 - 100)
+         */
+        public double getPercentile(Stage stage, double percentile) {
+            return histograms.get(stage).getValueAtPercentile(percentile) / 1000.0;
+        }
+
+        public long getTimestamp() {
+            return timestamp;
+        }
+
+        /**
+         * Returns the csv records of the report, one per stage with the count and the percentiles (us)
+         * formatted as {@link #CSV_HEADER}
+         */
+        public String[] toCSV() {
+            Stage[] stages = Stage.values();
+            String[] result = new String[stages.length];
+            for (int i = 0; i < stages.length; i++) {
+                Histogram h = histograms.get(stages[i]);
+                result[i] = new StringJoiner(",")
+                        .add(String.valueOf(timestamp))
+                        .add(stages[i].getId())
+                        .add(String.valueOf(h.getTotalCount()))
+                        .add(String.valueOf(h.getValueAtPercentile(50)))
+                        .add(String.valueOf(h.getValueAtPercentile(90)))
+                        .add(String.valueOf(h.getValueAtPercentile(99)))
+                        .add(String.valueOf(h.getValueAtPercentile(99.9)))
+                        .add(String.valueOf(h.getMaxValue()))
+                        .toString();
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,282 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.util.Arrays;
+
+import static java.lang.Math.*;
+import static org.mmarini.wheelly.model.GridScannerMap.*;
+
+/**
+ * The structure of arrays of the obstacles updated by a sample.
+ * <p>
+ * The obstacle coordinates, timestamps and likelihoods are copied in flat arrays and the sample properties
+ * (distance from robot and direction relative to sensor) and the updated likelihoods are computed in batch loops
+ * with the same fuzzy rules and the same floating point operations of {@link ObstacleSampleProperties} and
+ * {@link FuzzyFunctions}, so the results are identical to the per obstacle evaluation.
+ * The batch is a reusable workspace and it is not thread safe.
+ * </p>
+ */
+public class ObstacleBatch {
+    private static final int MIN_CAPACITY = 64;
+    private static final double BETWEEN_X0 = -NO_SENSITIVITY_ANGLE;
+    private static final double BETWEEN_X1 = -MAX_SENSITIVITY_ANGLE;
+    private static final double BETWEEN_X2 = MAX_SENSITIVITY_ANGLE;
+    private static final double BETWEEN_X3 = NO_SENSITIVITY_ANGLE;
+
+    /**
+     * Returns the trapezoidal function of direction sensitivity (same of {@link FuzzyFunctions#between})
+     *
+     * @param x the direction
+     */
+    private static double isOnDirection(double x) {
+        double isPositive = min(max((x - BETWEEN_X0) / (BETWEEN_X1 - BETWEEN_X0), 0), 1);
+        double isNegative = min(max(-(x - BETWEEN_X3) / (BETWEEN_X3 - BETWEEN_X2), 0), 1);
+        return min(min(1, isPositive), isNegative);
+    }
+
+    private int size;
+    private Obstacle[] obstacles;
+    private double[] x;
+    private double[] y;
+    private long[] timestamp;
+    private double[] likelihood;
+    private double[] distance;
+    private double[] sensorRad;
+    private double[] updated;
+
+    /**
+     * Creates the batch
+     */
+    public ObstacleBatch() {
+        this.obstacles = new Obstacle[MIN_CAPACITY];
+        this.x = new double[MIN_CAPACITY];
+        this.y = new double[MIN_CAPACITY];
+        this.timestamp = new long[MIN_CAPACITY];
+        this.likelihood = new double[MIN_CAPACITY];
+        this.distance = new double[MIN_CAPACITY];
+        this.sensorRad = new double[MIN_CAPACITY];
+        this.updated = new double[MIN_CAPACITY];
+    }
+
+    /**
+     * Adds an obstacle to the batch
+     *
+     * @param obstacle the obstacle
+     */
+    public ObstacleBatch add(Obstacle obstacle) {
+        if (size >= obstacles.length) {
+            int capacity = obstacles.length * 2;
+            obstacles = Arrays.copyOf(obstacles, capacity);
+            x = Arrays.copyOf(x, capacity);
+            y = Arrays.copyOf(y, capacity);
+            timestamp = Arrays.copyOf(timestamp, capacity);
+            likelihood = Arrays.copyOf(likelihood, capacity);
+            distance = Arrays.copyOf(distance, capacity);
+            sensorRad = Arrays.copyOf(sensorRad, capacity);
+            updated = Arrays.copyOf(updated, capacity);
+        }
+        obstacles[size] = obstacle;
+        x[size] = obstacle.location.getX();
+        y[size] = obstacle.location.getY();
+        timestamp[size] = obstacle.timestamp;
+        likelihood[size] = obstacle.likelihood;
+        size++;
+        return this;
+    }
+
+    /**
+     * Clears the batch releasing the obstacles
+     */
+    public ObstacleBatch clear() {
+        Arrays.fill(obstacles, 0, size, null);
+        size = 0;
+        return this;
+    }
+
+    /**
+     * Computes the distances from the robot and the directions relative to the sensor
+     *
+     * @param robotX      the robot x coordinate
+     * @param robotY      the robot y coordinate
+     * @param sensorAngle the sensor direction (RAD)
+     */
+    public ObstacleBatch computeProperties(double robotX, double robotY, double sensorAngle) {
+        int n = size;
+        double[] x = this.x;
+        double[] y = this.y;
+        double[] distance = this.distance;
+        for (int i = 0; i < n; i++) {
+            double dx = robotX - x[i];
+            double dy = robotY - y[i];
+            distance[i] = sqrt(dx * dx + dy * dy);
+        }
+        double[] sensorRad = this.sensorRad;
+        for (int i = 0; i < n; i++) {
+            sensorRad[i] = Utils.normalizeAngle(atan2(y[i] - robotY, x[i] - robotX) - sensorAngle);
+        }
+        return this;
+    }
+
+    /**
+     * Returns true if the batch contains an obstacle at the location
+     *
+     * @param locationX the x coordinate
+     * @param locationY the y coordinate
+     */
+    public boolean contains(double locationX, double locationY) {
+        for (int i = 0; i < size; i++) {
+            if (x[i] == locationX && y[i] == locationY) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Returns the distance of an obstacle from the robot
+     *
+     * @param index the obstacle index
+     */
+    public double getDistance(int index) {
+        return distance[index];
+    }
+
+    /**
+     * Returns an obstacle
+     *
+     * @param index the obstacle index
+     */
+    public Obstacle getObstacle(int index) {
+        return obstacles[index];
+    }
+
+    /**
+     * Returns the direction of an obstacle relative to the sensor
+     *
+     * @param index the obstacle index
+     */
+    public double getSensorRad(int index) {
+        return sensorRad[index];
+    }
+
+    /**
+     * Returns the updated likelihood of an obstacle
+     *
+     * @param index the obstacle index
+     */
+    public double getUpdatedLikelihood(int index) {
+        return updated[index];
+    }
+
+    /**
+     * Computes the likelihoods of obstacles reinforced by an echo sample:
+     * the obstacles near the echo location are reinforced and the obstacles before the echo location are weakened
+     *
+     * @param sampleTimestamp the sample timestamp
+     * @param sampleDistance  the sample distance
+     */
+    public ObstacleBatch reinforce(long sampleTimestamp, double sampleDistance) {
+        int n = size;
+        double beforeDistance = sampleDistance - THRESHOLD_DISTANCE;
+        double afterDistance = sampleDistance + THRESHOLD_DISTANCE;
+        for (int i = 0; i < n; i++) {
+            double isBeforeSample = min(max(-(distance[i] - beforeDistance) / FUZZY_THRESHOLD_DISTANCE, 0), 1);
+            double isAfterSample = min(max((distance[i] - afterDistance) / FUZZY_THRESHOLD_DISTANCE, 0), 1);
+            double isNearSample = 1 - max(max(0, isBeforeSample), isAfterSample);
+            double isOnDirection = isOnDirection(sensorRad[i]);
+
+            double reinforce = min(min(1, isNearSample), isOnDirection);
+            double weakening = min(min(1, isBeforeSample), isOnDirection);
+            double hold = 1 - max(max(0, reinforce), weakening);
+
+            double t = (sampleTimestamp - timestamp[i]) * 1e-3;
+            double currentLikelihood = likelihood[i] * exp(-t / LIKELIHOOD_TAU);
+            updated[i] = (0 + 1 * reinforce + currentLikelihood * hold + 0 * weakening)
+                    / (0 + reinforce + hold + weakening);
+        }
+        return this;
+    }
+
+    /**
+     * Retains only the obstacles eligible for update by a sample (in the sensor cone and within the distance)
+     *
+     * @param maxDistance the maximum distance (exclusive)
+     */
+    public ObstacleBatch retainEligibles(double maxDistance) {
+        int n = size;
+        int k = 0;
+        for (int i = 0; i < n; i++) {
+            if (abs(sensorRad[i]) <= NO_SENSITIVITY_ANGLE && distance[i] < maxDistance) {
+                if (k != i) {
+                    obstacles[k] = obstacles[i];
+                    x[k] = x[i];
+                    y[k] = y[i];
+                    timestamp[k] = timestamp[i];
+                    likelihood[k] = likelihood[i];
+                    distance[k] = distance[i];
+                    sensorRad[k] = sensorRad[i];
+                }
+                k++;
+            }
+        }
+        Arrays.fill(obstacles, k, n, null);
+        size = k;
+        return this;
+    }
+
+    /**
+     * Returns the number of obstacles
+     */
+    public int size() {
+        return size;
+    }
+
+    /**
+     * Computes the likelihoods of obstacles weakened by an empty sample:
+     * the obstacles in the sensor cone within the maximum distance are weakened
+     *
+     * @param sampleTimestamp the sample timestamp
+     */
+    public ObstacleBatch weaken(long sampleTimestamp) {
+        int n = size;
+        for (int i = 0; i < n; i++) {
+            double isOnDirection = isOnDirection(abs(sensorRad[i]));
+            double isInRange = min(max(-(distance[i] - MAX_DISTANCE) / FUZZY_THRESHOLD_DISTANCE, 0), 1);
+            double weakening = min(min(1, isOnDirection), isInRange);
+            double t = (sampleTimestamp - timestamp[i]) * 1e-3;
+            double currentLikelihood = likelihood[i] * exp(-t / LIKELIHOOD_TAU);
+            double notWeakening = 1 - weakening;
+            updated[i] = (0 + currentLikelihood * notWeakening + 0 * weakening)
+                    / (0 + notWeakening + weakening);
+        }
+        return this;
+    }
+}
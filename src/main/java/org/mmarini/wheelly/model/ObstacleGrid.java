@@ -0,0 +1,788 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.*;
+import java.util.List;
+import java.util.*;
+import java.util.function.Consumer;
+import java.util.stream.Stream;
+
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The obstacles indexed by grid cell.
+ * <p>
+ * The cells are grouped in square tiles of {@link #TILE_SIZE} x {@link #TILE_SIZE} cells.
+ * The tiles are held in an open-addressed hash table keyed by the packed tile coordinates.
+ * The grid is immutable: the changes are applied by a {@link Builder} that copies only the tiles it modifies,
+ * so each version of the grid shares the untouched tiles with the previous one.
+ * The tiles are indexed by their minimum obstacle timestamp and likelihood in persistent min heaps,
+ * so the removal of the expired obstacles touches only the expiring tiles.
+ * The memory may be bounded by evicting the least recently updated tiles farthest from a center cell
+ * ({@link Builder#evict(int, int, int, int)}).
+ * </p>
+ */
+public class ObstacleGrid {
+    public static final int TILE_BITS = 4;
+    public static final int TILE_SIZE = 1 << TILE_BITS;
+    static final int TILE_MASK = TILE_SIZE - 1;
+    static final int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+    private static final int MIN_CAPACITY = 16;
+    private static final ObstacleGrid EMPTY = new ObstacleGrid(new int[MIN_CAPACITY], new Tile[MIN_CAPACITY], 0, 0, null, null);
+
+    /**
+     * Returns the empty grid
+     */
+    public static ObstacleGrid empty() {
+        return EMPTY;
+    }
+
+    /**
+     * Returns the index of a cell within its tile
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    static int localIndex(int i, int j) {
+        return ((i & TILE_MASK) << TILE_BITS) | (j & TILE_MASK);
+    }
+
+    /**
+     * Returns the cell location
+     *
+     * @param key the tile key
+     * @param k   the local index
+     */
+    static Point location(int key, int k) {
+        return new Point(((key >> 16) << TILE_BITS) | (k >> TILE_BITS), ((short) key << TILE_BITS) | (k & TILE_MASK));
+    }
+
+    /**
+     * Returns the square distance from a cell to the nearest cell of a rectangle
+     *
+     * @param i  the cell x index
+     * @param j  the cell y index
+     * @param i0 the minimum x index of rectangle
+     * @param j0 the minimum y index of rectangle
+     * @param i1 the maximum x index of rectangle
+     * @param j1 the maximum y index of rectangle
+     */
+    static long distanceSq(int i, int j, int i0, int j0, int i1, int j1) {
+        long di = i < i0 ? i0 - i : i > i1 ? i - i1 : 0;
+        long dj = j < j0 ? j0 - j : j > j1 ? j - j1 : 0;
+        return di * di + dj * dj;
+    }
+
+    /**
+     * Returns the slot of a tile key in a table
+     *
+     * @param key      the tile key
+     * @param capacity the table capacity (power of 2)
+     */
+    private static int slot(int key, int capacity) {
+        int h = key * 0x9E3779B9;
+        return (h ^ (h >>> 16)) & (capacity - 1);
+    }
+
+    /**
+     * Returns the key of a tile
+     *
+     * @param ti the tile x index
+     * @param tj the tile y index
+     */
+    static int tileKey(int ti, int tj) {
+        return (ti << 16) | (tj & 0xffff);
+    }
+
+    /**
+     * Returns the slot of a tile in a table or -(insertion slot + 1) if the tile is not in the table
+     *
+     * @param keys  the keys table
+     * @param tiles the tiles table
+     * @param key   the tile key
+     */
+    static int findSlot(int[] keys, Object[] tiles, int key) {
+        int capacity = tiles.length;
+        int idx = slot(key, capacity);
+        while (tiles[idx] != null) {
+            if (keys[idx] == key) {
+                return idx;
+            }
+            idx = (idx + 1) & (capacity - 1);
+        }
+        return -idx - 1;
+    }
+
+    private final int[] keys;
+    private final Tile[] tiles;
+    private final int tileCount;
+    private final int size;
+    private final TileHeap timestamps;
+    private final TileHeap likelihoods;
+
+    /**
+     * Creates the grid
+     *
+     * @param keys        the tile keys
+     * @param tiles       the tiles
+     * @param tileCount   the number of tiles
+     * @param size        the number of obstacles
+     * @param timestamps  the heap of tiles by minimum timestamp
+     * @param likelihoods the heap of tiles by minimum likelihood
+     */
+    protected ObstacleGrid(int[] keys, Tile[] tiles, int tileCount, int size, TileHeap timestamps, TileHeap likelihoods) {
+        this.keys = keys;
+        this.tiles = tiles;
+        this.tileCount = tileCount;
+        this.size = size;
+        this.timestamps = timestamps;
+        this.likelihoods = likelihoods;
+    }
+
+    /**
+     * Returns the cells of a tile or null if the tile does not exist
+     *
+     * @param key the tile key
+     */
+    Obstacle[] cells(int key) {
+        int idx = findSlot(keys, tiles, key);
+        return idx >= 0 ? tiles[idx].cells : null;
+    }
+
+    /**
+     * Returns the cells of a tile in a slot of the table or null if the slot is empty
+     *
+     * @param slot the slot
+     */
+    Obstacle[] cellsAt(int slot) {
+        return tiles[slot] != null ? tiles[slot].cells : null;
+    }
+
+    /**
+     * Returns the capacity of the tile table
+     */
+    int capacity() {
+        return tiles.length;
+    }
+
+    /**
+     * Returns the tile key in a slot of the table
+     *
+     * @param slot the slot
+     */
+    int keyAt(int slot) {
+        return keys[slot];
+    }
+
+    /**
+     * Returns the cells whose obstacles differ from a previous version of the grid.
+     * Only the tiles not shared with the previous version are compared.
+     *
+     * @param previous the previous version
+     */
+    public List<Point> changedCells(ObstacleGrid previous) {
+        requireNonNull(previous);
+        List<Point> result = new ArrayList<>();
+        if (previous == this) {
+            return result;
+        }
+        for (int slot = 0; slot < tiles.length; slot++) {
+            Tile tile = tiles[slot];
+            if (tile != null) {
+                Obstacle[] oldCells = previous.cells(keys[slot]);
+                if (oldCells != tile.cells) {
+                    for (int k = 0; k < TILE_CELLS; k++) {
+                        if (tile.cells[k] != (oldCells != null ? oldCells[k] : null)) {
+                            result.add(location(keys[slot], k));
+                        }
+                    }
+                }
+            }
+        }
+        for (int slot = 0; slot < previous.tiles.length; slot++) {
+            Tile tile = previous.tiles[slot];
+            if (tile != null && tile.count > 0 && cells(previous.keys[slot]) == null) {
+                for (int k = 0; k < TILE_CELLS; k++) {
+                    if (tile.cells[k] != null) {
+                        result.add(location(previous.keys[slot], k));
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the builder of a new version of the grid
+     */
+    public Builder builder() {
+        return new Builder(this);
+    }
+
+    /**
+     * Applies an action to every obstacle in a rectangular area of cells
+     *
+     * @param minI   the minimum cell x index
+     * @param minJ   the minimum cell y index
+     * @param maxI   the maximum cell x index (inclusive)
+     * @param maxJ   the maximum cell y index (inclusive)
+     * @param action the action
+     */
+    public void forEach(int minI, int minJ, int maxI, int maxJ, Consumer<Obstacle> action) {
+        for (int ti = minI >> TILE_BITS; ti <= maxI >> TILE_BITS; ti++) {
+            int i0 = max(minI, ti << TILE_BITS);
+            int i1 = min(maxI, (ti << TILE_BITS) + TILE_MASK);
+            for (int tj = minJ >> TILE_BITS; tj <= maxJ >> TILE_BITS; tj++) {
+                int idx = findSlot(keys, tiles, tileKey(ti, tj));
+                if (idx >= 0 && tiles[idx].count > 0) {
+                    Obstacle[] cells = tiles[idx].cells;
+                    int j0 = max(minJ, tj << TILE_BITS);
+                    int j1 = min(maxJ, (tj << TILE_BITS) + TILE_MASK);
+                    for (int i = i0; i <= i1; i++) {
+                        for (int j = j0; j <= j1; j++) {
+                            Obstacle obstacle = cells[localIndex(i, j)];
+                            if (obstacle != null) {
+                                action.accept(obstacle);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Applies an action to the obstacles in the cells within a radius from a center cell.
+     * Only the tiles intersecting the circle are scanned.
+     *
+     * @param centerI the center cell x index
+     * @param centerJ the center cell y index
+     * @param radius  the radius (cells)
+     * @param action  the action
+     */
+    public void forEachWithin(int centerI, int centerJ, int radius, Consumer<Obstacle> action) {
+        long radiusSq = (long) radius * radius;
+        int minI = centerI - radius;
+        int maxI = centerI + radius;
+        int minJ = centerJ - radius;
+        int maxJ = centerJ + radius;
+        for (int ti = minI >> TILE_BITS; ti <= maxI >> TILE_BITS; ti++) {
+            int i0 = max(minI, ti << TILE_BITS);
+            int i1 = min(maxI, (ti << TILE_BITS) + TILE_MASK);
+            for (int tj = minJ >> TILE_BITS; tj <= maxJ >> TILE_BITS; tj++) {
+                int j0 = max(minJ, tj << TILE_BITS);
+                int j1 = min(maxJ, (tj << TILE_BITS) + TILE_MASK);
+                if (distanceSq(centerI, centerJ, i0, j0, i1, j1) > radiusSq) {
+                    continue;
+                }
+                int idx = findSlot(keys, tiles, tileKey(ti, tj));
+                if (idx >= 0 && tiles[idx].count > 0) {
+                    Obstacle[] cells = tiles[idx].cells;
+                    for (int i = i0; i <= i1; i++) {
+                        long di = i - centerI;
+                        for (int j = j0; j <= j1; j++) {
+                            long dj = j - centerJ;
+                            Obstacle obstacle = cells[localIndex(i, j)];
+                            if (obstacle != null && di * di + dj * dj <= radiusSq) {
+                                action.accept(obstacle);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the obstacle in a cell or null if none
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    public Obstacle get(int i, int j) {
+        int idx = findSlot(keys, tiles, tileKey(i >> TILE_BITS, j >> TILE_BITS));
+        return idx >= 0 ? tiles[idx].cells[localIndex(i, j)] : null;
+    }
+
+    /**
+     * Returns true if the grid has no obstacles
+     */
+    public boolean isEmpty() {
+        return size == 0;
+    }
+
+    /**
+     * Returns the number of obstacles
+     */
+    public int size() {
+        return size;
+    }
+
+    /**
+     * Returns the stream of obstacles
+     */
+    public Stream<Obstacle> stream() {
+        return Arrays.stream(tiles)
+                .filter(tile -> tile != null && tile.count > 0)
+                .flatMap(tile -> Arrays.stream(tile.cells))
+                .filter(Objects::nonNull);
+    }
+
+    /**
+     * Returns the number of tiles
+     */
+    public int tileCount() {
+        return tileCount;
+    }
+
+    /**
+     * The tile of cells
+     */
+    static class Tile {
+        final Obstacle[] cells;
+        int count;
+        long minTimestamp;
+        long maxTimestamp;
+        double minLikelihood;
+
+        /**
+         * Creates an empty tile
+         */
+        Tile() {
+            this.cells = new Obstacle[TILE_CELLS];
+            this.minTimestamp = Long.MAX_VALUE;
+            this.maxTimestamp = Long.MIN_VALUE;
+            this.minLikelihood = Double.POSITIVE_INFINITY;
+        }
+
+        /**
+         * Creates a copy of a tile
+         *
+         * @param other the tile
+         */
+        Tile(Tile other) {
+            this.cells = other.cells.clone();
+            this.count = other.count;
+            this.minTimestamp = other.minTimestamp;
+            this.maxTimestamp = other.maxTimestamp;
+            this.minLikelihood = other.minLikelihood;
+        }
+
+        /**
+         * Recomputes the minimum timestamp, the last update timestamp and the minimum likelihood of the tile
+         */
+        void updateStats() {
+            long minTimestamp = Long.MAX_VALUE;
+            long maxTimestamp = Long.MIN_VALUE;
+            double minLikelihood = Double.POSITIVE_INFINITY;
+            for (Obstacle obstacle : cells) {
+                if (obstacle != null) {
+                    minTimestamp = min(minTimestamp, obstacle.timestamp);
+                    maxTimestamp = max(maxTimestamp, obstacle.timestamp);
+                    minLikelihood = min(minLikelihood, obstacle.likelihood);
+                }
+            }
+            this.minTimestamp = minTimestamp;
+            this.maxTimestamp = maxTimestamp;
+            this.minLikelihood = minLikelihood;
+        }
+    }
+
+    /**
+     * Builds a new version of the grid.
+     * The builder copies a tile the first time it changes and can build only one grid,
+     * the source grid is returned if nothing changed.
+     */
+    public static class Builder {
+        private final ObstacleGrid source;
+        private boolean modified;
+        private int[] keys;
+        private Tile[] tiles;
+        private boolean[] owned;
+        private int[] ownedKeys;
+        private int numOwned;
+        private int tileCount;
+        private int size;
+        private TileHeap timestamps;
+        private TileHeap likelihoods;
+
+        /**
+         * Creates the builder from a grid.
+         * The builder shares the table of the grid until the first change.
+         *
+         * @param grid the initial grid
+         */
+        protected Builder(ObstacleGrid grid) {
+            this.source = grid;
+            this.keys = grid.keys;
+            this.tiles = grid.tiles;
+            this.ownedKeys = new int[MIN_CAPACITY];
+            this.tileCount = grid.tileCount;
+            this.size = grid.size;
+            this.timestamps = grid.timestamps;
+            this.likelihoods = grid.likelihoods;
+        }
+
+        /**
+         * Returns the grid
+         */
+        public ObstacleGrid build() {
+            checkNotBuilt();
+            if (!modified) {
+                keys = null;
+                tiles = null;
+                owned = null;
+                return source;
+            }
+            // Indexes the changed tiles, the previous entries of the tiles become stale
+            for (int n = 0; n < numOwned; n++) {
+                int idx = findSlot(keys, tiles, ownedKeys[n]);
+                if (idx >= 0 && isOwned(idx)) {
+                    owned[idx] = false;
+                    Tile tile = tiles[idx];
+                    tile.updateStats();
+                    if (tile.count > 0) {
+                        timestamps = TileHeap.insert(timestamps, tile.minTimestamp, ownedKeys[n]);
+                        likelihoods = TileHeap.insert(likelihoods, tile.minLikelihood, ownedKeys[n]);
+                    }
+                }
+            }
+            if (max(TileHeap.size(timestamps), TileHeap.size(likelihoods)) > 2 * tileCount + MIN_CAPACITY) {
+                compactHeaps();
+            }
+            ObstacleGrid result = new ObstacleGrid(keys, tiles, tileCount, size, timestamps, likelihoods);
+            keys = null;
+            tiles = null;
+            owned = null;
+            return result;
+        }
+
+        /**
+         * Rebuilds the heaps dropping the stale entries.
+         * The heaps are rebuilt after at least as many changes as the tiles, so the cost is amortized by the changes.
+         */
+        private void compactHeaps() {
+            double[] minTimestamps = new double[tileCount];
+            double[] minLikelihoods = new double[tileCount];
+            int[] tileKeys = new int[tileCount];
+            int n = 0;
+            for (int idx = 0; idx < tiles.length; idx++) {
+                Tile tile = tiles[idx];
+                if (tile != null && tile.count > 0) {
+                    minTimestamps[n] = tile.minTimestamp;
+                    minLikelihoods[n] = tile.minLikelihood;
+                    tileKeys[n] = keys[idx];
+                    n++;
+                }
+            }
+            timestamps = TileHeap.create(minTimestamps, tileKeys, n);
+            likelihoods = TileHeap.create(minLikelihoods, tileKeys, n);
+        }
+
+        /**
+         * Copies the table of the source grid on the first change.
+         * The owned flags are allocated with the copy, so no slot is owned while the table is shared.
+         */
+        private void copyTable() {
+            if (owned == null) {
+                keys = keys.clone();
+                tiles = tiles.clone();
+                owned = new boolean[tiles.length];
+            }
+        }
+
+        private void checkNotBuilt() {
+            if (tiles == null) {
+                throw new IllegalStateException("The grid has already been built");
+            }
+        }
+
+        /**
+         * Returns the obstacle in a cell or null if none
+         *
+         * @param i the cell x index
+         * @param j the cell y index
+         */
+        public Obstacle get(int i, int j) {
+            checkNotBuilt();
+            int idx = findSlot(keys, tiles, tileKey(i >> TILE_BITS, j >> TILE_BITS));
+            return idx >= 0 ? tiles[idx].cells[localIndex(i, j)] : null;
+        }
+
+        /**
+         * Evicts the tiles exceeding the maximum number of tiles or obstacles.
+         * The tiles are evicted in order of last update, the farthest from the center cell first among
+         * the tiles updated at the same time, and the table is compacted.
+         *
+         * @param maxTiles     the maximum number of not empty tiles
+         * @param maxObstacles the maximum number of obstacles
+         * @param centerI      the center cell x index
+         * @param centerJ      the center cell y index
+         */
+        public Builder evict(int maxTiles, int maxObstacles, int centerI, int centerJ) {
+            checkNotBuilt();
+            int count = 0;
+            for (Tile tile : tiles) {
+                if (tile != null && tile.count > 0) {
+                    count++;
+                }
+            }
+            if (count <= maxTiles && size <= maxObstacles) {
+                return this;
+            }
+            Integer[] candidates = new Integer[count];
+            long[] distances = new long[tiles.length];
+            int n = 0;
+            for (int idx = 0; idx < tiles.length; idx++) {
+                Tile tile = tiles[idx];
+                if (tile != null && tile.count > 0) {
+                    if (isOwned(idx)) {
+                        tile.updateStats();
+                    }
+                    int ti = keys[idx] >> 16;
+                    int tj = (short) keys[idx];
+                    int i0 = ti << TILE_BITS;
+                    int j0 = tj << TILE_BITS;
+                    distances[idx] = distanceSq(centerI, centerJ, i0, j0, i0 + TILE_MASK, j0 + TILE_MASK);
+                    candidates[n++] = idx;
+                }
+            }
+            copyTable();
+            Arrays.sort(candidates, Comparator.<Integer>comparingLong(idx -> tiles[idx].maxTimestamp)
+                    .thenComparing(Comparator.<Integer>comparingLong(idx -> distances[idx]).reversed()));
+            for (int k = 0; k < candidates.length && (count > maxTiles || size > maxObstacles); k++) {
+                int idx = candidates[k];
+                size -= tiles[idx].count;
+                modified = true;
+                tiles[idx] = new Tile();
+                own(idx);
+                count--;
+            }
+            rehash(tiles.length);
+            return this;
+        }
+
+        /**
+         * Doubles the capacity of the table dropping the empty tiles
+         */
+        private void grow() {
+            rehash(tiles.length * 2);
+        }
+
+        /**
+         * Rebuilds the table with a capacity dropping the empty tiles
+         *
+         * @param capacity the capacity (power of 2)
+         */
+        private void rehash(int capacity) {
+            int[] newKeys = new int[capacity];
+            Tile[] newTiles = new Tile[capacity];
+            boolean[] newOwned = new boolean[capacity];
+            int count = 0;
+            for (int idx = 0; idx < tiles.length; idx++) {
+                Tile tile = tiles[idx];
+                if (tile != null && tile.count > 0) {
+                    int newIdx = -findSlot(newKeys, newTiles, keys[idx]) - 1;
+                    newKeys[newIdx] = keys[idx];
+                    newTiles[newIdx] = tile;
+                    newOwned[newIdx] = isOwned(idx);
+                    count++;
+                }
+            }
+            keys = newKeys;
+            tiles = newTiles;
+            owned = newOwned;
+            tileCount = count;
+        }
+
+        /**
+         * Returns true if a tile slot is owned by the builder
+         *
+         * @param idx the slot
+         */
+        private boolean isOwned(int idx) {
+            return owned != null && owned[idx];
+        }
+
+        /**
+         * Marks a tile slot of the copied table as owned by the builder
+         *
+         * @param idx the slot
+         */
+        private void own(int idx) {
+            if (!owned[idx]) {
+                owned[idx] = true;
+                if (numOwned >= ownedKeys.length) {
+                    ownedKeys = Arrays.copyOf(ownedKeys, ownedKeys.length * 2);
+                }
+                ownedKeys[numOwned++] = keys[idx];
+            }
+        }
+
+        /**
+         * Puts an obstacle in a cell replacing the existing one if any
+         *
+         * @param i        the cell x index
+         * @param j        the cell y index
+         * @param obstacle the obstacle
+         */
+        public Builder put(int i, int j, Obstacle obstacle) {
+            checkNotBuilt();
+            Tile tile = writableTile(i, j);
+            int local = localIndex(i, j);
+            if (tile.cells[local] == null) {
+                tile.count++;
+                size++;
+            }
+            tile.cells[local] = obstacle;
+            tile.minTimestamp = min(tile.minTimestamp, obstacle.timestamp);
+            tile.maxTimestamp = max(tile.maxTimestamp, obstacle.timestamp);
+            tile.minLikelihood = min(tile.minLikelihood, obstacle.likelihood);
+            return this;
+        }
+
+        /**
+         * Puts an obstacle in a cell if the cell is empty
+         *
+         * @param i        the cell x index
+         * @param j        the cell y index
+         * @param obstacle the obstacle
+         */
+        public Builder putIfAbsent(int i, int j, Obstacle obstacle) {
+            return get(i, j) == null ? put(i, j, obstacle) : this;
+        }
+
+        /**
+         * Removes the obstacle in a cell if any
+         *
+         * @param i the cell x index
+         * @param j the cell y index
+         */
+        public Builder remove(int i, int j) {
+            if (get(i, j) != null) {
+                Tile tile = writableTile(i, j);
+                tile.cells[localIndex(i, j)] = null;
+                tile.count--;
+                size--;
+            }
+            return this;
+        }
+
+        /**
+         * Removes the obstacles older than a timestamp or with likelihood lower than a threshold.
+         * Only the tiles that contain such obstacles are taken from the heaps, scanned and copied.
+         *
+         * @param minTimestamp  the minimum timestamp of holding obstacles
+         * @param minLikelihood the minimum likelihood of holding obstacles
+         */
+        public Builder removeExpired(long minTimestamp, double minLikelihood) {
+            checkNotBuilt();
+            while (timestamps != null && timestamps.priority < minTimestamp) {
+                int key = timestamps.key;
+                timestamps = timestamps.pop();
+                removeExpired(key, minTimestamp, minLikelihood);
+            }
+            while (likelihoods != null && likelihoods.priority < minLikelihood) {
+                int key = likelihoods.key;
+                likelihoods = likelihoods.pop();
+                removeExpired(key, minTimestamp, minLikelihood);
+            }
+            return this;
+        }
+
+        /**
+         * Removes the obstacles of a tile older than a timestamp or with likelihood lower than a threshold.
+         * The tiles changed by the builder are indexed again when the grid is built.
+         *
+         * @param key           the tile key
+         * @param minTimestamp  the minimum timestamp of holding obstacles
+         * @param minLikelihood the minimum likelihood of holding obstacles
+         */
+        private void removeExpired(int key, long minTimestamp, double minLikelihood) {
+            int idx = findSlot(keys, tiles, key);
+            if (idx < 0) {
+                // Stale entry of a removed tile
+                return;
+            }
+            Tile tile = tiles[idx];
+            if (tile.count > 0 && (tile.minTimestamp < minTimestamp || tile.minLikelihood < minLikelihood)) {
+                if (!isOwned(idx)) {
+                    copyTable();
+                    tile = new Tile(tile);
+                    tiles[idx] = tile;
+                    own(idx);
+                }
+                modified = true;
+                Obstacle[] cells = tile.cells;
+                for (int k = 0; k < cells.length; k++) {
+                    Obstacle obstacle = cells[k];
+                    if (obstacle != null && (obstacle.timestamp < minTimestamp || obstacle.likelihood < minLikelihood)) {
+                        cells[k] = null;
+                        tile.count--;
+                        size--;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Returns the tile of a cell owned by the builder creating it if not exist
+         *
+         * @param i the cell x index
+         * @param j the cell y index
+         */
+        private Tile writableTile(int i, int j) {
+            modified = true;
+            int key = tileKey(i >> TILE_BITS, j >> TILE_BITS);
+            int idx = findSlot(keys, tiles, key);
+            if (idx < 0) {
+                if ((tileCount + 1) * 2 > tiles.length) {
+                    grow();
+                    idx = findSlot(keys, tiles, key);
+                } else {
+                    copyTable();
+                }
+                idx = -idx - 1;
+                keys[idx] = key;
+                tiles[idx] = new Tile();
+                own(idx);
+                tileCount++;
+            } else if (!isOwned(idx)) {
+                copyTable();
+                tiles[idx] = new Tile(tiles[idx]);
+                own(idx);
+            }
+            return tiles[idx];
+        }
+    }
+}
@@ -0,0 +1,561 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.*;
+import java.util.AbstractSet;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Iterator;
+import java.util.List;
+import java.util.Objects;
+import java.util.Set;
+import java.util.stream.IntStream;
+import java.util.stream.Stream;
+
+import static java.lang.Math.ceil;
+import static org.mmarini.wheelly.model.ObstacleGrid.TILE_BITS;
+import static org.mmarini.wheelly.model.ObstacleGrid.TILE_CELLS;
+import static org.mmarini.wheelly.model.ObstacleGrid.TILE_MASK;
+import static org.mmarini.wheelly.model.ObstacleGrid.findSlot;
+import static org.mmarini.wheelly.model.ObstacleGrid.localIndex;
+import static org.mmarini.wheelly.model.ObstacleGrid.tileKey;
+
+/**
+ * The prohibited area of an obstacle grid.
+ * <p>
+ * The area is the set of cells within the safe distance from any obstacle with likelihood not lower than the
+ * threshold.
+ * Each cell holds the number of obstacles that cover it (coverage) and the number of its prohibited neighbours
+ * (adjacency), so that the contour cells are the not prohibited cells with prohibited neighbours.
+ * The area is immutable and is updated incrementally to a new version of the obstacle grid:
+ * only the tiles of the grid that changed are compared and only the neighbourhoods of the changed obstacles
+ * are updated, copying the tiles of the area the first time they change.
+ * </p>
+ */
+public class ProhibitedArea {
+    private static final int MIN_CAPACITY = 16;
+
+    /**
+     * Returns the empty prohibited area
+     *
+     * @param gridSize            the grid size m
+     * @param safeDistance        the safe distance m
+     * @param likelihoodThreshold the likelihood threshold
+     */
+    public static ProhibitedArea create(double gridSize, double safeDistance, double likelihoodThreshold) {
+        return new ProhibitedArea(ObstacleGrid.empty(), gridSize, safeDistance, likelihoodThreshold,
+                diskOffsets(safeDistance / gridSize),
+                new int[MIN_CAPACITY], new Tile[MIN_CAPACITY], 0, 0, 0);
+    }
+
+    /**
+     * Returns the offsets of the cells within a distance (di0, dj0, di1, dj1, ...)
+     *
+     * @param safeCellDistance the distance in cell units
+     */
+    static int[] diskOffsets(double safeCellDistance) {
+        int k = (int) ceil(safeCellDistance);
+        double safeCellDistanceSq = safeCellDistance * safeCellDistance;
+        List<Integer> offsets = new ArrayList<>();
+        for (int i = -k; i <= k; i++) {
+            for (int j = -k; j <= k; j++) {
+                if ((i == 0 && j == 0) || i * i + j * j <= safeCellDistanceSq) {
+                    offsets.add(i);
+                    offsets.add(j);
+                }
+            }
+        }
+        return offsets.stream().mapToInt(Integer::intValue).toArray();
+    }
+
+    private final ObstacleGrid grid;
+    private final double gridSize;
+    private final double safeDistance;
+    private final double likelihoodThreshold;
+    private final int[] disk;
+    private final int[] keys;
+    private final Tile[] tiles;
+    private final int tileCount;
+    private final int prohibitedSize;
+    private final int contourSize;
+    private final Set<Point> prohibited;
+    private final Set<Point> contours;
+
+    /**
+     * Creates the prohibited area
+     *
+     * @param grid                the obstacle grid
+     * @param gridSize            the grid size m
+     * @param safeDistance        the safe distance m
+     * @param likelihoodThreshold the likelihood threshold
+     * @param disk                the offsets of the safe distance disk
+     * @param keys                the tile keys
+     * @param tiles               the tiles
+     * @param tileCount           the number of tiles
+     * @param prohibitedSize      the number of prohibited cells
+     * @param contourSize         the number of contour cells
+     */
+    protected ProhibitedArea(ObstacleGrid grid, double gridSize, double safeDistance, double likelihoodThreshold,
+                             int[] disk, int[] keys, Tile[] tiles, int tileCount, int prohibitedSize, int contourSize) {
+        this.grid = grid;
+        this.gridSize = gridSize;
+        this.safeDistance = safeDistance;
+        this.likelihoodThreshold = likelihoodThreshold;
+        this.disk = disk;
+        this.keys = keys;
+        this.tiles = tiles;
+        this.tileCount = tileCount;
+        this.prohibitedSize = prohibitedSize;
+        this.contourSize = contourSize;
+        this.prohibited = new CellSet(false);
+        this.contours = new CellSet(true);
+    }
+
+    /**
+     * Returns the cells whose prohibited status differs from a previous area.
+     * Only the tiles not shared with the previous area are compared.
+     *
+     * @param previous the previous area
+     */
+    public List<Point> changedCells(ProhibitedArea previous) {
+        List<Point> result = new ArrayList<>();
+        for (Tile tile : tiles) {
+            if (tile != null) {
+                int idx = findSlot(previous.keys, previous.tiles, tileKey(tile.ti, tile.tj));
+                Tile other = idx >= 0 ? previous.tiles[idx] : null;
+                if (other != tile) {
+                    for (int k = 0; k < TILE_CELLS; k++) {
+                        boolean before = other != null && other.coverage[k] > 0;
+                        if (before != (tile.coverage[k] > 0)) {
+                            result.add(tile.location(k));
+                        }
+                    }
+                }
+            }
+        }
+        for (Tile other : previous.tiles) {
+            if (other != null && findSlot(keys, tiles, tileKey(other.ti, other.tj)) < 0) {
+                for (int k = 0; k < TILE_CELLS; k++) {
+                    if (other.coverage[k] > 0) {
+                        result.add(other.location(k));
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the contour cells (not prohibited cells adjacent to prohibited cells)
+     */
+    public Set<Point> getContours() {
+        return contours;
+    }
+
+    /**
+     * Returns the obstacle grid of the area
+     */
+    public ObstacleGrid getGrid() {
+        return grid;
+    }
+
+    public double getGridSize() {
+        return gridSize;
+    }
+
+    public double getLikelihoodThreshold() {
+        return likelihoodThreshold;
+    }
+
+    /**
+     * Returns the prohibited cells
+     */
+    public Set<Point> getProhibited() {
+        return prohibited;
+    }
+
+    public double getSafeDistance() {
+        return safeDistance;
+    }
+
+    /**
+     * Returns true if a cell is a contour cell
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    public boolean isContour(int i, int j) {
+        int idx = findSlot(keys, tiles, tileKey(i >> TILE_BITS, j >> TILE_BITS));
+        if (idx < 0) {
+            return false;
+        }
+        int k = localIndex(i, j);
+        return tiles[idx].coverage[k] == 0 && tiles[idx].adjacency[k] > 0;
+    }
+
+    /**
+     * Returns true if a cell is prohibited
+     *
+     * @param i the cell x index
+     * @param j the cell y index
+     */
+    public boolean isProhibited(int i, int j) {
+        int idx = findSlot(keys, tiles, tileKey(i >> TILE_BITS, j >> TILE_BITS));
+        return idx >= 0 && tiles[idx].coverage[localIndex(i, j)] > 0;
+    }
+
+    /**
+     * Returns true if the obstacle generates prohibited area
+     *
+     * @param obstacle the obstacle
+     */
+    private boolean isSignificant(Obstacle obstacle) {
+        return obstacle != null && obstacle.likelihood >= likelihoodThreshold;
+    }
+
+    /**
+     * Returns the prohibited area of an obstacle grid.
+     * The area is computed from this area updating only the changed tiles of the grids.
+     *
+     * @param grid the obstacle grid
+     */
+    public ProhibitedArea update(ObstacleGrid grid) {
+        if (grid == this.grid) {
+            return this;
+        }
+        Updater updater = new Updater();
+        // Changed or added tiles
+        for (int slot = 0; slot < grid.capacity(); slot++) {
+            Obstacle[] cells = grid.cellsAt(slot);
+            if (cells != null) {
+                int key = grid.keyAt(slot);
+                Obstacle[] oldCells = this.grid.cells(key);
+                if (oldCells != cells) {
+                    updater.diff(key, oldCells, cells);
+                }
+            }
+        }
+        // Removed tiles
+        for (int slot = 0; slot < this.grid.capacity(); slot++) {
+            Obstacle[] oldCells = this.grid.cellsAt(slot);
+            if (oldCells != null) {
+                int key = this.grid.keyAt(slot);
+                if (grid.cells(key) == null) {
+                    updater.diff(key, oldCells, null);
+                }
+            }
+        }
+        return updater.build(grid);
+    }
+
+    /**
+     * The tile of cells
+     */
+    static class Tile {
+        final int ti;
+        final int tj;
+        final int[] coverage;
+        final int[] adjacency;
+        int used;
+
+        /**
+         * Creates an empty tile
+         *
+         * @param ti the tile x index
+         * @param tj the tile y index
+         */
+        Tile(int ti, int tj) {
+            this.ti = ti;
+            this.tj = tj;
+            this.coverage = new int[TILE_CELLS];
+            this.adjacency = new int[TILE_CELLS];
+        }
+
+        /**
+         * Creates a copy of a tile
+         *
+         * @param other the tile
+         */
+        Tile(Tile other) {
+            this.ti = other.ti;
+            this.tj = other.tj;
+            this.coverage = other.coverage.clone();
+            this.adjacency = other.adjacency.clone();
+            this.used = other.used;
+        }
+
+        /**
+         * Returns the cell location
+         *
+         * @param k the local index
+         */
+        Point location(int k) {
+            return new Point((ti << TILE_BITS) | (k >> TILE_BITS), (tj << TILE_BITS) | (k & TILE_MASK));
+        }
+
+        /**
+         * Sets the counters of a cell
+         *
+         * @param k         the local index
+         * @param coverage  the coverage
+         * @param adjacency the adjacency
+         */
+        void set(int k, int coverage, int adjacency) {
+            boolean wasUsed = this.coverage[k] != 0 || this.adjacency[k] != 0;
+            boolean isUsed = coverage != 0 || adjacency != 0;
+            this.coverage[k] = coverage;
+            this.adjacency[k] = adjacency;
+            if (wasUsed && !isUsed) {
+                used--;
+            } else if (!wasUsed && isUsed) {
+                used++;
+            }
+        }
+    }
+
+    /**
+     * The view of prohibited or contour cells
+     */
+    private class CellSet extends AbstractSet<Point> {
+        private final boolean contour;
+
+        /**
+         * Creates the view
+         *
+         * @param contour true for contour cells
+         */
+        CellSet(boolean contour) {
+            this.contour = contour;
+        }
+
+        @Override
+        public boolean contains(Object o) {
+            if (!(o instanceof Point)) {
+                return false;
+            }
+            Point cell = (Point) o;
+            return contour ? isContour(cell.x, cell.y) : isProhibited(cell.x, cell.y);
+        }
+
+        @Override
+        public Iterator<Point> iterator() {
+            return stream().iterator();
+        }
+
+        @Override
+        public int size() {
+            return contour ? contourSize : prohibitedSize;
+        }
+
+        @Override
+        public Stream<Point> stream() {
+            return Arrays.stream(tiles)
+                    .filter(Objects::nonNull)
+                    .filter(tile -> tile.used > 0)
+                    .flatMap(tile -> IntStream.range(0, TILE_CELLS)
+                            .filter(k -> contour
+                                    ? tile.coverage[k] == 0 && tile.adjacency[k] > 0
+                                    : tile.coverage[k] > 0)
+                            .mapToObj(tile::location));
+        }
+    }
+
+    /**
+     * Updates a copy of the area
+     */
+    private class Updater {
+        private int[] keys;
+        private Tile[] tiles;
+        private boolean[] owned;
+        private int tileCount;
+        private int prohibitedSize;
+        private int contourSize;
+
+        /**
+         * Creates the updater
+         */
+        Updater() {
+            this.keys = ProhibitedArea.this.keys.clone();
+            this.tiles = ProhibitedArea.this.tiles.clone();
+            this.owned = new boolean[tiles.length];
+            this.tileCount = ProhibitedArea.this.tileCount;
+            this.prohibitedSize = ProhibitedArea.this.prohibitedSize;
+            this.contourSize = ProhibitedArea.this.contourSize;
+        }
+
+        /**
+         * Adds a value to the adjacency of the neighbours of a cell
+         *
+         * @param i     the cell x index
+         * @param j     the cell y index
+         * @param delta the value
+         */
+        private void addAdjacency(int i, int j, int delta) {
+            for (int di = -1; di <= 1; di++) {
+                for (int dj = -1; dj <= 1; dj++) {
+                    if (!(di == 0 && dj == 0)) {
+                        int ni = i + di;
+                        int nj = j + dj;
+                        Tile tile = writableTile(ni, nj);
+                        int k = localIndex(ni, nj);
+                        int coverage = tile.coverage[k];
+                        int adjacency = tile.adjacency[k];
+                        int newAdjacency = adjacency + delta;
+                        tile.set(k, coverage, newAdjacency);
+                        if (coverage == 0) {
+                            if (adjacency == 0 && newAdjacency > 0) {
+                                contourSize++;
+                            } else if (adjacency > 0 && newAdjacency == 0) {
+                                contourSize--;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Returns the updated area
+         *
+         * @param grid the obstacle grid of the area
+         */
+        ProhibitedArea build(ObstacleGrid grid) {
+            return new ProhibitedArea(grid, gridSize, safeDistance, likelihoodThreshold, disk,
+                    keys, tiles, tileCount, prohibitedSize, contourSize);
+        }
+
+        /**
+         * Adds a value to the coverage of the cells within the safe distance of a cell
+         *
+         * @param i     the cell x index
+         * @param j     the cell y index
+         * @param delta the value
+         */
+        private void dilate(int i, int j, int delta) {
+            for (int n = 0; n < disk.length; n += 2) {
+                int ci = i + disk[n];
+                int cj = j + disk[n + 1];
+                Tile tile = writableTile(ci, cj);
+                int k = localIndex(ci, cj);
+                int coverage = tile.coverage[k];
+                int newCoverage = coverage + delta;
+                tile.set(k, newCoverage, tile.adjacency[k]);
+                if (coverage == 0 && newCoverage > 0) {
+                    prohibitedSize++;
+                    if (tile.adjacency[k] > 0) {
+                        contourSize--;
+                    }
+                    addAdjacency(ci, cj, 1);
+                } else if (coverage > 0 && newCoverage == 0) {
+                    prohibitedSize--;
+                    if (tile.adjacency[k] > 0) {
+                        contourSize++;
+                    }
+                    addAdjacency(ci, cj, -1);
+                }
+            }
+        }
+
+        /**
+         * Updates the area for the changes of the cells of an obstacle tile
+         *
+         * @param key      the tile key
+         * @param oldCells the old cells or null if none
+         * @param newCells the new cells or null if none
+         */
+        void diff(int key, Obstacle[] oldCells, Obstacle[] newCells) {
+            int ti = key >> 16;
+            int tj = (short) key;
+            for (int k = 0; k < TILE_CELLS; k++) {
+                boolean before = oldCells != null && isSignificant(oldCells[k]);
+                boolean after = newCells != null && isSignificant(newCells[k]);
+                if (before != after) {
+                    int i = (ti << TILE_BITS) | (k >> TILE_BITS);
+                    int j = (tj << TILE_BITS) | (k & TILE_MASK);
+                    dilate(i, j, after ? 1 : -1);
+                }
+            }
+        }
+
+        /**
+         * Doubles the capacity of the table dropping the unused tiles
+         */
+        private void grow() {
+            int capacity = tiles.length * 2;
+            int[] newKeys = new int[capacity];
+            Tile[] newTiles = new Tile[capacity];
+            boolean[] newOwned = new boolean[capacity];
+            int count = 0;
+            for (int idx = 0; idx < tiles.length; idx++) {
+                Tile tile = tiles[idx];
+                if (tile != null && tile.used > 0) {
+                    int newIdx = -findSlot(newKeys, newTiles, keys[idx]) - 1;
+                    newKeys[newIdx] = keys[idx];
+                    newTiles[newIdx] = tile;
+                    newOwned[newIdx] = owned[idx];
+                    count++;
+                }
+            }
+            keys = newKeys;
+            tiles = newTiles;
+            owned = newOwned;
+            tileCount = count;
+        }
+
+        /**
+         * Returns the tile of a cell owned by the updater creating it if not exist
+         *
+         * @param i the cell x index
+         * @param j the cell y index
+         */
+        private Tile writableTile(int i, int j) {
+            int ti = i >> TILE_BITS;
+            int tj = j >> TILE_BITS;
+            int key = tileKey(ti, tj);
+            int idx = findSlot(keys, tiles, key);
+            if (idx < 0) {
+                if ((tileCount + 1) * 2 > tiles.length) {
+                    grow();
+                    idx = findSlot(keys, tiles, key);
+                }
+                idx = -idx - 1;
+                keys[idx] = key;
+                tiles[idx] = new Tile(ti, tj);
+                owned[idx] = true;
+                tileCount++;
+            } else if (!owned[idx]) {
+                tiles[idx] = new Tile(tiles[idx]);
+                owned[idx] = true;
+            }
+            return tiles[idx];
+        }
+    }
+}
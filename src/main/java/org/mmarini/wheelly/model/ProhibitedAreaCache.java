@@ -0,0 +1,77 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.mmarini.Tuple2;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+/**
+ * The cache of the last prohibited areas computed for the versions of a scanner map.
+ * The versions of the map derived from the same map share the cache so that each area is updated incrementally
+ * from the last computed one with the same safe distance and likelihood threshold.
+ */
+class ProhibitedAreaCache {
+    private static final int MAX_ENTRIES = 8;
+
+    private final Map<Tuple2<Double, Double>, ProhibitedArea> areas;
+
+    /**
+     * Creates the cache
+     */
+    ProhibitedAreaCache() {
+        this.areas = new LinkedHashMap<>(MAX_ENTRIES, 0.75f, true) {
+            @Override
+            protected boolean removeEldestEntry(Map.Entry<Tuple2<Double, Double>, ProhibitedArea> eldest) {
+                return size() > MAX_ENTRIES;
+            }
+        };
+    }
+
+    /**
+     * Returns the prohibited area of an obstacle grid
+     *
+     * @param grid                the obstacle grid
+     * @param gridSize            the grid size m
+     * @param safeDistance        the safe distance m
+     * @param likelihoodThreshold the likelihood threshold
+     */
+    synchronized ProhibitedArea get(ObstacleGrid grid, double gridSize, double safeDistance, double likelihoodThreshold) {
+        Tuple2<Double, Double> key = Tuple2.of(safeDistance, likelihoodThreshold);
+        ProhibitedArea area = areas.get(key);
+        if (area == null) {
+            area = ProhibitedArea.create(gridSize, safeDistance, likelihoodThreshold);
+        }
+        area = area.update(grid);
+        areas.put(key, area);
+        return area;
+    }
+}
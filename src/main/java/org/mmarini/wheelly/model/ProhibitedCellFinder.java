@@ -35,9 +35,7 @@ import java.awt.*;
 import java.awt.geom.Point2D;
 import java.util.List;
 import java.util.*;
-import java.util.function.Predicate;
 import java.util.stream.Collectors;
-import java.util.stream.Stream;
 
 import static java.lang.Math.*;
 
@@ -100,31 +98,86 @@ public class ProhibitedCellFinder {
                 new Point(ic, jc));
     }
 
+    /**
+     * Returns the contour cells (not prohibited cells adjacent to prohibited cells)
+     *
+     * @param prohibited the prohibited cells
+     */
     public static Set<Point> findContour(Set<Point> prohibited) {
-        return prohibited.stream()
-                .flatMap(center -> {
-                    Stream.Builder<Point> builder = Stream.builder();
-                    for (int i = -1; i <= 1; i++) {
-                        for (int j = -1; j <= 1; j++) {
-                            if (!(i == 0 && j == 0)) {
-                                Point cell = new Point(center.x + i, center.y + j);
-                                if (!prohibited.contains(cell)) {
-                                    builder.add(cell);
-                                }
-                            }
-                        }
-                    }
-                    return builder.build();
-                }).collect(Collectors.toSet());
+        return CellBitmap.of(prohibited).contour().asSet();
+    }
+
+    /**
+     * Returns true if the segment between two points does not cross any prohibited cell.
+     * <p>
+     * The crossed cells are traversed by the Amanatides-Woo digital differential analyzer without allocations:
+     * the parameters of the next vertical and horizontal cell boundaries are advanced incrementally and
+     * the segment steps both axes when it crosses a cell corner.
+     * </p>
+     *
+     * @param from       the starting point
+     * @param to         the destination point
+     * @param gridSize   the grid size
+     * @param prohibited the prohibited cell predicate
+     */
+    public static boolean isClear(Point2D from, Point2D to, double gridSize, CellPredicate prohibited) {
+        // Coordinates in cell units shifted so that the cell (i, j) is [i, i + 1) x [j, j + 1)
+        double ax = from.getX() / gridSize + 0.5;
+        double ay = from.getY() / gridSize + 0.5;
+        double dx = to.getX() / gridSize + 0.5 - ax;
+        double dy = to.getY() / gridSize + 0.5 - ay;
+        int i = (int) floor(ax);
+        int j = (int) floor(ay);
+        int endI = (int) floor(ax + dx);
+        int endJ = (int) floor(ay + dy);
+        int stepI = dx > 0 ? 1 : dx < 0 ? -1 : 0;
+        int stepJ = dy > 0 ? 1 : dy < 0 ? -1 : 0;
+        double tDeltaX = stepI != 0 ? 1 / abs(dx) : Double.POSITIVE_INFINITY;
+        double tDeltaY = stepJ != 0 ? 1 / abs(dy) : Double.POSITIVE_INFINITY;
+        double tMaxX = stepI > 0 ? (i + 1 - ax) / dx
+                : stepI < 0 ? (i - ax) / dx
+                : Double.POSITIVE_INFINITY;
+        double tMaxY = stepJ > 0 ? (j + 1 - ay) / dy
+                : stepJ < 0 ? (j - ay) / dy
+                : Double.POSITIVE_INFINITY;
+        for (; ; ) {
+            if (prohibited.test(i, j)) {
+                return false;
+            }
+            if ((i == endI && j == endJ) || min(tMaxX, tMaxY) > 1) {
+                return true;
+            }
+            if (tMaxX < tMaxY) {
+                i += stepI;
+                tMaxX += tDeltaX;
+            } else if (tMaxY < tMaxX) {
+                j += stepJ;
+                tMaxY += tDeltaY;
+            } else {
+                // Corner crossing
+                i += stepI;
+                j += stepJ;
+                tMaxX += tDeltaX;
+                tMaxY += tDeltaY;
+            }
+        }
     }
 
-    public static boolean isValid(Point2D from, Point2D to, double gridSize, Predicate<Point> prohibited) {
+    /**
+     * Returns true if the segment between two points does not cross any prohibited cell
+     *
+     * @param from       the starting point
+     * @param to         the destination point
+     * @param gridSize   the grid size
+     * @param prohibited the prohibited cell predicate
+     */
+    public static boolean isValid(Point2D from, Point2D to, double gridSize, CellPredicate prohibited) {
         Point2D cellFrom = new Point2D.Double(from.getX() / gridSize, from.getY() / gridSize);
         Point2D cellTo = new Point2D.Double(to.getX() / gridSize, to.getY() / gridSize);
         Point cell0 = GridScannerMap.cell(from, gridSize);
 
         for (; ; ) {
-            if (prohibited.test(cell0)) {
+            if (prohibited.test(cell0.x, cell0.y)) {
                 return false;
             }
             if (cellFrom.equals(cellTo)) {
@@ -137,18 +190,41 @@ public class ProhibitedCellFinder {
     }
 
     /**
-     * Returns the nearest cell and the related distance square
+     * Returns the path optimized by bisection validating the segments by the allocation free cell traversal
      *
-     * @param neighbour the cell
-     * @param cells     the cell list
+     * @param path       the path
+     * @param gridSize   the grid size
+     * @param prohibited the prohibited cell predicate
+     * @see #isClear(Point2D, Point2D, double, CellPredicate)
      */
-    private static Optional<Tuple2<Point, Double>> nearestCell(Point neighbour, Collection<Point> cells) {
-        return cells.stream()
-                .map(c -> Tuple2.of(c, c.distanceSq(neighbour)))
-                .min(Comparator.comparingDouble(Tuple2::getV2));
+    public static List<Point2D> optimizeClearPath(List<Point2D> path, double gridSize, CellPredicate prohibited) {
+        int n = path.size();
+        if (n <= 2) {
+            return path;
+        }
+        int lastIndex = n - 1;
+        if (isClear(path.get(0), path.get(lastIndex), gridSize, prohibited)) {
+            return List.of(path.get(0), path.get(lastIndex));
+        }
+        //divide
+        int mid = path.size() / 2;
+        List<Point2D> left = optimizeClearPath(path.subList(0, mid + 1), gridSize, prohibited);
+        List<Point2D> right = optimizeClearPath(path.subList(mid, path.size()), gridSize, prohibited);
+        List<Point2D> result = new ArrayList<>(left);
+        result.remove(result.size() - 1);
+        result.addAll(right);
+        return result;
     }
 
-    public static List<Point2D> optimizePath(List<Point2D> path, double gridSize, Predicate<Point> prohibited) {
+    /**
+     * Returns the path optimized by bisection validating the segments by the crossed cells
+     *
+     * @param path       the path
+     * @param gridSize   the grid size
+     * @param prohibited the prohibited cell predicate
+     * @see #isValid(Point2D, Point2D, double, CellPredicate)
+     */
+    public static List<Point2D> optimizePath(List<Point2D> path, double gridSize, CellPredicate prohibited) {
         int n = path.size();
         if (n <= 2) {
             return path;
@@ -167,6 +243,36 @@ public class ProhibitedCellFinder {
         return result;
     }
 
+    /**
+     * Returns the path smoothed by string pulling.
+     * <p>
+     * The points are scanned once keeping the last kept point as anchor, a point is kept only if the segment
+     * from the anchor to the following point is not clear.
+     * The first and the last points are always kept.
+     * </p>
+     *
+     * @param path       the path
+     * @param gridSize   the grid size
+     * @param prohibited the prohibited cell predicate
+     */
+    public static List<Point2D> pullString(List<Point2D> path, double gridSize, CellPredicate prohibited) {
+        int n = path.size();
+        if (n <= 2) {
+            return path;
+        }
+        List<Point2D> result = new ArrayList<>();
+        Point2D anchor = path.get(0);
+        result.add(anchor);
+        for (int k = 1; k < n - 1; k++) {
+            if (!isClear(anchor, path.get(k + 1), gridSize, prohibited)) {
+                anchor = path.get(k);
+                result.add(anchor);
+            }
+        }
+        result.add(path.get(n - 1));
+        return result;
+    }
+
     private final GridScannerMap map;
     private final double safeDistance;
     private final double likelihoodThreshold;
@@ -177,39 +283,16 @@ public class ProhibitedCellFinder {
         this.likelihoodThreshold = likelihoodThreshold;
     }
 
+    /**
+     * Returns the cells within the safe distance from the obstacles with likelihood not lower than the threshold
+     */
     public Set<Point> find() {
-        Set<Point> cells = map.getObstacles().stream()
-                .filter(o -> o.getLikelihood() >= likelihoodThreshold)
-                .map(Obstacle::getLocation)
-                .map(map::cell)
-                .collect(Collectors.toSet());
-        return findNeighbour(cells);
-    }
-
-    private Set<Point> findNeighbour(Set<Point> cells) {
-        double safeCellDistance = safeDistance / map.gridSize;
-        int saveIndexDistance = (int) ceil(safeCellDistance);
-        double safeCellDistanceSq = safeCellDistance * safeCellDistance;
-        Stream<Point> fringe = cells.stream().flatMap(cell -> {
-            Stream.Builder<Point> builder = Stream.builder();
-            // Create near cells
-            for (int i = -saveIndexDistance; i <= saveIndexDistance; i++) {
-                for (int j = -saveIndexDistance; j <= saveIndexDistance; j++) {
-                    if (!(i == 0 && j == 0)) {
-                        Point neighbour = new Point(cell.x + i, cell.y + j);
-                        // Filter the cells within safe distance
-                        nearestCell(neighbour, cells)
-                                .map(Tuple2::getV2)
-                                .filter(distSqr -> distSqr <= safeCellDistanceSq)
-                                .ifPresent(
-                                        x -> builder.add(neighbour)
-                                );
-                    }
-                }
-            }
-            return builder.build();
-        });
-        // Merge the fringe with kernel
-        return Stream.concat(fringe, cells.stream()).collect(Collectors.toSet());
+        List<Point> obstacles = map.getGrid().stream()
+                .filter(obstacle -> obstacle.likelihood >= likelihoodThreshold)
+                .map(obstacle -> GridScannerMap.cell(obstacle.location, map.gridSize))
+                .collect(Collectors.toList());
+        return CellBitmap.of(obstacles)
+                .dilate(ProhibitedArea.diskOffsets(safeDistance / map.gridSize))
+                .asSet();
     }
 }
@@ -36,8 +36,6 @@ import io.reactivex.rxjava3.schedulers.Timed;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
-import static java.lang.Integer.parseInt;
-import static java.lang.String.format;
 import static java.util.Objects.requireNonNull;
 
 /**
@@ -58,7 +56,7 @@ public class RawController implements RobotController {
     public static RawController create(String host, int port,
                                        long connectionTimeout, long retryConnectionInterval, long readTimeout) {
         return new RawController(host, port,
-                connectionTimeout, retryConnectionInterval, readTimeout
+                connectionTimeout, retryConnectionInterval, readTimeout, false, 0, null
         );
     }
 
@@ -68,8 +66,19 @@ public class RawController implements RobotController {
      * @param configParams the config parameters
      */
     public static RobotController create(ConfigParameters configParams) {
+        return create(configParams, null);
+    }
+
+    /**
+     * Returns the raw controller
+     *
+     * @param configParams the config parameters
+     * @param selector     the shared socket selector or null for blocking reading
+     */
+    public static RobotController create(ConfigParameters configParams, SocketSelector selector) {
         return new RawController(configParams.host, configParams.port,
-                configParams.connectionTimeout, configParams.retryConnectionInterval, configParams.readTimeout
+                configParams.connectionTimeout, configParams.retryConnectionInterval, configParams.readTimeout,
+                configParams.binaryTelemetry, configParams.clockSyncInterval, selector
         );
     }
 
@@ -86,46 +95,26 @@ public class RawController implements RobotController {
      * @param connectionTimeout       the connection timeout
      * @param retryConnectionInterval the retry connection interval (ms)
      * @param readTimeout             the read timeout (ms)
+     * @param binaryTelemetry         true if binary telemetry mode is requested
+     * @param clockSyncInterval       the interval of clock sync requests (ms) or 0 if no clock sync
+     * @param selector                the shared socket selector or null for blocking reading
      */
-    protected RawController(String host, int port, long connectionTimeout, long retryConnectionInterval, long readTimeout) {
+    protected RawController(String host, int port, long connectionTimeout, long retryConnectionInterval, long readTimeout,
+                            boolean binaryTelemetry, long clockSyncInterval, SocketSelector selector) {
         requireNonNull(host);
-        this.socket = ReliableSocket.create(host, port, connectionTimeout, retryConnectionInterval, readTimeout);
+        this.socket = ReliableSocket.create(host, port, connectionTimeout, retryConnectionInterval, readTimeout, binaryTelemetry,
+                clockSyncInterval, selector);
         this.states = PublishProcessor.create();
         this.cps = PublishProcessor.create();
         this.localErrors = PublishProcessor.create();
 
-        // Transforms the received line into assets
-        socket.readLines()
-                .filter(line -> line.value().startsWith("st "))
-                .subscribe(st -> {
-                            try {
-                                Timed<WheellyStatus> status =
-                                        new Timed<>(WheellyStatus.from(st.value()), st.time(), st.unit());
-                                states.onNext(status);
-                            } catch (Throwable ex) {
-                                this.localErrors.onNext(ex);
-                            }
-                        },
-                        states::onError,
-                        states::onComplete);
-
-        socket.readLines()
-                .filter(line -> line.value().startsWith("cs "))
-                .subscribe(t -> {
-                            try {
-                                String line = t.value();
-                                String[] params = line.split(" ");
-                                if (params.length != 3) {
-                                    throw new IllegalArgumentException(format("Wrong cps command \"%s\"", line));
-                                }
-                                int cps = parseInt(params[2]);
-                                this.cps.onNext(new Timed<>(cps, t.time(), t.unit()));
-                            } catch (Throwable ex) {
-                                this.localErrors.onNext(ex);
-                            }
-                        },
-                        cps::onError,
-                        cps::onComplete);
+        // The status and cps records (text or binary frames) are decoded by the socket
+        socket.readStatus().subscribe(states::onNext,
+                states::onError,
+                states::onComplete);
+        socket.readCps().subscribe(cps::onNext,
+                cps::onError,
+                cps::onComplete);
 
         // Debugging flows
         if (logger.isDebugEnabled()) {
@@ -150,6 +139,11 @@ public class RawController implements RobotController {
         return socket.firstConnection();
     }
 
+    @Override
+    public Flowable<ClockSyncEvent> readClockSync() {
+        return socket.readClockSync();
+    }
+
     @Override
     public Flowable<Boolean> readConnection() {
         return socket.readConnection();
@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+
+import static java.lang.String.format;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * Routes each received record to the handler registered for its prefix.
+ * <p>
+ * The handlers are indexed by the first byte of the prefix so each record is tested only against the prefixes
+ * that can match it.
+ * The registry is copied on write and can be extended while the records are dispatched.
+ * </p>
+ */
+public class RecordDispatcher {
+    private static final int INDEX_SIZE = 256;
+
+    /**
+     * Returns an empty dispatcher
+     */
+    public static RecordDispatcher create() {
+        return new RecordDispatcher();
+    }
+
+    private volatile Entry[][] index;
+
+    /**
+     * Creates an empty dispatcher
+     */
+    protected RecordDispatcher() {
+        this.index = new Entry[INDEX_SIZE][];
+    }
+
+    /**
+     * Returns true if the record has been handled
+     *
+     * @param record    the record
+     * @param timestamp the receive timestamp
+     * @throws IllegalArgumentException if the handler cannot parse the record
+     */
+    public boolean dispatch(StatusParser record, long timestamp) {
+        if (record.isEmpty()) {
+            return false;
+        }
+        Entry[] entries = index[record.firstByte() & 0xff];
+        if (entries != null) {
+            for (Entry entry : entries) {
+                if (record.startsWith(entry.prefix)) {
+                    entry.handler.handle(record, timestamp);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Registers the handler of records with a prefix.
+     * The longer prefixes take precedence over the shorter ones.
+     * Registering again the same handler with the same prefix has no effect.
+     *
+     * @param prefix  the record prefix
+     * @param handler the handler
+     * @throws IllegalArgumentException if the prefix is empty or already registered with another handler
+     */
+    public synchronized RecordDispatcher register(String prefix, Handler handler) {
+        requireNonNull(prefix);
+        requireNonNull(handler);
+        byte[] bytes = prefix.getBytes(StandardCharsets.US_ASCII);
+        if (bytes.length == 0) {
+            throw new IllegalArgumentException("Empty record prefix");
+        }
+        int key = bytes[0] & 0xff;
+        Entry[] entries = index[key];
+        if (entries != null) {
+            for (Entry entry : entries) {
+                if (Arrays.equals(entry.prefix, bytes)) {
+                    if (entry.handler == handler) {
+                        return this;
+                    }
+                    throw new IllegalArgumentException(format("Record prefix \"%s\" already registered", prefix));
+                }
+            }
+        }
+        Entry[] newEntries = entries == null ? new Entry[1] : Arrays.copyOf(entries, entries.length + 1);
+        newEntries[newEntries.length - 1] = new Entry(bytes, handler);
+        Arrays.sort(newEntries, (a, b) -> Integer.compare(b.prefix.length, a.prefix.length));
+        Entry[][] newIndex = index.clone();
+        newIndex[key] = newEntries;
+        index = newIndex;
+        return this;
+    }
+
+    /**
+     * Handles the records
+     */
+    @FunctionalInterface
+    public interface Handler {
+        /**
+         * Handles a record
+         *
+         * @param record    the record
+         * @param timestamp the receive timestamp
+         * @throws IllegalArgumentException if the record cannot be parsed
+         */
+        void handle(StatusParser record, long timestamp);
+    }
+
+    /**
+     * The registry entry
+     */
+    private static class Entry {
+        final byte[] prefix;
+        final Handler handler;
+
+        Entry(byte[] prefix, Handler handler) {
+            this.prefix = prefix;
+            this.handler = handler;
+        }
+    }
+}
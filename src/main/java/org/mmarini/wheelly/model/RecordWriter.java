@@ -0,0 +1,342 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.nio.channels.WritableByteChannel;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.locks.ReadWriteLock;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
+import java.util.zip.Deflater;
+import java.util.zip.GZIPOutputStream;
+
+import static java.lang.Math.max;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The record writer appends the records to a file in a dedicated thread.
+ * <p>
+ * The producers put the records into a bounded queue, the writer thread collects them into a large direct buffer
+ * and writes the buffer when it is full or when the flush interval elapses.
+ * When the queue is full the records are dropped or the producers wait, depending on the overflow policy.
+ * The files with the {@link #COMPRESSED_EXTENSION} extension are gzip compressed.
+ * </p>
+ */
+public class RecordWriter implements Closeable {
+    public static final String COMPRESSED_EXTENSION = ".gz";
+    public static final int DEFAULT_QUEUE_SIZE = 4096;
+    public static final int DEFAULT_BUFFER_SIZE = 256 * 1024;
+    public static final long DEFAULT_FLUSH_INTERVAL = 1000;
+    private static final Logger logger = LoggerFactory.getLogger(RecordWriter.class);
+    private static final byte[] END = new byte[0];
+    private static final byte[] NEW_LINE = "\n".getBytes(StandardCharsets.UTF_8);
+
+    /**
+     * Returns the record writer appending to a file with the default buffering
+     *
+     * @param file   the file
+     * @param policy the overflow policy
+     * @throws IOException in case of error
+     */
+    public static RecordWriter create(File file, OverflowPolicy policy) throws IOException {
+        return create(file, DEFAULT_QUEUE_SIZE, DEFAULT_BUFFER_SIZE, DEFAULT_FLUSH_INTERVAL, policy);
+    }
+
+    /**
+     * Returns the record writer appending to a file
+     *
+     * @param file          the file
+     * @param queueSize     the maximum number of queued records
+     * @param bufferSize    the size of write buffer (bytes)
+     * @param flushInterval the flush interval (ms)
+     * @param policy        the overflow policy
+     * @throws IOException in case of error
+     */
+    public static RecordWriter create(File file, int queueSize, int bufferSize, long flushInterval, OverflowPolicy policy) throws IOException {
+        FileOutputStream out = new FileOutputStream(file, true);
+        WritableByteChannel channel = isCompressedName(file)
+                ? Channels.newChannel(new GZIPOutputStream(out, bufferSize) {
+            {
+                def.setLevel(Deflater.BEST_SPEED);
+            }
+        })
+                : out.getChannel();
+        RecordWriter writer = new RecordWriter(channel, queueSize, bufferSize, flushInterval, policy, file.getName());
+        writer.start();
+        return writer;
+    }
+
+    /**
+     * Returns true if the file name has the compressed extension
+     *
+     * @param file the file
+     */
+    public static boolean isCompressedName(File file) {
+        return file.getName().endsWith(COMPRESSED_EXTENSION);
+    }
+
+    private final WritableByteChannel channel;
+    private final BlockingQueue<byte[]> queue;
+    private final ByteBuffer buffer;
+    private final long flushInterval;
+    private final OverflowPolicy policy;
+    private final Thread thread;
+    private final AtomicLong written;
+    private final AtomicLong dropped;
+    private final AtomicLong bytes;
+    private final ReadWriteLock closeLock;
+    private volatile boolean closed;
+
+    /**
+     * Creates the record writer
+     *
+     * @param channel       the output channel
+     * @param queueSize     the maximum number of queued records
+     * @param bufferSize    the size of write buffer (bytes)
+     * @param flushInterval the flush interval (ms)
+     * @param policy        the overflow policy
+     * @param name          the name of writer thread
+     */
+    protected RecordWriter(WritableByteChannel channel, int queueSize, int bufferSize, long flushInterval, OverflowPolicy policy, String name) {
+        this.channel = requireNonNull(channel);
+        this.policy = requireNonNull(policy);
+        this.queue = new ArrayBlockingQueue<>(queueSize);
+        this.buffer = ByteBuffer.allocateDirect(bufferSize);
+        this.flushInterval = flushInterval;
+        this.written = new AtomicLong();
+        this.dropped = new AtomicLong();
+        this.bytes = new AtomicLong();
+        this.closeLock = new ReentrantReadWriteLock();
+        this.thread = new Thread(this::run, "RecordWriter-" + name);
+        thread.setDaemon(true);
+    }
+
+    /**
+     * Appends a record to the write buffer writing the buffer if it has no room for the record
+     *
+     * @param record the record
+     * @throws IOException in case of error
+     */
+    private void append(byte[] record) throws IOException {
+        if (record.length > buffer.remaining()) {
+            flush();
+        }
+        if (record.length > buffer.capacity()) {
+            writeFully(ByteBuffer.wrap(record));
+        } else {
+            buffer.put(record);
+        }
+        written.incrementAndGet();
+        bytes.addAndGet(record.length);
+    }
+
+    /**
+     * Writes the queued records and closes the file waiting for the writer thread completion.
+     * The end of records is queued after the records of the pending writes.
+     */
+    @Override
+    public void close() {
+        closeLock.writeLock().lock();
+        boolean closing = !closed;
+        try {
+            if (closing) {
+                closed = true;
+                queue.put(END);
+            }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        } finally {
+            closeLock.writeLock().unlock();
+        }
+        if (closing) {
+            try {
+                thread.join();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+            logger.info("{} written {} records, {} bytes, dropped {} records", thread.getName(),
+                    getWritten(), getBytes(), getDropped());
+        }
+    }
+
+    /**
+     * Writes the buffer content to the channel
+     *
+     * @throws IOException in case of error
+     */
+    private void flush() throws IOException {
+        buffer.flip();
+        writeFully(buffer);
+        buffer.clear();
+    }
+
+    /**
+     * Returns the number of written bytes (uncompressed)
+     */
+    public long getBytes() {
+        return bytes.get();
+    }
+
+    /**
+     * Returns the number of dropped records
+     */
+    public long getDropped() {
+        return dropped.get();
+    }
+
+    /**
+     * Returns the number of queued records
+     */
+    public int getQueued() {
+        return queue.size();
+    }
+
+    /**
+     * Returns the number of written records
+     */
+    public long getWritten() {
+        return written.get();
+    }
+
+    /**
+     * Runs the writer loop until the end of records
+     */
+    private void run() {
+        try (channel) {
+            long nextFlush = System.currentTimeMillis() + flushInterval;
+            for (; ; ) {
+                byte[] record = queue.poll(max(nextFlush - System.currentTimeMillis(), 0), TimeUnit.MILLISECONDS);
+                while (record != null && record != END) {
+                    append(record);
+                    record = queue.poll();
+                }
+                if (record == END) {
+                    break;
+                }
+                long now = System.currentTimeMillis();
+                if (now >= nextFlush) {
+                    flush();
+                    nextFlush = now + flushInterval;
+                }
+            }
+            flush();
+        } catch (IOException | InterruptedException ex) {
+            logger.error(ex.getMessage(), ex);
+            closed = true;
+            dropped.addAndGet(queue.size());
+            queue.clear();
+        }
+    }
+
+    /**
+     * Starts the writer thread
+     */
+    protected void start() {
+        thread.start();
+    }
+
+    /**
+     * Queues a record and returns true if the record has been queued or false if it has been dropped
+     *
+     * @param record the record
+     */
+    public boolean write(byte[] record) {
+        requireNonNull(record);
+        // The concurrent writes queue the records before the end of records queued by close
+        closeLock.readLock().lock();
+        try {
+            if (!closed) {
+                if (policy == OverflowPolicy.BLOCK) {
+                    queue.put(record);
+                    return true;
+                } else if (queue.offer(record)) {
+                    return true;
+                }
+            }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        } finally {
+            closeLock.readLock().unlock();
+        }
+        dropped.incrementAndGet();
+        return false;
+    }
+
+    /**
+     * Writes all the buffer content to the channel
+     *
+     * @param bfr the buffer
+     * @throws IOException in case of error
+     */
+    private void writeFully(ByteBuffer bfr) throws IOException {
+        while (bfr.hasRemaining()) {
+            channel.write(bfr);
+        }
+    }
+
+    /**
+     * Queues a text line and returns true if the line has been queued or false if it has been dropped
+     *
+     * @param line the line
+     */
+    public boolean writeLine(String line) {
+        byte[] text = line.getBytes(StandardCharsets.UTF_8);
+        byte[] record = new byte[text.length + NEW_LINE.length];
+        System.arraycopy(text, 0, record, 0, text.length);
+        System.arraycopy(NEW_LINE, 0, record, text.length, NEW_LINE.length);
+        return write(record);
+    }
+
+    /**
+     * The policy applied when the queue is full
+     */
+    public enum OverflowPolicy {
+        /**
+         * Drops the record
+         */
+        DROP,
+        /**
+         * Waits for room in the queue
+         */
+        BLOCK
+    }
+}
@@ -37,18 +37,33 @@ import io.reactivex.rxjava3.processors.BehaviorProcessor;
 import io.reactivex.rxjava3.processors.PublishProcessor;
 import io.reactivex.rxjava3.schedulers.Timed;
 import io.reactivex.rxjava3.subjects.CompletableSubject;
+import org.mmarini.Tuple2;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.util.List;
 import java.util.Optional;
+import java.util.concurrent.CopyOnWriteArrayList;
 import java.util.concurrent.TimeUnit;
 
 import static io.reactivex.rxjava3.core.Flowable.just;
 
 /**
  * The ReliableSocket manages the connectivity to a socket by handling the io errors reconnecting to the host
+ * <p>
+ * When the clock sync interval is positive, the socket periodically sends the clock sync requests
+ * <code>ck [originate]</code> and the robot replies <code>ck [originate] [receive] [transmit]</code>.
+ * The replies feed a {@link ClockSync} estimator, reset at each connection, that timestamps the status and cps
+ * records with the local time of their remote sample time.
+ * The clock sync replies are text records, so the clock sync cannot be combined with the binary telemetry mode
+ * and the requests are never sent to a socket in binary mode.
+ * </p>
+ * <p>
+ * When a {@link SocketSelector} is given, the generated sockets are read and written by the shared selector thread.
+ * </p>
  */
 public class ReliableSocket implements AsyncSocket {
+    public static final String CLOCK_SYNC_RECORD = "ck ";
     private final static Logger logger = LoggerFactory.getLogger(ReliableSocket.class);
 
     /**
@@ -61,7 +76,56 @@ public class ReliableSocket implements AsyncSocket {
      * @param readTimeout       the read timeout
      */
     public static ReliableSocket create(String host, int port, long connectionTimeout, long retryInterval, long readTimeout) {
-        return new ReliableSocket(host, port, connectionTimeout, retryInterval, readTimeout);
+        return new ReliableSocket(host, port, connectionTimeout, retryInterval, readTimeout, false, 0, null);
+    }
+
+    /**
+     * Returns a reliable socket
+     *
+     * @param host              the host
+     * @param port              the port
+     * @param connectionTimeout the connection timeout
+     * @param retryInterval     the retry interval
+     * @param readTimeout       the read timeout
+     * @param binaryTelemetry   true if binary telemetry mode is requested at each connection
+     */
+    public static ReliableSocket create(String host, int port, long connectionTimeout, long retryInterval, long readTimeout, boolean binaryTelemetry) {
+        return new ReliableSocket(host, port, connectionTimeout, retryInterval, readTimeout, binaryTelemetry, 0, null);
+    }
+
+    /**
+     * Returns a reliable socket
+     *
+     * @param host              the host
+     * @param port              the port
+     * @param connectionTimeout the connection timeout
+     * @param retryInterval     the retry interval
+     * @param readTimeout       the read timeout
+     * @param binaryTelemetry   true if binary telemetry mode is requested at each connection
+     * @param clockSyncInterval the interval of clock sync requests (ms) or 0 if no clock sync
+     * @throws IllegalArgumentException if clock sync is requested in binary telemetry mode
+     */
+    public static ReliableSocket create(String host, int port, long connectionTimeout, long retryInterval, long readTimeout, boolean binaryTelemetry,
+                                        long clockSyncInterval) {
+        return new ReliableSocket(host, port, connectionTimeout, retryInterval, readTimeout, binaryTelemetry, clockSyncInterval, null);
+    }
+
+    /**
+     * Returns a reliable socket
+     *
+     * @param host              the host
+     * @param port              the port
+     * @param connectionTimeout the connection timeout
+     * @param retryInterval     the retry interval
+     * @param readTimeout       the read timeout
+     * @param binaryTelemetry   true if binary telemetry mode is requested at each connection
+     * @param clockSyncInterval the interval of clock sync requests (ms) or 0 if no clock sync
+     * @param selector          the shared selector or null for blocking reading
+     * @throws IllegalArgumentException if clock sync is requested in binary telemetry mode
+     */
+    public static ReliableSocket create(String host, int port, long connectionTimeout, long retryInterval, long readTimeout, boolean binaryTelemetry,
+                                        long clockSyncInterval, SocketSelector selector) {
+        return new ReliableSocket(host, port, connectionTimeout, retryInterval, readTimeout, binaryTelemetry, clockSyncInterval, selector);
     }
 
     private final String host;
@@ -69,9 +133,14 @@ public class ReliableSocket implements AsyncSocket {
     private final long retryInterval;
     private final long connectionTimeout;
     private final long readTimeout;
+    private final boolean binaryTelemetry;
+    private final ClockSync clock;
+    private final SocketSelector selector;
+    private final List<Tuple2<String, RecordDispatcher.Handler>> handlers;
     private final BehaviorProcessor<Optional<AsyncSocketImpl>> sockets;
-    private final PublishProcessor<Timed<String>> readLines;
-    private final PublishProcessor<Timed<String>> readLog;
+    private final PublishProcessor<Timed<WheellyStatus>> readStatus;
+    private final PublishProcessor<Timed<Integer>> readCps;
+    private final PublishProcessor<ClockSyncEvent> clockEvents;
     private final PublishProcessor<String> writeLines;
     private final PublishProcessor<Throwable> errors;
     private final PublishProcessor<AsyncSocketImpl> badSockets;
@@ -85,16 +154,27 @@ public class ReliableSocket implements AsyncSocket {
      * @param connectionTimeout the connection timeout
      * @param retryInterval     the retry interval
      * @param readTimeout       the read timeout
+     * @param binaryTelemetry   true if binary telemetry mode is requested at each connection
+     * @param clockSyncInterval the interval of clock sync requests (ms) or 0 if no clock sync
+     * @param selector          the shared selector or null for blocking reading
      */
-    protected ReliableSocket(String host, int port, long connectionTimeout, long retryInterval, long readTimeout) {
+    protected ReliableSocket(String host, int port, long connectionTimeout, long retryInterval, long readTimeout, boolean binaryTelemetry,
+                             long clockSyncInterval, SocketSelector selector) {
+        if (binaryTelemetry && clockSyncInterval > 0) {
+            throw new IllegalArgumentException("Clock sync is not supported in binary telemetry mode");
+        }
         this.host = host;
+        this.selector = selector;
         this.port = port;
         this.connectionTimeout = connectionTimeout;
         this.retryInterval = retryInterval;
         this.readTimeout = readTimeout;
+        this.binaryTelemetry = binaryTelemetry;
+        this.handlers = new CopyOnWriteArrayList<>();
         this.sockets = BehaviorProcessor.createDefault(Optional.empty());
-        this.readLines = PublishProcessor.create();
-        this.readLog = PublishProcessor.create();
+        this.readStatus = PublishProcessor.create();
+        this.readCps = PublishProcessor.create();
+        this.clockEvents = PublishProcessor.create();
         this.writeLines = PublishProcessor.create();
         this.errors = PublishProcessor.create();
         this.badSockets = PublishProcessor.create();
@@ -102,6 +182,36 @@ public class ReliableSocket implements AsyncSocket {
         // Close bad socket and regenerate the socket after the retry interval
         badSockets.distinctUntilChanged()
                 .subscribe(socket -> retryConnection());
+        if (clockSyncInterval > 0) {
+            this.clock = ClockSync.create();
+            handlers.add(Tuple2.of(CLOCK_SYNC_RECORD, this::handleClockSync));
+            // Sends the clock sync requests to the connected socket
+            println(Flowable.interval(clockSyncInterval, TimeUnit.MILLISECONDS)
+                    .takeUntil(closed.toFlowable())
+                    .filter(t -> sockets.getValue() == null
+                            || sockets.getValue().map(socket -> !socket.isBinaryMode()).orElse(true))
+                    .map(t -> CLOCK_SYNC_RECORD + System.currentTimeMillis()));
+        } else {
+            this.clock = null;
+        }
+    }
+
+    /**
+     * Adds the handler of the records with a prefix to the current and the following sockets
+     *
+     * @param prefix  the record prefix
+     * @param handler the handler
+     */
+    public ReliableSocket addHandler(String prefix, RecordDispatcher.Handler handler) {
+        // Serialized with the publication of new sockets, so a reconnecting socket gets the handler once
+        synchronized (handlers) {
+            handlers.add(Tuple2.of(prefix, handler));
+            Optional<AsyncSocketImpl> current = sockets.getValue();
+            if (current != null) {
+                current.ifPresent(socket -> socket.addHandler(prefix, handler));
+            }
+        }
+        return this;
     }
 
     @Override
@@ -115,11 +225,12 @@ public class ReliableSocket implements AsyncSocket {
                 .subscribe(closed);
         sockets.onNext(Optional.empty());
         sockets.onComplete();
-        readLines.onComplete();
+        readStatus.onComplete();
+        readCps.onComplete();
+        clockEvents.onComplete();
         writeLines.onComplete();
         badSockets.onComplete();
         errors.onComplete();
-        readLog.onComplete();
         return this;
     }
 
@@ -138,25 +249,43 @@ public class ReliableSocket implements AsyncSocket {
      * Generates a new socket
      */
     private ReliableSocket generateNewSocket() {
-        AsyncSocketImpl socket = AsyncSocketImpl.create(host, port, connectionTimeout, readTimeout);
+        AsyncSocketImpl socket = AsyncSocketImpl.create(host, port, connectionTimeout, readTimeout, selector);
+        handlers.forEach(t -> socket.addHandler(t._1, t._2));
+        if (clock != null) {
+            // The remote clock may be restarted
+            clock.reset();
+            socket.setClock(clock);
+        }
         socket.connect();
         socket.connected()
                 .subscribe(() -> {
                             logger.debug("Socket connected");
                             // Attaches for writing each generated sockets and copies the writing lines from internal publisher to sockets
-                            socket.readLog().subscribe(readLog::onNext);
+                            socket.readParseErrors().subscribe(errors::onNext);
                             socket.readErrors()
                                     .subscribe(ex -> {
                                         errors.onNext(ex);
                                         sockets.onNext(Optional.empty());
                                         badSockets.onNext(socket);
                                     });
+                            if (binaryTelemetry) {
+                                // Negotiates the binary mode before any other command
+                                socket.requestBinaryMode();
+                            }
                             socket.println(writeLines);
-                            socket.readLines().subscribe(
-                                    readLines::onNext,
+                            socket.readStatus().subscribe(
+                                    readStatus::onNext,
+                                    ex -> {
+                                    });
+                            socket.readCps().subscribe(
+                                    readCps::onNext,
                                     ex -> {
                                     });
-                            sockets.onNext(Optional.of(socket));
+                            synchronized (handlers) {
+                                // Adds the handlers added while connecting
+                                handlers.forEach(t -> socket.addHandler(t._1, t._2));
+                                sockets.onNext(Optional.of(socket));
+                            }
                         },
                         ex -> {
                             logger.error("Error creating socket", ex);
@@ -166,6 +295,18 @@ public class ReliableSocket implements AsyncSocket {
         return this;
     }
 
+    /**
+     * Handles the clock sync record
+     *
+     * @param record    the record
+     * @param timestamp the receive timestamp
+     */
+    private void handleClockSync(StatusParser record, long timestamp) {
+        ClockSyncEvent event = ClockSyncEvent.from(record.line(), timestamp);
+        clock.add(event);
+        clockEvents.onNext(event);
+    }
+
     /**
      * Returns the connection status
      */
@@ -190,6 +331,13 @@ public class ReliableSocket implements AsyncSocket {
         return result;
     }
 
+    /**
+     * Returns the clock sync events
+     */
+    public Flowable<ClockSyncEvent> readClockSync() {
+        return clockEvents;
+    }
+
     @Override
     public Flowable<Boolean> readConnection() {
         return sockets.map(Optional::isPresent);
@@ -202,14 +350,36 @@ public class ReliableSocket implements AsyncSocket {
         return errors;
     }
 
+    @Override
+    public Flowable<Timed<Integer>> readCps() {
+        return readCps;
+    }
+
+    /**
+     * Returns the text lines of current socket.
+     * The lines are decoded by the sockets only while this flow is subscribed.
+     */
     @Override
     public Flowable<Timed<String>> readLines() {
-        return readLines;
+        return sockets.switchMap(socket -> socket
+                .map(s -> s.readLines().onErrorResumeNext(ex -> Flowable.empty()))
+                .orElse(Flowable.empty()));
     }
 
+    /**
+     * Returns the log of current socket.
+     * The log is produced by the sockets only while this flow is subscribed.
+     */
     @Override
     public Flowable<Timed<String>> readLog() {
-        return readLog;
+        return sockets.switchMap(socket -> socket
+                .map(AsyncSocketImpl::readLog)
+                .orElse(Flowable.empty()));
+    }
+
+    @Override
+    public Flowable<Timed<WheellyStatus>> readStatus() {
+        return readStatus;
     }
 
     /**
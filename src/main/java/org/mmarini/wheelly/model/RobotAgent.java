@@ -30,7 +30,9 @@
 package org.mmarini.wheelly.model;
 
 import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.core.Scheduler;
 import io.reactivex.rxjava3.processors.BehaviorProcessor;
+import io.reactivex.rxjava3.processors.FlowableProcessor;
 import io.reactivex.rxjava3.processors.PublishProcessor;
 import io.reactivex.rxjava3.schedulers.Schedulers;
 import io.reactivex.rxjava3.schedulers.Timed;
@@ -43,26 +45,48 @@ import java.util.Optional;
 import java.util.concurrent.TimeUnit;
 
 import static io.reactivex.rxjava3.core.Flowable.*;
+import static java.lang.Math.min;
 import static java.lang.Math.round;
 import static java.lang.String.format;
+import static java.util.Objects.requireNonNull;
 import static org.mmarini.wheelly.model.GridScannerMap.THRESHOLD_DISTANCE;
-import static org.mmarini.wheelly.model.HaltCommand.HALT_COMMAND;
+import static org.mmarini.wheelly.model.LatencyMonitor.Stage.*;
 
 public class RobotAgent implements InferenceMonitor {
     private static final Logger logger = LoggerFactory.getLogger(RobotAgent.class);
     private static final double MOTOR_SCALE = 0.1;
+    private static final long LATENCY_REPORT_INTERVAL = 1000;
+    private static final String WRITE_LOG_PREFIX = "> ";
 
     /**
      * Returns the behavior engine
      *
      * @param controller           the roboto controller
      * @param engine               the inference engine
-     * @param motorCommandInterval the interval between motor commands (ms)
-     * @param scanCommandInterval  the interval between scan commands (ms)
+     * @param motorCommandInterval the keep-alive interval of motor commands (ms)
+     * @param scanCommandInterval  the keep-alive interval of scan commands (ms)
      * @param responseTime         the response time of inference engine (ms)
      */
     public static RobotAgent create(RobotController controller, InferenceEngine engine, long motorCommandInterval, long scanCommandInterval, long responseTime) {
-        return new RobotAgent(controller, engine, motorCommandInterval, scanCommandInterval, responseTime);
+        return new RobotAgent(controller, engine, motorCommandInterval, scanCommandInterval, responseTime,
+                GridScannerMap.UNLIMITED, GridScannerMap.UNLIMITED, Schedulers.computation());
+    }
+
+    /**
+     * Returns the behavior engine
+     *
+     * @param controller           the roboto controller
+     * @param engine               the inference engine
+     * @param motorCommandInterval the keep-alive interval of motor commands (ms)
+     * @param scanCommandInterval  the keep-alive interval of scan commands (ms)
+     * @param responseTime         the response time of inference engine (ms)
+     * @param mapMaxTiles          the maximum number of map tiles
+     * @param mapMaxObstacles      the maximum number of map obstacles
+     */
+    public static RobotAgent create(RobotController controller, InferenceEngine engine, long motorCommandInterval, long scanCommandInterval, long responseTime,
+                                    int mapMaxTiles, int mapMaxObstacles) {
+        return new RobotAgent(controller, engine, motorCommandInterval, scanCommandInterval, responseTime,
+                mapMaxTiles, mapMaxObstacles, Schedulers.computation());
     }
 
     /**
@@ -70,39 +94,76 @@ public class RobotAgent implements InferenceMonitor {
      * @param engine       the inference engine
      */
     public static RobotAgent create(ConfigParameters configParams, InferenceEngine engine) {
-        RobotController controller = RawController.create(configParams);
-        return create(controller, engine, configParams.motorCommandInterval, configParams.scanCommandInterval, configParams.responseTime);
+        return create(configParams, engine, null, Schedulers.computation());
+    }
+
+    /**
+     * Returns the behavior engine processing the map, the inference and the commands on a scheduler partition
+     *
+     * @param configParams the configuration parameters
+     * @param engine       the inference engine
+     * @param selector     the shared socket selector or null for blocking reading
+     * @param scheduler    the scheduler of the agent flows
+     */
+    public static RobotAgent create(ConfigParameters configParams, InferenceEngine engine, SocketSelector selector, Scheduler scheduler) {
+        RobotController controller = configParams.simulated
+                ? SimulatedController.create(configParams)
+                : RawController.create(configParams, selector);
+        return new RobotAgent(controller, engine, configParams.motorCommandInterval, configParams.scanCommandInterval, configParams.responseTime,
+                configParams.mapMaxTiles, configParams.mapMaxObstacles, scheduler);
     }
 
     private final RobotController controller;
     private final BehaviorProcessor<Timed<MapStatus>> mapFlow;
+    private final PublishProcessor<Tuple2<Timed<MapStatus>, Long>> stampedMapFlow;
     private final PublishProcessor<String> inferenceMessages;
-    private final PublishProcessor<Tuple2<String, Optional<?>>> inferenceData;
+    private final FlowableProcessor<Tuple2<String, Optional<?>>> inferenceData;
     private final InferenceEngine engine;
     private final Flowable<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> commands;
     private final long responseTime;
+    private final LatencyMonitor latencyMonitor;
+    private final Flowable<LatencyMonitor.Report> latencies;
+    private final Scheduler scheduler;
+    private volatile long lastInferenceNanos;
+    private volatile long pendingInferenceNanos;
+    private volatile String lastCommand;
+    private volatile long lastCommandTime;
 
     /**
      * Creates the behavior engine
      *
      * @param controller           the roboto controller
      * @param engine               the inference engine
-     * @param motorCommandInterval the interval between motor commands (ms)
-     * @param scanCommandInterval  the interval between scan commands (ms)
+     * @param motorCommandInterval the keep-alive interval of motor commands (ms)
+     * @param scanCommandInterval  the keep-alive interval of scan commands (ms)
      * @param responseTime         the response time of inference engine (ms)
+     * @param mapMaxTiles          the maximum number of map tiles
+     * @param mapMaxObstacles      the maximum number of map obstacles
+     * @param scheduler            the scheduler of the agent flows
      */
-    protected RobotAgent(RobotController controller, InferenceEngine engine, long motorCommandInterval, long scanCommandInterval, long responseTime) {
+    protected RobotAgent(RobotController controller, InferenceEngine engine, long motorCommandInterval, long scanCommandInterval, long responseTime,
+                         int mapMaxTiles, int mapMaxObstacles, Scheduler scheduler) {
         this.responseTime = responseTime;
+        this.scheduler = requireNonNull(scheduler);
         logger.debug("Created");
         this.controller = controller;
         this.mapFlow = BehaviorProcessor.create();
-        this.inferenceData = PublishProcessor.create();
+        this.stampedMapFlow = PublishProcessor.create();
+        this.inferenceData = PublishProcessor.<Tuple2<String, Optional<?>>>create().toSerialized();
         this.inferenceMessages = PublishProcessor.create();
         this.engine = engine;
+        this.latencyMonitor = LatencyMonitor.create();
+        this.latencies = interval(LATENCY_REPORT_INTERVAL, TimeUnit.MILLISECONDS)
+                .map(t -> latencyMonitor.report(System.currentTimeMillis()))
+                .publish()
+                .autoConnect();
         this.commands = createCommandFlow();
 
-        createMapFlow();
+        createMapFlow(mapMaxTiles, mapMaxObstacles);
         createActionFlow(motorCommandInterval, scanCommandInterval);
+        createWriteLatencyFlow();
+        controller.readClockSync()
+                .subscribe(event -> latencyMonitor.recordMillis(RTT, event.getRoundTripTime()));
     }
 
     public RobotController action(Flowable<? extends WheellyCommand> commands) {
@@ -114,76 +175,77 @@ public class RobotAgent implements InferenceMonitor {
     }
 
     private void createActionFlow(long motorCommandInterval, long scanCommandInterval) {
-        // Splits the commands  flow in motor and scanner command flows
-        createMotionFlow(commands.map(Tuple2::getV2).map(Tuple2::getV1), motorCommandInterval);
-        createScanFlow(commands.map(Tuple2::getV2).map(Tuple2::getV2), scanCommandInterval);
+        // Sends the changed motor and scan commands and keeps alive the active ones
+        Flowable<Tuple2<MotionCommand, Integer>> robotCommands = commands.map(Tuple2::getV2)
+                .map(cmd -> Tuple2.of(normalize(cmd._1), cmd._2))
+                .distinctUntilChanged()
+                .doOnNext(cmd -> pendingInferenceNanos = lastInferenceNanos);
+        long keepAliveInterval = min(motorCommandInterval, scanCommandInterval);
+        controller.action(CommandScheduler.schedule(robotCommands, keepAliveInterval, scheduler)
+                .doOnNext(this::recordCommand));
     }
 
     private Flowable<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> createCommandFlow() {
         // Builds command flow by applying inference engine
-        return mapFlow.observeOn(Schedulers.computation())
-                .throttleLatest(responseTime, TimeUnit.MILLISECONDS)
+        return stampedMapFlow.observeOn(scheduler)
+                .throttleLatest(responseTime, TimeUnit.MILLISECONDS, scheduler)
                 .map(this::handleTransition)
                 .publish()
                 .autoConnect();
     }
 
-    private void createMapFlow() {
+    private void createMapFlow(int mapMaxTiles, int mapMaxObstacles) {
         // Creates map flow
         controller.readStatus()
-                .observeOn(Schedulers.computation())
-                .scanWith(() -> Tuple2.of(Optional.<Timed<WheellyStatus>>empty(), GridScannerMap.create(List.of(), THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0)),
-                        (t, status) -> Tuple2.of(Optional.of(status), t._2.process(status)))
+                .observeOn(scheduler)
+                .scanWith(() -> Tuple2.of(Optional.<Timed<WheellyStatus>>empty(),
+                                GridScannerMap.create(List.of(), THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0)
+                                        .setLimits(mapMaxTiles, mapMaxObstacles)),
+                        (t, status) -> {
+                            long start = System.nanoTime();
+                            GridScannerMap map = t._2.process(status);
+                            latencyMonitor.recordNanos(MAP, System.nanoTime() - start);
+                            return Tuple2.of(Optional.of(status), map);
+                        })
                 .concatMap(t -> t._1.map(tt -> just(
                                 new Timed<>(MapStatus.create(tt.value(), t._2), tt.time(), tt.unit())
                         ))
                         .orElse(empty()))
+                // Stamps the emission time to measure the queue latency independently of the status clock
+                .map(status -> Tuple2.of(status, System.nanoTime()))
+                .subscribe(stampedMapFlow);
+        stampedMapFlow.map(Tuple2::getV1)
                 .subscribe(mapFlow);
     }
 
-    private void createMotionFlow(Flowable<MotionCommand> commands, long motorCommandInterval) {
-        // The motor command are sample every motorCommandInterval (ms)
-        Flowable<MotionCommand> motorCommandFlow1 = commands.map(cmd -> {
-                    if (cmd instanceof MoveCommand) {
-                        MoveCommand moveCommand = (MoveCommand) cmd;
-                        double speed = round(moveCommand.speed / MOTOR_SCALE) * MOTOR_SCALE;
-                        return MoveCommand.create(moveCommand.direction, speed);
-                    } else {
-                        return cmd;
+    /**
+     * Records the latency of command writes from the controller log
+     */
+    private void createWriteLatencyFlow() {
+        controller.readLog()
+                .subscribe(log -> {
+                    String command = lastCommand;
+                    if (command != null && log.value().startsWith(WRITE_LOG_PREFIX)
+                            && log.value().regionMatches(WRITE_LOG_PREFIX.length(), command, 0, command.length())) {
+                        lastCommand = null;
+                        latencyMonitor.recordMillis(WRITE, log.time(TimeUnit.MILLISECONDS) - lastCommandTime);
                     }
-                })
-                .distinctUntilChanged();
-        Flowable<MotionCommand> motorCommandFlow = combineLatest(interval(motorCommandInterval, TimeUnit.MILLISECONDS),
-                motorCommandFlow1,
-                Tuple2::of)
-                .distinctUntilChanged()
-                .map(Tuple2::getV2)
-                .buffer(2, 1)
-                .filter(cmds -> !(cmds.get(0) == HALT_COMMAND
-                        && cmds.get(1) == HALT_COMMAND))
-                .map(cmds -> cmds.get(1));
-
-        controller.action(motorCommandFlow);
+                });
     }
 
-    private void createScanFlow(Flowable<Integer> commands, long scanCommandInterval) {
-        // the distinct scan command
-        Flowable<ScanCommand> scanCommandFlow = Flowable.combineLatest(
-                        interval(scanCommandInterval, TimeUnit.MILLISECONDS),
-                        commands.distinctUntilChanged(),
-                        Tuple2::of)
-                .distinctUntilChanged()
-                .map(Tuple2::getV2)
-                .buffer(2, 1)
-                .filter((list) -> !(list.get(0) == 0 && list.get(1) == 0))
-                .map(list -> list.get(1))
-//                .throttleLatest(50, TimeUnit.MILLISECONDS)
-                .map(ScanCommand::create);
-        controller.action(scanCommandFlow);
-    }
-
-    private Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> handleTransition(Timed<MapStatus> status) {
+    /**
+     * Returns the status and the command inferred by the engine
+     *
+     * @param stampedStatus the status and its emission time (ns)
+     */
+    private Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> handleTransition(Tuple2<Timed<MapStatus>, Long> stampedStatus) {
+        Timed<MapStatus> status = stampedStatus._1;
+        long start = System.nanoTime();
+        latencyMonitor.recordNanos(QUEUE, start - stampedStatus._2);
         Tuple2<MotionCommand, Integer> command = engine.process(status, this);
+        long end = System.nanoTime();
+        latencyMonitor.recordNanos(ENGINE, end - start);
+        lastInferenceNanos = end;
         return Tuple2.of(status, command);
     }
 
@@ -211,10 +273,24 @@ public class RobotAgent implements InferenceMonitor {
         return commands.map(FileFunctions::toString);
     }
 
+    /**
+     * Returns the flow of dump records (status and command)
+     */
+    public Flowable<Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>>> readDumpRecords() {
+        return commands;
+    }
+
     public Flowable<Throwable> readErrors() {
         return controller.readErrors();
     }
 
+    /**
+     * Returns the flow of control loop latency reports (one per second)
+     */
+    public Flowable<LatencyMonitor.Report> readLatencies() {
+        return latencies;
+    }
+
     public Flowable<Tuple2<String, Optional<?>>> readInferenceData() {
         return inferenceData;
     }
@@ -238,6 +314,36 @@ public class RobotAgent implements InferenceMonitor {
         return controller.readStatus();
     }
 
+    /**
+     * Returns the motion command with the speed rounded to the motor scale
+     *
+     * @param cmd the motion command
+     */
+    private static MotionCommand normalize(MotionCommand cmd) {
+        if (cmd instanceof MoveCommand) {
+            MoveCommand moveCommand = (MoveCommand) cmd;
+            double speed = round(moveCommand.speed / MOTOR_SCALE) * MOTOR_SCALE;
+            return MoveCommand.create(moveCommand.direction, speed);
+        } else {
+            return cmd;
+        }
+    }
+
+    /**
+     * Records the latency from the inference to the first command sent after a change
+     *
+     * @param command the sent command
+     */
+    private void recordCommand(WheellyCommand command) {
+        long inference = pendingInferenceNanos;
+        if (inference != 0) {
+            pendingInferenceNanos = 0;
+            latencyMonitor.recordNanos(SAMPLE, System.nanoTime() - inference);
+        }
+        lastCommandTime = System.currentTimeMillis();
+        lastCommand = command.getString();
+    }
+
     @Override
     public InferenceMonitor remove(String key) {
         inferenceData.onNext(Tuple2.of(key, Optional.empty()));
@@ -46,6 +46,13 @@ public interface RobotController {
      */
     RobotController close();
 
+    /**
+     * Returns the clock sync events of the robot clock
+     */
+    default Flowable<ClockSyncEvent> readClockSync() {
+        return Flowable.empty();
+    }
+
     /**
      *
      */
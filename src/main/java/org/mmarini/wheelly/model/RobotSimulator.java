@@ -0,0 +1,334 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import io.reactivex.rxjava3.schedulers.Timed;
+
+import java.awt.geom.Line2D;
+import java.awt.geom.Point2D;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static java.lang.Math.*;
+import static java.util.Objects.requireNonNull;
+import static org.mmarini.wheelly.model.ContactSensors.*;
+import static org.mmarini.wheelly.model.Utils.normalizeAngle;
+import static org.mmarini.wheelly.model.Utils.normalizeDegAngle;
+
+/**
+ * The kinematic simulator of the robot.
+ * <p>
+ * The robot is a differential drive vehicle with the maximum linear and angular speeds measured in
+ * <a href="../../../../../../docs/motion-data.md">motion data</a>,
+ * the motor speeds are computed by the motion control law of
+ * <a href="../../../../../../docs/Motion-process.md">motion process</a>.
+ * The world is a set of segments (the sides of obstacle polygons), the sonar distance is ray cast against the segments
+ * within the sensitivity cone and the contact sensors detect the segments near the bumpers.
+ * The simulator is not thread safe, each environment should use its own instance.
+ * </p>
+ */
+public class RobotSimulator {
+    public static final double MAX_LINEAR_SPEED = 0.319;
+    public static final double MAX_ANGULAR_SPEED = 1.17;
+    public static final double ROTATION_TAU = 0.25;
+    public static final double SENSOR_SPEED_DEG = 600;
+    public static final double MAX_SONAR_DISTANCE = 3;
+    public static final double SONAR_CONE_DEG = 15;
+    public static final double CONTACT_DISTANCE = 0.02;
+    public static final double VOLTAGE = 12;
+
+    private static final double[] SONAR_RAYS_DEG = {-SONAR_CONE_DEG, 0, SONAR_CONE_DEG};
+    private static final Point2D[] FRONT_LEFT_BUMPER = {
+            new Point2D.Double(X_FRONT, 0), new Point2D.Double(X_FRONT, Y_LEFT)};
+    private static final Point2D[] FRONT_RIGHT_BUMPER = {
+            new Point2D.Double(X_FRONT, 0), new Point2D.Double(X_FRONT, Y_RIGHT)};
+    private static final Point2D[] REAR_LEFT_BUMPER = {
+            new Point2D.Double(X_REAR, 0), new Point2D.Double(X_REAR, Y_LEFT)};
+    private static final Point2D[] REAR_RIGHT_BUMPER = {
+            new Point2D.Double(X_REAR, 0), new Point2D.Double(X_REAR, Y_RIGHT)};
+
+    /**
+     * Returns the simulator
+     *
+     * @param world     the world segments
+     * @param location  the initial location
+     * @param robotDeg  the initial direction DEG
+     * @param timestamp the initial simulation time (ms)
+     */
+    public static RobotSimulator create(List<Line2D> world, Point2D location, int robotDeg, long timestamp) {
+        return new RobotSimulator(world, location, robotDeg, timestamp);
+    }
+
+    /**
+     * Returns the segments of the sides of polygons
+     *
+     * @param polygons the polygons (list of vertices)
+     */
+    public static List<Line2D> polygons(List<List<Point2D>> polygons) {
+        List<Line2D> result = new ArrayList<>();
+        for (List<Point2D> polygon : polygons) {
+            int n = polygon.size();
+            if (n == 2) {
+                result.add(new Line2D.Double(polygon.get(0), polygon.get(1)));
+            } else if (n > 2) {
+                for (int i = 0; i < n; i++) {
+                    result.add(new Line2D.Double(polygon.get(i), polygon.get((i + 1) % n)));
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the segments of the world polygons
+     *
+     * @param node the world node (list of polygons of [x, y] vertices)
+     */
+    public static List<Line2D> worldFromJson(JsonNode node) {
+        requireNonNull(node);
+        List<List<Point2D>> polygons = new ArrayList<>();
+        for (JsonNode polygon : node) {
+            List<Point2D> vertices = new ArrayList<>();
+            for (JsonNode vertex : polygon) {
+                vertices.add(new Point2D.Double(vertex.get(0).asDouble(), vertex.get(1).asDouble()));
+            }
+            polygons.add(vertices);
+        }
+        return polygons(polygons);
+    }
+
+    /**
+     * Returns the distance of ray to the nearest segment or {@link Double#POSITIVE_INFINITY} if no segment intersects
+     * the ray
+     *
+     * @param world    the world segments
+     * @param x        the ray origin abscissa
+     * @param y        the ray origin ordinate
+     * @param rad      the ray direction RAD
+     * @param maxRange the maximum distance
+     */
+    static double rayCast(List<Line2D> world, double x, double y, double rad, double maxRange) {
+        double dx = cos(rad);
+        double dy = sin(rad);
+        double result = Double.POSITIVE_INFINITY;
+        for (Line2D segment : world) {
+            double ex = segment.getX2() - segment.getX1();
+            double ey = segment.getY2() - segment.getY1();
+            double det = ex * dy - ey * dx;
+            if (det == 0) {
+                continue;
+            }
+            double wx = segment.getX1() - x;
+            double wy = segment.getY1() - y;
+            // Ray parameter and segment parameter of intersection
+            double t = (ex * wy - ey * wx) / det;
+            double u = (dx * wy - dy * wx) / det;
+            if (t >= 0 && t <= maxRange && u >= 0 && u <= 1 && t < result) {
+                result = t;
+            }
+        }
+        return result;
+    }
+
+    private final List<Line2D> world;
+    private double x;
+    private double y;
+    private double robotRad;
+    private double sensorDeg;
+    private double leftSpeed;
+    private double rightSpeed;
+    private long timestamp;
+    private MotionCommand motionCommand;
+    private int scanDeg;
+
+    /**
+     * Creates the simulator
+     *
+     * @param world     the world segments
+     * @param location  the initial location
+     * @param robotDeg  the initial direction DEG
+     * @param timestamp the initial simulation time (ms)
+     */
+    protected RobotSimulator(List<Line2D> world, Point2D location, int robotDeg, long timestamp) {
+        this.world = requireNonNull(world);
+        this.x = location.getX();
+        this.y = location.getY();
+        this.robotRad = toRadians(normalizeDegAngle(robotDeg));
+        this.timestamp = timestamp;
+        this.motionCommand = HaltCommand.HALT_COMMAND;
+    }
+
+    /**
+     * Returns the contact sensors signals
+     */
+    private int contacts() {
+        return (isContact(FRONT_LEFT_BUMPER) ? FRONT_LEFT_MASK : 0)
+                | (isContact(FRONT_RIGHT_BUMPER) ? FRONT_RIGHT_MASK : 0)
+                | (isContact(REAR_LEFT_BUMPER) ? REAR_LEFT_MASK : 0)
+                | (isContact(REAR_RIGHT_BUMPER) ? REAR_RIGHT_MASK : 0);
+    }
+
+    /**
+     * Returns the simulation time (ms)
+     */
+    public long getTimestamp() {
+        return timestamp;
+    }
+
+    /**
+     * Returns true if a bumper touches any world segment
+     *
+     * @param bumper the relative end points of bumper
+     */
+    private boolean isContact(Point2D[] bumper) {
+        double ca = cos(robotRad);
+        double sa = sin(robotRad);
+        Point2D p0 = bumper[0];
+        Point2D p1 = bumper[1];
+        double x0 = x + p0.getX() * ca - p0.getY() * sa;
+        double y0 = y + p0.getX() * sa + p0.getY() * ca;
+        double x1 = x + p1.getX() * ca - p1.getY() * sa;
+        double y1 = y + p1.getX() * sa + p1.getY() * ca;
+        for (Line2D segment : world) {
+            if (segment.intersectsLine(x0, y0, x1, y1)
+                    || segment.ptSegDist(x0, y0) <= CONTACT_DISTANCE
+                    || segment.ptSegDist(x1, y1) <= CONTACT_DISTANCE
+                    || Line2D.ptSegDist(x0, y0, x1, y1, segment.getX1(), segment.getY1()) <= CONTACT_DISTANCE
+                    || Line2D.ptSegDist(x0, y0, x1, y1, segment.getX2(), segment.getY2()) <= CONTACT_DISTANCE) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Sets the motion command
+     *
+     * @param command the command
+     */
+    public RobotSimulator move(MotionCommand command) {
+        this.motionCommand = requireNonNull(command);
+        return this;
+    }
+
+    /**
+     * Sets the target sensor direction
+     *
+     * @param sensorDeg the sensor direction relative to the robot DEG
+     */
+    public RobotSimulator scan(int sensorDeg) {
+        this.scanDeg = min(max(sensorDeg, -90), 90);
+        return this;
+    }
+
+    /**
+     * Returns the sonar distance or 0 if no echo
+     */
+    private double sonarDistance() {
+        double sensorRad = robotRad + toRadians(sensorDeg);
+        double distance = Double.POSITIVE_INFINITY;
+        for (double rayDeg : SONAR_RAYS_DEG) {
+            distance = min(distance, rayCast(world, x, y, sensorRad + toRadians(rayDeg), MAX_SONAR_DISTANCE));
+        }
+        return Double.isInfinite(distance) ? 0 : distance;
+    }
+
+    /**
+     * Returns the robot status after the simulation of an interval
+     *
+     * @param interval the interval (ms)
+     */
+    public Timed<WheellyStatus> step(long interval) {
+        double dt = interval * 1e-3;
+        int contacts = contacts();
+        boolean canMoveForward = (contacts & FRONT_MASK) == 0;
+        boolean canMoveBackward = (contacts & REAR_MASK) == 0;
+        boolean halt = !(motionCommand instanceof MoveCommand);
+        int moveDeg = 0;
+        double moveSpeed = 0;
+
+        // Motion control law
+        double left = 0;
+        double right = 0;
+        if (!halt) {
+            MoveCommand move = (MoveCommand) motionCommand;
+            moveDeg = move.direction;
+            moveSpeed = move.speed;
+            double dRad = normalizeAngle(toRadians(moveDeg) - robotRad);
+            double sum = 2 * moveSpeed;
+            double diff = 2 * dRad / (MAX_ANGULAR_SPEED * ROTATION_TAU);
+            left = (sum + diff) / 2;
+            right = (sum - diff) / 2;
+            double lambda = min(1, 1 / max(abs(left), abs(right)));
+            left *= lambda;
+            right *= lambda;
+        }
+        double linearSpeed = (left + right) / 2 * MAX_LINEAR_SPEED;
+        if ((linearSpeed > 0 && !canMoveForward) || (linearSpeed < 0 && !canMoveBackward)) {
+            linearSpeed = 0;
+        }
+        double angularSpeed = (left - right) / 2 * MAX_ANGULAR_SPEED;
+
+        // Kinematics
+        double newRad = normalizeAngle(robotRad + angularSpeed * dt);
+        double midRad = robotRad + angularSpeed * dt / 2;
+        double newX = x + linearSpeed * dt * cos(midRad);
+        double newY = y + linearSpeed * dt * sin(midRad);
+        if (world.stream().noneMatch(segment -> segment.intersectsLine(x, y, newX, newY))) {
+            // The robot cannot cross the walls
+            x = newX;
+            y = newY;
+        }
+        robotRad = newRad;
+        leftSpeed = left;
+        rightSpeed = right;
+
+        // Sensor servo
+        double sensorStep = SENSOR_SPEED_DEG * dt;
+        sensorDeg = sensorDeg + min(max(scanDeg - sensorDeg, -sensorStep), sensorStep);
+
+        timestamp += interval;
+        int newContacts = contacts();
+        WheellyStatus status = WheellyStatus.create(new Point2D.Double(x, y),
+                normalizeDegAngle((int) round(toDegrees(robotRad))),
+                (int) round(sensorDeg),
+                sonarDistance(),
+                leftSpeed, rightSpeed,
+                newContacts, VOLTAGE,
+                (newContacts & FRONT_MASK) == 0,
+                (newContacts & REAR_MASK) == 0,
+                false,
+                halt, moveDeg, moveSpeed,
+                scanDeg);
+        return new Timed<>(status, timestamp, TimeUnit.MILLISECONDS);
+    }
+}
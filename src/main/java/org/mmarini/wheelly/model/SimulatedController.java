@@ -0,0 +1,226 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.core.Scheduler;
+import io.reactivex.rxjava3.disposables.CompositeDisposable;
+import io.reactivex.rxjava3.processors.BehaviorProcessor;
+import io.reactivex.rxjava3.processors.PublishProcessor;
+import io.reactivex.rxjava3.schedulers.Schedulers;
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.awt.geom.Line2D;
+import java.awt.geom.Point2D;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+import static java.lang.Math.max;
+import static java.lang.Math.round;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The robot controller of a simulated robot.
+ * <p>
+ * The robot is simulated by {@link RobotSimulator} in a world of polygons without the hardware.
+ * The simulation advances by status interval steps of simulated time and each step emits the robot status,
+ * the steps are scheduled every status interval divided by the speed up factor of real time,
+ * so the simulation may run faster than real time.
+ * The status timestamps are the simulated time.
+ * The commands and the simulation steps are serialized on a dedicated thread.
+ * </p>
+ */
+public class SimulatedController implements RobotController {
+    public static final long DEFAULT_STATUS_INTERVAL = 50;
+    public static final double DEFAULT_SPEED_UP = 1;
+    private static final long CPS_INTERVAL = 1000;
+    private static final Logger logger = LoggerFactory.getLogger(SimulatedController.class);
+
+    /**
+     * Returns the simulated controller
+     *
+     * @param world          the world segments
+     * @param location       the initial robot location
+     * @param robotDeg       the initial robot direction DEG
+     * @param statusInterval the interval between status of simulated time (ms)
+     * @param speedUp        the speed up factor of simulated time relative to real time
+     */
+    public static SimulatedController create(List<Line2D> world, Point2D location, int robotDeg,
+                                             long statusInterval, double speedUp) {
+        return new SimulatedController(world, location, robotDeg, statusInterval, speedUp);
+    }
+
+    /**
+     * Returns the simulated controller
+     *
+     * @param configParams the config parameters
+     */
+    public static SimulatedController create(ConfigParameters configParams) {
+        return create(configParams.world, configParams.startLocation, configParams.startDirection,
+                configParams.statusInterval, configParams.speedUp);
+    }
+
+    private final RobotSimulator simulator;
+    private final long statusInterval;
+    private final double speedUp;
+    private final ExecutorService executor;
+    private final Scheduler scheduler;
+    private final PublishProcessor<Timed<WheellyStatus>> states;
+    private final PublishProcessor<Timed<Integer>> cps;
+    private final PublishProcessor<Throwable> errors;
+    private final PublishProcessor<Timed<String>> logs;
+    private final BehaviorProcessor<Boolean> connection;
+    private final CompositeDisposable disposables;
+
+    /**
+     * Creates the simulated controller
+     *
+     * @param world          the world segments
+     * @param location       the initial robot location
+     * @param robotDeg       the initial robot direction DEG
+     * @param statusInterval the interval between status of simulated time (ms)
+     * @param speedUp        the speed up factor of simulated time relative to real time
+     */
+    protected SimulatedController(List<Line2D> world, Point2D location, int robotDeg,
+                                  long statusInterval, double speedUp) {
+        if (statusInterval <= 0) {
+            throw new IllegalArgumentException(String.format("Status interval must be positive (%d)", statusInterval));
+        }
+        if (!(speedUp > 0)) {
+            throw new IllegalArgumentException(String.format("Speed up must be positive (%g)", speedUp));
+        }
+        this.simulator = RobotSimulator.create(requireNonNull(world), requireNonNull(location), robotDeg,
+                System.currentTimeMillis());
+        this.statusInterval = statusInterval;
+        this.speedUp = speedUp;
+        this.executor = Executors.newSingleThreadExecutor();
+        this.scheduler = Schedulers.from(executor);
+        this.states = PublishProcessor.create();
+        this.cps = PublishProcessor.create();
+        this.errors = PublishProcessor.create();
+        this.logs = PublishProcessor.create();
+        this.connection = BehaviorProcessor.createDefault(false);
+        this.disposables = new CompositeDisposable();
+    }
+
+    @Override
+    public SimulatedController action(Flowable<? extends WheellyCommand> commands) {
+        disposables.add(commands.observeOn(scheduler)
+                .subscribe(this::handleCommand, errors::onNext));
+        return this;
+    }
+
+    @Override
+    public SimulatedController close() {
+        disposables.dispose();
+        connection.onNext(false);
+        connection.onComplete();
+        states.onComplete();
+        cps.onComplete();
+        errors.onComplete();
+        logs.onComplete();
+        executor.shutdown();
+        return this;
+    }
+
+    /**
+     * Applies and logs the command
+     *
+     * @param command the command
+     */
+    private void handleCommand(WheellyCommand command) {
+        applyCommand(command);
+        logs.onNext(new Timed<>("> " + command.getString(), System.currentTimeMillis(), TimeUnit.MILLISECONDS));
+    }
+
+    /**
+     * Applies the command to the simulator
+     *
+     * @param command the command
+     */
+    private void applyCommand(WheellyCommand command) {
+        if (command instanceof CompositeCommand) {
+            for (WheellyCommand cmd : ((CompositeCommand) command).commands) {
+                applyCommand(cmd);
+            }
+        } else if (command instanceof MotionCommand) {
+            simulator.move((MotionCommand) command);
+        } else if (command instanceof ScanCommand) {
+            simulator.scan(((ScanCommand) command).direction);
+        }
+    }
+
+    @Override
+    public Flowable<Boolean> readConnection() {
+        return connection;
+    }
+
+    @Override
+    public Flowable<Timed<Integer>> readCps() {
+        return cps;
+    }
+
+    @Override
+    public Flowable<Throwable> readErrors() {
+        return errors;
+    }
+
+    @Override
+    public Flowable<Timed<String>> readLog() {
+        return logs;
+    }
+
+    @Override
+    public Flowable<Timed<WheellyStatus>> readStatus() {
+        return states;
+    }
+
+    @Override
+    public SimulatedController start() {
+        long period = max(round(statusInterval * 1000 / speedUp), 1);
+        long stepsPerCps = max(CPS_INTERVAL / statusInterval, 1);
+        logger.info("Simulating status every {} ms ({} us real time)", statusInterval, period);
+        disposables.add(Flowable.interval(period, TimeUnit.MICROSECONDS, scheduler)
+                .onBackpressureDrop()
+                .subscribe(tick -> {
+                    Timed<WheellyStatus> status = simulator.step(statusInterval);
+                    states.onNext(status);
+                    if ((tick + 1) % stepsPerCps == 0) {
+                        cps.onNext(new Timed<>((int) (1000 / statusInterval), status.time(), TimeUnit.MILLISECONDS));
+                    }
+                }, errors::onNext));
+        connection.onNext(true);
+        return this;
+    }
+}
@@ -0,0 +1,328 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.ClosedSelectorException;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.SocketChannel;
+import java.util.Iterator;
+import java.util.List;
+import java.util.Queue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.TimeoutException;
+
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The SocketSelector multiplexes the reading and the writing of several non blocking socket channels
+ * on a single selector thread.
+ * <p>
+ * The channels are registered with a {@link Handler} that processes the received data on the selector thread,
+ * so the handlers should not block.
+ * The data written to a registration are queued and flushed by the selector thread when the channel is writable.
+ * The channels that receive no data within the read timeout are closed and notified to the handler by
+ * a {@link TimeoutException}.
+ * </p>
+ */
+public class SocketSelector {
+    private static final long SELECT_INTERVAL = 100;
+    private static final Logger logger = LoggerFactory.getLogger(SocketSelector.class);
+
+    /**
+     * Returns the selector with the selector thread started
+     *
+     * @param name the name of selector thread
+     * @throws IOException in case of error
+     */
+    public static SocketSelector create(String name) throws IOException {
+        SocketSelector result = new SocketSelector(Selector.open());
+        Thread thread = new Thread(result::run, name);
+        thread.setDaemon(true);
+        thread.start();
+        return result;
+    }
+
+    private final Selector selector;
+    private final Queue<Runnable> tasks;
+    private final List<Registration> registrations;
+    private volatile boolean closed;
+
+    /**
+     * Creates the selector
+     *
+     * @param selector the nio selector
+     */
+    protected SocketSelector(Selector selector) {
+        this.selector = requireNonNull(selector);
+        this.tasks = new ConcurrentLinkedQueue<>();
+        this.registrations = new CopyOnWriteArrayList<>();
+    }
+
+    /**
+     * Closes the selector.
+     * The registered channels are notified by a {@link ClosedChannelException}
+     */
+    public void close() {
+        closed = true;
+        selector.wakeup();
+    }
+
+    /**
+     * Returns the number of registered channels
+     */
+    public int getNumChannels() {
+        return registrations.size();
+    }
+
+    /**
+     * Returns the registration of a channel.
+     * The channel is set to non blocking mode and registered for reading with the selector on the selector thread.
+     *
+     * @param channel     the connected channel
+     * @param buffer      the read buffer
+     * @param readTimeout the read timeout (ms)
+     * @param handler     the handler of the channel events
+     * @throws IOException              in case of error
+     * @throws ClosedSelectorException if the selector is closed
+     */
+    public Registration register(SocketChannel channel, ByteBuffer buffer, long readTimeout, Handler handler) throws IOException {
+        if (closed) {
+            throw new ClosedSelectorException();
+        }
+        requireNonNull(channel);
+        requireNonNull(buffer);
+        requireNonNull(handler);
+        channel.configureBlocking(false);
+        Registration result = new Registration(channel, buffer, readTimeout, handler);
+        submit(() -> {
+            try {
+                result.key = channel.register(selector, SelectionKey.OP_READ, result);
+                result.lastRead = System.currentTimeMillis();
+                registrations.add(result);
+            } catch (ClosedChannelException ex) {
+                handler.onError(ex);
+            }
+        });
+        return result;
+    }
+
+    /**
+     * Runs the selector loop
+     */
+    private void run() {
+        logger.debug("Selector started");
+        try {
+            while (!closed) {
+                selector.select(SELECT_INTERVAL);
+                for (Runnable task; (task = tasks.poll()) != null; ) {
+                    task.run();
+                }
+                Iterator<SelectionKey> keys = selector.selectedKeys().iterator();
+                while (keys.hasNext()) {
+                    SelectionKey key = keys.next();
+                    keys.remove();
+                    Registration registration = (Registration) key.attachment();
+                    if (key.isValid() && key.isWritable()) {
+                        registration.flush();
+                    }
+                    if (key.isValid() && key.isReadable()) {
+                        registration.read();
+                    }
+                }
+                long now = System.currentTimeMillis();
+                for (int i = registrations.size() - 1; i >= 0; i--) {
+                    Registration registration = registrations.get(i);
+                    if (!registration.channel.isOpen()) {
+                        registration.terminate(new ClosedChannelException());
+                    } else if (registration.readTimeout > 0 && now - registration.lastRead > registration.readTimeout) {
+                        registration.terminate(new TimeoutException());
+                    }
+                }
+            }
+        } catch (Throwable ex) {
+            logger.error("Selector error", ex);
+        }
+        for (int i = registrations.size() - 1; i >= 0; i--) {
+            registrations.get(i).terminate(new ClosedChannelException());
+        }
+        try {
+            selector.close();
+        } catch (IOException ex) {
+            logger.error("Error closing selector", ex);
+        }
+        logger.debug("Selector closed");
+    }
+
+    /**
+     * Submits a task to the selector thread
+     *
+     * @param task the task
+     */
+    private void submit(Runnable task) {
+        tasks.offer(task);
+        selector.wakeup();
+    }
+
+    /**
+     * The handler of channel events.
+     * The methods are called by the selector thread.
+     */
+    public interface Handler {
+        /**
+         * Handles the end of stream
+         */
+        void onEnd();
+
+        /**
+         * Handles the channel error
+         *
+         * @param ex the error
+         */
+        void onError(Throwable ex);
+
+        /**
+         * Handles the received data
+         *
+         * @param buffer    the read buffer with the received data from the start to the position
+         * @param timestamp the receive timestamp (ms)
+         */
+        void onRead(ByteBuffer buffer, long timestamp);
+    }
+
+    /**
+     * The registration of a channel
+     */
+    public class Registration {
+        private final SocketChannel channel;
+        private final ByteBuffer buffer;
+        private final long readTimeout;
+        private final Handler handler;
+        private final Queue<ByteBuffer> writes;
+        private SelectionKey key;
+        private long lastRead;
+
+        /**
+         * Creates the registration
+         *
+         * @param channel     the channel
+         * @param buffer      the read buffer
+         * @param readTimeout the read timeout (ms)
+         * @param handler     the handler
+         */
+        protected Registration(SocketChannel channel, ByteBuffer buffer, long readTimeout, Handler handler) {
+            this.channel = channel;
+            this.buffer = buffer;
+            this.readTimeout = readTimeout;
+            this.handler = handler;
+            this.writes = new ConcurrentLinkedQueue<>();
+        }
+
+        /**
+         * Writes the queued data until the channel send buffer is full
+         */
+        private void flush() {
+            try {
+                for (ByteBuffer data; (data = writes.peek()) != null; writes.poll()) {
+                    channel.write(data);
+                    if (data.hasRemaining()) {
+                        // Waits for writable channel
+                        key.interestOps(SelectionKey.OP_READ | SelectionKey.OP_WRITE);
+                        return;
+                    }
+                }
+                key.interestOps(SelectionKey.OP_READ);
+            } catch (Throwable ex) {
+                terminate(ex);
+            }
+        }
+
+        /**
+         * Reads the available data
+         */
+        private void read() {
+            try {
+                int n = channel.read(buffer);
+                if (n < 0) {
+                    terminate(null);
+                } else if (n > 0) {
+                    lastRead = System.currentTimeMillis();
+                    handler.onRead(buffer, lastRead);
+                }
+            } catch (Throwable ex) {
+                terminate(ex);
+            }
+        }
+
+        /**
+         * Deregisters the channel and notifies the handler
+         *
+         * @param ex the error or null if end of stream
+         */
+        private void terminate(Throwable ex) {
+            registrations.remove(this);
+            key.cancel();
+            if (ex instanceof TimeoutException) {
+                try {
+                    channel.close();
+                } catch (IOException e) {
+                    logger.error("Error closing channel", e);
+                }
+            }
+            if (ex != null) {
+                handler.onError(ex);
+            } else {
+                handler.onEnd();
+            }
+        }
+
+        /**
+         * Queues the data to be written
+         *
+         * @param data the data
+         */
+        public Registration write(ByteBuffer data) {
+            writes.offer(data);
+            submit(() -> {
+                if (key != null && key.isValid()) {
+                    flush();
+                }
+            });
+            return this;
+        }
+    }
+}
@@ -0,0 +1,365 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.geom.Point2D;
+import java.nio.charset.StandardCharsets;
+
+import static java.lang.String.format;
+
+/**
+ * Parses the robot text records directly from the received bytes.
+ * <p>
+ * The parser tokenizes the bytes of a line in place and converts the numeric fields without creating
+ * intermediate strings.
+ * The numbers out of the exact conversion range fall back to the standard parsers.
+ * The parser is reused line by line and is not thread safe.
+ * </p>
+ */
+public class StatusParser {
+    private static final byte SPACE = ' ';
+    private static final byte[] STATUS_PREFIX = "st ".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] CPS_PREFIX = "cs ".getBytes(StandardCharsets.US_ASCII);
+    private static final int NO_CPS_PARAMS = 3;
+    private static final int MAX_LONG_DIGITS = 18;
+    private static final long MAX_EXACT_MANTISSA = 1L << 53;
+    private static final double[] POWERS_OF_TEN = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+            1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    /**
+     * Returns the parser
+     */
+    public static StatusParser create() {
+        return new StatusParser();
+    }
+
+    private byte[] data;
+    private int from;
+    private int to;
+    private int pos;
+    private int tokenStart;
+    private int tokenEnd;
+
+    /**
+     * Creates the parser
+     */
+    protected StatusParser() {
+    }
+
+    /**
+     * Returns the first byte of the line
+     */
+    public byte firstByte() {
+        return data[from];
+    }
+
+    /**
+     * Returns true if the line is equal to an ASCII text
+     *
+     * @param text the text
+     */
+    public boolean equalsTo(String text) {
+        if (to - from != text.length()) {
+            return false;
+        }
+        for (int i = 0; i < text.length(); i++) {
+            if (data[from + i] != text.charAt(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns true if the line is a clock per second record
+     */
+    public boolean isCps() {
+        return startsWith(CPS_PREFIX);
+    }
+
+    /**
+     * Returns true if the line is empty
+     */
+    public boolean isEmpty() {
+        return to == from;
+    }
+
+    /**
+     * Returns true if the line is a status record
+     */
+    public boolean isStatus() {
+        return startsWith(STATUS_PREFIX);
+    }
+
+    /**
+     * Returns the line as string
+     */
+    public String line() {
+        return new String(data, from, to - from, StandardCharsets.UTF_8);
+    }
+
+    /**
+     * Moves to the next token returning true if exists
+     */
+    private boolean next() {
+        if (pos > to) {
+            return false;
+        }
+        tokenStart = pos;
+        int i = pos;
+        while (i < to && data[i] != SPACE) {
+            i++;
+        }
+        tokenEnd = i;
+        pos = i + 1;
+        return true;
+    }
+
+    /**
+     * Returns the clock per second of a cps record
+     * The record is formatted as
+     * <pre>
+     *     cs [time] [cps]
+     * </pre>
+     *
+     * @throws IllegalArgumentException in case of wrong record
+     */
+    public int parseCps() {
+        pos = from;
+        for (int i = 0; i < NO_CPS_PARAMS - 1; i++) {
+            requireToken("cps command");
+        }
+        int cps = requireToken("cps command").parseIntToken();
+        if (next()) {
+            throw new IllegalArgumentException(format("Wrong cps command \"%s\"", line()));
+        }
+        return cps;
+    }
+
+    /**
+     * Returns the double value of current token
+     */
+    private double parseDoubleToken() {
+        int i = tokenStart;
+        boolean negative = false;
+        if (i < tokenEnd && (data[i] == '-' || data[i] == '+')) {
+            negative = data[i] == '-';
+            i++;
+        }
+        long mantissa = 0;
+        int digits = 0;
+        int scale = 0;
+        for (; i < tokenEnd && data[i] >= '0' && data[i] <= '9'; i++) {
+            mantissa = mantissa * 10 + data[i] - '0';
+            digits++;
+        }
+        if (i < tokenEnd && data[i] == '.') {
+            i++;
+            for (; i < tokenEnd && data[i] >= '0' && data[i] <= '9'; i++) {
+                mantissa = mantissa * 10 + data[i] - '0';
+                digits++;
+                scale++;
+            }
+        }
+        int exponent = 0;
+        if (digits > 0 && i < tokenEnd && (data[i] == 'e' || data[i] == 'E')) {
+            i++;
+            boolean negativeExp = false;
+            if (i < tokenEnd && (data[i] == '-' || data[i] == '+')) {
+                negativeExp = data[i] == '-';
+                i++;
+            }
+            int expDigits = 0;
+            for (; i < tokenEnd && data[i] >= '0' && data[i] <= '9' && expDigits < 4; i++) {
+                exponent = exponent * 10 + data[i] - '0';
+                expDigits++;
+            }
+            if (expDigits == 0) {
+                digits = 0;
+            }
+            if (negativeExp) {
+                exponent = -exponent;
+            }
+        }
+        int exp10 = exponent - scale;
+        if (i != tokenEnd || digits == 0 || digits > MAX_LONG_DIGITS
+                || mantissa >= MAX_EXACT_MANTISSA || exp10 < -22 || exp10 > 22) {
+            // Not exactly convertible or not a plain decimal number
+            return Double.parseDouble(token());
+        }
+        // Both the mantissa and the power of ten are exact so the result is correctly rounded
+        double value = exp10 >= 0 ? mantissa * POWERS_OF_TEN[exp10] : mantissa / POWERS_OF_TEN[-exp10];
+        return negative ? -value : value;
+    }
+
+    /**
+     * Returns the int value of current token
+     */
+    private int parseIntToken() {
+        long value = parseLongToken();
+        if (value < Integer.MIN_VALUE || value > Integer.MAX_VALUE) {
+            throw new NumberFormatException(format("For input string: \"%s\"", token()));
+        }
+        return (int) value;
+    }
+
+    /**
+     * Returns the long value of current token
+     */
+    private long parseLongToken() {
+        int i = tokenStart;
+        boolean negative = false;
+        if (i < tokenEnd && (data[i] == '-' || data[i] == '+')) {
+            negative = data[i] == '-';
+            i++;
+        }
+        int digits = tokenEnd - i;
+        if (digits == 0 || digits > MAX_LONG_DIGITS) {
+            return Long.parseLong(token());
+        }
+        long value = 0;
+        for (; i < tokenEnd; i++) {
+            int digit = data[i] - '0';
+            if (digit < 0 || digit > 9) {
+                throw new NumberFormatException(format("For input string: \"%s\"", token()));
+            }
+            value = value * 10 + digit;
+        }
+        return negative ? -value : value;
+    }
+
+    /**
+     * Returns the remote sample time of a status or cps record (ms)
+     * The sample time is the second token of the record.
+     *
+     * @throws IllegalArgumentException in case of wrong record
+     */
+    public long parseSampleTime() {
+        pos = from;
+        requireToken("record");
+        return requireToken("record").parseLongToken();
+    }
+
+    /**
+     * Returns the Wheelly status of a status record
+     *
+     * @throws IllegalArgumentException in case of wrong record
+     * @see WheellyStatus#from(String)
+     */
+    public WheellyStatus parseStatus() {
+        pos = from;
+        // Skips record type and sample time
+        requireToken("status message");
+        requireToken("status message");
+        double x = requireToken("status message").parseDoubleToken();
+        double y = requireToken("status message").parseDoubleToken();
+        int robotDeg = requireToken("status message").parseIntToken();
+        int sensorDirection = requireToken("status message").parseIntToken();
+        double distance = requireToken("status message").parseDoubleToken();
+        double left = requireToken("status message").parseDoubleToken();
+        double right = requireToken("status message").parseDoubleToken();
+        int contactSensors = requireToken("status message").parseIntToken();
+        double voltage = requireToken("status message").parseDoubleToken();
+        boolean canMoveForward = requireToken("status message").parseIntToken() != 0;
+        boolean canMoveBackward = requireToken("status message").parseIntToken() != 0;
+        boolean imuFailure = requireToken("status message").parseIntToken() != 0;
+        boolean halt = requireToken("status message").parseIntToken() != 0;
+        int moveDeg = requireToken("status message").parseIntToken();
+        double moveSpeed = requireToken("status message").parseDoubleToken();
+        int nextSensorDeg = requireToken("status message").parseIntToken();
+        if (next()) {
+            throw new IllegalArgumentException(format("Wrong status message \"%s\"", line()));
+        }
+        return WheellyStatus.create(new Point2D.Double(x, y), robotDeg,
+                sensorDirection, distance,
+                left, right,
+                contactSensors, voltage,
+                canMoveForward, canMoveBackward,
+                imuFailure, halt, moveDeg, moveSpeed, nextSensorDeg);
+    }
+
+    /**
+     * Moves to the next token
+     *
+     * @param record the record description for error message
+     * @throws IllegalArgumentException if the token does not exist
+     */
+    private StatusParser requireToken(String record) {
+        if (!next()) {
+            throw new IllegalArgumentException(format("Wrong %s \"%s\"", record, line()));
+        }
+        return this;
+    }
+
+    /**
+     * Sets the line to parse
+     * The trailing spaces are ignored.
+     *
+     * @param data the data buffer
+     * @param from the line start offset
+     * @param to   the line end offset (exclusive)
+     */
+    public StatusParser reset(byte[] data, int from, int to) {
+        while (to > from && data[to - 1] == SPACE) {
+            to--;
+        }
+        this.data = data;
+        this.from = from;
+        this.to = to;
+        this.pos = from;
+        return this;
+    }
+
+    /**
+     * Returns true if the line starts with a prefix
+     *
+     * @param prefix the prefix
+     */
+    public boolean startsWith(byte[] prefix) {
+        if (to - from < prefix.length) {
+            return false;
+        }
+        for (int i = 0; i < prefix.length; i++) {
+            if (data[from + i] != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the current token as string
+     */
+    private String token() {
+        return new String(data, tokenStart, tokenEnd - tokenStart, StandardCharsets.UTF_8);
+    }
+}
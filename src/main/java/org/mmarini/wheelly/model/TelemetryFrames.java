@@ -0,0 +1,209 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import java.awt.geom.Point2D;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * The binary telemetry frames.
+ * <p>
+ * The frames have fixed size, little endian fields and start with the type tag and the 16 bits sequence number
+ * shared by all the frame types.
+ * The binary mode is requested by the host sending the {@link #BINARY_MODE_REQUEST} line and is entered when the
+ * robot replies with the {@link #BINARY_MODE_ACK} line, the following data are binary frames.
+ * <pre>
+ *     offset type  status frame           cps frame
+ *     0      u8    tag (1)                tag (2)
+ *     1      u16   sequence number        sequence number
+ *     3      u32   sample time (ms)       sample time (ms)
+ *     7      f32   x location             cps (i32)
+ *     11     f32   y location
+ *     15     i16   yaw (DEG)
+ *     17     i16   sensor direction (DEG)
+ *     19     f32   distance
+ *     23     f32   left speed
+ *     27     f32   right speed
+ *     31     u8    contact signals
+ *     32     f32   voltage
+ *     36     u8    flags (bit 0 can move forward, bit 1 can move backward, bit 2 imu failure, bit 3 halt)
+ *     37     i16   move direction (DEG)
+ *     39     f32   move speed
+ *     43     i16   next sensor direction (DEG)
+ * </pre>
+ * </p>
+ */
+public interface TelemetryFrames {
+    String BINARY_MODE_REQUEST = "bm 1";
+    String BINARY_MODE_ACK = "bm 1";
+    ByteOrder BYTE_ORDER = ByteOrder.LITTLE_ENDIAN;
+    byte STATUS_FRAME = 1;
+    byte CPS_FRAME = 2;
+    int STATUS_FRAME_SIZE = 45;
+    int CPS_FRAME_SIZE = 11;
+    int SEQUENCE_MODULE = 1 << 16;
+
+    int CAN_MOVE_FORWARD_FLAG = 1;
+    int CAN_MOVE_BACKWARD_FLAG = 2;
+    int IMU_FAILURE_FLAG = 4;
+    int HALT_FLAG = 8;
+
+    /**
+     * Returns the cps of a cps frame
+     *
+     * @param bfr    the buffer (little endian)
+     * @param offset the frame offset
+     */
+    static int cps(ByteBuffer bfr, int offset) {
+        return bfr.getInt(offset + 7);
+    }
+
+    /**
+     * Returns the size of a frame type or -1 if unknown type
+     *
+     * @param tag the frame type tag
+     */
+    static int frameSize(byte tag) {
+        switch (tag) {
+            case STATUS_FRAME:
+                return STATUS_FRAME_SIZE;
+            case CPS_FRAME:
+                return CPS_FRAME_SIZE;
+            default:
+                return -1;
+        }
+    }
+
+    /**
+     * Returns the number of frames lost between two sequence numbers
+     *
+     * @param previous the previous sequence number
+     * @param current  the current sequence number
+     */
+    static int lostFrames(int previous, int current) {
+        return (current - previous - 1) & (SEQUENCE_MODULE - 1);
+    }
+
+    /**
+     * Returns the sample time of a frame (ms)
+     *
+     * @param bfr    the buffer (little endian)
+     * @param offset the frame offset
+     */
+    static long sampleTime(ByteBuffer bfr, int offset) {
+        return bfr.getInt(offset + 3) & 0xffffffffL;
+    }
+
+    /**
+     * Returns the sequence number of a frame
+     *
+     * @param bfr    the buffer (little endian)
+     * @param offset the frame offset
+     */
+    static int sequence(ByteBuffer bfr, int offset) {
+        return bfr.getShort(offset + 1) & 0xffff;
+    }
+
+    /**
+     * Returns the Wheelly status of a status frame
+     *
+     * @param bfr    the buffer (little endian)
+     * @param offset the frame offset
+     */
+    static WheellyStatus status(ByteBuffer bfr, int offset) {
+        double x = bfr.getFloat(offset + 7);
+        double y = bfr.getFloat(offset + 11);
+        int robotDeg = bfr.getShort(offset + 15);
+        int sensorDirection = bfr.getShort(offset + 17);
+        double distance = bfr.getFloat(offset + 19);
+        double left = bfr.getFloat(offset + 23);
+        double right = bfr.getFloat(offset + 27);
+        int contactSensors = bfr.get(offset + 31) & 0xff;
+        double voltage = bfr.getFloat(offset + 32);
+        int flags = bfr.get(offset + 36);
+        int moveDeg = bfr.getShort(offset + 37);
+        double moveSpeed = bfr.getFloat(offset + 39);
+        int nextSensorDeg = bfr.getShort(offset + 43);
+        return WheellyStatus.create(new Point2D.Double(x, y), robotDeg,
+                sensorDirection, distance,
+                left, right,
+                contactSensors, voltage,
+                (flags & CAN_MOVE_FORWARD_FLAG) != 0, (flags & CAN_MOVE_BACKWARD_FLAG) != 0,
+                (flags & IMU_FAILURE_FLAG) != 0, (flags & HALT_FLAG) != 0,
+                moveDeg, moveSpeed, nextSensorDeg);
+    }
+
+    /**
+     * Writes a cps frame
+     *
+     * @param bfr      the buffer (little endian)
+     * @param sequence the sequence number
+     * @param time     the sample time (ms)
+     * @param cps      the cps
+     */
+    static ByteBuffer writeCps(ByteBuffer bfr, int sequence, long time, int cps) {
+        return bfr.put(CPS_FRAME)
+                .putShort((short) sequence)
+                .putInt((int) time)
+                .putInt(cps);
+    }
+
+    /**
+     * Writes a status frame
+     *
+     * @param bfr      the buffer (little endian)
+     * @param sequence the sequence number
+     * @param time     the sample time (ms)
+     * @param status   the status
+     */
+    static ByteBuffer writeStatus(ByteBuffer bfr, int sequence, long time, WheellyStatus status) {
+        int flags = (status.getCannotMoveForward() ? 0 : CAN_MOVE_FORWARD_FLAG)
+                | (status.getCannotMoveBackward() ? 0 : CAN_MOVE_BACKWARD_FLAG)
+                | (status.isImuFailure() ? IMU_FAILURE_FLAG : 0)
+                | (status.isHalt() ? HALT_FLAG : 0);
+        return bfr.put(STATUS_FRAME)
+                .putShort((short) sequence)
+                .putInt((int) time)
+                .putFloat((float) status.getRobotLocation().getX())
+                .putFloat((float) status.getRobotLocation().getY())
+                .putShort((short) status.getRobotDeg())
+                .putShort((short) status.getSensorRelativeDeg())
+                .putFloat((float) status.getSampleDistance())
+                .putFloat((float) status.getLeftSpeed())
+                .putFloat((float) status.getRightSpeed())
+                .put((byte) status.getContactSensors())
+                .putFloat((float) status.getVoltage())
+                .put((byte) flags)
+                .putShort((short) status.getMoveDeg())
+                .putFloat((float) status.getMoveSpeed())
+                .putShort((short) status.getNextSensorDeg());
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+/**
+ * The persistent leftist min heap of tile keys by priority.
+ * <p>
+ * The heap is immutable, the insertion and the removal of the minimum return new heaps sharing the nodes
+ * of the original one, so that the versions of a grid share their heaps.
+ * The empty heap is null.
+ * The entries are not updated when the tiles change, the users skip the stale entries.
+ * </p>
+ */
+class TileHeap {
+
+    /**
+     * Returns the heap built from the priorities and the keys
+     *
+     * @param priorities the priorities
+     * @param keys       the tile keys
+     * @param n          the number of entries
+     */
+    static TileHeap create(double[] priorities, int[] keys, int n) {
+        if (n == 0) {
+            return null;
+        }
+        // Merges the heaps pairwise
+        TileHeap[] heaps = new TileHeap[n];
+        for (int i = 0; i < n; i++) {
+            heaps[i] = new TileHeap(priorities[i], keys[i], null, null);
+        }
+        for (int m = n; m > 1; m = (m + 1) / 2) {
+            for (int i = 0; i < m / 2; i++) {
+                heaps[i] = merge(heaps[2 * i], heaps[2 * i + 1]);
+            }
+            if ((m & 1) != 0) {
+                heaps[m / 2] = heaps[m - 1];
+            }
+        }
+        return heaps[0];
+    }
+
+    /**
+     * Returns the heap with an entry added
+     *
+     * @param heap     the heap
+     * @param priority the priority
+     * @param key      the tile key
+     */
+    static TileHeap insert(TileHeap heap, double priority, int key) {
+        return merge(heap, new TileHeap(priority, key, null, null));
+    }
+
+    /**
+     * Returns the merged heap
+     *
+     * @param a the first heap
+     * @param b the second heap
+     */
+    static TileHeap merge(TileHeap a, TileHeap b) {
+        if (a == null) {
+            return b;
+        }
+        if (b == null) {
+            return a;
+        }
+        if (b.priority < a.priority) {
+            TileHeap t = a;
+            a = b;
+            b = t;
+        }
+        TileHeap left = a.left;
+        TileHeap right = merge(a.right, b);
+        return rank(left) >= rank(right)
+                ? new TileHeap(a.priority, a.key, left, right)
+                : new TileHeap(a.priority, a.key, right, left);
+    }
+
+    /**
+     * Returns the rank of a heap (the length of the right spine)
+     *
+     * @param heap the heap
+     */
+    static int rank(TileHeap heap) {
+        return heap != null ? heap.rank : 0;
+    }
+
+    /**
+     * Returns the number of entries of a heap
+     *
+     * @param heap the heap
+     */
+    static int size(TileHeap heap) {
+        return heap != null ? heap.size : 0;
+    }
+
+    final double priority;
+    final int key;
+    private final TileHeap left;
+    private final TileHeap right;
+    private final int rank;
+    private final int size;
+
+    /**
+     * Creates the heap node
+     *
+     * @param priority the priority
+     * @param key      the tile key
+     * @param left     the left heap
+     * @param right    the right heap
+     */
+    private TileHeap(double priority, int key, TileHeap left, TileHeap right) {
+        this.priority = priority;
+        this.key = key;
+        this.left = left;
+        this.right = right;
+        this.rank = rank(right) + 1;
+        this.size = size(left) + size(right) + 1;
+    }
+
+    /**
+     * Returns the heap without the minimum entry
+     */
+    TileHeap pop() {
+        return merge(left, right);
+    }
+}
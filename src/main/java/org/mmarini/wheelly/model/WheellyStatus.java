@@ -32,12 +32,9 @@ package org.mmarini.wheelly.model;
 import org.mmarini.Tuple2;
 
 import java.awt.geom.Point2D;
+import java.nio.charset.StandardCharsets;
 import java.util.StringJoiner;
 
-import static java.lang.Double.parseDouble;
-import static java.lang.Integer.parseInt;
-import static java.lang.String.format;
-
 /**
  * The Wheelly status contain the sensor value of Wheelly
  */
@@ -106,39 +103,8 @@ public class WheellyStatus implements ProxySample, ContactSensors {
      * @param statusString the status string
      */
     public static WheellyStatus from(String statusString) {
-        String[] params = statusString.split(" ");
-        if (params.length != NO_STATUS_PARAMS) {
-            throw new IllegalArgumentException(format("Wrong status message \"%s\"", statusString));
-        }
-
-        double x = parseDouble(params[2]);
-        double y = parseDouble(params[3]);
-        int robotDeg = Integer.parseInt(params[4]);
-        Point2D robotLocation = new Point2D.Double(x, y);
-
-        int sensorDirection = parseInt(params[5]);
-        double distance = parseDouble(params[6]);
-        int contactSensors = parseInt(params[9]);
-        double voltage = parseDouble(params[10]);
-
-        boolean canMoveForward = Integer.parseInt(params[11]) != 0;
-        boolean canMoveBackward = Integer.parseInt(params[12]) != 0;
-
-        double left = parseDouble(params[7]);
-        double right = parseDouble(params[8]);
-
-        boolean imuFailure = Integer.parseInt(params[13]) != 0;
-        boolean halt = Integer.parseInt(params[14]) != 0;
-        int moveDeg = Integer.parseInt(params[15]);
-        double moveSpeed = parseDouble(params[16]);
-        int nextSensorDeg = Integer.parseInt(params[17]);
-
-        return new WheellyStatus(robotLocation, robotDeg,
-                sensorDirection, distance,
-                left, right,
-                contactSensors, voltage,
-                canMoveForward, canMoveBackward,
-                imuFailure, halt, moveDeg, moveSpeed, nextSensorDeg);
+        byte[] data = statusString.getBytes(StandardCharsets.UTF_8);
+        return StatusParser.create().reset(data, 0, data.length).parseStatus();
     }
 
     private final Point2D robotLocation;
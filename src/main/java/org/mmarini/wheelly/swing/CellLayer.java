@@ -0,0 +1,225 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.swing;
+
+import java.awt.*;
+import java.awt.geom.AffineTransform;
+import java.awt.geom.Rectangle2D;
+import java.awt.image.BufferedImage;
+import java.util.HashMap;
+import java.util.Iterator;
+import java.util.Map;
+
+import static java.lang.Math.max;
+import static java.lang.Math.min;
+import static java.util.Objects.requireNonNull;
+
+/**
+ * The cell layer caches the colors of the map cells in an image with a pixel per cell.
+ * <p>
+ * Each update writes only the pixels of the cells changed from the previous update and returns
+ * the region to repaint, the image is reallocated only when the cells fall outside it.
+ * The layer is not thread safe, it should be used by the event dispatch thread only.
+ * </p>
+ */
+public class CellLayer {
+    public static final int MARGIN = 16;
+    private static final int TRANSPARENT = 0;
+
+    private final Map<Point, Integer> pixels;
+    private BufferedImage image;
+    private int originI;
+    private int originJ;
+    private double gridSize;
+
+    /**
+     * Creates an empty cell layer
+     */
+    public CellLayer() {
+        this.pixels = new HashMap<>();
+    }
+
+    /**
+     * Returns the union of two regions
+     *
+     * @param a the first region or null if empty
+     * @param b the second region or null if empty
+     */
+    private static Rectangle2D union(Rectangle2D a, Rectangle2D b) {
+        if (a == null) {
+            return b;
+        }
+        if (b == null) {
+            return a;
+        }
+        return a.createUnion(b);
+    }
+
+    /**
+     * Allocates the image for the cells and draws all of them
+     *
+     * @param gridSize the grid size
+     * @param cells    the cell colors
+     */
+    private void allocate(double gridSize, Map<Point, Color> cells) {
+        this.gridSize = gridSize;
+        pixels.clear();
+        if (cells.isEmpty()) {
+            image = null;
+            return;
+        }
+        int minI = Integer.MAX_VALUE;
+        int minJ = Integer.MAX_VALUE;
+        int maxI = Integer.MIN_VALUE;
+        int maxJ = Integer.MIN_VALUE;
+        for (Point cell : cells.keySet()) {
+            minI = min(minI, cell.x);
+            minJ = min(minJ, cell.y);
+            maxI = max(maxI, cell.x);
+            maxJ = max(maxJ, cell.y);
+        }
+        originI = minI - MARGIN;
+        originJ = minJ - MARGIN;
+        image = new BufferedImage(maxI - minI + 1 + 2 * MARGIN, maxJ - minJ + 1 + 2 * MARGIN,
+                BufferedImage.TYPE_INT_ARGB);
+        for (Map.Entry<Point, Color> entry : cells.entrySet()) {
+            Point cell = entry.getKey();
+            int argb = entry.getValue().getRGB();
+            image.setRGB(cell.x - originI, cell.y - originJ, argb);
+            pixels.put(cell, argb);
+        }
+    }
+
+    /**
+     * Returns the region covered by a range of cells
+     *
+     * @param minI the minimum x cell index
+     * @param minJ the minimum y cell index
+     * @param maxI the maximum x cell index
+     * @param maxJ the maximum y cell index
+     */
+    private Rectangle2D cellBounds(int minI, int minJ, int maxI, int maxJ) {
+        return new Rectangle2D.Double((minI - 0.5) * gridSize, (minJ - 0.5) * gridSize,
+                (maxI - minI + 1) * gridSize, (maxJ - minJ + 1) * gridSize);
+    }
+
+    /**
+     * Returns true if the layer image contains the cell
+     *
+     * @param cell the cell
+     */
+    private boolean contains(Point cell) {
+        int x = cell.x - originI;
+        int y = cell.y - originJ;
+        return x >= 0 && y >= 0 && x < image.getWidth() && y < image.getHeight();
+    }
+
+    /**
+     * Returns the region covered by the layer image or null if the layer is empty
+     */
+    public Rectangle2D getBounds() {
+        return image != null
+                ? cellBounds(originI, originJ, originI + image.getWidth() - 1, originJ + image.getHeight() - 1)
+                : null;
+    }
+
+    /**
+     * Returns the color of a cell or null if the cell is not drawn
+     *
+     * @param cell the cell
+     */
+    public Color getColor(Point cell) {
+        Integer argb = pixels.get(cell);
+        return argb != null ? new Color(argb, true) : null;
+    }
+
+    /**
+     * Paints the layer
+     *
+     * @param gr the graphic environment in map coordinates
+     */
+    public void paint(Graphics2D gr) {
+        BufferedImage image = this.image;
+        if (image != null) {
+            AffineTransform tr = gr.getTransform();
+            gr.setRenderingHint(RenderingHints.KEY_INTERPOLATION, RenderingHints.VALUE_INTERPOLATION_NEAREST_NEIGHBOR);
+            gr.translate((originI - 0.5) * gridSize, (originJ - 0.5) * gridSize);
+            gr.scale(gridSize, gridSize);
+            gr.drawImage(image, 0, 0, null);
+            gr.setTransform(tr);
+        }
+    }
+
+    /**
+     * Updates the layer with the cell colors and returns the changed region or null if nothing changed
+     *
+     * @param gridSize the grid size
+     * @param cells    the cell colors
+     */
+    public Rectangle2D update(double gridSize, Map<Point, Color> cells) {
+        requireNonNull(cells);
+        if (gridSize != this.gridSize || image == null
+                || !cells.keySet().stream().allMatch(this::contains)) {
+            Rectangle2D before = getBounds();
+            allocate(gridSize, cells);
+            return union(before, getBounds());
+        }
+        int minI = Integer.MAX_VALUE;
+        int minJ = Integer.MAX_VALUE;
+        int maxI = Integer.MIN_VALUE;
+        int maxJ = Integer.MIN_VALUE;
+        // Clears the removed cells
+        for (Iterator<Point> iter = pixels.keySet().iterator(); iter.hasNext(); ) {
+            Point cell = iter.next();
+            if (!cells.containsKey(cell)) {
+                image.setRGB(cell.x - originI, cell.y - originJ, TRANSPARENT);
+                iter.remove();
+                minI = min(minI, cell.x);
+                minJ = min(minJ, cell.y);
+                maxI = max(maxI, cell.x);
+                maxJ = max(maxJ, cell.y);
+            }
+        }
+        // Draws the changed cells
+        for (Map.Entry<Point, Color> entry : cells.entrySet()) {
+            Point cell = entry.getKey();
+            int argb = entry.getValue().getRGB();
+            Integer old = pixels.put(cell, argb);
+            if (old == null || old != argb) {
+                image.setRGB(cell.x - originI, cell.y - originJ, argb);
+                minI = min(minI, cell.x);
+                minJ = min(minJ, cell.y);
+                maxI = max(maxI, cell.x);
+                maxJ = max(maxJ, cell.y);
+            }
+        }
+        return minI <= maxI ? cellBounds(minI, minJ, maxI, maxJ) : null;
+    }
+}
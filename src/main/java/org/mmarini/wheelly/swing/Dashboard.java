@@ -33,6 +33,7 @@ import hu.akarnokd.rxjava3.swing.SwingObservable;
 import io.reactivex.rxjava3.core.BackpressureStrategy;
 import io.reactivex.rxjava3.core.Flowable;
 import org.mmarini.swing.GridLayoutHelper;
+import org.mmarini.wheelly.model.LatencyMonitor;
 
 import javax.swing.*;
 import java.awt.*;
@@ -71,6 +72,7 @@ public class Dashboard extends JPanel {
     private final JLabel cps;
     private final Flowable<ActionEvent> resetFlow;
     private final JLabel elaps;
+    private final JLabel latency;
     private final JButton reset;
     private final JLabel yaw;
     private final JLabel robotLocation;
@@ -98,6 +100,7 @@ public class Dashboard extends JPanel {
         this.rightSpeed = new JLabel();
         this.cps = new JLabel();
         this.elaps = new JLabel();
+        this.latency = new JLabel();
         this.yaw = new JLabel();
         this.robotLocation = new JLabel();
         this.reset = new JButton("Reset");
@@ -119,6 +122,8 @@ public class Dashboard extends JPanel {
         cps.setForeground(WHITE);
         elaps.setBackground(BLACK);
         elaps.setForeground(WHITE);
+        latency.setBackground(BLACK);
+        latency.setForeground(WHITE);
         leftSpeed.setBackground(BLACK);
         leftSpeed.setForeground(WHITE);
         rightSpeed.setBackground(BLACK);
@@ -160,6 +165,7 @@ public class Dashboard extends JPanel {
                 .at(0, 0).weight(1, 1).add(wifiLed)
                 .at(0, 1).center().add(cps)
                 .at(0, 2).add(elaps)
+                .at(0, 3).add(latency)
                 .getContainer();
         container.setBackground(BLACK);
         return container;
@@ -249,6 +255,19 @@ public class Dashboard extends JPanel {
         this.elaps.setText(format("%.0f ms", elaps));
     }
 
+    /**
+     * Sets the control loop latencies (99th percentile)
+     *
+     * @param report the latency report
+     */
+    public void setLatencies(LatencyMonitor.Report report) {
+        StringBuilder text = new StringBuilder("<html>p99 ms");
+        for (LatencyMonitor.Stage stage : LatencyMonitor.Stage.values()) {
+            text.append(format("<br>%s %.1f", stage.getId(), report.getPercentile(stage, 99)));
+        }
+        this.latency.setText(text.append("</html>").toString());
+    }
+
     /**
      * Sets the forward direction block
      *
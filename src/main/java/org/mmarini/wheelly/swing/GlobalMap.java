@@ -65,27 +65,40 @@ public class GlobalMap extends TopographicMap {
         this.shape = shape;
     }
 
+    @Override
+    protected AffineTransform getMapTransform() {
+        AffineTransform tr = getRobotTransform();
+        Point2D offset = getOffset();
+        tr.translate(-offset.getX(), -offset.getY());
+        return tr;
+    }
+
+    /**
+     * Returns the transformation from robot coordinates to component coordinates
+     */
+    private AffineTransform getRobotTransform() {
+        Dimension size = getSize();
+        int minSize = min(size.width, size.height);
+        double scale = minSize / getMaxDistance() / 2;
+        AffineTransform tr = AffineTransform.getTranslateInstance(size.width / 2, size.height / 2);
+        tr.scale(scale, scale);
+        tr.rotate(-PI / 2);
+        return tr;
+    }
+
     @Override
     protected void paintComponent(Graphics g) {
         Dimension size = getSize();
         g.setColor(getBackground());
         g.fillRect(0, 0, size.width, size.height);
-        Point2D offset = getOffset();
-        double maxDistance = getMaxDistance();
 
         Graphics2D gr = (Graphics2D) g.create(0, 0, size.width, size.height);
-        gr.translate(size.width / 2, size.height / 2);
-        int minSize = min(size.width, size.height);
-        double scale = minSize / maxDistance / 2;
-        gr.scale(scale, scale);
-
-        gr.rotate(-PI / 2);
-        AffineTransform oldTr = gr.getTransform();
-        gr.translate(-offset.getX(), -offset.getY());
-
+        AffineTransform base = gr.getTransform();
+        gr.transform(getMapTransform());
         paintGrid(gr);
         paintMap(gr);
-        gr.setTransform(oldTr);
+        gr.setTransform(base);
+        gr.transform(getRobotTransform());
         gr.rotate(getDirection());
         paintRobot(gr);
     }
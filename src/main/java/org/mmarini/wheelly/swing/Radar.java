@@ -30,6 +30,7 @@
 package org.mmarini.wheelly.swing;
 
 import java.awt.*;
+import java.awt.geom.AffineTransform;
 import java.awt.geom.Ellipse2D;
 import java.awt.geom.Line2D;
 import java.awt.geom.Point2D;
@@ -63,25 +64,40 @@ public class Radar extends TopographicMap {
     public Radar() {
     }
 
+    @Override
+    protected AffineTransform getMapTransform() {
+        AffineTransform tr = getGridTransform();
+        Point2D offset = getOffset();
+        tr.rotate(-PI / 2);
+        tr.rotate(-getDirection());
+        tr.translate(-offset.getX(), -offset.getY());
+        return tr;
+    }
+
+    /**
+     * Returns the transformation from radar grid coordinates to component coordinates
+     */
+    private AffineTransform getGridTransform() {
+        Dimension size = getSize();
+        int minSize = min(size.width, size.height);
+        double scale = minSize / getMaxDistance() / 2;
+        AffineTransform tr = AffineTransform.getTranslateInstance(size.width / 2, size.height / 2);
+        tr.scale(scale, scale);
+        return tr;
+    }
+
     @Override
     protected void paintComponent(Graphics g) {
         Dimension size = getSize();
         g.setColor(getBackground());
         g.fillRect(0, 0, size.width, size.height);
-        Point2D offset = getOffset();
-        double maxDistance = getMaxDistance();
-        double direction = getDirection();
 
         Graphics2D gr = (Graphics2D) g.create(0, 0, size.width, size.height);
-        gr.translate(size.width / 2, size.height / 2);
-        int minSize = min(size.width, size.height);
-        double scale = minSize / maxDistance / 2;
-        gr.scale(scale, scale);
-
+        AffineTransform base = gr.getTransform();
+        gr.transform(getGridTransform());
         paintGrid(gr);
-        gr.rotate(-PI / 2);
-        gr.rotate(-direction);
-        gr.translate(-offset.getX(), -offset.getY());
+        gr.setTransform(base);
+        gr.transform(getMapTransform());
         paintMap(gr);
     }
 
@@ -35,15 +35,21 @@ import org.slf4j.LoggerFactory;
 
 import javax.swing.*;
 import java.awt.*;
+import java.awt.geom.AffineTransform;
 import java.awt.geom.Line2D;
 import java.awt.geom.Point2D;
+import java.awt.geom.Rectangle2D;
 import java.util.List;
+import java.util.Map;
 
 import static java.awt.Color.GREEN;
 import static java.util.Objects.requireNonNull;
 
 /**
  * The topographic map shows the locations of obstacles
+ * <p>
+ * The map cells are drawn by a cached cell layer, updating the cells repaints only the changed region.
+ * </p>
  */
 public abstract class TopographicMap extends JComponent {
     public static final BasicStroke THIN_STROKE = new BasicStroke(0f);
@@ -57,6 +63,7 @@ public abstract class TopographicMap extends JComponent {
     public static final Color GRID = new Color(63, 63, 63);
     public static final double DEFAULT_MAX_DISTANCE = 3;
 
+    private final CellLayer layer;
     private List<Tuple2<Color, Shape>> shapes;
     private Point2D offset;
     private double direction;
@@ -68,6 +75,7 @@ public abstract class TopographicMap extends JComponent {
      */
     public TopographicMap() {
         this.offset = new Point2D.Double();
+        this.layer = new CellLayer();
         maxDistance = DEFAULT_MAX_DISTANCE;
         setBackground(BACKGROUND);
         setForeground(FOREGROUND);
@@ -96,6 +104,27 @@ public abstract class TopographicMap extends JComponent {
         return shapes;
     }
 
+    /**
+     * Returns the transformation from map coordinates to component coordinates
+     */
+    protected abstract AffineTransform getMapTransform();
+
+    /**
+     * Sets the colors of map cells repainting the changed region
+     *
+     * @param gridSize the grid size
+     * @param cells    the cell colors
+     */
+    public TopographicMap setCells(double gridSize, Map<Point, Color> cells) {
+        Rectangle2D dirty = layer.update(gridSize, cells);
+        if (dirty != null) {
+            Rectangle bounds = getMapTransform().createTransformedShape(dirty).getBounds();
+            bounds.grow(1, 1);
+            repaint(bounds);
+        }
+        return this;
+    }
+
     public TopographicMap setShapes(List<Tuple2<Color, Shape>> shapes) {
         this.shapes = requireNonNull(shapes);
         repaint();
@@ -111,6 +140,7 @@ public abstract class TopographicMap extends JComponent {
      * @param gr the graphic environ
      */
     protected void paintMap(Graphics2D gr) {
+        layer.paint(gr);
         List<Tuple2<Color, Shape>> shapes = this.shapes;
         if (shapes != null) {
             for (Tuple2<Color, Shape> t : shapes) {
@@ -132,9 +162,12 @@ public abstract class TopographicMap extends JComponent {
      * @param rotation the rotation
      */
     public TopographicMap setAsset(Point2D offset, double rotation) {
-        this.offset = requireNonNull(offset);
-        this.direction = rotation;
-        repaint();
+        requireNonNull(offset);
+        if (!offset.equals(this.offset) || rotation != direction) {
+            this.offset = offset;
+            this.direction = rotation;
+            repaint();
+        }
         return this;
     }
 
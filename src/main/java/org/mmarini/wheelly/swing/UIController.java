@@ -31,6 +31,7 @@ package org.mmarini.wheelly.swing;
 
 import com.fasterxml.jackson.databind.JsonNode;
 import hu.akarnokd.rxjava3.swing.SwingObservable;
+import hu.akarnokd.rxjava3.swing.SwingSchedulers;
 import io.reactivex.rxjava3.core.BackpressureStrategy;
 import io.reactivex.rxjava3.core.Flowable;
 import io.reactivex.rxjava3.disposables.Disposable;
@@ -41,6 +42,7 @@ import org.deeplearning4j.ui.model.stats.StatsListener;
 import org.deeplearning4j.ui.model.storage.InMemoryStatsStorage;
 import org.mmarini.Function3;
 import org.mmarini.Tuple2;
+import org.mmarini.wheelly.engines.Builders;
 import org.mmarini.wheelly.engines.deepl.RLEngine;
 import org.mmarini.wheelly.engines.statemachine.FindPathStatus;
 import org.mmarini.wheelly.model.*;
@@ -57,18 +59,11 @@ import java.awt.event.WindowAdapter;
 import java.awt.event.WindowEvent;
 import java.awt.geom.Line2D;
 import java.awt.geom.Point2D;
-import java.awt.geom.Rectangle2D;
 import java.io.File;
-import java.io.FileWriter;
 import java.io.IOException;
-import java.io.PrintWriter;
-import java.lang.reflect.Method;
-import java.lang.reflect.Modifier;
 import java.util.List;
 import java.util.*;
 import java.util.concurrent.TimeUnit;
-import java.util.regex.Matcher;
-import java.util.regex.Pattern;
 import java.util.stream.Collectors;
 
 import static java.awt.Color.*;
@@ -95,7 +90,6 @@ public class UIController {
     public static final long FRAME_INTERVAL = 1000L / 60;
     public static final Color PROHIBITED_COLOR = new Color(0x4f432c);// new Color(0x7c4422);
     public static final Color PATH_COLOR = WHITE;
-    public static final int FLUSH_INTERVAL = 1000;
     public static final int PERFORMANCE_WINDOW = 30;
     public static final int PERFORMANCE_SKIP = 10;
     private static final String CONFIG_FILE = ".wheelly.yml";
@@ -120,20 +114,14 @@ public class UIController {
         return new UIController();
     }
 
-    private static Shape createCellShape(Point2D center, double size) {
-        return new Rectangle2D.Double(center.getX() - size / 2, center.getY() - size / 2, size, size);
-    }
-
-    private static List<Tuple2<Color, Shape>> createContourShapes(GridScannerMap map, Point2D offset, double maxDistance) {
-        return map.getContours().stream()
-                .map(map::toPoint)
-                .map(o -> Tuple2.of(o, o.distance(offset)))
-                .filter(t -> t._2 <= maxDistance)
-                .map(center -> {
-                    Shape shape = createCellShape(center._1, map.gridSize);
-                    return Tuple2.of(CONTOUR_COLOR, shape);
-                })
-                .collect(Collectors.toList());
+    private static Map<Point, Color> createContourCells(GridScannerMap map, Point2D offset, double maxDistance) {
+        Map<Point, Color> result = new HashMap<>();
+        for (Point cell : map.getContours()) {
+            if (map.toPoint(cell).distance(offset) <= maxDistance) {
+                result.put(cell, CONTOUR_COLOR);
+            }
+        }
+        return result;
     }
 
     private static List<Tuple2<Color, Line2D>> createCross(Point2D point, Color color, double size) {
@@ -161,55 +149,39 @@ public class UIController {
                 .collect(Collectors.toList());
     }
 
-    private static List<Tuple2<Color, Shape>> createProhibitedShapes(GridScannerMap map, Point2D offset, double maxDistance) {
-        Set<Point> cells = map.getProhibited();
-        Set<Point> mapCells = map.getCells().collect(Collectors.toSet());
-        cells.removeAll(mapCells);
-        List<Tuple2<Color, Shape>> result = cells.stream()
-                .map(map::toPoint)
-                .map(o -> Tuple2.of(o, o.distance(offset)))
-                .filter(t -> t._2 <= maxDistance)
-                .map(center -> {
-                    Shape shape = createCellShape(center._1, map.gridSize);
-                    return Tuple2.of(PROHIBITED_COLOR, shape);
-                })
-                .collect(Collectors.toList());
-        result.addAll(createScannerMapShapes(map, offset, maxDistance));
+    private static Map<Point, Color> createProhibitedCells(GridScannerMap map, Point2D offset, double maxDistance) {
+        Map<Point, Color> result = new HashMap<>();
+        for (Point cell : map.getProhibited()) {
+            if (map.toPoint(cell).distance(offset) <= maxDistance) {
+                result.put(cell, PROHIBITED_COLOR);
+            }
+        }
+        result.putAll(createScannerMapCells(map, offset, maxDistance));
         return result;
     }
 
-    private static List<Tuple2<Color, Shape>> createScannerMapShapes(GridScannerMap map, Point2D offset, double maxDistance) {
+    private static Map<Point, Color> createScannerMapCells(GridScannerMap map, Point2D offset, double maxDistance) {
         long now = System.currentTimeMillis();
-        return map.obstacles.stream()
-                .map(o -> Tuple2.of(o, o.getLocation().distance(offset)))
-                .filter(t -> t._2 <= maxDistance)
-                .map(t -> {
-                    Obstacle o = t._1;
-                    Shape shape = createCellShape(o.location, map.gridSize);
-                    double dt = (now - o.timestamp) * 1e-3;
-                    double value = o.likelihood * exp(-dt / LIKELIHOOD_TAU);
-                    return Tuple2.of(value, t.setV1(shape));
-                })
-                .sorted(Comparator.comparing(Tuple2::getV1))
-                .map(t -> {
-                    float bright = (float) ((t._1 * 0.8) + 0.2);
-                    double distance = t._2._2;
-                    double hue;
-                    if (distance > INFO_DISTANCE) {
-                        hue = 0;
-                    } else if (distance > WARN_DISTANCE) {
-                        hue = 1d / 3;
-                    } else if (distance > STOP_DISTANCE) {
-                        hue = 1d / 6;
-                    } else {
-                        hue = 0;
-                    }
-                    float saturation = distance > INFO_DISTANCE ? 0 : 1;
-
-                    Color c = Color.getHSBColor((float) hue, saturation, bright);
-                    return Tuple2.of(c, t._2._1);
-                })
-                .collect(Collectors.toList());
+        Map<Point, Color> result = new HashMap<>();
+        for (Obstacle o : map.getObstacles(offset, maxDistance)) {
+            double dt = (now - o.timestamp) * 1e-3;
+            double value = o.likelihood * exp(-dt / LIKELIHOOD_TAU);
+            float bright = (float) ((value * 0.8) + 0.2);
+            double distance = o.getLocation().distance(offset);
+            double hue;
+            if (distance > INFO_DISTANCE) {
+                hue = 0;
+            } else if (distance > WARN_DISTANCE) {
+                hue = 1d / 3;
+            } else if (distance > STOP_DISTANCE) {
+                hue = 1d / 6;
+            } else {
+                hue = 0;
+            }
+            float saturation = distance > INFO_DISTANCE ? 0 : 1;
+            result.put(map.cell(o.location), Color.getHSBColor((float) hue, saturation, bright));
+        }
+        return result;
     }
 
     private final PreferencesPane preferencesPane;
@@ -223,9 +195,9 @@ public class UIController {
     private JsonNode configNode;
     private RobotAgent robotAgent;
     private ConfigParameters configParams;
-    private Function3<
+    private volatile Function3<
             GridScannerMap, Point2D, Double,
-            List<Tuple2<Color, Shape>>> shapeBuilder;
+            Map<Point, Color>> cellBuilder;
     private List<Tuple2<Color, Line2D>> path;
     private List<Tuple2<Color, Line2D>> obstacleCross;
     private List<Tuple2<Color, Line2D>> targetCross;
@@ -243,7 +215,7 @@ public class UIController {
         this.radar = frame.getRadar();
         this.monitor = frame.getMonitor();
         this.globalMap = frame.getGlobalMap();
-        this.shapeBuilder = UIController::createProhibitedShapes;
+        this.cellBuilder = UIController::createProhibitedCells;
         this.configDisposables = new ArrayList<>();
         obstacleCross = targetCross = path = List.of();
 
@@ -270,9 +242,9 @@ public class UIController {
                 .doOnNext(ev -> closeConfig()
                         .openConfig())
                 .subscribe();
-        frame.getScannerViewFlow().subscribe(x -> this.shapeBuilder = UIController::createScannerMapShapes);
-        frame.getProhibitedViewFlow().subscribe(x -> this.shapeBuilder = UIController::createProhibitedShapes);
-        frame.getContourViewFlow().subscribe(x -> this.shapeBuilder = UIController::createContourShapes);
+        frame.getScannerViewFlow().subscribe(x -> this.cellBuilder = UIController::createScannerMapCells);
+        frame.getProhibitedViewFlow().subscribe(x -> this.cellBuilder = UIController::createProhibitedCells);
+        frame.getContourViewFlow().subscribe(x -> this.cellBuilder = UIController::createContourCells);
         return this;
     }
 
@@ -293,33 +265,7 @@ public class UIController {
      * Returns the inference engine
      */
     private InferenceEngine createEngine() {
-        Locator engineRef = Yaml.engine(configNode, Locator.root());
-        JsonNode engineNode = engineRef.getNode(configNode);
-        if (engineNode.isMissingNode()) {
-            throw new IllegalArgumentException(format("Missing %s node", engineRef.pointer));
-        }
-        String builder = engineNode.path("builder").asText();
-        if (builder.isEmpty()) {
-            throw new IllegalArgumentException(format("Missing %s/builder node", engineRef.pointer));
-        }
-        Matcher m = Pattern.compile("^([a-zA-Z_]\\w*\\.)+([a-zA-Z_]\\w*)$").matcher(builder);
-        if (!m.matches()) {
-            throw new IllegalArgumentException(format("builder %s does not match the format", builder));
-        }
-        String methodName = m.group(2);
-        String className = builder.substring(0, builder.length() - methodName.length() - 1);
-        try {
-            Class<?> clazz = Thread.currentThread().getContextClassLoader().loadClass(className);
-            Method creator = clazz.getDeclaredMethod(methodName, JsonNode.class, Locator.class);
-            int modifiers = creator.getModifiers();
-            if (!Modifier.isStatic(modifiers)) {
-                throw new IllegalArgumentException(format("builder %s is not static", builder));
-            }
-            Object result = creator.invoke(null, configNode, engineRef);
-            return (InferenceEngine) result;
-        } catch (Exception e) {
-            throw new RuntimeException(e);
-        }
+        return Builders.fromJson(configNode, Yaml.engine(configNode, Locator.root()));
     }
 
     private void handleCps(Timed<Integer> cps) {
@@ -352,8 +298,14 @@ public class UIController {
         frame.log(text);
     }
 
-    private void handleMapMessage(Timed<MapStatus> mapStatus) {
-        WheellyStatus status = mapStatus.value().getWheelly();
+    /**
+     * Handles the map message and its cell colors in the event dispatch thread
+     *
+     * @param data the map status and the cell colors
+     */
+    private void handleMapMessage(Tuple2<Timed<MapStatus>, Map<Point, Color>> data) {
+        MapStatus mapStatus = data._1.value();
+        WheellyStatus status = mapStatus.getWheelly();
         dashboard.setObstacleDistance(status.getSampleDistance());
         dashboard.setPower(status.getVoltage());
         dashboard.setSpeed(status.getLeftSpeed(), status.getRightSpeed());
@@ -364,11 +316,9 @@ public class UIController {
         globalMap.setAsset(status.getRobotLocation(), status.getRobotRad());
         dashboard.setImuFailure(status.isImuFailure() ? 1 : 0);
 
-        List<Tuple2<Color, Shape>> shapes = shapeBuilder.apply(mapStatus.value().getMap(), status.getRobotLocation(), DEFAULT_MAX_DISTANCE);
-
-        radar.setShapes(shapes);
-        globalMap.setShapes(shapes);
-
+        double gridSize = mapStatus.getMap().gridSize;
+        radar.setCells(gridSize, data._2);
+        globalMap.setCells(gridSize, data._2);
     }
 
     private void handlePerformance(INDArray data) {
@@ -428,40 +378,49 @@ public class UIController {
                 ((RLEngine) engine).getAgent().getAgentModel().setListeners(new StatsListener(statsStorage));
             }
             this.robotAgent = RobotAgent.create(configParams, engine);
+            configDisposables.clear();
             if (configParams.robotLogFile != null) {
                 File file = new File(configParams.robotLogFile);
                 if (file.canWrite() || !file.exists()) {
                     file.delete();
-                    robotAgent.readLog().observeOn(Schedulers.io())
-                            .map(v -> format("%d %s", v.time(TimeUnit.MILLISECONDS), v.value()))
-                            .buffer(FLUSH_INTERVAL, TimeUnit.MILLISECONDS)
-                            .subscribe(data -> {
-                                try (FileWriter fw = new FileWriter(file, true)) {
-                                    try (PrintWriter out = new PrintWriter(fw)) {
-                                        data.forEach(out::println);
-                                    }
-                                } catch (IOException ex) {
-                                    logger.error(ex.getMessage(), ex);
-                                }
-                            });
+                    RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+                    configDisposables.add(robotAgent.readLog()
+                            .doFinally(writer::close)
+                            .subscribe(v -> writer.writeLine(format("%d %s", v.time(TimeUnit.MILLISECONDS), v.value()))));
                 }
             }
             if (configParams.dumpFile != null) {
                 File file = new File(configParams.dumpFile);
+                if ((file.canWrite() || !file.exists()) && DumpFiles.isBinaryName(file)) {
+                    file.delete();
+                    RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+                    writer.write(DumpFiles.header());
+                    configDisposables.add(robotAgent.readDumpRecords()
+                            .doFinally(writer::close)
+                            .subscribe(data -> writer.write(DumpFiles.toBytes(data))));
+                } else if (file.canWrite() || !file.exists()) {
+                    file.delete();
+                    RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+                    configDisposables.add(robotAgent.readDump()
+                            .doFinally(writer::close)
+                            .subscribe(writer::writeLine));
+                }
+            }
+            if (configParams.latencyFile != null) {
+                File file = new File(configParams.latencyFile);
                 if (file.canWrite() || !file.exists()) {
                     file.delete();
-                    robotAgent.readDump().observeOn(Schedulers.io()).subscribe(data -> {
-                        try (FileWriter fw = new FileWriter(file, true)) {
-                            try (PrintWriter out = new PrintWriter(fw)) {
-                                out.println(data);
-                            }
-                        } catch (IOException ex) {
-                            logger.error(ex.getMessage(), ex);
-                        }
-                    });
+                    RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.DROP);
+                    writer.writeLine(LatencyMonitor.CSV_HEADER);
+                    configDisposables.add(robotAgent.readLatencies()
+                            .doFinally(writer::close)
+                            .subscribe(report -> {
+                                for (String line : report.toCSV()) {
+                                    writer.writeLine(line);
+                                }
+                            }));
                 }
             }
-            configDisposables.clear();
             configDisposables.add(robotAgent.readConnection()
                     .subscribe(connected -> {
                         dashboard.setWifiLed(connected);
@@ -476,11 +435,18 @@ public class UIController {
 
             configDisposables.add(robotAgent.readMapFlow()
                     .throttleLatest(FRAME_INTERVAL, TimeUnit.MILLISECONDS)
+                    .observeOn(Schedulers.computation())
+                    .map(status -> Tuple2.of(status,
+                            cellBuilder.apply(status.value().getMap(), status.value().getWheelly().getRobotLocation(), DEFAULT_MAX_DISTANCE)))
+                    .observeOn(SwingSchedulers.edt())
                     .subscribe(this::handleMapMessage));
 
             configDisposables.add(robotAgent.readCps()
                     .subscribe(this::handleCps));
 
+            configDisposables.add(robotAgent.readLatencies()
+                    .subscribe(dashboard::setLatencies));
+
             configDisposables.add(robotAgent.readInferenceData().subscribe(this::handleInferenceData));
 
             configDisposables.add(readPerformaceWindow(PERFORMANCE_WINDOW, PERFORMANCE_SKIP)
@@ -33,6 +33,7 @@ import com.fasterxml.jackson.databind.JsonNode;
 import org.mmarini.yaml.schema.Locator;
 import org.mmarini.yaml.schema.Validator;
 
+import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
 
@@ -47,28 +48,79 @@ public class Yaml {
      *
      */
     public static Validator config() {
+        Map<String, Validator> properties = new HashMap<>(robot());
+        properties.put("version", Validator.string(Validator.values("0.1")));
+        properties.put("fleet", fleet());
         return Validator.objectPropertiesRequired(
-                Map.ofEntries(
-                        Map.entry("version", Validator.string(Validator.values("0.1"))),
-                        Map.entry("host", Validator.string()),
-                        Map.entry("port", Validator.positiveInteger()),
-                        Map.entry("connectionTimeout", Validator.positiveInteger()),
-                        Map.entry("readTimeout", Validator.positiveInteger()),
-                        Map.entry("retryConnectionInterval", Validator.positiveInteger()),
-                        Map.entry("responseTime", Validator.positiveInteger()),
-                        Map.entry("motorCommandInterval", Validator.positiveInteger()),
-                        Map.entry("scanCommandInterval", Validator.positiveInteger()),
-                        Map.entry("engine", Validator.string()),
-                        Map.entry("dumpFile", Validator.string()),
-                        Map.entry("robotLogFile", Validator.string()),
-                        Map.entry("netMonitor", Validator.booleanValue())
-                ),
+                properties,
                 List.of("version", "host", "port", "connectionTimeout", "readTimeout", "retryConnectionInterval",
                         "responseTime", "motorCommandInterval", "scanCommandInterval",
                         "engine")
         );
     }
 
+    /**
+     * Returns the validator of the fleet section.
+     * Each robot item overrides the properties of the configuration root.
+     */
+    public static Validator fleet() {
+        return Validator.objectPropertiesRequired(Map.of(
+                        "threads", Validator.positiveInteger(),
+                        "batchTimeout", Validator.positiveInteger(),
+                        "robots", Validator.array(
+                                Validator.items(Validator.objectProperties(robot())),
+                                Validator.minItems(1))
+                ),
+                List.of("robots")
+        );
+    }
+
+    private static Validator point() {
+        return Validator.array(Validator.prefixItems(Validator.number(), Validator.number()),
+                Validator.minItems(2), Validator.maxItems(2));
+    }
+
+    /**
+     * Returns the validators of the robot properties
+     */
+    private static Map<String, Validator> robot() {
+        return Map.ofEntries(
+                Map.entry("host", Validator.string()),
+                Map.entry("port", Validator.positiveInteger()),
+                Map.entry("connectionTimeout", Validator.positiveInteger()),
+                Map.entry("readTimeout", Validator.positiveInteger()),
+                Map.entry("retryConnectionInterval", Validator.positiveInteger()),
+                Map.entry("responseTime", Validator.positiveInteger()),
+                Map.entry("motorCommandInterval", Validator.positiveInteger()),
+                Map.entry("scanCommandInterval", Validator.positiveInteger()),
+                Map.entry("engine", Validator.string()),
+                Map.entry("dumpFile", Validator.string()),
+                Map.entry("robotLogFile", Validator.string()),
+                Map.entry("latencyFile", Validator.string()),
+                Map.entry("netMonitor", Validator.booleanValue()),
+                Map.entry("binaryTelemetry", Validator.booleanValue()),
+                Map.entry("clockSyncInterval", Validator.nonNegativeInteger()),
+                Map.entry("simulation", simulation()),
+                Map.entry("map", Validator.objectProperties(Map.of(
+                        "maxTiles", Validator.positiveInteger(),
+                        "maxObstacles", Validator.positiveInteger()
+                )))
+        );
+    }
+
+    /**
+     * Returns the validator of the simulated robot section
+     */
+    public static Validator simulation() {
+        return Validator.objectProperties(Map.of(
+                "world", Validator.arrayItems(Validator.arrayItems(point())),
+                "startLocation", point(),
+                "startDirection", Validator.integer(Validator.minimum(-180), Validator.maximum(180)),
+                "statusInterval", Validator.positiveInteger(),
+                "speedUp", Validator.positiveNumber()
+        ));
+    }
+
     public static Locator engine(JsonNode root, Locator locator) {
         requireNonNull(root);
         requireNonNull(root);
@@ -39,6 +39,14 @@ import java.util.stream.Stream;
 import static java.util.Objects.requireNonNull;
 import static org.mmarini.Utils.stream;
 
+/**
+ * Locates a node in a json document.
+ * <p>
+ * The locators created by the path methods resolve the node relative to the node of their parent locator,
+ * and each locator caches the node resolved for the last document, so the nodes of a document tree walked by
+ * parent and child locators are resolved once instead of walking the document from the root at each access.
+ * </p>
+ */
 public class Locator {
 
     private static final Locator ROOT = new Locator(JsonPointer.empty());
@@ -58,8 +66,24 @@ public class Locator {
     }
 
     public final JsonPointer pointer;
+    private final Locator parent;
+    private final JsonPointer relative;
+    private volatile Resolution resolution;
 
     public Locator(JsonPointer pointer) {
+        this(null, pointer, pointer);
+    }
+
+    /**
+     * Creates the locator
+     *
+     * @param parent   the parent locator or null if absolute locator
+     * @param relative the pointer relative to the parent
+     * @param pointer  the absolute pointer
+     */
+    protected Locator(Locator parent, JsonPointer relative, JsonPointer pointer) {
+        this.parent = parent;
+        this.relative = requireNonNull(relative);
         this.pointer = requireNonNull(pointer);
     }
 
@@ -77,7 +101,18 @@ public class Locator {
      * @param root the root element
      */
     public JsonNode getNode(JsonNode root) {
-        return root.at(pointer);
+        if (pointer.matches()) {
+            return root;
+        }
+        Resolution cached = resolution;
+        if (cached != null && cached.root == root) {
+            return cached.node;
+        }
+        JsonNode node = parent != null
+                ? parent.getNode(root).at(relative)
+                : root.at(pointer);
+        resolution = new Resolution(root, node);
+        return node;
     }
 
     /**
@@ -119,7 +154,7 @@ public class Locator {
      */
     public Locator path(JsonPointer path) {
         requireNonNull(path);
-        return new Locator(pointer.append(path));
+        return new Locator(this, path, pointer.append(path));
     }
 
     /**
@@ -150,4 +185,17 @@ public class Locator {
     public String toString() {
         return pointer.toString();
     }
+
+    /**
+     * The node resolved for a document
+     */
+    private static class Resolution {
+        final JsonNode root;
+        final JsonNode node;
+
+        Resolution(JsonNode root, JsonNode node) {
+            this.root = root;
+            this.node = node;
+        }
+    }
 }
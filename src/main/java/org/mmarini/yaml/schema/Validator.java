@@ -36,6 +36,7 @@ import java.util.*;
 import java.util.function.BiFunction;
 import java.util.function.Consumer;
 import java.util.function.Function;
+import java.util.regex.Pattern;
 
 import static java.lang.Math.min;
 import static java.lang.String.format;
@@ -525,9 +526,10 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
      * @param pattern the regex pattern
      */
     static Validator pattern(String pattern) {
+        Pattern compiled = Pattern.compile(pattern);
         return locator -> root -> {
             String value = locator.getNode(root).asText("");
-            assertFor(value.matches(pattern), locator, "must match pattern \"%s\" (%s)", pattern, value);
+            assertFor(compiled.matcher(value).matches(), locator, "must match pattern \"%s\" (%s)", pattern, value);
         };
     }
 
@@ -596,6 +598,7 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
         requireNonNull(properties);
         requireNonNull(required);
         requireNonNull(additionalProperties);
+        Set<String> requiredSet = Set.copyOf(required);
         return locator -> root -> {
             JsonNode node = locator.getNode(root);
             // Validate required properties
@@ -609,7 +612,7 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
             }
             // Validate optional properties
             for (String name : iterable(node.fieldNames())) {
-                if (!required.contains(name)) {
+                if (!requiredSet.contains(name)) {
                     getValue(properties, name)
                             .orElse(additionalProperties)
                             .apply(locator.path(name))
@@ -636,6 +639,7 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
     static Validator properties(Map<String, Validator> properties, List<String> required) {
         requireNonNull(properties);
         requireNonNull(required);
+        Set<String> requiredSet = Set.copyOf(required);
         return locator -> root -> {
             JsonNode node = locator.getNode(root);
             // Validate required properties
@@ -649,7 +653,7 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
             }
             // Validate optional properties
             for (String name : iterable(node.fieldNames())) {
-                if (!required.contains(name)) {
+                if (!requiredSet.contains(name)) {
                     Locator child = locator.path(name);
                     Validator schema = properties.get(name);
                     if (schema != null) {
@@ -693,9 +697,10 @@ public interface Validator extends Function<Locator, Consumer<JsonNode>> {
      * @param values the accepted values
      */
     static Validator values(Collection<String> values) {
+        Set<String> accepted = Set.copyOf(values);
         return locator -> root -> {
             String value = locator.getNode(root).asText("");
-            assertFor(values.contains(value), locator, "must match a value in %s (%s)", values, value);
+            assertFor(accepted.contains(value), locator, "must match a value in %s (%s)", values, value);
         };
     }
 
@@ -0,0 +1,99 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.apps;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.Files;
+import java.util.List;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.contains;
+import static org.hamcrest.Matchers.equalTo;
+
+class TrainingDatasetsTest {
+
+    @TempDir
+    File tempDir;
+
+    private File createFile(String name) throws IOException {
+        File file = new File(tempDir, name);
+        Files.writeString(file.toPath(), "1,2,3\n");
+        return file;
+    }
+
+    @Test
+    void listFile() throws IOException {
+        File a = createFile("a.csv");
+        createFile("b.csv");
+
+        assertThat(TrainingDatasets.listFiles(a.getPath()), contains(a));
+    }
+
+    @Test
+    void listFolder() throws IOException {
+        File b = createFile("b.csv");
+        File a = createFile("a.csv");
+        File c = createFile("c.txt");
+
+        assertThat(TrainingDatasets.listFiles(tempDir.getPath()), contains(a, b, c));
+    }
+
+    @Test
+    void listGlob() throws IOException {
+        File b = createFile("dataset-b.csv");
+        File a = createFile("dataset-a.csv");
+        createFile("dataset-c.txt");
+        createFile("other.csv");
+
+        assertThat(TrainingDatasets.listFiles(new File(tempDir, "dataset-*.csv").getPath()), contains(a, b));
+    }
+
+    @Test
+    void cacheValidity() throws IOException {
+        File a = createFile("a.csv");
+        File cacheDir = new File(tempDir, "cache");
+        List<File> files = List.of(a);
+
+        assertThat(TrainingDatasets.isCacheValid(cacheDir, files, 32, 10), equalTo(false));
+
+        TrainingDatasets.clearCache(cacheDir);
+        Files.write(new File(cacheDir, TrainingDatasets.INDEX_FILE).toPath(), TrainingDatasets.index(files, 32, 10));
+
+        assertThat(TrainingDatasets.isCacheValid(cacheDir, files, 32, 10), equalTo(true));
+        assertThat(TrainingDatasets.isCacheValid(cacheDir, files, 16, 10), equalTo(false));
+
+        Files.writeString(a.toPath(), "1,2,3\n4,5,6\n");
+        assertThat(TrainingDatasets.isCacheValid(cacheDir, files, 32, 10), equalTo(false));
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.benchmarks;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.wheelly.model.GridScannerMap;
+import org.mmarini.wheelly.model.MapStatus;
+import org.mmarini.wheelly.model.Obstacle;
+import org.mmarini.wheelly.model.WheellyStatus;
+
+import java.awt.*;
+import java.awt.geom.Point2D;
+import java.util.ArrayList;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Random;
+import java.util.Set;
+import java.util.concurrent.TimeUnit;
+
+import static java.lang.Math.max;
+import static java.lang.Math.sqrt;
+import static org.mmarini.wheelly.model.GridScannerMap.*;
+
+/**
+ * The random fixtures shared by the benchmarks
+ */
+interface Fixtures {
+    long SEED = 1234;
+    double MIN_RANGE = 3;
+
+    /**
+     * Returns the random map with the given number of obstacles.
+     * The obstacles are spread in a square area of about four cells per obstacle around the origin
+     *
+     * @param numObstacles the number of obstacles
+     * @param timestamp    the timestamp of the most recent obstacle
+     * @param random       the random generator
+     */
+    static GridScannerMap map(int numObstacles, long timestamp, Random random) {
+        double range = max(MIN_RANGE, sqrt(numObstacles) * THRESHOLD_DISTANCE);
+        List<Obstacle> obstacles = new ArrayList<>(numObstacles);
+        for (int i = 0; i < numObstacles; i++) {
+            Point2D location = snapToGrid(new Point2D.Double(
+                            (random.nextDouble() * 2 - 1) * range,
+                            (random.nextDouble() * 2 - 1) * range),
+                    THRESHOLD_DISTANCE);
+            obstacles.add(Obstacle.create(location,
+                    timestamp - (long) (random.nextDouble() * HOLD_DURATION),
+                    random.nextDouble()));
+        }
+        return GridScannerMap.create(obstacles, THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0);
+    }
+
+    /**
+     * Returns the maze of prohibited cells.
+     * The maze is a sequence of vertical walls every four cells with a gap alternating at the top and at the bottom
+     *
+     * @param size the half size of maze (cells)
+     */
+    static Set<Point> maze(int size) {
+        Set<Point> result = new HashSet<>();
+        boolean top = true;
+        for (int i = -size + 2; i < size - 1; i += 4) {
+            for (int j = -size; j <= size; j++) {
+                if (top ? j < size - 1 : j > -size + 1) {
+                    result.add(new Point(i, j));
+                }
+            }
+            top = !top;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the map status of robot with an echo
+     *
+     * @param map       the map
+     * @param timestamp the timestamp
+     */
+    static Timed<MapStatus> status(GridScannerMap map, long timestamp) {
+        return new Timed<>(MapStatus.create(wheelly(), map), timestamp, TimeUnit.MILLISECONDS);
+    }
+
+    /**
+     * Returns the robot status near the origin with an echo
+     */
+    static WheellyStatus wheelly() {
+        return WheellyStatus.create(new Point2D.Double(0.1, -0.2), 30,
+                -15, 1.2,
+                0.1, 0.2,
+                0, 12,
+                true, true,
+                false, false, 0, 0, 0);
+    }
+}
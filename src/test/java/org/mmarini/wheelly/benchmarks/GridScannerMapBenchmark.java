@@ -0,0 +1,89 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.benchmarks;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.wheelly.model.CellBitmap;
+import org.mmarini.wheelly.model.GridScannerMap;
+import org.mmarini.wheelly.model.ProhibitedCellFinder;
+import org.mmarini.wheelly.model.WheellyStatus;
+import org.openjdk.jmh.annotations.*;
+
+import java.awt.*;
+import java.util.Random;
+import java.util.Set;
+import java.util.concurrent.TimeUnit;
+
+import static org.mmarini.wheelly.model.GridScannerMap.THRESHOLD_DISTANCE;
+
+/**
+ * Benchmarks the map update by sensor samples and the prohibited cells computation
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.Throughput)
+@OutputTimeUnit(TimeUnit.SECONDS)
+public class GridScannerMapBenchmark {
+    @Param({"100", "1000", "10000"})
+    public int numObstacles;
+
+    private GridScannerMap map;
+    private Timed<WheellyStatus> sample;
+    private Set<Point> prohibited;
+    private CellBitmap bitmap;
+
+    @Benchmark
+    public CellBitmap bitmapContour() {
+        return bitmap.contour();
+    }
+
+    @Benchmark
+    public Set<Point> findContour() {
+        return ProhibitedCellFinder.findContour(prohibited);
+    }
+
+    @Benchmark
+    public Set<Point> findProhibited() {
+        return ProhibitedCellFinder.create(map, THRESHOLD_DISTANCE, 0).find();
+    }
+
+    @Benchmark
+    public GridScannerMap process() {
+        return map.process(sample);
+    }
+
+    @Setup
+    public void setup() {
+        long timestamp = System.currentTimeMillis();
+        map = Fixtures.map(numObstacles, timestamp, new Random(Fixtures.SEED));
+        sample = new Timed<>(Fixtures.wheelly(), timestamp, TimeUnit.MILLISECONDS);
+        prohibited = ProhibitedCellFinder.create(map, THRESHOLD_DISTANCE, 0).find();
+        bitmap = CellBitmap.of(prohibited);
+    }
+}
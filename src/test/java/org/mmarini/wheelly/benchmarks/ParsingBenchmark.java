@@ -0,0 +1,69 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.benchmarks;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.Tuple2;
+import org.mmarini.wheelly.model.*;
+import org.openjdk.jmh.annotations.*;
+
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Benchmarks the parsing of status records and dump lines
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.Throughput)
+@OutputTimeUnit(TimeUnit.SECONDS)
+public class ParsingBenchmark {
+    private static final String STATUS_RECORD = "st 1234567 0.12 -0.34 30 -15 1.23 0.10 0.20 0 12.0 1 1 0 0 0 0.00 0";
+    private static final int NUM_OBSTACLES = 100;
+
+    private String dumpLine;
+
+    @Benchmark
+    public Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> fromDumpLine() {
+        return FileFunctions.fromDumpLine(dumpLine);
+    }
+
+    @Setup
+    public void setup() {
+        long timestamp = System.currentTimeMillis();
+        GridScannerMap map = Fixtures.map(NUM_OBSTACLES, timestamp, new Random(Fixtures.SEED));
+        dumpLine = FileFunctions.toString(Tuple2.of(Fixtures.status(map, timestamp),
+                Tuple2.of(MoveCommand.create(30, 0.5), 0)));
+    }
+
+    @Benchmark
+    public WheellyStatus statusFrom() {
+        return WheellyStatus.from(STATUS_RECORD);
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.benchmarks;
+
+import org.mmarini.wheelly.engines.statemachine.AStar;
+import org.mmarini.wheelly.engines.statemachine.GridAStar;
+import org.mmarini.wheelly.model.CellPredicate;
+import org.mmarini.wheelly.model.ProhibitedCellFinder;
+import org.openjdk.jmh.annotations.*;
+
+import java.awt.*;
+import java.awt.geom.Point2D;
+import java.util.List;
+import java.util.Set;
+import java.util.concurrent.TimeUnit;
+import java.util.stream.Collectors;
+
+import static org.mmarini.wheelly.model.GridScannerMap.THRESHOLD_DISTANCE;
+
+/**
+ * Benchmarks the path finding and the path optimization on open and maze grids
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.Throughput)
+@OutputTimeUnit(TimeUnit.SECONDS)
+public class PathBenchmark {
+    private static final int SIZE = 20;
+    private static final double EXTENSION_DISTANCE = 20;
+
+    @Param({"open", "maze"})
+    public String grid;
+
+    private Set<Point> prohibited;
+    private Point start;
+    private Point goal;
+    private GridAStar gridAStar;
+    private List<Point2D> path;
+
+    @Benchmark
+    public List<Point> findPath() {
+        return AStar.findPath(start, goal, prohibited, EXTENSION_DISTANCE);
+    }
+
+    @Benchmark
+    public List<Point> gridFindPath() {
+        return gridAStar.findPath(start, goal, CellPredicate.of(prohibited), EXTENSION_DISTANCE);
+    }
+
+    @Benchmark
+    public List<Point2D> optimizePath() {
+        return ProhibitedCellFinder.optimizePath(path, THRESHOLD_DISTANCE, CellPredicate.of(prohibited));
+    }
+
+    @Benchmark
+    public List<Point2D> optimizeClearPath() {
+        return ProhibitedCellFinder.optimizeClearPath(path, THRESHOLD_DISTANCE, CellPredicate.of(prohibited));
+    }
+
+    @Benchmark
+    public List<Point2D> pullString() {
+        return ProhibitedCellFinder.pullString(path, THRESHOLD_DISTANCE, CellPredicate.of(prohibited));
+    }
+
+    @Setup
+    public void setup() {
+        prohibited = "maze".equals(grid) ? Fixtures.maze(SIZE) : Set.of();
+        start = new Point(-SIZE, 0);
+        goal = new Point(SIZE, 0);
+        gridAStar = new GridAStar();
+        path = AStar.findPath(start, goal, prohibited, EXTENSION_DISTANCE).stream()
+                .map(cell -> new Point2D.Double(cell.x * THRESHOLD_DISTANCE, cell.y * THRESHOLD_DISTANCE))
+                .collect(Collectors.toList());
+        if (path.isEmpty()) {
+            throw new IllegalStateException("Path not found");
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.benchmarks;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.mmarini.wheelly.engines.deepl.*;
+import org.mmarini.wheelly.model.GridScannerMap;
+import org.mmarini.wheelly.model.MapStatus;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.openjdk.jmh.annotations.*;
+
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Benchmarks the signal encoders
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.Throughput)
+@OutputTimeUnit(TimeUnit.SECONDS)
+public class SignalEncoderBenchmark {
+    private static final int NUM_OBSTACLES = 1000;
+
+    @Param({"simple", "map", "full"})
+    public String encoderType;
+
+    private SignalEncoder encoder;
+    private Timed<MapStatus> status;
+    private SignalBuffer buffer;
+
+    @Benchmark
+    public INDArray encode() {
+        return encoder.encode(status);
+    }
+
+    @Benchmark
+    public int[] encodeIndices() {
+        return encoder.encodeIndices(status);
+    }
+
+    @Benchmark
+    public SignalBuffer encodeBuffer() {
+        return encoder.encode(status, buffer, 0);
+    }
+
+    @Setup
+    public void setup() {
+        switch (encoderType) {
+            case "map":
+                encoder = MapFeaturesSignalEncoder.create();
+                break;
+            case "full":
+                encoder = FullFeaturesSignalEncoder.create();
+                break;
+            default:
+                encoder = SimpleFeaturesSignalEncoder.create();
+        }
+        long timestamp = System.currentTimeMillis();
+        GridScannerMap map = Fixtures.map(NUM_OBSTACLES, timestamp, new Random(Fixtures.SEED));
+        status = Fixtures.status(map, timestamp);
+        buffer = SignalBuffer.create(1, encoder.getNumSignals());
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+import org.mmarini.wheelly.engines.statemachine.DStarLite;
+import org.mmarini.wheelly.engines.statemachine.GridAStar;
+import org.mmarini.wheelly.model.Obstacle;
+import org.mmarini.wheelly.model.ObstacleGrid;
+import org.mmarini.wheelly.model.ProhibitedArea;
+
+import java.awt.*;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Random;
+import java.util.Set;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class DStarLiteTest {
+    static final double GRID_SIZE = 0.2;
+    static final double LIKELIHOOD_THRESHOLD = 0.5;
+    static final int RANGE = 20;
+
+    static ObstacleGrid.Builder put(ObstacleGrid.Builder builder, int i, int j) {
+        return builder.put(i, j, Obstacle.create(i * GRID_SIZE, j * GRID_SIZE, 0, 1));
+    }
+
+    static ProhibitedArea area() {
+        return ProhibitedArea.create(GRID_SIZE, 0, LIKELIHOOD_THRESHOLD);
+    }
+
+    @Test
+    void changedCells() {
+        ProhibitedArea area0 = area();
+        ProhibitedArea area1 = area0.update(put(ObstacleGrid.empty().builder(), 1, 1).build());
+        ProhibitedArea area2 = area1.update(put(ObstacleGrid.empty().builder(), 40, 40).build());
+
+        assertThat(area1.changedCells(area0), contains(new Point(1, 1)));
+        assertThat(area1.changedCells(area1), empty());
+        assertThat(area2.changedCells(area1), containsInAnyOrder(new Point(1, 1), new Point(40, 40)));
+    }
+
+    @Test
+    void findPath1() {
+        Point start = new Point();
+        Point goal = new Point(2, 2);
+        ProhibitedArea area = area().update(put(ObstacleGrid.empty().builder(), 1, 1).build());
+        List<Point> path = DStarLite.create(start, goal, area, 1).findPath(start, area);
+        assertThat(path, hasSize(4));
+        assertThat(path.get(0), equalTo(start));
+        assertThat(path.get(3), equalTo(goal));
+        assertThat(path, not(hasItem(new Point(1, 1))));
+    }
+
+    @Test
+    void prohibitedGoal() {
+        Point goal = new Point(2, 2);
+        ProhibitedArea area = area().update(put(ObstacleGrid.empty().builder(), 2, 2).build());
+        List<Point> path = DStarLite.create(new Point(), goal, area, 1).findPath(new Point(), area);
+        assertThat(path, empty());
+    }
+
+    @Test
+    void sameCell() {
+        Point cell = new Point(3, -2);
+        ProhibitedArea area = area();
+        List<Point> path = DStarLite.create(cell, cell, area, 1).findPath(cell, area);
+        assertThat(path, contains(cell));
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "1234,0.1,3",
+            "4321,0.2,5",
+            "1111,0.3,10",
+            "2222,0.4,15",
+    })
+    void replan(long seed, double density, int extension) {
+        Random random = new Random(seed);
+        GridAStar aStar = new GridAStar();
+        Point start = new Point(random.nextInt(2 * RANGE + 1) - RANGE, random.nextInt(2 * RANGE + 1) - RANGE);
+        Point goal = new Point(random.nextInt(2 * RANGE + 1) - RANGE, random.nextInt(2 * RANGE + 1) - RANGE);
+        ObstacleGrid grid = ObstacleGrid.empty();
+        ProhibitedArea area = area();
+        DStarLite planner = DStarLite.create(start, goal, area, extension);
+        double maxDistanceSq = start.distanceSq(goal) + extension * extension;
+        for (int n = 0; n < 30; n++) {
+            // Changes some cells
+            ObstacleGrid.Builder builder = grid.builder();
+            for (int k = 0; k < 100; k++) {
+                int i = random.nextInt(2 * RANGE + 11) - RANGE - 5;
+                int j = random.nextInt(2 * RANGE + 11) - RANGE - 5;
+                if (random.nextDouble() < density) {
+                    put(builder, i, j);
+                } else {
+                    builder.remove(i, j);
+                }
+            }
+            builder.remove(start.x, start.y);
+            grid = builder.build();
+            area = area.update(grid);
+            Set<Point> prohibited = new HashSet<>(area.getProhibited());
+
+            List<Point> expected = aStar.findPath(start, goal, area::isProhibited, extension);
+            List<Point> path = planner.findPath(start, area);
+
+            assertThat(path.isEmpty(), equalTo(expected.isEmpty()));
+            if (!path.isEmpty()) {
+                assertThat(path.get(0), equalTo(start));
+                assertThat(path.get(path.size() - 1), equalTo(goal));
+                for (int k = 1; k < path.size(); k++) {
+                    Point cell = path.get(k);
+                    assertThat(cell.distanceSq(path.get(k - 1)), lessThanOrEqualTo(2d));
+                    assertThat(prohibited.contains(cell), equalTo(false));
+                    assertThat(cell.distanceSq(start), lessThanOrEqualTo(maxDistanceSq));
+                    assertThat(cell.distanceSq(goal), lessThanOrEqualTo(maxDistanceSq));
+                }
+            }
+        }
+    }
+}
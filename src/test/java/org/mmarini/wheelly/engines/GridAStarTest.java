@@ -0,0 +1,132 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+import org.mmarini.wheelly.engines.statemachine.AStar;
+import org.mmarini.wheelly.engines.statemachine.GridAStar;
+import org.mmarini.wheelly.model.CellPredicate;
+
+import java.awt.*;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Random;
+import java.util.Set;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class GridAStarTest {
+
+    public static final int EXTENSION_DISTANCE = 1;
+
+    @Test
+    void findPath1() {
+        Point start = new Point();
+        Point goal = new Point(2, 2);
+        Set<Point> prohibited = Set.of(
+                new Point(1, 1)
+        );
+        List<Point> path = new GridAStar().findPath(start, goal, CellPredicate.of(prohibited), EXTENSION_DISTANCE);
+        assertThat(path,
+                anyOf(
+                        contains(
+                                new Point(),
+                                new Point(0, 1),
+                                new Point(1, 2),
+                                new Point(2, 2)
+                        ),
+                        contains(
+                                new Point(),
+                                new Point(1, 0),
+                                new Point(2, 1),
+                                new Point(2, 2)
+                        )
+                )
+        );
+    }
+
+    @Test
+    void prohibitedGoal() {
+        Point goal = new Point(2, 2);
+        List<Point> path = new GridAStar().findPath(new Point(), goal, CellPredicate.of(Set.of(goal)), EXTENSION_DISTANCE);
+        assertThat(path, empty());
+    }
+
+    @Test
+    void sameCell() {
+        List<Point> path = new GridAStar().findPath(new Point(3, -2), new Point(3, -2), CellPredicate.of(Set.of()), EXTENSION_DISTANCE);
+        assertThat(path, contains(new Point(3, -2)));
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "1234,0.1,3",
+            "4321,0.2,5",
+            "1111,0.3,10",
+            "2222,0.4,15",
+    })
+    void randomGrid(long seed, double density, int extension) {
+        Random random = new Random(seed);
+        GridAStar aStar = new GridAStar();
+        for (int n = 0; n < 50; n++) {
+            Set<Point> prohibited = new HashSet<>();
+            for (int i = -30; i <= 30; i++) {
+                for (int j = -30; j <= 30; j++) {
+                    if (random.nextDouble() < density) {
+                        prohibited.add(new Point(i, j));
+                    }
+                }
+            }
+            Point start = new Point(random.nextInt(41) - 20, random.nextInt(41) - 20);
+            Point goal = new Point(random.nextInt(41) - 20, random.nextInt(41) - 20);
+            prohibited.remove(start);
+
+            List<Point> expected = AStar.findPath(start, goal, prohibited, extension);
+            List<Point> path = aStar.findPath(start, goal, CellPredicate.of(prohibited), extension);
+
+            assertThat(path.isEmpty(), equalTo(expected.isEmpty()));
+            if (!path.isEmpty()) {
+                double maxDistanceSq = start.distanceSq(goal) + extension * extension;
+                assertThat(path.get(0), equalTo(start));
+                assertThat(path.get(path.size() - 1), equalTo(goal));
+                for (int k = 1; k < path.size(); k++) {
+                    Point cell = path.get(k);
+                    assertThat(cell.distanceSq(path.get(k - 1)), lessThanOrEqualTo(2d));
+                    assertThat(prohibited.contains(cell), equalTo(false));
+                    assertThat(cell.distanceSq(start), lessThanOrEqualTo(maxDistanceSq));
+                    assertThat(cell.distanceSq(goal), lessThanOrEqualTo(maxDistanceSq));
+                }
+            }
+        }
+    }
+}
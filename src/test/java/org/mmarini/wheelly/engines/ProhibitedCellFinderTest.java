@@ -33,6 +33,7 @@ import org.junit.jupiter.api.Test;
 import org.junit.jupiter.params.ParameterizedTest;
 import org.junit.jupiter.params.provider.CsvSource;
 import org.mmarini.Tuple2;
+import org.mmarini.wheelly.model.CellPredicate;
 import org.mmarini.wheelly.model.GridScannerMap;
 import org.mmarini.wheelly.model.Obstacle;
 import org.mmarini.wheelly.model.ProhibitedCellFinder;
@@ -294,6 +295,52 @@ class ProhibitedCellFinderTest {
         commonTest(sx, sy, tx, ty, i, j, expi, expj, expx, expy);
     }
 
+    @ParameterizedTest
+    @CsvSource(value = {
+            "0,0, 8,8, 0,0, false",
+            "0,0, 8,8, 2,2, false",
+            "0,0, 8,8, 4,4, false",
+
+            "0,0, -8,-8, 0,0, false",
+            "0,0, -8,-8, -2,-2, false",
+            "0,0, -8,-8, -4,-4, false",
+
+            "0,0, -8,8, 0,0, false",
+            "0,0, -8,8, -2,2, false",
+            "0,0, -8,8, -4,4, false",
+
+            "0,0, 8,4, 0,0, false",
+            "0,0, 8,4, 2,1, false",
+            "0,0, 8,4, 3,2, false",
+
+            "0,0, 8,8, 5,5, true",
+    })
+    void isClear(double fromx, double fromy, double tox, double toy, int i, int j, boolean isValid) {
+        Point2D from = new Point2D.Double(fromx, fromy);
+        Point2D to = new Point2D.Double(tox, toy);
+        boolean result = ProhibitedCellFinder.isClear(from, to, GRID_SIZE1, (ci, cj) -> ci == i && cj == j);
+        assertThat(result, equalTo(isValid));
+    }
+
+    @Test
+    void isClearHorizontal() {
+        Point2D from = new Point2D.Double(0, 0);
+        Point2D to = new Point2D.Double(2, 0);
+        Set<Point> avoid = Set.of(GridScannerMap.cell(new Point2D.Double(1, 0), GRID_SIZE2));
+
+        assertThat(ProhibitedCellFinder.isClear(from, to, GRID_SIZE2, CellPredicate.of(avoid)), equalTo(false));
+        assertThat(ProhibitedCellFinder.isClear(from, new Point2D.Double(0.9, 0), GRID_SIZE2, CellPredicate.of(avoid)), equalTo(true));
+    }
+
+    @Test
+    void isClearTargetCell() {
+        Point2D from = new Point2D.Double(0, 0);
+        Point2D to = new Point2D.Double(2, 1);
+        Set<Point> avoid = Set.of(GridScannerMap.cell(to, GRID_SIZE2));
+
+        assertThat(ProhibitedCellFinder.isClear(from, to, GRID_SIZE2, CellPredicate.of(avoid)), equalTo(false));
+    }
+
     @ParameterizedTest
     @CsvSource(value = {
             "0,0, 8,8, 0,0, false",
@@ -318,7 +365,7 @@ class ProhibitedCellFinderTest {
         Point2D from = new Point2D.Double(fromx, fromy);
         Point2D to = new Point2D.Double(tox, toy);
         Point avoidCell = new Point(i, j);
-        boolean result = ProhibitedCellFinder.isValid(from, to, GRID_SIZE1, c -> c.equals(avoidCell));
+        boolean result = ProhibitedCellFinder.isValid(from, to, GRID_SIZE1, (ci, cj) -> ci == avoidCell.x && cj == avoidCell.y);
         assertThat(result, equalTo(isValid));
     }
 
@@ -328,7 +375,7 @@ class ProhibitedCellFinderTest {
                 new Point2D.Double(0, 0),
                 new Point2D.Double(4, 4)
         );
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, c -> false);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, (i, j) -> false);
 
         assertThat(result, sameInstance(path));
     }
@@ -340,7 +387,7 @@ class ProhibitedCellFinderTest {
                 new Point2D.Double(2, 2),
                 new Point2D.Double(4, 4)
         );
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, c -> false);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, (i, j) -> false);
 
         assertThat(result, hasSize(2));
         assertThat(result, contains(
@@ -356,7 +403,7 @@ class ProhibitedCellFinderTest {
                 new Point2D.Double(2, 2),
                 new Point2D.Double(4, 4)
         );
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, c -> true);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, (i, j) -> true);
 
         assertThat(result, hasSize(3));
         assertThat(result, contains(
@@ -375,7 +422,7 @@ class ProhibitedCellFinderTest {
                 new Point2D.Double(6, 6),
                 new Point2D.Double(8, 8)
         );
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, c -> false);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE1, (i, j) -> false);
 
         assertThat(result, hasSize(2));
         assertThat(result, contains(
@@ -394,7 +441,7 @@ class ProhibitedCellFinderTest {
                 new Point2D.Double(4, 0)
         );
         Set<Point> avoid = Set.of(GridScannerMap.cell(new Point2D.Double(2, 0), GRID_SIZE2));
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE2, avoid::contains);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE2, CellPredicate.of(avoid));
 
         assertThat(result, hasSize(3));
         assertThat(result, contains(
@@ -418,7 +465,7 @@ class ProhibitedCellFinderTest {
                 GridScannerMap.cell(new Point2D.Double(2, 1), GRID_SIZE2),
                 GridScannerMap.cell(new Point2D.Double(2.5, 0.5), GRID_SIZE2)
         );
-        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE2, avoid::contains);
+        List<Point2D> result = ProhibitedCellFinder.optimizePath(path, GRID_SIZE2, CellPredicate.of(avoid));
 
         assertThat(result, hasSize(4));
         assertThat(result, contains(
@@ -429,6 +476,112 @@ class ProhibitedCellFinderTest {
         ));
     }
 
+    @Test
+    void optimizeClearPath5to3() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(1, 0),
+                new Point2D.Double(2, 1),
+                new Point2D.Double(3, 0),
+                new Point2D.Double(4, 0)
+        );
+        Set<Point> avoid = Set.of(GridScannerMap.cell(new Point2D.Double(2, 0), GRID_SIZE2));
+        List<Point2D> result = ProhibitedCellFinder.optimizeClearPath(path, GRID_SIZE2, CellPredicate.of(avoid));
+
+        assertThat(result, contains(
+                path.get(0),
+                path.get(2),
+                path.get(4)
+        ));
+    }
+
+    @Test
+    void pullString2to2() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(4, 4)
+        );
+        List<Point2D> result = ProhibitedCellFinder.pullString(path, GRID_SIZE1, (i, j) -> false);
+
+        assertThat(result, sameInstance(path));
+    }
+
+    @Test
+    void pullString3to3() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(2, 2),
+                new Point2D.Double(4, 4)
+        );
+        List<Point2D> result = ProhibitedCellFinder.pullString(path, GRID_SIZE1, (i, j) -> true);
+
+        assertThat(result, contains(
+                path.get(0),
+                path.get(1),
+                path.get(2)
+        ));
+    }
+
+    @Test
+    void pullString5to2() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(2, 2),
+                new Point2D.Double(4, 4),
+                new Point2D.Double(6, 6),
+                new Point2D.Double(8, 8)
+        );
+        List<Point2D> result = ProhibitedCellFinder.pullString(path, GRID_SIZE1, (i, j) -> false);
+
+        assertThat(result, contains(
+                path.get(0),
+                path.get(4)
+        ));
+    }
+
+    @Test
+    void pullString5to3() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(1, 0),
+                new Point2D.Double(2, 1),
+                new Point2D.Double(3, 0),
+                new Point2D.Double(4, 0)
+        );
+        Set<Point> avoid = Set.of(GridScannerMap.cell(new Point2D.Double(2, 0), GRID_SIZE2));
+        List<Point2D> result = ProhibitedCellFinder.pullString(path, GRID_SIZE2, CellPredicate.of(avoid));
+
+        assertThat(result, contains(
+                path.get(0),
+                path.get(2),
+                path.get(4)
+        ));
+    }
+
+    @Test
+    void pullString5to4() {
+        List<Point2D> path = List.of(
+                new Point2D.Double(0, 0),
+                new Point2D.Double(1, 1),
+                new Point2D.Double(2, 0),
+                new Point2D.Double(3, 0),
+                new Point2D.Double(3, 1)
+        );
+        Set<Point> avoid = Set.of(
+                GridScannerMap.cell(new Point2D.Double(1, 0), GRID_SIZE2),
+                GridScannerMap.cell(new Point2D.Double(2, 1), GRID_SIZE2),
+                GridScannerMap.cell(new Point2D.Double(2.5, 0.5), GRID_SIZE2)
+        );
+        List<Point2D> result = ProhibitedCellFinder.pullString(path, GRID_SIZE2, CellPredicate.of(avoid));
+
+        assertThat(result, contains(
+                path.get(0),
+                path.get(1),
+                path.get(3),
+                path.get(4)
+        ));
+    }
+
     @ParameterizedTest
     @CsvSource(value = {
             "0,0, 0.1,0.0, 0,0, 0,0, 0.1,0",
@@ -0,0 +1,110 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.junit.jupiter.api.Test;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.factory.Nd4j;
+
+import java.util.List;
+import java.util.concurrent.*;
+import java.util.function.Function;
+import java.util.stream.Collectors;
+import java.util.stream.IntStream;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class InferenceBatcherTest {
+
+    /**
+     * Returns the actions doubling the signal rows
+     */
+    static Function<INDArray, INDArray[]> doubler() {
+        return signals -> IntStream.range(0, (int) signals.rows())
+                .mapToObj(i -> signals.getRow(i, true).mul(2))
+                .toArray(INDArray[]::new);
+    }
+
+    static INDArray signals(int i) {
+        return Nd4j.createFromArray(new float[][]{{i, -i}});
+    }
+
+    @Test
+    void batchAllMembers() throws Exception {
+        int n = 4;
+        InferenceBatcher batcher = new InferenceBatcher(doubler(), n, 10000);
+        ExecutorService executor = Executors.newFixedThreadPool(n);
+        try {
+            for (int step = 0; step < 10; step++) {
+                List<Future<INDArray>> results = IntStream.range(0, n)
+                        .mapToObj(i -> executor.submit(() -> batcher.chooseAction(signals(i))))
+                        .collect(Collectors.toList());
+                for (int i = 0; i < n; i++) {
+                    assertThat(results.get(i).get(5, TimeUnit.SECONDS), equalTo(signals(i).mul(2)));
+                }
+            }
+        } finally {
+            executor.shutdown();
+        }
+        assertThat(batcher.getAverageBatchSize(), closeTo(n, 1e-6));
+    }
+
+    @Test
+    void singleMember() {
+        InferenceBatcher batcher = new InferenceBatcher(doubler(), 1, 10000);
+        assertThat(batcher.chooseAction(signals(3)), equalTo(signals(3).mul(2)));
+        assertThat(batcher.chooseAction(signals(5)), equalTo(signals(5).mul(2)));
+        assertThat(batcher.getAverageBatchSize(), closeTo(1, 1e-6));
+    }
+
+    @Test
+    void timeout() {
+        InferenceBatcher batcher = new InferenceBatcher(doubler(), 2, 50);
+        long start = System.currentTimeMillis();
+        INDArray action = batcher.chooseAction(signals(1));
+        long elapsed = System.currentTimeMillis() - start;
+        assertThat(action, equalTo(signals(1).mul(2)));
+        assertThat(elapsed, greaterThanOrEqualTo(45L));
+        assertThat(batcher.getAverageBatchSize(), closeTo(1, 1e-6));
+    }
+
+    @Test
+    void exclusive() throws Exception {
+        InferenceBatcher batcher = new InferenceBatcher(doubler(), 2, 10000);
+        CompletableFuture<INDArray> pending = CompletableFuture.supplyAsync(() -> batcher.chooseAction(signals(1)));
+        // The waiting member releases the batcher to the exclusive tasks
+        Thread.sleep(50);
+        assertThat(batcher.exclusive(() -> "done"), equalTo("done"));
+        assertThat(pending.isDone(), equalTo(false));
+        assertThat(batcher.chooseAction(signals(2)), equalTo(signals(2).mul(2)));
+        assertThat(pending.get(5, TimeUnit.SECONDS), equalTo(signals(1).mul(2)));
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.deeplearning4j.nn.conf.ComputationGraphConfiguration;
+import org.deeplearning4j.nn.conf.NeuralNetConfiguration;
+import org.deeplearning4j.nn.conf.layers.DenseLayer;
+import org.deeplearning4j.nn.conf.layers.OutputLayer;
+import org.deeplearning4j.nn.graph.ComputationGraph;
+import org.deeplearning4j.nn.weights.WeightInit;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+import org.nd4j.linalg.activations.Activation;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.factory.Nd4j;
+import org.nd4j.linalg.learning.config.Sgd;
+import org.nd4j.linalg.lossfunctions.LossFunctions;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.Files;
+import java.nio.file.Path;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static assertThrows;
+
+class InferenceNetworkTest {
+
+    static final int NUM_INPUTS = 10;
+    static final int NUM_SIGNALS = 8;
+
+    /**
+     * Returns the computation graph with 2 hidden layers, a shortcut from input to the output layers and 2 outputs
+     */
+    static ComputationGraph createGraph(Activation activation) {
+        ComputationGraphConfiguration.GraphBuilder builder = new NeuralNetConfiguration.Builder()
+                .seed(1234)
+                .weightInit(WeightInit.XAVIER)
+                .updater(new Sgd(1e-3))
+                .graphBuilder()
+                .addInputs("L0")
+                .addLayer("L1", new DenseLayer.Builder().nIn(NUM_INPUTS).nOut(6).activation(activation)
+                        .dropOut(0.8).build(), "L0")
+                .addLayer("L2", new DenseLayer.Builder().nIn(6).nOut(5).activation(activation)
+                        .dropOut(0.8).build(), "L1")
+                .addLayer("O0", new OutputLayer.Builder().nIn(5 + NUM_INPUTS).nOut(1).activation(Activation.TANH)
+                        .lossFunction(LossFunctions.LossFunction.MSE).build(), "L0", "L2")
+                .addLayer("O1", new OutputLayer.Builder().nIn(5 + NUM_INPUTS).nOut(3).activation(Activation.TANH)
+                        .lossFunction(LossFunctions.LossFunction.MSE).build(), "L0", "L2")
+                .setOutputs("O0", "O1");
+        ComputationGraph net = new ComputationGraph(builder.build());
+        net.init();
+        return net;
+    }
+
+    /**
+     * Returns the sparse signals
+     */
+    static INDArray createSignals() {
+        INDArray signals = Nd4j.rand(1234, NUM_SIGNALS, NUM_INPUTS).subi(0.5).muli(2);
+        // Zeros the half of signals
+        for (int i = 0; i < NUM_SIGNALS; i++) {
+            for (int j = i % 2; j < NUM_INPUTS; j += 2) {
+                signals.putScalar(i, j, 0);
+            }
+        }
+        return signals;
+    }
+
+    @TempDir
+    Path tempDir;
+
+    @ParameterizedTest
+    @CsvSource({
+            "RELU",
+            "TANH",
+            "SOFTPLUS",
+            "HARDTANH",
+            "SIGMOID",
+            "HARDSIGMOID"
+    })
+    void fromGraph(Activation activation) {
+        ComputationGraph net = createGraph(activation);
+        INDArray signals = createSignals();
+        INDArray[] expected = net.output(signals);
+
+        InferenceNetwork network = InferenceNetwork.fromGraph(net);
+        INDArray[] outputs = network.output(signals);
+
+        assertThat(network.getNumInputs(), equalTo(NUM_INPUTS));
+        assertThat(network.getNumOutputs(), equalTo(new int[]{1, 3}));
+        assertThat(network.getNumParameters(), equalTo(net.numParams()));
+        assertThat(outputs.length, equalTo(2));
+        for (int i = 0; i < outputs.length; i++) {
+            assertThat(outputs[i].shape(), equalTo(expected[i].shape()));
+            assertThat(outputs[i].sub(expected[i]).amaxNumber().doubleValue(), lessThan(1e-5));
+        }
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "FLOAT32,1e-6",
+            "FLOAT16,1e-2",
+            "INT8,5e-2"
+    })
+    void writeRead(InferenceNetwork.Precision precision, double epsilon) throws IOException {
+        ComputationGraph net = createGraph(Activation.RELU);
+        INDArray signals = createSignals();
+        INDArray[] expected = net.output(signals);
+        File file = tempDir.resolve("network.inf").toFile();
+
+        InferenceNetwork.fromGraph(net).write(file, precision);
+        InferenceNetwork network = InferenceNetwork.read(file);
+        INDArray[] outputs = network.output(signals);
+
+        assertThat(network.getNumOutputs(), equalTo(new int[]{1, 3}));
+        for (int i = 0; i < outputs.length; i++) {
+            assertThat(outputs[i].sub(expected[i]).amaxNumber().doubleValue(), lessThan(epsilon));
+        }
+    }
+
+    @Test
+    void readWrongFile() throws IOException {
+        File file = tempDir.resolve("wrong.inf").toFile();
+        Files.write(file.toPath(), new byte[]{1, 2, 3, 4, 5});
+        IOException ex = assertThrows(IOException.class, () -> InferenceNetwork.read(file));
+        assertThat(ex.getMessage(), containsString("is not an inference network"));
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "0,0",
+            "1,1",
+            "-2,-2",
+            "0.5,0.5",
+            "65504,65504",
+            "1e-7,1.1920929e-7",
+            "0.1,0.099975586",
+            "3.14159,3.140625",
+    })
+    void half(float value, float expected) {
+        assertThat(InferenceNetwork.halfToFloat(InferenceNetwork.floatToHalf(value)), equalTo(expected));
+    }
+
+    @Test
+    void halfSpecials() {
+        assertThat(InferenceNetwork.halfToFloat(InferenceNetwork.floatToHalf(1e6f)), equalTo(Float.POSITIVE_INFINITY));
+        assertThat(InferenceNetwork.halfToFloat(InferenceNetwork.floatToHalf(Float.NEGATIVE_INFINITY)), equalTo(Float.NEGATIVE_INFINITY));
+        assertThat(Float.isNaN(InferenceNetwork.halfToFloat(InferenceNetwork.floatToHalf(Float.NaN))), equalTo(true));
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.junit.jupiter.api.Test;
+import org.nd4j.linalg.api.rng.Random;
+import org.nd4j.linalg.factory.Nd4j;
+
+import java.util.List;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+
+class ReplayBufferTest {
+
+    static Feedback feedback(int i) {
+        return Feedback.create(
+                Nd4j.createFromArray(new float[][]{{i, i + 1f}}),
+                Nd4j.createFromArray(new float[][]{{i, 0, 0, -i}}),
+                i * 0.5,
+                Nd4j.createFromArray(new float[][]{{i + 2f, i + 3f}}),
+                0.1);
+    }
+
+    @Test
+    void add() {
+        ReplayBuffer buffer = ReplayBuffer.create(3)
+                .add(feedback(0))
+                .add(feedback(1));
+        assertThat(buffer.size(), equalTo(2));
+        assertThat(buffer.get(0), equalTo(feedback(0)));
+        assertThat(buffer.get(1), equalTo(feedback(1)));
+    }
+
+    @Test
+    void overwrite() {
+        ReplayBuffer buffer = ReplayBuffer.create(3);
+        for (int i = 0; i < 5; i++) {
+            buffer.add(feedback(i));
+        }
+        assertThat(buffer.size(), equalTo(3));
+        assertThat(buffer.get(0), equalTo(feedback(2)));
+        assertThat(buffer.get(1), equalTo(feedback(3)));
+        assertThat(buffer.get(2), equalTo(feedback(4)));
+        assertThrows(IndexOutOfBoundsException.class, () -> buffer.get(3));
+    }
+
+    @Test
+    void sample() {
+        ReplayBuffer buffer = ReplayBuffer.create(4);
+        Random random = Nd4j.getRandomFactory().getNewRandomInstance(1234);
+        assertThat(buffer.sample(3, random), empty());
+
+        for (int i = 0; i < 6; i++) {
+            buffer.add(feedback(i));
+        }
+        List<Feedback> result = buffer.sample(10, random);
+        assertThat(result, hasSize(10));
+        assertThat(result, everyItem(isIn(List.of(feedback(2), feedback(3), feedback(4), feedback(5)))));
+    }
+}
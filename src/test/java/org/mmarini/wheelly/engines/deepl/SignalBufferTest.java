@@ -0,0 +1,65 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.engines.deepl;
+
+import org.junit.jupiter.api.Test;
+import org.nd4j.linalg.api.ndarray.INDArray;
+import org.nd4j.linalg.factory.Nd4j;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+
+class SignalBufferTest {
+
+    @Test
+    void reuse() {
+        SignalBuffer buffer = SignalBuffer.create(2, 5)
+                .set(0, new int[]{0, 3})
+                .set(1, new int[]{1, 1, 4});
+        assertThat(buffer.toINDArray(), equalTo(Nd4j.createFromArray(new float[][]{
+                {1, 0, 0, 1, 0},
+                {0, 1, 0, 0, 1}
+        })));
+
+        buffer.set(0, new int[]{2});
+        INDArray result = buffer.toINDArray(1);
+        assertThat(result, equalTo(Nd4j.createFromArray(new float[][]{
+                {0, 0, 1, 0, 0}
+        })));
+    }
+
+    @Test
+    void outOfRange() {
+        SignalBuffer buffer = SignalBuffer.create(1, 5);
+        assertThrows(IllegalArgumentException.class, () -> buffer.set(0, new int[]{5}));
+        assertThrows(IllegalArgumentException.class, () -> buffer.set(0, new int[]{-1}));
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+
+import java.awt.*;
+import java.util.HashSet;
+import java.util.Random;
+import java.util.Set;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class CellBitmapTest {
+
+    /**
+     * Returns random cells
+     *
+     * @param random the random generator
+     * @param n      the number of cells
+     * @param rangeI the x index range
+     * @param rangeJ the y index range
+     */
+    static Set<Point> randomCells(Random random, int n, int rangeI, int rangeJ) {
+        Set<Point> cells = new HashSet<>();
+        for (int k = 0; k < n; k++) {
+            cells.add(new Point(random.nextInt(2 * rangeI + 1) - rangeI, random.nextInt(2 * rangeJ + 1) - rangeJ));
+        }
+        return cells;
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "1234,10,5",
+            "4321,40,100",
+            "1111,100,200",
+    })
+    void contour(long seed, int n, int rangeI) {
+        Random random = new Random(seed);
+        for (int step = 0; step < 20; step++) {
+            Set<Point> cells = randomCells(random, n, rangeI, 10);
+            Set<Point> expected = new HashSet<>();
+            for (Point cell : cells) {
+                for (int i = -1; i <= 1; i++) {
+                    for (int j = -1; j <= 1; j++) {
+                        expected.add(new Point(cell.x + i, cell.y + j));
+                    }
+                }
+            }
+            expected.removeAll(cells);
+
+            Set<Point> result = CellBitmap.of(cells).contour().asSet();
+
+            assertThat(result, equalTo(expected));
+            assertThat(result.size(), equalTo(expected.size()));
+        }
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "1234,10,5,1",
+            "4321,40,100,2.5",
+            "1111,100,200,3.3",
+            "2222,20,70,7",
+    })
+    void dilate(long seed, int n, int rangeI, double distance) {
+        Random random = new Random(seed);
+        int[] disk = ProhibitedArea.diskOffsets(distance);
+        for (int step = 0; step < 20; step++) {
+            Set<Point> cells = randomCells(random, n, rangeI, 10);
+            Set<Point> expected = new HashSet<>();
+            for (Point cell : cells) {
+                for (int k = 0; k < disk.length; k += 2) {
+                    expected.add(new Point(cell.x + disk[k], cell.y + disk[k + 1]));
+                }
+            }
+
+            CellBitmap result = CellBitmap.of(cells).dilate(disk);
+
+            assertThat(result.asSet(), equalTo(expected));
+            assertThat(result.getCardinality(), equalTo(expected.size()));
+        }
+    }
+
+    @Test
+    void empty() {
+        CellBitmap bitmap = CellBitmap.of(Set.of());
+
+        assertThat(bitmap, sameInstance(CellBitmap.empty()));
+        assertThat(bitmap.asSet(), empty());
+        assertThat(bitmap.test(0, 0), equalTo(false));
+        assertThat(bitmap.contour().asSet(), empty());
+        assertThat(bitmap.dilate(ProhibitedArea.diskOffsets(2)).asSet(), empty());
+    }
+
+    @Test
+    void of() {
+        Set<Point> cells = Set.of(
+                new Point(-70, -3),
+                new Point(0, 0),
+                new Point(63, 2),
+                new Point(64, 2)
+        );
+        CellBitmap bitmap = CellBitmap.of(cells);
+
+        assertThat(bitmap.getCardinality(), equalTo(4));
+        assertThat(bitmap.test(-70, -3), equalTo(true));
+        assertThat(bitmap.test(63, 2), equalTo(true));
+        assertThat(bitmap.test(64, 2), equalTo(true));
+        assertThat(bitmap.test(62, 2), equalTo(false));
+        assertThat(bitmap.test(-71, -3), equalTo(false));
+        assertThat(bitmap.test(1000, 0), equalTo(false));
+        assertThat(bitmap.asSet(), containsInAnyOrder(cells.toArray()));
+        assertThat(bitmap.asPredicate().test(new Point(0, 0)), equalTo(true));
+    }
+}
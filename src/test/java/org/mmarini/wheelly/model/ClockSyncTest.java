@@ -0,0 +1,140 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+
+import java.util.Random;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class ClockSyncTest {
+    static final long LOCAL_START = 1_600_000_000_000L;
+
+    /**
+     * Returns the clock sync event of a remote clock
+     *
+     * @param originate   the local originate time (ms)
+     * @param remoteStart the local time of remote clock start (ms)
+     * @param drift       the drift of remote clock
+     * @param upLatency   the latency from local to remote (ms)
+     * @param downLatency the latency from remote to local (ms)
+     */
+    static ClockSyncEvent event(long originate, long remoteStart, double drift, long upLatency, long downLatency) {
+        long receiveLocal = originate + upLatency;
+        long transmitLocal = receiveLocal + 1;
+        long receive = Math.round((receiveLocal - remoteStart) * (1 - drift));
+        long transmit = Math.round((transmitLocal - remoteStart) * (1 - drift));
+        return ClockSyncEvent.create(originate, receive, transmit, transmitLocal + downLatency);
+    }
+
+    @Test
+    void constantOffset() {
+        long remoteStart = LOCAL_START - 5000;
+        ClockSync clock = ClockSync.create();
+        for (int k = 0; k < 10; k++) {
+            clock.add(event(LOCAL_START + k * 1000, remoteStart, 0, 3, 3));
+        }
+
+        assertThat(clock.isSynchronized(), equalTo(true));
+        assertThat(clock.getRoundTripTime(), equalTo(6L));
+        assertThat(clock.getDrift(), closeTo(0, 1e-9));
+        assertThat(clock.getOffset(LOCAL_START), closeTo(remoteStart, 1));
+        assertThat(clock.toLocal(12345), equalTo(remoteStart + 12345));
+    }
+
+    @Test
+    void drift() {
+        long remoteStart = LOCAL_START - 1000;
+        double drift = 100e-6;
+        ClockSync clock = ClockSync.create();
+        for (int k = 0; k < 20; k++) {
+            clock.add(event(LOCAL_START + k * 10000, remoteStart, drift, 2, 2));
+        }
+        long local = LOCAL_START + 200000;
+        long remote = Math.round((local - remoteStart) * (1 - drift));
+
+        assertThat(clock.getDrift(), closeTo(drift, 20e-6));
+        assertThat((double) clock.toLocal(remote), closeTo(local, 2));
+    }
+
+    @Test
+    void driftShortInterval() {
+        ClockSync clock = ClockSync.create();
+        for (int k = 0; k < 10; k++) {
+            clock.add(event(LOCAL_START + k * 1000, LOCAL_START - 1000, 100e-6, 2, 2));
+        }
+
+        assertThat(clock.getDrift(), equalTo(0.0));
+    }
+
+    @Test
+    void empty() {
+        ClockSync clock = ClockSync.create();
+
+        assertThat(clock.isSynchronized(), equalTo(false));
+    }
+
+    @Test
+    void minRoundTrip() {
+        long remoteStart = LOCAL_START - 5000;
+        Random random = new Random(1234);
+        ClockSync clock = ClockSync.create();
+        for (int k = 0; k < 8; k++) {
+            // Asymmetric queueing delays
+            long up = k == 5 ? 2 : 2 + random.nextInt(50);
+            long down = k == 5 ? 2 : 2 + random.nextInt(10);
+            clock.add(event(LOCAL_START + k * 1000, remoteStart, 0, up, down));
+        }
+
+        assertThat(clock.getRoundTripTime(), equalTo(4L));
+        assertThat((double) clock.toLocal(30000), closeTo(remoteStart + 30000, 2));
+    }
+
+    @Test
+    void reset() {
+        ClockSync clock = ClockSync.create();
+        clock.add(event(LOCAL_START, LOCAL_START - 5000, 0, 3, 3));
+
+        clock.reset();
+
+        assertThat(clock.isSynchronized(), equalTo(false));
+        assertThat(clock.getRoundTripTime(), equalTo(0L));
+    }
+
+    @Test
+    void roundTripTime() {
+        ClockSyncEvent event = ClockSyncEvent.from("ck 1000 200 210", 1030);
+
+        assertThat(event.getRoundTripTime(), equalTo(20L));
+        assertThat(event.getLatency(), equalTo(10L));
+    }
+}
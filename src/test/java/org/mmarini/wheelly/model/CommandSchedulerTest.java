@@ -0,0 +1,137 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.processors.PublishProcessor;
+import io.reactivex.rxjava3.schedulers.TestScheduler;
+import io.reactivex.rxjava3.subscribers.TestSubscriber;
+import org.junit.jupiter.api.Test;
+import org.mmarini.Tuple2;
+
+import java.util.concurrent.TimeUnit;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.mmarini.wheelly.model.HaltCommand.HALT_COMMAND;
+
+class CommandSchedulerTest {
+    static final long KEEP_ALIVE = 700;
+
+    static TestSubscriber<String> schedule(PublishProcessor<Tuple2<MotionCommand, Integer>> commands, TestScheduler scheduler) {
+        return CommandScheduler.schedule(commands, KEEP_ALIVE, scheduler)
+                .map(WheellyCommand::getString)
+                .test();
+    }
+
+    @Test
+    void coalesce() {
+        TestScheduler scheduler = new TestScheduler();
+        PublishProcessor<Tuple2<MotionCommand, Integer>> commands = PublishProcessor.create();
+        TestSubscriber<String> sent = schedule(commands, scheduler);
+
+        commands.onNext(Tuple2.of(MoveCommand.create(30, 0.5), 45));
+
+        sent.assertValues("mv 30 0.50\nsc 45");
+    }
+
+    @Test
+    void halted() {
+        TestScheduler scheduler = new TestScheduler();
+        PublishProcessor<Tuple2<MotionCommand, Integer>> commands = PublishProcessor.create();
+        TestSubscriber<String> sent = schedule(commands, scheduler);
+
+        commands.onNext(Tuple2.of(HALT_COMMAND, 0));
+        commands.onNext(Tuple2.of(HALT_COMMAND, 0));
+        scheduler.advanceTimeBy(10 * KEEP_ALIVE, TimeUnit.MILLISECONDS);
+
+        // Only the first halt without scan and keep-alive
+        sent.assertValues("al");
+    }
+
+    @Test
+    void keepAlive() {
+        TestScheduler scheduler = new TestScheduler();
+        PublishProcessor<Tuple2<MotionCommand, Integer>> commands = PublishProcessor.create();
+        TestSubscriber<String> sent = schedule(commands, scheduler);
+
+        commands.onNext(Tuple2.of(HALT_COMMAND, 0));
+        commands.onNext(Tuple2.of(MoveCommand.create(0, 1), 0));
+        scheduler.advanceTimeBy(KEEP_ALIVE - 1, TimeUnit.MILLISECONDS);
+        assertThat(sent.values(), contains("al", "mv 0 1.00"));
+
+        scheduler.advanceTimeBy(1, TimeUnit.MILLISECONDS);
+        assertThat(sent.values(), contains("al", "mv 0 1.00", "mv 0 1.00"));
+
+        // Same command does not restart the keep-alive
+        commands.onNext(Tuple2.of(MoveCommand.create(0, 1), 0));
+        scheduler.advanceTimeBy(KEEP_ALIVE, TimeUnit.MILLISECONDS);
+        assertThat(sent.values(), hasSize(4));
+
+        // Changed scan is sent immediately and kept alive with the motion
+        commands.onNext(Tuple2.of(MoveCommand.create(0, 1), 30));
+        assertThat(sent.values().get(4), equalTo("sc 30"));
+        scheduler.advanceTimeBy(KEEP_ALIVE, TimeUnit.MILLISECONDS);
+        assertThat(sent.values().get(5), equalTo("mv 0 1.00\nsc 30"));
+
+        // Halt stops the keep-alive
+        commands.onNext(Tuple2.of(HALT_COMMAND, 0));
+        assertThat(sent.values().get(6), equalTo("al\nsc 0"));
+        scheduler.advanceTimeBy(10 * KEEP_ALIVE, TimeUnit.MILLISECONDS);
+        assertThat(sent.values(), hasSize(7));
+    }
+
+    @Test
+    void keepAliveMoveWhileScanning() {
+        TestScheduler scheduler = new TestScheduler();
+        PublishProcessor<Tuple2<MotionCommand, Integer>> commands = PublishProcessor.create();
+        TestSubscriber<Tuple2<Long, String>> sent = CommandScheduler.schedule(commands, KEEP_ALIVE, scheduler)
+                .map(cmd -> Tuple2.of(scheduler.now(TimeUnit.MILLISECONDS), cmd.getString()))
+                .test();
+
+        commands.onNext(Tuple2.of(MoveCommand.create(0, 1), 0));
+        // The scanner changes direction faster than the keep-alive interval
+        int steps = 20;
+        for (int step = 1; step <= steps; step++) {
+            scheduler.advanceTimeBy(KEEP_ALIVE / 2, TimeUnit.MILLISECONDS);
+            commands.onNext(Tuple2.of(MoveCommand.create(0, 1), step % 2 == 0 ? 30 : -30));
+        }
+
+        long[] moveTimes = sent.values().stream()
+                .filter(t -> t._2.contains("mv 0 1.00"))
+                .mapToLong(t -> t._1)
+                .toArray();
+        assertThat(moveTimes.length, greaterThanOrEqualTo(steps / 2 + 1));
+        assertThat(moveTimes[0], equalTo(0L));
+        for (int i = 1; i < moveTimes.length; i++) {
+            assertThat(moveTimes[i] - moveTimes[i - 1], lessThanOrEqualTo(KEEP_ALIVE));
+        }
+        assertThat(steps * KEEP_ALIVE / 2 - moveTimes[moveTimes.length - 1], lessThanOrEqualTo(KEEP_ALIVE));
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+import org.mmarini.Tuple2;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.nio.ByteBuffer;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class DumpFilesTest {
+    static final String MOVE_LINE = "1234567890123,0.5,-1.25,90,-30,0.8,0.25,-0.5,12,1,0,0,1,45,0.5,15,2,0.2,0.4,1234567890000,0.75,-1.0,0.6,1234567889000,0.5,0,30,0.75,-45";
+    static final String HALT_LINE = "1234567890200,1.5,2.25,-179,0,0.0,0.0,0.0,15,0,1,1,0,0,0.0,0,0,1,0,0,90";
+
+    @TempDir
+    File tempDir;
+
+    @Test
+    void bytes() {
+        for (String line : List.of(MOVE_LINE, HALT_LINE)) {
+            Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> record = FileFunctions.fromDumpLine(line);
+            byte[] bytes = DumpFiles.toBytes(record);
+            assertThat(bytes.length, equalTo(DumpFiles.recordSize(record)));
+
+            ByteBuffer bfr = ByteBuffer.wrap(bytes).order(DumpFiles.BYTE_ORDER);
+            Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> result = DumpFiles.read(bfr);
+            assertThat(bfr.hasRemaining(), equalTo(false));
+            assertThat(FileFunctions.toString(result), equalTo(FileFunctions.toString(record)));
+        }
+    }
+
+    @Test
+    void readBinaryFile() throws IOException {
+        File file = new File(tempDir, "dump" + DumpFiles.EXTENSION);
+        Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> move = FileFunctions.fromDumpLine(MOVE_LINE);
+        Tuple2<Timed<MapStatus>, Tuple2<MotionCommand, Integer>> halt = FileFunctions.fromDumpLine(HALT_LINE);
+        DumpFiles.append(file, List.of(move));
+        DumpFiles.append(file, List.of(halt, move));
+
+        assertThat(DumpFiles.isBinary(file), equalTo(true));
+        List<String> result = FileFunctions.readDumpFile(file)
+                .map(FileFunctions::toString)
+                .toList()
+                .blockingGet();
+        assertThat(result, contains(
+                FileFunctions.toString(move),
+                FileFunctions.toString(halt),
+                FileFunctions.toString(move)));
+    }
+
+    @Test
+    void readCsvFile() throws IOException {
+        File file = new File(tempDir, "dump.csv");
+        try (PrintWriter out = new PrintWriter(file)) {
+            out.println(MOVE_LINE);
+            out.println(HALT_LINE);
+        }
+        assertThat(DumpFiles.isBinary(file), equalTo(false));
+        List<String> result = FileFunctions.readDumpFile(file)
+                .map(FileFunctions::toString)
+                .toList()
+                .blockingGet();
+        assertThat(result, hasSize(2));
+        assertThat(result.get(0), startsWith("1234567890123,0.5,-1.25,90,-30"));
+    }
+
+    @Test
+    void truncatedFile() throws IOException {
+        File file = new File(tempDir, "dump" + DumpFiles.EXTENSION);
+        byte[] bytes = DumpFiles.toBytes(FileFunctions.fromDumpLine(MOVE_LINE));
+        try (FileOutputStream out = new FileOutputStream(file)) {
+            out.write(DumpFiles.header());
+            out.write(bytes, 0, bytes.length - 1);
+        }
+        FileFunctions.readDumpFile(file)
+                .test()
+                .awaitDone(10, TimeUnit.SECONDS)
+                .assertError(IOException.class);
+    }
+}
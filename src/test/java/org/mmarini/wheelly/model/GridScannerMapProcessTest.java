@@ -0,0 +1,171 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.Arguments;
+import org.junit.jupiter.params.provider.MethodSource;
+import org.junit.jupiter.params.provider.ValueSource;
+
+import java.awt.*;
+import java.awt.geom.Point2D;
+import java.util.List;
+import java.util.*;
+import java.util.concurrent.TimeUnit;
+import java.util.stream.Collectors;
+import java.util.stream.Stream;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.hamcrest.Matchers.notNullValue;
+import static org.mmarini.ArgumentsGenerator.*;
+import static org.mmarini.wheelly.model.GridScannerMap.*;
+
+/**
+ * Verifies the incremental update of the map against the update of all the obstacles
+ */
+class GridScannerMapProcessTest {
+    static final int NUM_OBSTACLES = 300;
+    static final double MAP_RANGE = 8;
+
+    static Stream<Arguments> processArgs() {
+        return createStream(1234,
+                uniform(-2d, 2d),   // robotX
+                uniform(-2d, 2d),   // robotY
+                uniform(-180, 179), // robotDeg
+                uniform(-90, 90),   // sensorDeg
+                uniform(0d, 3d),    // echoDistance
+                uniform(0, 15),     // contacts
+                uniform(0, 1000)    // seed
+        );
+    }
+
+    /**
+     * Returns the expected map
+     *
+     * @param map    the initial map
+     * @param sample the sample
+     */
+    static Map<Point2D, Obstacle> expected(GridScannerMap map, Timed<WheellyStatus> sample) {
+        long timestamp = sample.time(TimeUnit.MILLISECONDS);
+        long holdTimestamp = timestamp - HOLD_DURATION;
+        Stream<Obstacle> scannerObstacles = map.createObstacles(sample)
+                .filter(o -> o.timestamp >= holdTimestamp)
+                .filter(o -> o.getLikelihood() >= THRESHOLD_LIKELIHOOD);
+        Stream<Obstacle> contacts = sample.value().getContactObstacles().stream()
+                .map(map::cell)
+                .map(map::toPoint)
+                .map(pt -> Obstacle.create(pt, timestamp, 1));
+        return Stream.concat(scannerObstacles, contacts)
+                .collect(Collectors.toMap(Obstacle::getLocation, o -> o, (a, b) -> b));
+    }
+
+    @ParameterizedTest
+    @MethodSource("processArgs")
+    void process(double robotX, double robotY, int robotDeg, int sensorDeg, double echoDistance, int contacts, int seed) {
+        Random random = new Random(seed);
+        long timestamp = System.currentTimeMillis();
+        List<Obstacle> obstacles = new ArrayList<>();
+        for (int i = 0; i < NUM_OBSTACLES; i++) {
+            Point2D location = snapToGrid(new Point2D.Double(
+                            (random.nextDouble() * 2 - 1) * MAP_RANGE,
+                            (random.nextDouble() * 2 - 1) * MAP_RANGE),
+                    THRESHOLD_DISTANCE);
+            obstacles.add(Obstacle.create(location,
+                    timestamp - (long) (random.nextDouble() * HOLD_DURATION * 1.2),
+                    random.nextDouble()));
+        }
+        GridScannerMap map = GridScannerMap.create(obstacles, THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0);
+        WheellyStatus status = WheellyStatus.create(new Point2D.Double(robotX, robotY), robotDeg,
+                sensorDeg, echoDistance < 0.3 ? 0 : echoDistance,
+                0, 0,
+                contacts, 12,
+                true, true,
+                false, false, 0, 0, 0);
+        Timed<WheellyStatus> sample = new Timed<>(status, timestamp, TimeUnit.MILLISECONDS);
+
+        Map<Point2D, Obstacle> expected = expected(map, sample);
+        GridScannerMap next = map.process(sample);
+        Map<Point2D, Obstacle> result = next.getObstacles().stream()
+                .collect(Collectors.toMap(Obstacle::getLocation, o -> o));
+
+        assertThat(result.keySet(), equalTo(expected.keySet()));
+        for (Map.Entry<Point2D, Obstacle> entry : expected.entrySet()) {
+            Obstacle actual = result.get(entry.getKey());
+            assertThat(actual.likelihood, equalTo(entry.getValue().likelihood));
+            assertThat(actual.timestamp, equalTo(entry.getValue().timestamp));
+        }
+
+        Set<Point> expectedChanges = Stream.concat(map.getCells(), next.getCells())
+                .filter(cell -> map.getGrid().get(cell.x, cell.y) != next.getGrid().get(cell.x, cell.y))
+                .collect(Collectors.toSet());
+        assertThat(new HashSet<>(next.getChangedCells()), equalTo(expectedChanges));
+
+        CellPredicate prohibitedCells = next.getProhibitedCells();
+        for (Point cell : next.getProhibited()) {
+            assertThat(prohibitedCells.test(cell.x, cell.y), equalTo(true));
+        }
+        for (Point cell : next.getContours()) {
+            assertThat(prohibitedCells.test(cell.x, cell.y), equalTo(false));
+        }
+    }
+
+    @ParameterizedTest
+    @ValueSource(ints = {1, 2, 4, 8, 3, 12, 15})
+    void staleObstacleUnderContact(int contacts) {
+        long timestamp = System.currentTimeMillis();
+        WheellyStatus status = WheellyStatus.create(new Point2D.Double(), 0,
+                0, 0,
+                0, 0,
+                contacts, 12,
+                true, true,
+                false, false, 0, 0, 0);
+        Timed<WheellyStatus> sample = new Timed<>(status, timestamp, TimeUnit.MILLISECONDS);
+        GridScannerMap empty = GridScannerMap.create(List.of(), THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0);
+        // The stale obstacles in the contact cells
+        List<Obstacle> obstacles = status.getContactObstacles().stream()
+                .map(empty::cell)
+                .map(empty::toPoint)
+                .map(pt -> Obstacle.create(pt, timestamp - HOLD_DURATION - 1, 1))
+                .collect(Collectors.toList());
+        GridScannerMap map = GridScannerMap.create(obstacles, THRESHOLD_DISTANCE, THRESHOLD_DISTANCE, 0);
+
+        GridScannerMap next = map.process(sample);
+
+        for (Obstacle stale : obstacles) {
+            Point cell = next.cell(stale.getLocation());
+            Obstacle obstacle = next.getGrid().get(cell.x, cell.y);
+            assertThat(obstacle, notNullValue());
+            assertThat(obstacle.timestamp, equalTo(timestamp));
+            assertThat(obstacle.likelihood, equalTo(1d));
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.mmarini.wheelly.model.LatencyMonitor.Stage.*;
+
+class LatencyMonitorTest {
+
+    @Test
+    void report() {
+        LatencyMonitor monitor = LatencyMonitor.create();
+        for (int i = 1; i <= 100; i++) {
+            monitor.recordMicros(MAP, i * 10);
+        }
+        monitor.recordMillis(ENGINE, 5)
+                .recordNanos(SAMPLE, 2_000_000)
+                .recordMicros(WRITE, -1);
+
+        LatencyMonitor.Report report = monitor.report(1234);
+
+        assertThat(report.getTimestamp(), equalTo(1234L));
+        assertThat(report.getHistogram(MAP).getTotalCount(), equalTo(100L));
+        assertThat(report.getPercentile(MAP, 50), closeTo(0.5, 0.01));
+        assertThat(report.getPercentile(MAP, 99), closeTo(0.99, 0.01));
+        assertThat(report.getPercentile(ENGINE, 100), closeTo(5, 0.05));
+        assertThat(report.getPercentile(SAMPLE, 100), closeTo(2, 0.02));
+        assertThat(report.getHistogram(WRITE).getTotalCount(), equalTo(0L));
+        assertThat(report.getHistogram(QUEUE).getTotalCount(), equalTo(0L));
+    }
+
+    @Test
+    void intervals() {
+        LatencyMonitor monitor = LatencyMonitor.create();
+        monitor.recordMicros(MAP, 100);
+        LatencyMonitor.Report first = monitor.report(0);
+        monitor.recordMicros(MAP, 200).recordMicros(MAP, 300);
+        LatencyMonitor.Report second = monitor.report(1000);
+
+        assertThat(first.getHistogram(MAP).getTotalCount(), equalTo(1L));
+        assertThat(second.getHistogram(MAP).getTotalCount(), equalTo(2L));
+        assertThat(monitor.report(2000).getHistogram(MAP).getTotalCount(), equalTo(0L));
+    }
+
+    @Test
+    void toCSV() {
+        LatencyMonitor monitor = LatencyMonitor.create();
+        monitor.recordMicros(ENGINE, 1000);
+        String[] csv = monitor.report(1234).toCSV();
+
+        assertThat(csv, arrayWithSize(LatencyMonitor.Stage.values().length));
+        assertThat(csv[0], equalTo("1234,map,0,0,0,0,0,0"));
+        assertThat(csv[2], startsWith("1234,engine,1,"));
+        assertThat(csv[2].split(","), arrayWithSize(8));
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.Arguments;
+import org.junit.jupiter.params.provider.MethodSource;
+
+import java.awt.geom.Point2D;
+import java.util.Random;
+import java.util.stream.Stream;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.mmarini.ArgumentsGenerator.*;
+import static org.mmarini.wheelly.model.GridScannerMap.*;
+
+/**
+ * Verifies the batch properties against the per obstacle properties
+ */
+class ObstacleBatchTest {
+    static final int NUM_OBSTACLES = 300;
+    static final double MAP_RANGE = 4;
+
+    static Stream<Arguments> batchArgs() {
+        return createStream(1234,
+                uniform(-2d, 2d),   // robotX
+                uniform(-2d, 2d),   // robotY
+                uniform(-180, 179), // robotDeg
+                uniform(-90, 90),   // sensorDeg
+                uniform(0, 1000)    // seed
+        );
+    }
+
+    @ParameterizedTest
+    @MethodSource("batchArgs")
+    void properties(double robotX, double robotY, int robotDeg, int sensorDeg, int seed) {
+        Random random = new Random(seed);
+        long timestamp = System.currentTimeMillis();
+        WheellyStatus status = WheellyStatus.create(new Point2D.Double(robotX, robotY), robotDeg,
+                sensorDeg, 0,
+                0, 0,
+                0, 12,
+                true, true,
+                false, false, 0, 0, 0);
+        ObstacleBatch batch = new ObstacleBatch();
+        Obstacle[] obstacles = new Obstacle[NUM_OBSTACLES];
+        for (int i = 0; i < NUM_OBSTACLES; i++) {
+            obstacles[i] = Obstacle.create(snapToGrid(new Point2D.Double(
+                                    (random.nextDouble() * 2 - 1) * MAP_RANGE,
+                                    (random.nextDouble() * 2 - 1) * MAP_RANGE),
+                            THRESHOLD_DISTANCE),
+                    timestamp - (long) (random.nextDouble() * HOLD_DURATION),
+                    random.nextDouble());
+            batch.add(obstacles[i]);
+        }
+        batch.computeProperties(robotX, robotY, status.getSensorRad());
+
+        assertThat(batch.size(), equalTo(NUM_OBSTACLES));
+        for (int i = 0; i < NUM_OBSTACLES; i++) {
+            ObstacleSampleProperties expected = ObstacleSampleProperties.from(obstacles[i], status);
+            assertThat(batch.getObstacle(i), equalTo(obstacles[i]));
+            assertThat(batch.getDistance(i), equalTo(expected.robotObstacleDistance));
+            assertThat(batch.getSensorRad(i), equalTo(expected.obstacleSensorRad));
+        }
+    }
+
+    @ParameterizedTest
+    @MethodSource("batchArgs")
+    void retainEligibles(double robotX, double robotY, int robotDeg, int sensorDeg, int seed) {
+        Random random = new Random(seed);
+        long timestamp = System.currentTimeMillis();
+        WheellyStatus status = WheellyStatus.create(new Point2D.Double(robotX, robotY), robotDeg,
+                sensorDeg, 0,
+                0, 0,
+                0, 12,
+                true, true,
+                false, false, 0, 0, 0);
+        ObstacleBatch batch = new ObstacleBatch();
+        int expectedSize = 0;
+        for (int i = 0; i < NUM_OBSTACLES; i++) {
+            Obstacle obstacle = Obstacle.create(
+                    (random.nextDouble() * 2 - 1) * MAP_RANGE,
+                    (random.nextDouble() * 2 - 1) * MAP_RANGE,
+                    timestamp, 1);
+            ObstacleSampleProperties properties = ObstacleSampleProperties.from(obstacle, status);
+            if (Math.abs(properties.obstacleSensorRad) <= NO_SENSITIVITY_ANGLE
+                    && properties.robotObstacleDistance < MAX_DISTANCE) {
+                expectedSize++;
+            }
+            batch.add(obstacle);
+        }
+        batch.computeProperties(robotX, robotY, status.getSensorRad())
+                .retainEligibles(MAX_DISTANCE);
+
+        assertThat(batch.size(), equalTo(expectedSize));
+        for (int i = 0; i < batch.size(); i++) {
+            ObstacleSampleProperties properties = ObstacleSampleProperties.from(batch.getObstacle(i), status);
+            assertThat(batch.getDistance(i), equalTo(properties.robotObstacleDistance));
+            assertThat(batch.getSensorRad(i), equalTo(properties.obstacleSensorRad));
+        }
+    }
+}
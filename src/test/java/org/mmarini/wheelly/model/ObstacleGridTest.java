@@ -0,0 +1,359 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+
+import java.awt.*;
+import java.util.List;
+import java.util.*;
+import java.util.stream.Collectors;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class ObstacleGridTest {
+
+    @Test
+    void empty() {
+        ObstacleGrid grid = ObstacleGrid.empty();
+        assertThat(grid.size(), equalTo(0));
+        assertThat(grid.isEmpty(), equalTo(true));
+        assertThat(grid.get(0, 0), nullValue());
+        assertThat(grid.stream().count(), equalTo(0L));
+    }
+
+    @Test
+    void forEachRect() {
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        for (int i = -20; i <= 20; i++) {
+            for (int j = -20; j <= 20; j++) {
+                builder.put(i, j, Obstacle.create(i, j, 0, 1));
+            }
+        }
+        ObstacleGrid grid = builder.build();
+        List<Obstacle> result = new ArrayList<>();
+        grid.forEach(-17, -1, 15, 3, result::add);
+
+        assertThat(result, hasSize(33 * 5));
+        assertThat(result, everyItem(hasProperty("location", allOf(
+                hasProperty("x", allOf(greaterThanOrEqualTo(-17d), lessThanOrEqualTo(15d))),
+                hasProperty("y", allOf(greaterThanOrEqualTo(-1d), lessThanOrEqualTo(3d)))
+        ))));
+    }
+
+    @Test
+    void grow() {
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        for (int i = -500; i < 500; i += 7) {
+            for (int j = -500; j < 500; j += 11) {
+                builder.put(i, j, Obstacle.create(i, j, 0, 1));
+            }
+        }
+        ObstacleGrid grid = builder.build();
+        assertThat(grid.size(), equalTo(143 * 91));
+        assertThat(grid.stream().count(), equalTo(143L * 91));
+        for (int i = -500; i < 500; i += 7) {
+            for (int j = -500; j < 500; j += 11) {
+                assertThat(grid.get(i, j), hasProperty("location", allOf(
+                        hasProperty("x", equalTo((double) i)),
+                        hasProperty("y", equalTo((double) j)))));
+            }
+        }
+        assertThat(grid.get(-499, -500), nullValue());
+    }
+
+    @Test
+    void putGet() {
+        Obstacle o1 = Obstacle.create(0, 0, 0, 1);
+        Obstacle o2 = Obstacle.create(-1, -1, 0, 1);
+        Obstacle o3 = Obstacle.create(16, -17, 0, 1);
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(-1, -1, o2)
+                .put(16, -17, o3)
+                .build();
+
+        assertThat(grid.size(), equalTo(3));
+        assertThat(grid.get(0, 0), sameInstance(o1));
+        assertThat(grid.get(-1, -1), sameInstance(o2));
+        assertThat(grid.get(16, -17), sameInstance(o3));
+        assertThat(grid.get(15, -17), nullValue());
+        assertThat(grid.get(-16, 17), nullValue());
+        assertThat(grid.stream().collect(Collectors.toList()), containsInAnyOrder(o1, o2, o3));
+    }
+
+    @Test
+    void putIfAbsent() {
+        Obstacle o1 = Obstacle.create(0, 0, 0, 1);
+        Obstacle o2 = Obstacle.create(0, 0, 1, 1);
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .putIfAbsent(0, 0, o1)
+                .putIfAbsent(0, 0, o2)
+                .build();
+
+        assertThat(grid.size(), equalTo(1));
+        assertThat(grid.get(0, 0), sameInstance(o1));
+    }
+
+    @Test
+    void removeExpired() {
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(1, 0, 10, 1);
+        Obstacle o3 = Obstacle.create(40, 0, 100, 0.1);
+        ObstacleGrid grid0 = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(1, 0, o2)
+                .put(40, 0, o3)
+                .build();
+
+        ObstacleGrid grid = grid0.builder()
+                .removeExpired(50, 0.5)
+                .build();
+
+        assertThat(grid.size(), equalTo(1));
+        assertThat(grid.get(0, 0), sameInstance(o1));
+        assertThat(grid.get(1, 0), nullValue());
+        assertThat(grid.get(40, 0), nullValue());
+        assertThat(grid0.size(), equalTo(3));
+    }
+
+    @Test
+    void removeExpiredVersions() {
+        Random random = new Random(1234);
+        Map<Point, Obstacle> expected = new HashMap<>();
+        ObstacleGrid grid = ObstacleGrid.empty();
+        for (long t = 0; t < 500; t++) {
+            ObstacleGrid.Builder builder = grid.builder();
+            for (int k = 0; k < 20; k++) {
+                int i = random.nextInt(200) - 100;
+                int j = random.nextInt(200) - 100;
+                Point cell = new Point(i, j);
+                if (random.nextInt(4) == 0) {
+                    builder.remove(i, j);
+                    expected.remove(cell);
+                } else {
+                    Obstacle obstacle = Obstacle.create(i, j, t, random.nextDouble());
+                    builder.put(i, j, obstacle);
+                    expected.put(cell, obstacle);
+                }
+            }
+            long minTimestamp = t - 50;
+            builder.removeExpired(minTimestamp, 0.1);
+            expected.values().removeIf(o -> o.timestamp < minTimestamp || o.likelihood < 0.1);
+            grid = builder.build();
+
+            assertThat(grid.size(), equalTo(expected.size()));
+            for (Map.Entry<Point, Obstacle> entry : expected.entrySet()) {
+                assertThat(grid.get(entry.getKey().x, entry.getKey().y), sameInstance(entry.getValue()));
+            }
+        }
+    }
+
+    @Test
+    void removeExpiredSharesTiles() {
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(40, 0, 10, 1);
+        ObstacleGrid grid0 = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(40, 0, o2)
+                .build();
+
+        ObstacleGrid grid = grid0.builder()
+                .removeExpired(50, 0.5)
+                .build();
+
+        int key = ObstacleGrid.tileKey(0, 0);
+        assertThat(grid.cells(key), sameInstance(grid0.cells(key)));
+        assertThat(grid.get(40, 0), nullValue());
+        // Nothing more to expire
+        assertThat(grid.builder().removeExpired(50, 0.5).build(), sameInstance(grid));
+    }
+
+    @Test
+    void versions() {
+        Obstacle o1 = Obstacle.create(0, 0, 0, 1);
+        Obstacle o2 = Obstacle.create(1, 1, 0, 1);
+        Obstacle o3 = Obstacle.create(1, 1, 1, 1);
+        ObstacleGrid grid0 = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(1, 1, o2)
+                .build();
+
+        ObstacleGrid grid1 = grid0.builder()
+                .remove(0, 0)
+                .put(1, 1, o3)
+                .put(100, 100, o1)
+                .build();
+
+        assertThat(grid0.size(), equalTo(2));
+        assertThat(grid0.get(0, 0), sameInstance(o1));
+        assertThat(grid0.get(1, 1), sameInstance(o2));
+        assertThat(grid0.get(100, 100), nullValue());
+
+        assertThat(grid1.size(), equalTo(2));
+        assertThat(grid1.get(0, 0), nullValue());
+        assertThat(grid1.get(1, 1), sameInstance(o3));
+        assertThat(grid1.get(100, 100), sameInstance(o1));
+    }
+
+    @Test
+    void forEachWithin() {
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        for (int i = -40; i <= 40; i++) {
+            for (int j = -40; j <= 40; j++) {
+                builder.put(i, j, Obstacle.create(i, j, 0, 1));
+            }
+        }
+        ObstacleGrid grid = builder.build();
+        List<Obstacle> result = new ArrayList<>();
+        grid.forEachWithin(3, -5, 20, result::add);
+
+        long expected = grid.stream()
+                .filter(o -> o.getLocation().distanceSq(3, -5) <= 400)
+                .count();
+        assertThat((long) result.size(), equalTo(expected));
+        assertThat(result, everyItem(hasProperty("location",
+                hasProperty("x", allOf(greaterThanOrEqualTo(-17d), lessThanOrEqualTo(23d))))));
+    }
+
+    @Test
+    void evictOldest() {
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(32, 0, 200, 1);
+        Obstacle o3 = Obstacle.create(64, 0, 300, 1);
+        ObstacleGrid grid = builder.put(0, 0, o1)
+                .put(32, 0, o2)
+                .put(64, 0, o3)
+                .evict(2, Integer.MAX_VALUE, 0, 0)
+                .build();
+
+        assertThat(grid.size(), equalTo(2));
+        assertThat(grid.get(0, 0), nullValue());
+        assertThat(grid.get(32, 0), sameInstance(o2));
+        assertThat(grid.get(64, 0), sameInstance(o3));
+    }
+
+    @Test
+    void evictFarthest() {
+        ObstacleGrid.Builder builder = ObstacleGrid.empty().builder();
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(1, 0, 100, 1);
+        Obstacle o3 = Obstacle.create(64, 0, 100, 1);
+        ObstacleGrid grid = builder.put(0, 0, o1)
+                .put(1, 0, o2)
+                .put(64, 0, o3)
+                .evict(Integer.MAX_VALUE, 2, 0, 0)
+                .build();
+
+        assertThat(grid.size(), equalTo(2));
+        assertThat(grid.get(0, 0), sameInstance(o1));
+        assertThat(grid.get(1, 0), sameInstance(o2));
+        assertThat(grid.get(64, 0), nullValue());
+    }
+
+    @Test
+    void evictKeepsSource() {
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(64, 0, 200, 1);
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(64, 0, o2)
+                .build();
+        ObstacleGrid grid1 = grid.builder()
+                .evict(1, 2, 0, 0)
+                .build();
+
+        assertThat(grid1.size(), equalTo(1));
+        assertThat(grid1.get(0, 0), nullValue());
+        assertThat(grid1.get(64, 0), sameInstance(o2));
+        assertThat(grid.size(), equalTo(2));
+        assertThat(grid.get(0, 0), sameInstance(o1));
+        assertThat(grid.get(64, 0), sameInstance(o2));
+    }
+
+    @Test
+    void evictWithinLimits() {
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, Obstacle.create(0, 0, 100, 1))
+                .put(64, 0, Obstacle.create(64, 0, 200, 1))
+                .build();
+        ObstacleGrid grid1 = grid.builder()
+                .evict(2, 2, 0, 0)
+                .build();
+
+        assertThat(grid1.size(), equalTo(2));
+        assertThat(grid.size(), equalTo(2));
+    }
+
+    @Test
+    void unchangedBuilder() {
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, Obstacle.create(0, 0, 100, 1))
+                .build();
+        ObstacleGrid grid1 = grid.builder()
+                .remove(5, 5)
+                .removeExpired(0, 0)
+                .build();
+
+        assertThat(grid1, sameInstance(grid));
+    }
+
+    @Test
+    void changedCells() {
+        Obstacle o1 = Obstacle.create(0, 0, 100, 1);
+        Obstacle o2 = Obstacle.create(-1, -1, 100, 1);
+        Obstacle o3 = Obstacle.create(40, 40, 100, 1);
+        Obstacle o4 = Obstacle.create(0, 0, 200, 1);
+        Obstacle o5 = Obstacle.create(-40, 3, 200, 1);
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, o1)
+                .put(1, 1, o1)
+                .put(-1, -1, o2)
+                .put(40, 40, o3)
+                .build();
+        ObstacleGrid grid1 = grid.builder()
+                .put(0, 0, o4)
+                .remove(40, 40)
+                .put(-40, 3, o5)
+                .build();
+
+        assertThat(grid1.changedCells(grid), containsInAnyOrder(
+                new java.awt.Point(0, 0),
+                new java.awt.Point(40, 40),
+                new java.awt.Point(-40, 3)));
+        assertThat(grid.changedCells(grid1), containsInAnyOrder(
+                new java.awt.Point(0, 0),
+                new java.awt.Point(40, 40),
+                new java.awt.Point(-40, 3)));
+        assertThat(grid1.changedCells(grid1), empty());
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+
+import java.awt.*;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Random;
+import java.util.Set;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class ProhibitedAreaTest {
+    static final double GRID_SIZE = 0.2;
+    static final double LIKELIHOOD_THRESHOLD = 0.5;
+    static final int NUM_STEPS = 30;
+    static final int CHANGES_PER_STEP = 40;
+    static final int RANGE = 40;
+
+    /**
+     * Returns the prohibited cells computed by brute force
+     *
+     * @param grid         the obstacle grid
+     * @param safeDistance the safe distance
+     */
+    static Set<Point> bruteForce(ObstacleGrid grid, double safeDistance) {
+        double safeCellDistance = safeDistance / GRID_SIZE;
+        int k = (int) Math.ceil(safeCellDistance);
+        Set<Point> result = new HashSet<>();
+        grid.stream()
+                .filter(o -> o.likelihood >= LIKELIHOOD_THRESHOLD)
+                .forEach(o -> {
+                    Point cell = GridScannerMap.cell(o.location, GRID_SIZE);
+                    for (int i = -k; i <= k; i++) {
+                        for (int j = -k; j <= k; j++) {
+                            if (i * i + j * j <= safeCellDistance * safeCellDistance) {
+                                result.add(new Point(cell.x + i, cell.y + j));
+                            }
+                        }
+                    }
+                    result.add(cell);
+                });
+        return result;
+    }
+
+    @Test
+    void empty() {
+        ProhibitedArea area = ProhibitedArea.create(GRID_SIZE, 0.3, LIKELIHOOD_THRESHOLD);
+        assertThat(area.getProhibited(), empty());
+        assertThat(area.getContours(), empty());
+        assertThat(area.isProhibited(0, 0), equalTo(false));
+    }
+
+    @Test
+    void singleObstacle() {
+        ObstacleGrid grid = ObstacleGrid.empty().builder()
+                .put(0, 0, Obstacle.create(0, 0, 0, 1))
+                .build();
+        ProhibitedArea area = ProhibitedArea.create(GRID_SIZE, GRID_SIZE, LIKELIHOOD_THRESHOLD).update(grid);
+
+        assertThat(area.getProhibited(), containsInAnyOrder(
+                new Point(0, 0),
+                new Point(1, 0), new Point(-1, 0),
+                new Point(0, 1), new Point(0, -1)));
+        assertThat(area.getContours(), hasSize(16));
+        assertThat(area.getContours(), equalTo(ProhibitedCellFinder.findContour(area.getProhibited())));
+
+        ProhibitedArea cleared = area.update(ObstacleGrid.empty());
+        assertThat(cleared.getProhibited(), empty());
+        assertThat(cleared.getContours(), empty());
+        assertThat(area.getProhibited(), hasSize(5));
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "0,1234",
+            "0.2,1234",
+            "0.3,4321",
+            "0.5,1111",
+            "1,2222",
+    })
+    void incremental(double safeDistance, long seed) {
+        Random random = new Random(seed);
+        ObstacleGrid grid = ObstacleGrid.empty();
+        ProhibitedArea area = ProhibitedArea.create(GRID_SIZE, safeDistance, LIKELIHOOD_THRESHOLD);
+        for (int step = 0; step < NUM_STEPS; step++) {
+            ObstacleGrid.Builder builder = grid.builder();
+            for (int n = 0; n < CHANGES_PER_STEP; n++) {
+                int i = random.nextInt(RANGE * 2) - RANGE;
+                int j = random.nextInt(RANGE * 2) - RANGE;
+                if (random.nextDouble() < 0.3) {
+                    builder.remove(i, j);
+                } else {
+                    builder.put(i, j, Obstacle.create(i * GRID_SIZE, j * GRID_SIZE, step, random.nextDouble()));
+                }
+            }
+            ObstacleGrid previous = grid;
+            ProhibitedArea previousArea = area;
+            Set<Point> previousProhibited = new HashSet<>(previousArea.getProhibited());
+            grid = builder.build();
+            area = area.update(grid);
+
+            Set<Point> expected = bruteForce(grid, safeDistance);
+            assertThat(area.getProhibited(), equalTo(expected));
+            assertThat(area.getProhibited().size(), equalTo(expected.size()));
+            assertThat(area.getContours(), equalTo(ProhibitedCellFinder.findContour(expected)));
+            // The previous version is not changed
+            assertThat(previousArea.getProhibited(), equalTo(previousProhibited));
+            assertThat(previousArea.getProhibited(), equalTo(bruteForce(previous, safeDistance)));
+        }
+        // Back to a grid of a different lineage
+        List<Obstacle> obstacles = grid.stream().collect(java.util.stream.Collectors.toList());
+        GridScannerMap map = GridScannerMap.create(obstacles, GRID_SIZE, safeDistance, LIKELIHOOD_THRESHOLD);
+        assertThat(area.update(map.getGrid()).getProhibited(), equalTo(map.getProhibited()));
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.contains;
+import static org.hamcrest.Matchers.equalTo;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+
+class RecordDispatcherTest {
+
+    static StatusParser record(String line) {
+        byte[] data = line.getBytes(StandardCharsets.UTF_8);
+        return StatusParser.create().reset(data, 0, data.length);
+    }
+
+    @Test
+    void dispatch() {
+        List<String> handled = new ArrayList<>();
+        RecordDispatcher dispatcher = RecordDispatcher.create()
+                .register("st ", (record, timestamp) -> handled.add("st " + timestamp))
+                .register("sc ", (record, timestamp) -> handled.add("sc " + timestamp))
+                .register("s", (record, timestamp) -> handled.add("s " + timestamp))
+                .register("cs ", (record, timestamp) -> handled.add("cs " + record.parseCps()));
+
+        assertThat(dispatcher.dispatch(record("st 1 2"), 1), equalTo(true));
+        assertThat(dispatcher.dispatch(record("sc 90"), 2), equalTo(true));
+        assertThat(dispatcher.dispatch(record("sx"), 3), equalTo(true));
+        assertThat(dispatcher.dispatch(record("cs 123 45"), 4), equalTo(true));
+        assertThat(dispatcher.dispatch(record("ck 1 2 3"), 5), equalTo(false));
+        assertThat(dispatcher.dispatch(record("c"), 6), equalTo(false));
+        assertThat(dispatcher.dispatch(record(""), 7), equalTo(false));
+
+        assertThat(handled, contains("st 1", "sc 2", "s 3", "cs 45"));
+    }
+
+    @Test
+    void duplicatedPrefix() {
+        RecordDispatcher dispatcher = RecordDispatcher.create()
+                .register("st ", (record, timestamp) -> {
+                });
+        assertThrows(IllegalArgumentException.class, () -> dispatcher.register("st ", (record, timestamp) -> {
+        }));
+        assertThrows(IllegalArgumentException.class, () -> dispatcher.register("", (record, timestamp) -> {
+        }));
+    }
+
+    @Test
+    void sameHandler() {
+        List<Long> handled = new ArrayList<>();
+        RecordDispatcher.Handler handler = (record, timestamp) -> handled.add(timestamp);
+        RecordDispatcher dispatcher = RecordDispatcher.create()
+                .register("st ", handler)
+                .register("st ", handler);
+
+        assertThat(dispatcher.dispatch(record("st 1 2"), 1), equalTo(true));
+        assertThat(handled, contains(1L));
+    }
+
+    @Test
+    void wrongRecord() {
+        RecordDispatcher dispatcher = RecordDispatcher.create()
+                .register("cs ", (record, timestamp) -> record.parseCps());
+        assertThrows(IllegalArgumentException.class, () -> dispatcher.dispatch(record("cs 1"), 0));
+    }
+}
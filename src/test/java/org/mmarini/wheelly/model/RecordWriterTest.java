@@ -0,0 +1,146 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.nio.channels.Channels;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.stream.Collectors;
+import java.util.stream.IntStream;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class RecordWriterTest {
+
+    @TempDir
+    File tempDir;
+
+    @Test
+    void compressed() throws IOException {
+        File file = new File(tempDir, "log.txt" + RecordWriter.COMPRESSED_EXTENSION);
+        List<String> lines = IntStream.range(0, 1000)
+                .mapToObj(i -> "line " + i)
+                .collect(Collectors.toList());
+        try (RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.BLOCK)) {
+            lines.forEach(writer::writeLine);
+        }
+
+        List<String> result = FileFunctions.readFile(file).toList().blockingGet();
+        assertThat(result, equalTo(lines));
+    }
+
+    @Test
+    void closeWhileWriting() throws InterruptedException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        RecordWriter writer = new RecordWriter(Channels.newChannel(out), 4, 16, 1000,
+                RecordWriter.OverflowPolicy.BLOCK, "test");
+        writer.start();
+        int numThreads = 4;
+        int numRecords = 1000;
+        AtomicLong queued = new AtomicLong();
+        List<Thread> producers = IntStream.range(0, numThreads)
+                .mapToObj(i -> new Thread(() -> {
+                    for (int j = 0; j < numRecords; j++) {
+                        if (writer.writeLine("a")) {
+                            queued.incrementAndGet();
+                        }
+                    }
+                }))
+                .collect(Collectors.toList());
+        producers.forEach(Thread::start);
+        Thread.sleep(5);
+        writer.close();
+        for (Thread producer : producers) {
+            producer.join();
+        }
+
+        // Every queued record is written and every other record is dropped
+        assertThat(writer.getWritten(), equalTo(queued.get()));
+        assertThat(writer.getWritten() + writer.getDropped(), equalTo((long) numThreads * numRecords));
+        assertThat((long) out.size(), equalTo(2 * queued.get()));
+    }
+
+    @Test
+    void drop() {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        RecordWriter writer = new RecordWriter(Channels.newChannel(out), 2, 16, 1000,
+                RecordWriter.OverflowPolicy.DROP, "test");
+
+        assertThat(writer.writeLine("a"), equalTo(true));
+        assertThat(writer.writeLine("b"), equalTo(true));
+        assertThat(writer.writeLine("c"), equalTo(false));
+        assertThat(writer.getQueued(), equalTo(2));
+        assertThat(writer.getDropped(), equalTo(1L));
+
+        writer.start();
+        writer.close();
+
+        assertThat(writer.getWritten(), equalTo(2L));
+        assertThat(writer.getBytes(), equalTo(4L));
+        assertThat(writer.writeLine("d"), equalTo(false));
+        assertThat(writer.getDropped(), equalTo(2L));
+        assertThat(out.toString(StandardCharsets.UTF_8), equalTo("a\nb\n"));
+    }
+
+    @Test
+    void largeRecords() {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        RecordWriter writer = new RecordWriter(Channels.newChannel(out), 16, 8, 1000,
+                RecordWriter.OverflowPolicy.BLOCK, "test");
+        writer.start();
+        writer.writeLine("abc");
+        writer.writeLine("0123456789");
+        writer.writeLine("def");
+        writer.close();
+
+        assertThat(writer.getDropped(), equalTo(0L));
+        assertThat(out.toString(StandardCharsets.UTF_8), equalTo("abc\n0123456789\ndef\n"));
+    }
+
+    @Test
+    void plain() throws IOException {
+        File file = new File(tempDir, "dump.csv");
+        try (RecordWriter writer = RecordWriter.create(file, RecordWriter.OverflowPolicy.BLOCK)) {
+            writer.writeLine("a,b");
+            writer.writeLine("c,d");
+        }
+
+        assertThat(Files.readAllLines(file.toPath()), contains("a,b", "c,d"));
+    }
+}
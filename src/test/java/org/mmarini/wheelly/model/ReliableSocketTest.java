@@ -31,12 +31,16 @@ package org.mmarini.wheelly.model;
 
 import io.reactivex.rxjava3.core.Flowable;
 import io.reactivex.rxjava3.schedulers.Schedulers;
+import org.junit.jupiter.api.Test;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.util.concurrent.TimeUnit;
 
 import static io.reactivex.rxjava3.core.Flowable.interval;
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.containsString;
+import static org.junit.jupiter.api.Assertions.assertThrows;
 
 class ReliableSocketTest {
     /*
@@ -71,6 +75,17 @@ class ReliableSocketTest {
     public static final int PORT = 22;
     private static final Logger logger = LoggerFactory.getLogger(ReliableSocketTest.class);
 
+    @Test
+    void binaryTelemetryWithClockSync() {
+        IllegalArgumentException ex = assertThrows(IllegalArgumentException.class,
+                () -> ReliableSocket.create(HOST, PORT, 3000, 1000, 100, true, 1000));
+        assertThat(ex.getMessage(), containsString("binary telemetry"));
+
+        // Each option alone is allowed
+        ReliableSocket.create(HOST, PORT, 3000, 1000, 100, true, 0).close();
+        ReliableSocket.create(HOST, PORT, 3000, 1000, 100, false, 1000).close();
+    }
+
     public static void main(String[] args) throws InterruptedException {
         ReliableSocket s = ReliableSocket.create(HOST, PORT, 3000, 1000, 100);
         Flowable<String> dataFlow = interval(500, TimeUnit.MILLISECONDS).map(x -> "sc 90");
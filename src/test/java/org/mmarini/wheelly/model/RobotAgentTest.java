@@ -0,0 +1,76 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import io.reactivex.rxjava3.subscribers.TestSubscriber;
+import org.junit.jupiter.api.Test;
+import org.mmarini.Tuple2;
+
+import java.awt.geom.Point2D;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.mmarini.wheelly.model.HaltCommand.HALT_COMMAND;
+import static org.mmarini.wheelly.model.LatencyMonitor.Stage.QUEUE;
+
+class RobotAgentTest {
+
+    @Test
+    void queueLatencyWithSimulatedTime() throws InterruptedException {
+        // The simulated status time runs 100 times faster than the wall clock
+        SimulatedController controller = SimulatedController.create(List.of(), new Point2D.Double(), 0, 100, 100);
+        InferenceEngine engine = new InferenceEngine() {
+            @Override
+            public InferenceEngine init(InferenceMonitor monitor) {
+                return this;
+            }
+
+            @Override
+            public Tuple2<MotionCommand, Integer> process(Timed<MapStatus> data, InferenceMonitor monitor) {
+                return Tuple2.of(HALT_COMMAND, 0);
+            }
+        };
+        RobotAgent agent = RobotAgent.create(controller, engine, 500, 500, 10);
+        TestSubscriber<LatencyMonitor.Report> reports = agent.readLatencies().take(2).test();
+        agent.start();
+
+        reports.await(5, TimeUnit.SECONDS);
+        agent.close();
+
+        reports.assertValueCount(2);
+        LatencyMonitor.Report report = reports.values().get(1);
+        assertThat(report.getHistogram(QUEUE).getTotalCount(), greaterThan(0L));
+        // The queue latency is bounded by the throttling and not by the simulated clock offset
+        assertThat(report.getPercentile(QUEUE, 100), lessThan(1000d));
+    }
+}
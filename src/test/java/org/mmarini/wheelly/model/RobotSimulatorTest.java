@@ -0,0 +1,122 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.schedulers.Timed;
+import org.junit.jupiter.api.Test;
+
+import java.awt.geom.Line2D;
+import java.awt.geom.Point2D;
+import java.util.List;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.mmarini.wheelly.model.RobotSimulator.MAX_LINEAR_SPEED;
+
+class RobotSimulatorTest {
+
+    static final List<Line2D> WALL = RobotSimulator.polygons(List.of(
+            List.of(new Point2D.Double(1, -1), new Point2D.Double(1, 1))
+    ));
+
+    static Timed<WheellyStatus> run(RobotSimulator simulator, int steps) {
+        Timed<WheellyStatus> result = null;
+        for (int i = 0; i < steps; i++) {
+            result = simulator.step(100);
+        }
+        return result;
+    }
+
+    @Test
+    void forward() {
+        RobotSimulator simulator = RobotSimulator.create(List.of(), new Point2D.Double(), 0, 1000)
+                .move(MoveCommand.create(0, 1));
+        Timed<WheellyStatus> status = run(simulator, 10);
+
+        assertThat(status.time(), equalTo(2000L));
+        assertThat(status.value().getRobotLocation().getX(), closeTo(MAX_LINEAR_SPEED, 1e-3));
+        assertThat(status.value().getRobotLocation().getY(), closeTo(0, 1e-3));
+        assertThat(status.value().getRobotDeg(), equalTo(0));
+        assertThat(status.value().isHalt(), equalTo(false));
+        assertThat(status.value().getSampleDistance(), equalTo(0.0));
+    }
+
+    @Test
+    void halt() {
+        RobotSimulator simulator = RobotSimulator.create(List.of(), new Point2D.Double(), 0, 0)
+                .move(HaltCommand.HALT_COMMAND);
+        Timed<WheellyStatus> status = run(simulator, 10);
+
+        assertThat(status.value().getRobotLocation(), equalTo(new Point2D.Double()));
+        assertThat(status.value().isHalt(), equalTo(true));
+    }
+
+    @Test
+    void rotate() {
+        RobotSimulator simulator = RobotSimulator.create(List.of(), new Point2D.Double(), 0, 0)
+                .move(MoveCommand.create(90, 0));
+        Timed<WheellyStatus> status = run(simulator, 30);
+
+        assertThat(status.value().getRobotDeg(), equalTo(90));
+        assertThat(status.value().getRobotLocation().distance(0, 0), closeTo(0, 1e-3));
+    }
+
+    @Test
+    void sonar() {
+        RobotSimulator simulator = RobotSimulator.create(WALL, new Point2D.Double(), 0, 0);
+        Timed<WheellyStatus> status = simulator.step(100);
+        assertThat(status.value().getSampleDistance(), closeTo(1, 1e-3));
+
+        simulator.scan(90);
+        status = run(simulator, 5);
+        assertThat(status.value().getSensorRelativeDeg(), equalTo(90));
+        assertThat(status.value().getSampleDistance(), equalTo(0.0));
+    }
+
+    @Test
+    void contact() {
+        RobotSimulator simulator = RobotSimulator.create(WALL, new Point2D.Double(0.5, 0), 0, 0)
+                .move(MoveCommand.create(0, 1));
+        Timed<WheellyStatus> status = run(simulator, 30);
+
+        assertThat(status.value().getRobotLocation().getX(), lessThan(1 - ContactSensors.X_FRONT + 0.05));
+        assertThat(status.value().getCannotMoveForward(), equalTo(true));
+        assertThat(status.value().getCannotMoveBackward(), equalTo(false));
+        assertThat(status.value().isContact(ContactSensors.FRONT_MASK), equalTo(true));
+    }
+
+    @Test
+    void rayCast() {
+        assertThat(RobotSimulator.rayCast(WALL, 0, 0, 0, 3), closeTo(1, 1e-9));
+        assertThat(RobotSimulator.rayCast(WALL, 0, 0, Math.PI, 3), equalTo(Double.POSITIVE_INFINITY));
+        assertThat(RobotSimulator.rayCast(WALL, 0, 0, Math.PI / 6, 3), closeTo(1 / Math.cos(Math.PI / 6), 1e-9));
+        assertThat(RobotSimulator.rayCast(WALL, -3, 0, 0, 3), equalTo(Double.POSITIVE_INFINITY));
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import io.reactivex.rxjava3.core.Flowable;
+import io.reactivex.rxjava3.schedulers.Timed;
+import io.reactivex.rxjava3.subscribers.TestSubscriber;
+import org.junit.jupiter.api.Test;
+
+import java.awt.geom.Point2D;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+
+class SimulatedControllerTest {
+
+    @Test
+    void statusFasterThanRealTime() throws InterruptedException {
+        SimulatedController controller = SimulatedController.create(List.of(), new Point2D.Double(), 0, 100, 100);
+        TestSubscriber<Timed<WheellyStatus>> states = controller.readStatus().take(20).test();
+        TestSubscriber<Boolean> connection = controller.readConnection().test();
+        controller.action(Flowable.just(MoveCommand.create(0, 1)));
+        controller.start();
+
+        // 2 s of simulated time in 20 ms of real time
+        states.await(1, TimeUnit.SECONDS);
+        controller.close();
+
+        states.assertComplete();
+        states.assertValueCount(20);
+        List<Timed<WheellyStatus>> values = states.values();
+        for (int i = 1; i < values.size(); i++) {
+            assertThat(values.get(i).time() - values.get(i - 1).time(), equalTo(100L));
+        }
+        assertThat(values.get(19).value().getRobotLocation().getX(), greaterThan(0.1));
+        connection.assertValues(false, true, false);
+    }
+
+    @Test
+    void invalidSpeedUp() {
+        IllegalArgumentException ex = assertThrows(IllegalArgumentException.class,
+                () -> SimulatedController.create(List.of(), new Point2D.Double(), 0, 100, 0));
+        assertThat(ex.getMessage(), containsString("Speed up"));
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.Test;
+
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.OutputStream;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.nio.ByteBuffer;
+import java.nio.channels.SocketChannel;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.hamcrest.Matchers.instanceOf;
+
+class SocketSelectorTest {
+
+    private ServerSocket server;
+    private SocketSelector selector;
+
+    /**
+     * Returns the handler completing the futures
+     *
+     * @param data  the future of the first received text
+     * @param error the future of error
+     * @param end   the future of end of stream
+     */
+    static SocketSelector.Handler handler(CompletableFuture<String> data, CompletableFuture<Throwable> error,
+                                          CompletableFuture<Boolean> end) {
+        return new SocketSelector.Handler() {
+            @Override
+            public void onEnd() {
+                end.complete(true);
+            }
+
+            @Override
+            public void onError(Throwable ex) {
+                error.complete(ex);
+            }
+
+            @Override
+            public void onRead(ByteBuffer buffer, long timestamp) {
+                data.complete(new String(buffer.array(), 0, buffer.position(), StandardCharsets.UTF_8));
+                buffer.clear();
+            }
+        };
+    }
+
+    private SocketChannel connect() throws IOException {
+        return SocketChannel.open(new InetSocketAddress(InetAddress.getLoopbackAddress(), server.getLocalPort()));
+    }
+
+    @BeforeEach
+    void setUp() throws IOException {
+        server = new ServerSocket(0, 10, InetAddress.getLoopbackAddress());
+        selector = SocketSelector.create("test-selector");
+    }
+
+    @AfterEach
+    void tearDown() throws IOException {
+        selector.close();
+        server.close();
+    }
+
+    @Test
+    void end() throws Exception {
+        CompletableFuture<Boolean> end = new CompletableFuture<>();
+        try (SocketChannel channel = connect()) {
+            Socket peer = server.accept();
+            selector.register(channel, ByteBuffer.allocate(64), 0,
+                    handler(new CompletableFuture<>(), new CompletableFuture<>(), end));
+            peer.close();
+            assertThat(end.get(5, TimeUnit.SECONDS), equalTo(true));
+        }
+    }
+
+    @Test
+    void readWrite() throws Exception {
+        CompletableFuture<String> data = new CompletableFuture<>();
+        try (SocketChannel channel = connect(); Socket peer = server.accept()) {
+            SocketSelector.Registration registration = selector.register(channel, ByteBuffer.allocate(64), 0,
+                    handler(data, new CompletableFuture<>(), new CompletableFuture<>()));
+            OutputStream out = peer.getOutputStream();
+            out.write("st 1\n".getBytes(StandardCharsets.UTF_8));
+            out.flush();
+            assertThat(data.get(5, TimeUnit.SECONDS), equalTo("st 1\n"));
+
+            registration.write(ByteBuffer.wrap("mv 0 0\n".getBytes(StandardCharsets.UTF_8)));
+            BufferedReader in = new BufferedReader(new InputStreamReader(peer.getInputStream(), StandardCharsets.UTF_8));
+            assertThat(in.readLine(), equalTo("mv 0 0"));
+        }
+    }
+
+    @Test
+    void multipleChannels() throws Exception {
+        CompletableFuture<String> data0 = new CompletableFuture<>();
+        CompletableFuture<String> data1 = new CompletableFuture<>();
+        try (SocketChannel channel0 = connect(); Socket peer0 = server.accept();
+             SocketChannel channel1 = connect(); Socket peer1 = server.accept()) {
+            selector.register(channel0, ByteBuffer.allocate(64), 0,
+                    handler(data0, new CompletableFuture<>(), new CompletableFuture<>()));
+            selector.register(channel1, ByteBuffer.allocate(64), 0,
+                    handler(data1, new CompletableFuture<>(), new CompletableFuture<>()));
+            peer1.getOutputStream().write("cs 1\n".getBytes(StandardCharsets.UTF_8));
+            peer0.getOutputStream().write("cs 0\n".getBytes(StandardCharsets.UTF_8));
+            assertThat(data0.get(5, TimeUnit.SECONDS), equalTo("cs 0\n"));
+            assertThat(data1.get(5, TimeUnit.SECONDS), equalTo("cs 1\n"));
+            assertThat(selector.getNumChannels(), equalTo(2));
+        }
+    }
+
+    @Test
+    void timeout() throws Exception {
+        CompletableFuture<Throwable> error = new CompletableFuture<>();
+        try (SocketChannel channel = connect(); Socket ignored = server.accept()) {
+            selector.register(channel, ByteBuffer.allocate(64), 200,
+                    handler(new CompletableFuture<>(), error, new CompletableFuture<>()));
+            assertThat(error.get(5, TimeUnit.SECONDS), instanceOf(TimeoutException.class));
+            assertThat(channel.isOpen(), equalTo(false));
+        }
+    }
+}
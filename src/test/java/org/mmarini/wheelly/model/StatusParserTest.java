@@ -0,0 +1,134 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Locale;
+import java.util.Random;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+
+class StatusParserTest {
+
+    static StatusParser parser(String line) {
+        byte[] data = ("xx" + line + "yy").getBytes(StandardCharsets.UTF_8);
+        return StatusParser.create().reset(data, 2, data.length - 2);
+    }
+
+    @Test
+    void parseCps() {
+        StatusParser parser = parser("cs 123 45");
+        assertThat(parser.isCps(), equalTo(true));
+        assertThat(parser.isStatus(), equalTo(false));
+        assertThat(parser.parseCps(), equalTo(45));
+    }
+
+    @ParameterizedTest
+    @ValueSource(strings = {
+            "0", "1", "-1", "+2", "0.5", "-0.25", "123.456", "1e3", "1.5E-3", "-0", "-0.0",
+            "0.1", "0.30000000000000004", "12345678901234567890", "1e-30", "NaN", "Infinity"
+    })
+    void parseDouble(String value) {
+        String line = "st 0 " + value + " 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0";
+        WheellyStatus status = parser(line).parseStatus();
+        assertThat(status.getRobotLocation().getX(), equalTo(Double.parseDouble(value)));
+    }
+
+    @Test
+    void parseRandomDouble() {
+        Random random = new Random(1234);
+        for (int n = 0; n < 1000; n++) {
+            String value = String.format(Locale.ROOT, "%.3f", (random.nextDouble() - 0.5) * 20);
+            String line = "st 0 0 0 0 0 " + value + " 0 0 0 0 0 0 0 0 0 0 0";
+            WheellyStatus status = parser(line).parseStatus();
+            assertThat(status.getSampleDistance(), equalTo(Double.parseDouble(value)));
+        }
+    }
+
+    @Test
+    void parseSampleTime() {
+        assertThat(parser("st 4294967295 0.1 -0.2 -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30").parseSampleTime(),
+                equalTo(4294967295L));
+        assertThat(parser("cs 123 45").parseSampleTime(), equalTo(123L));
+        assertThrows(IllegalArgumentException.class, () -> parser("cs").parseSampleTime());
+        assertThrows(IllegalArgumentException.class, () -> parser("cs a 45").parseSampleTime());
+    }
+
+    @Test
+    void parseStatus() {
+        StatusParser parser = parser("st 1234 0.1 -0.2 -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30  ");
+        assertThat(parser.isStatus(), equalTo(true));
+        assertThat(parser.isCps(), equalTo(false));
+        WheellyStatus status = parser.parseStatus();
+        assertThat(status.getRobotLocation().getX(), equalTo(0.1));
+        assertThat(status.getRobotLocation().getY(), equalTo(-0.2));
+        assertThat(status.getRobotDeg(), equalTo(-90));
+        assertThat(status.getSensorRelativeDeg(), equalTo(45));
+        assertThat(status.getSampleDistance(), equalTo(0.85));
+        assertThat(status.getLeftSpeed(), equalTo(-0.5));
+        assertThat(status.getRightSpeed(), equalTo(0.5));
+        assertThat(status.getContactSensors(), equalTo(12));
+        assertThat(status.getVoltage(), equalTo(7.4));
+        assertThat(status.getCannotMoveForward(), equalTo(false));
+        assertThat(status.getCannotMoveBackward(), equalTo(true));
+        assertThat(status.isImuFailure(), equalTo(false));
+        assertThat(status.isHalt(), equalTo(true));
+        assertThat(status.getMoveDeg(), equalTo(30));
+        assertThat(status.getMoveSpeed(), equalTo(0.75));
+        assertThat(status.getNextSensorDeg(), equalTo(-30));
+    }
+
+    @ParameterizedTest
+    @ValueSource(strings = {
+            "st 1234 0.1 -0.2 -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75",
+            "st 1234 0.1 -0.2 -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30 1",
+            "st 1234 0.1 -0.2 -90.5 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30",
+            "st 1234 0.1  -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30",
+            "st 1234 0.1 a -90 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30",
+            "st 1234 0.1 0 99999999999 45 0.85 -0.5 0.5 12 7.4 1 0 0 1 30 0.75 -30",
+    })
+    void wrongStatus(String line) {
+        assertThrows(IllegalArgumentException.class, () -> parser(line).parseStatus());
+        assertThrows(IllegalArgumentException.class, () -> WheellyStatus.from(line));
+    }
+
+    @Test
+    void wrongCps() {
+        assertThrows(IllegalArgumentException.class, () -> parser("cs 123").parseCps());
+        assertThrows(IllegalArgumentException.class, () -> parser("cs 123 4 5").parseCps());
+        assertThrows(IllegalArgumentException.class, () -> parser("cs 123 a").parseCps());
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.model;
+
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.CsvSource;
+
+import java.awt.geom.Point2D;
+import java.nio.ByteBuffer;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.equalTo;
+import static org.mmarini.wheelly.model.TelemetryFrames.*;
+
+class TelemetryFramesTest {
+
+    @Test
+    void cpsFrame() {
+        ByteBuffer bfr = ByteBuffer.allocate(64).order(BYTE_ORDER);
+        bfr.put((byte) 0);
+        writeCps(bfr, 65535, 1234, 987);
+
+        assertThat(bfr.position(), equalTo(1 + CPS_FRAME_SIZE));
+        assertThat(frameSize(bfr.get(1)), equalTo(CPS_FRAME_SIZE));
+        assertThat(sequence(bfr, 1), equalTo(65535));
+        assertThat(cps(bfr, 1), equalTo(987));
+    }
+
+    @ParameterizedTest
+    @CsvSource({
+            "0,1,0",
+            "0,2,1",
+            "10,15,4",
+            "65535,0,0",
+            "65534,1,2",
+            "3,3,65535",
+    })
+    void lostFramesTest(int previous, int current, int expected) {
+        assertThat(lostFrames(previous, current), equalTo(expected));
+    }
+
+    @Test
+    void statusFrame() {
+        WheellyStatus expected = WheellyStatus.create(new Point2D.Double(0.5, -1.25), -90,
+                45, 0.75,
+                -0.5, 0.25,
+                12, 7.5,
+                true, false,
+                false, true,
+                -135, 0.5, 30);
+        ByteBuffer bfr = ByteBuffer.allocate(64).order(BYTE_ORDER);
+        bfr.put((byte) 0);
+        writeStatus(bfr, 123, 4567, expected);
+
+        assertThat(bfr.position(), equalTo(1 + STATUS_FRAME_SIZE));
+        assertThat(frameSize(bfr.get(1)), equalTo(STATUS_FRAME_SIZE));
+        assertThat(sequence(bfr, 1), equalTo(123));
+        WheellyStatus status = status(bfr, 1);
+        assertThat(status.getRobotLocation(), equalTo(expected.getRobotLocation()));
+        assertThat(status.getRobotDeg(), equalTo(-90));
+        assertThat(status.getSensorRelativeDeg(), equalTo(45));
+        assertThat(status.getSampleDistance(), equalTo(0.75));
+        assertThat(status.getLeftSpeed(), equalTo(-0.5));
+        assertThat(status.getRightSpeed(), equalTo(0.25));
+        assertThat(status.getContactSensors(), equalTo(12));
+        assertThat(status.getVoltage(), equalTo(7.5));
+        assertThat(status.getCannotMoveForward(), equalTo(false));
+        assertThat(status.getCannotMoveBackward(), equalTo(true));
+        assertThat(status.isImuFailure(), equalTo(false));
+        assertThat(status.isHalt(), equalTo(true));
+        assertThat(status.getMoveDeg(), equalTo(-135));
+        assertThat(status.getMoveSpeed(), equalTo(0.5));
+        assertThat(status.getNextSensorDeg(), equalTo(30));
+    }
+
+    @Test
+    void unknownFrame() {
+        assertThat(frameSize((byte) 0), equalTo(-1));
+        assertThat(frameSize((byte) 's'), equalTo(-1));
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.wheelly.swing;
+
+import org.junit.jupiter.api.Test;
+
+import java.awt.*;
+import java.awt.geom.Rectangle2D;
+import java.util.Map;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+
+class CellLayerTest {
+
+    public static final double GRID_SIZE = 0.2;
+
+    @Test
+    void empty() {
+        CellLayer layer = new CellLayer();
+        assertThat(layer.update(GRID_SIZE, Map.of()), nullValue());
+        assertThat(layer.getBounds(), nullValue());
+    }
+
+    @Test
+    void first() {
+        CellLayer layer = new CellLayer();
+        Rectangle2D dirty = layer.update(GRID_SIZE, Map.of(
+                new Point(0, 0), Color.RED,
+                new Point(2, -1), Color.GREEN));
+
+        assertThat(dirty, equalTo(layer.getBounds()));
+        assertThat(dirty.contains(0, 0), equalTo(true));
+        assertThat(dirty.contains(0.4, -0.2), equalTo(true));
+        assertThat(layer.getColor(new Point(0, 0)), equalTo(Color.RED));
+        assertThat(layer.getColor(new Point(2, -1)), equalTo(Color.GREEN));
+        assertThat(layer.getColor(new Point(1, 0)), nullValue());
+    }
+
+    @Test
+    void unchanged() {
+        CellLayer layer = new CellLayer();
+        Map<Point, Color> cells = Map.of(
+                new Point(0, 0), Color.RED,
+                new Point(2, -1), Color.GREEN);
+        layer.update(GRID_SIZE, cells);
+
+        assertThat(layer.update(GRID_SIZE, cells), nullValue());
+    }
+
+    @Test
+    void changed() {
+        CellLayer layer = new CellLayer();
+        layer.update(GRID_SIZE, Map.of(
+                new Point(0, 0), Color.RED,
+                new Point(2, -1), Color.GREEN,
+                new Point(4, 4), Color.BLUE));
+        Rectangle2D bounds = layer.getBounds();
+
+        Rectangle2D dirty = layer.update(GRID_SIZE, Map.of(
+                new Point(0, 0), Color.RED,
+                new Point(2, -1), Color.BLUE,
+                new Point(3, -1), Color.BLUE));
+
+        assertThat(layer.getBounds(), equalTo(bounds));
+        assertThat(dirty.getMinX(), closeTo(0.3, 1e-6));
+        assertThat(dirty.getMinY(), closeTo(-0.3, 1e-6));
+        assertThat(dirty.getMaxX(), closeTo(0.9, 1e-6));
+        assertThat(dirty.getMaxY(), closeTo(0.9, 1e-6));
+        assertThat(layer.getColor(new Point(0, 0)), equalTo(Color.RED));
+        assertThat(layer.getColor(new Point(2, -1)), equalTo(Color.BLUE));
+        assertThat(layer.getColor(new Point(3, -1)), equalTo(Color.BLUE));
+        assertThat(layer.getColor(new Point(4, 4)), nullValue());
+    }
+
+    @Test
+    void outside() {
+        CellLayer layer = new CellLayer();
+        layer.update(GRID_SIZE, Map.of(new Point(0, 0), Color.RED));
+        Rectangle2D bounds = layer.getBounds();
+
+        Point far = new Point(CellLayer.MARGIN * 4, 0);
+        Rectangle2D dirty = layer.update(GRID_SIZE, Map.of(far, Color.GREEN));
+
+        assertThat(dirty.contains(bounds), equalTo(true));
+        assertThat(dirty.contains(layer.getBounds()), equalTo(true));
+        assertThat(layer.getColor(far), equalTo(Color.GREEN));
+        assertThat(layer.getColor(new Point(0, 0)), nullValue());
+    }
+}
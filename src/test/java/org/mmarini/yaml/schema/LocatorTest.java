@@ -0,0 +1,133 @@
+/*
+ *
+ * Copyright (c) 2022 Marco Marini, marco.marini@mmarini.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *    END OF TERMS AND CONDITIONS
+ *
+ */
+
+package org.mmarini.yaml.schema;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import org.junit.jupiter.api.Test;
+
+import java.io.IOException;
+import java.util.List;
+import java.util.Map;
+import java.util.stream.Collectors;
+
+import static org.hamcrest.MatcherAssert.assertThat;
+import static org.hamcrest.Matchers.*;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+import static org.mmarini.yaml.Utils.fromText;
+
+class LocatorTest {
+    static final String DOC = String.join("\n",
+            "a:",
+            "  b:",
+            "    - x: 1",
+            "    - x: 2",
+            "  c: text",
+            "d: 3.5");
+
+    @Test
+    void cachedNode() throws IOException {
+        JsonNode root = fromText(DOC);
+        Locator locator = Locator.locate("a").path("b").path("1");
+
+        JsonNode node = locator.getNode(root);
+
+        assertThat(locator.getNode(root), sameInstance(node));
+        assertThat(locator.path("x").getNode(root).asInt(), equalTo(2));
+    }
+
+    @Test
+    void elements() throws IOException {
+        JsonNode root = fromText(DOC);
+        List<Integer> values = Locator.locate("a/b").elements(root)
+                .map(l -> l.path("x").getNode(root).asInt())
+                .collect(Collectors.toList());
+
+        assertThat(values, contains(1, 2));
+    }
+
+    @Test
+    void missing() throws IOException {
+        JsonNode root = fromText(DOC);
+
+        assertThat(Locator.locate("a").path("z").path("y").getNode(root).isMissingNode(), equalTo(true));
+        assertThat(Locator.locate("d").path("y").getNode(root).isMissingNode(), equalTo(true));
+    }
+
+    @Test
+    void otherDocument() throws IOException {
+        JsonNode root1 = fromText(DOC);
+        JsonNode root2 = fromText("a: {c: other}");
+        Locator locator = Locator.locate("a").path("c");
+
+        assertThat(locator.getNode(root1).asText(), equalTo("text"));
+        assertThat(locator.getNode(root2).asText(), equalTo("other"));
+        assertThat(locator.getNode(root1).asText(), equalTo("text"));
+    }
+
+    @Test
+    void pointer() {
+        Locator locator = Locator.root().path("a").path("b/0");
+
+        assertThat(locator.toString(), equalTo("/a/b/0"));
+        assertThat(locator.parent().toString(), equalTo("/a/b"));
+        assertThat(locator.parent(3), hasToString(""));
+    }
+
+    @Test
+    void root() throws IOException {
+        JsonNode root = fromText(DOC);
+
+        assertThat(Locator.root().getNode(root), sameInstance(root));
+    }
+
+    @Test
+    void validate() throws IOException {
+        JsonNode root = fromText(DOC);
+        Validator validator = Validator.objectPropertiesRequired(Map.of(
+                "a", Validator.objectProperties(Map.of(
+                        "b", Validator.arrayItems(Validator.objectPropertiesRequired(Map.of(
+                                "x", Validator.positiveInteger()), List.of("x"))),
+                        "c", Validator.string(Validator.pattern("t.*t")))),
+                "d", Validator.integer()
+        ), List.of("a"));
+
+        IllegalArgumentException ex = assertThrows(IllegalArgumentException.class,
+                () -> validator.apply(Locator.root()).accept(root));
+        assertThat(ex.getMessage(), containsString("/d"));
+
+        JsonNode valid = fromText("a: {b: [{x: 1}], c: test}\nd: 1");
+        Validator.objectPropertiesRequired(Map.of(
+                "a", Validator.objectProperties(Map.of(
+                        "b", Validator.arrayItems(Validator.objectPropertiesRequired(Map.of(
+                                "x", Validator.positiveInteger()), List.of("x"))),
+                        "c", Validator.string(Validator.pattern("t.*t"))))
+        ), List.of("a")).apply(Locator.root()).accept(valid);
+    }
+}